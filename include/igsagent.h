@@ -179,6 +179,19 @@ INGESCAPE_EXPORT void igsagent_input_set_description(igsagent_t *self, const cha
 INGESCAPE_EXPORT void igsagent_output_set_description(igsagent_t *self, const char *name, const char *description);
 INGESCAPE_EXPORT void igsagent_parameter_set_description(igsagent_t *self, const char *name, const char *description);
 
+INGESCAPE_EXPORT igs_result_t igsagent_input_set_history(igsagent_t *self, const char *name, size_t depth);
+INGESCAPE_EXPORT igs_result_t igsagent_output_set_history(igsagent_t *self, const char *name, size_t depth);
+INGESCAPE_EXPORT igs_result_t igsagent_parameter_set_history(igsagent_t *self, const char *name, size_t depth);
+INGESCAPE_EXPORT size_t igsagent_input_history(igsagent_t *self, const char *name, size_t max_samples, int64_t since,
+                                               const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                                               const igs_iop_sample_t **second_part, size_t *second_part_nbr);
+INGESCAPE_EXPORT size_t igsagent_output_history(igsagent_t *self, const char *name, size_t max_samples, int64_t since,
+                                                const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                                                const igs_iop_sample_t **second_part, size_t *second_part_nbr);
+INGESCAPE_EXPORT size_t igsagent_parameter_history(igsagent_t *self, const char *name, size_t max_samples, int64_t since,
+                                                   const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                                                   const igs_iop_sample_t **second_part, size_t *second_part_nbr);
+
 /*These two functions enable sending and receiving DATA
  inputs/outputs by using zmsg_t structures. zmsg_t structures
  offer advanced functionalities for data serialization.
@@ -203,6 +216,12 @@ INGESCAPE_EXPORT void igsagent_observe_input (igsagent_t *self, const char *name
 INGESCAPE_EXPORT void igsagent_observe_output (igsagent_t *self, const char *name, igsagent_iop_fn cb, void *data);
 INGESCAPE_EXPORT void igsagent_observe_parameter (igsagent_t *self, const char *name, igsagent_iop_fn cb, void *data);
 
+typedef void (igsagent_inputs_batch_fn) (igsagent_t *agent,
+                                         const igs_iop_value_t *inputs,
+                                         size_t inputs_nbr,
+                                         void *data);
+INGESCAPE_EXPORT void igsagent_observe_inputs_batch (igsagent_t *self, igsagent_inputs_batch_fn cb, void *data);
+
 INGESCAPE_EXPORT void igsagent_output_mute (igsagent_t *self, const char *name);
 INGESCAPE_EXPORT void igsagent_output_unmute (igsagent_t *self, const char *name);
 INGESCAPE_EXPORT bool igsagent_output_is_muted (igsagent_t *self, const char *name);
@@ -220,6 +239,13 @@ INGESCAPE_EXPORT void igsagent_clear_mappings (igsagent_t *self);
 INGESCAPE_EXPORT void igsagent_clear_mappings_with_agent (igsagent_t *self, const char *agent_name);
 
 INGESCAPE_EXPORT uint64_t igsagent_mapping_add (igsagent_t *self, const char *from_our_input, const char *to_agent, const char *with_output);
+INGESCAPE_EXPORT uint64_t igsagent_mapping_add_with_reducer (igsagent_t *self, const char *from_our_input,
+                                                             const char *to_agent, const char *with_output,
+                                                             igs_reducer_t reducer, size_t window_samples,
+                                                             unsigned int window_ms);
+INGESCAPE_EXPORT igs_result_t igsagent_mapping_set_reducer (igsagent_t *self, uint64_t id,
+                                                           igs_reducer_t reducer, size_t window_samples,
+                                                           unsigned int window_ms);
 INGESCAPE_EXPORT igs_result_t igsagent_mapping_remove_with_id (igsagent_t *self, uint64_t id);
 INGESCAPE_EXPORT igs_result_t igsagent_mapping_remove_with_name (igsagent_t *self,
                                                                  const char *from_our_input,
@@ -233,6 +259,20 @@ INGESCAPE_EXPORT igs_result_t igsagent_split_remove_with_name (igsagent_t *self,
                                                                const char *from_our_input,
                                                                const char *to_agent,
                                                                const char *with_output);
+INGESCAPE_EXPORT void igsagent_split_set_batch_size (igsagent_t *self, size_t batch_size);
+INGESCAPE_EXPORT size_t igsagent_split_batch_size (igsagent_t *self);
+INGESCAPE_EXPORT void igsagent_split_set_scheduling (igsagent_t *self, igs_split_scheduling_t scheduling);
+INGESCAPE_EXPORT igs_split_scheduling_t igsagent_split_scheduling (igsagent_t *self);
+INGESCAPE_EXPORT void igsagent_split_set_key_prefix (igsagent_t *self, size_t prefix_length);
+INGESCAPE_EXPORT size_t igsagent_split_key_prefix (igsagent_t *self);
+INGESCAPE_EXPORT void igsagent_split_set_key (igsagent_t *self, const char *output_name, const char *key);
+INGESCAPE_EXPORT void igsagent_split_set_work_timeout (igsagent_t *self, unsigned int timeout_ms);
+INGESCAPE_EXPORT unsigned int igsagent_split_work_timeout (igsagent_t *self);
+INGESCAPE_EXPORT void igsagent_split_set_max_retries (igsagent_t *self, unsigned int max_retries);
+INGESCAPE_EXPORT unsigned int igsagent_split_max_retries (igsagent_t *self);
+INGESCAPE_EXPORT size_t igsagent_split_requeued (igsagent_t *self, const char *output_name);
+INGESCAPE_EXPORT igs_split_worker_stats_t * igsagent_split_workers_stats (igsagent_t *self, const char *output_name,
+                                                                          size_t *workers_nbr);
 
 INGESCAPE_EXPORT bool igsagent_mapping_outputs_request (igsagent_t *self);
 INGESCAPE_EXPORT void igsagent_mapping_set_outputs_request (igsagent_t *self, bool notify);
@@ -250,6 +290,33 @@ INGESCAPE_EXPORT igs_result_t igsagent_service_call (igsagent_t *self,
                                                      const char *service_name,
                                                      igs_service_arg_t **list,
                                                      const char *token);
+INGESCAPE_EXPORT igs_result_t igsagent_service_call_bulk (igsagent_t *self,
+                                                          const char **targets,
+                                                          size_t targets_nbr,
+                                                          const char *service_name,
+                                                          igs_service_arg_t **list,
+                                                          const char *token);
+typedef void (igsagent_service_reply_fn) (igsagent_t *agent,
+                                          uint64_t call_id,
+                                          igs_service_call_status_t status,
+                                          igs_service_arg_t *first_argument,
+                                          size_t args_nbr,
+                                          void *data);
+INGESCAPE_EXPORT uint64_t igsagent_service_call_async (igsagent_t *self,
+                                                       const char *agent_name_or_uuid,
+                                                       const char *service_name,
+                                                       igs_service_arg_t **list,
+                                                       unsigned int timeout_ms,
+                                                       igsagent_service_reply_fn cb,
+                                                       void *data);
+INGESCAPE_EXPORT igs_result_t igsagent_service_reply (igsagent_t *self,
+                                                      const char *caller_agent_uuid,
+                                                      const char *token,
+                                                      igs_service_arg_t **list);
+INGESCAPE_EXPORT size_t igsagent_service_latencies (igsagent_t *self,
+                                                    const char *service_name,
+                                                    size_t *histogram,
+                                                    size_t buckets_nbr);
 
 typedef void (igsagent_service_fn) (igsagent_t *agent,
                                     const char *sender_agent_name,
@@ -266,6 +333,16 @@ INGESCAPE_EXPORT igs_result_t igsagent_service_arg_add (igsagent_t *self,
                                                         const char *arg_name,
                                                         igs_iop_value_type_t value_type);
 INGESCAPE_EXPORT igs_result_t igsagent_service_arg_remove (igsagent_t *self, const char *service_name, const char *arg_name);
+INGESCAPE_EXPORT igs_result_t igsagent_service_set_concurrency (igsagent_t *self,
+                                                                const char *service_name,
+                                                                size_t max_in_flight,
+                                                                size_t queue_capacity);
+INGESCAPE_EXPORT igs_result_t igsagent_service_metrics (igsagent_t *self,
+                                                        const char *service_name,
+                                                        size_t *executed,
+                                                        size_t *rejected,
+                                                        double *average_queue_time_ms,
+                                                        double *average_run_time_ms);
 INGESCAPE_EXPORT size_t igsagent_service_count (igsagent_t *self);
 INGESCAPE_EXPORT bool igsagent_service_exists (igsagent_t *self, const char *service_name);
 INGESCAPE_EXPORT char ** igsagent_service_list (igsagent_t *self, size_t *nb_of_elements);//returned char** must be freed using igs_free_services_list
@@ -288,6 +365,13 @@ INGESCAPE_EXPORT void igsagent_definition_save (igsagent_t *self);
 INGESCAPE_EXPORT void igsagent_mapping_set_path (igsagent_t *self, const char *path);
 INGESCAPE_EXPORT void igsagent_mapping_save (igsagent_t *self);
 
+INGESCAPE_EXPORT void igsagent_inbound_queue_set (igsagent_t *self, size_t capacity, igs_queue_policy_t policy);
+INGESCAPE_EXPORT size_t igsagent_inbound_queue_size (igsagent_t *self);
+INGESCAPE_EXPORT size_t igsagent_inbound_queue_dropped (igsagent_t *self);
+INGESCAPE_EXPORT void igsagent_split_queue_set (igsagent_t *self, size_t capacity, igs_queue_policy_t policy);
+INGESCAPE_EXPORT size_t igsagent_split_queue_size (igsagent_t *self, const char *output_name);
+INGESCAPE_EXPORT size_t igsagent_split_queue_dropped (igsagent_t *self, const char *output_name);
+
 #ifdef __cplusplus
 }
 #endif
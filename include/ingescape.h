@@ -101,6 +101,11 @@ typedef struct _igs_service_arg_t igs_service_arg_t;
 #define IGS_DEFAULT_IPC_FOLDER_PATH "/tmp/ingescape/"  //
 #define IGS_MAX_STRING_MSG_LENGTH 4096       //
 #define IGS_DEFAULT_WORKER_CREDIT 3          //
+#define IGS_DEFAULT_SPLIT_QUEUE_CAPACITY 1024  //
+#define IGS_DEFAULT_SPLIT_MAX_RETRIES 3 //
+#define IGS_DEFAULT_SPLIT_LOCAL_THREADS 1 //
+#define IGS_DEFAULT_UPDATE_DEBOUNCE 5 //
+#define IGS_SERVICE_LATENCY_BUCKETS 16 //
 #define IGS_DEFAULT_LOG_DIR "~/Documents/IngeScape/logs/"  //
 
 #ifdef __cplusplus
@@ -367,6 +372,43 @@ INGESCAPE_EXPORT void igs_input_set_description(const char *name, const char *de
 INGESCAPE_EXPORT void igs_output_set_description(const char *name, const char *description);
 INGESCAPE_EXPORT void igs_parameter_set_description(const char *name, const char *description);
 
+/*IOP history
+ IOPs can keep their latest values in a ring buffer preallocated with
+ the requested depth. A depth of zero disables history (default).
+ Samples are timestamped in microseconds when the IOP is written.
+ History is read without copy, as a window of the latest max_samples
+ samples (zero for all samples) that are more recent than 'since'
+ (zero for no time limit). Because the ring may wrap, the window is
+ returned as one or two contiguous parts, each ordered from the oldest
+ to the newest sample. The total number of samples is returned.
+ Samples are owned by ingescape and remain valid until the IOP is written
+ again, i.e. they shall be read from an IOP callback or when no new
+ value can be received.*/
+typedef struct {
+    int64_t timestamp;
+    igs_iop_value_type_t type;
+    union{
+        bool b;
+        int i;
+        double d;
+        char *s;
+        void *data;
+    };
+    size_t size;
+} igs_iop_sample_t;
+INGESCAPE_EXPORT igs_result_t igs_input_set_history(const char *name, size_t depth);
+INGESCAPE_EXPORT igs_result_t igs_output_set_history(const char *name, size_t depth);
+INGESCAPE_EXPORT igs_result_t igs_parameter_set_history(const char *name, size_t depth);
+INGESCAPE_EXPORT size_t igs_input_history(const char *name, size_t max_samples, int64_t since,
+                                          const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                                          const igs_iop_sample_t **second_part, size_t *second_part_nbr);
+INGESCAPE_EXPORT size_t igs_output_history(const char *name, size_t max_samples, int64_t since,
+                                           const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                                           const igs_iop_sample_t **second_part, size_t *second_part_nbr);
+INGESCAPE_EXPORT size_t igs_parameter_history(const char *name, size_t max_samples, int64_t since,
+                                              const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                                              const igs_iop_sample_t **second_part, size_t *second_part_nbr);
+
 /*These two functions enable sending and receiving DATA on
  inputs/outputs by using zmsg_t structures. zmsg_t structures
  offer advanced functionalities for data serialization.
@@ -391,6 +433,24 @@ INGESCAPE_EXPORT void igs_observe_input(const char *name, igs_iop_fn cb, void *m
 INGESCAPE_EXPORT void igs_observe_output(const char *name, igs_iop_fn cb, void *my_data);
 INGESCAPE_EXPORT void igs_observe_parameter(const char *name, igs_iop_fn cb, void *my_data);
 
+/*observe changes to our inputs as a batch
+ Instead of one call per changed input, the callback is called once per
+ received publication (which may contain many outputs) with the latest
+ value of each input that changed. Inputs written directly, e.g. with
+ igs_input_set_*, are notified as a batch of one input.
+ Callbacks observing single inputs are still called, before the batch.
+ Values in the batch are only valid during the callback.*/
+typedef struct {
+    const char *name;
+    igs_iop_value_type_t value_type;
+    void *value;
+    size_t value_size;
+} igs_iop_value_t;
+typedef void (igs_inputs_batch_fn)(const igs_iop_value_t *inputs,
+                                   size_t inputs_nbr,
+                                   void *my_data);
+INGESCAPE_EXPORT void igs_observe_inputs_batch(igs_inputs_batch_fn cb, void *my_data);
+
 //mute or unmute an output
 INGESCAPE_EXPORT void igs_output_mute(const char *name);
 INGESCAPE_EXPORT void igs_output_unmute(const char *name);
@@ -419,6 +479,40 @@ INGESCAPE_EXPORT igs_result_t igs_mapping_remove_with_name(const char *from_our_
                                                            const char *to_agent,
                                                            const char *with_output);
 
+/*Mapping reducers are evaluated when receiving values from the mapped
+ output, before they are written to our input. Instead of one input
+ write (and one callback) per received value, a reducer produces one
+ value per window. A window is closed when window_samples values have
+ been received or when window_ms milliseconds have elapsed since its
+ first value. Time windows are closed by a timer of the ingescape loop, even
+ when no new value is received. At least one of them must be non-zero.
+ Reducers are part of the mapping and are exported in JSON. The reducer of
+ an existing mapping element is changed with igs_mapping_set_reducer, and
+ IGS_REDUCER_NONE removes it.
+ - IGS_REDUCER_DECIMATE : first value of each window
+ - IGS_REDUCER_LAST : last value of each window
+ - IGS_REDUCER_AVERAGE, IGS_REDUCER_MIN, IGS_REDUCER_MAX : computed on
+ INTEGER, DOUBLE and BOOL values and delivered as a DOUBLE. Other types
+ are handled like IGS_REDUCER_LAST.*/
+typedef enum {
+    IGS_REDUCER_NONE = 0,
+    IGS_REDUCER_DECIMATE,
+    IGS_REDUCER_AVERAGE,
+    IGS_REDUCER_MIN,
+    IGS_REDUCER_MAX,
+    IGS_REDUCER_LAST
+} igs_reducer_t;
+INGESCAPE_EXPORT uint64_t igs_mapping_add_with_reducer(const char *from_our_input,
+                                                       const char *to_agent,
+                                                       const char *with_output,
+                                                       igs_reducer_t reducer,
+                                                       size_t window_samples,
+                                                       unsigned int window_ms); //returns mapping id or zero if creation failed
+INGESCAPE_EXPORT igs_result_t igs_mapping_set_reducer(uint64_t id,
+                                                   igs_reducer_t reducer,
+                                                   size_t window_samples,
+                                                   unsigned int window_ms);
+
 //edit our splits
 INGESCAPE_EXPORT size_t igs_split_count(void); //number of splits entries
 INGESCAPE_EXPORT uint64_t igs_split_add(const char *from_our_input,
@@ -428,6 +522,80 @@ INGESCAPE_EXPORT igs_result_t igs_split_remove_with_id(uint64_t the_id);
 INGESCAPE_EXPORT igs_result_t igs_split_remove_with_name(const char *from_our_input,
                                                          const char *to_agent,
                                                          const char *with_output);
+/*As a worker, our agent receives split values one by one by default and
+ acknowledges each of them. With a batch size above one, splitters send us
+ up to batch_size values per message, which we acknowledge with a single
+ message. This reduces round-trips for small values. The batch size is
+ declared to splitters when our splits are created : set it before adding
+ splits. Batches require splitters running this version of ingescape.*/
+INGESCAPE_EXPORT void igs_split_set_batch_size(size_t batch_size);
+INGESCAPE_EXPORT size_t igs_split_batch_size(void);
+
+/*As a splitter, our agent measures the service time of each worker,
+ i.e. the time between sending works and receiving their acknowledgment,
+ averaged as an EWMA. Scheduling decides which worker receives the next
+ works among those having credit:
+ • IGS_SPLIT_SCHEDULING_CREDIT (default) : worker with more credit, then
+ less uses
+ • IGS_SPLIT_SCHEDULING_LATENCY : worker with the smallest service time,
+ then less uses, workers not measured yet being tried first
+ • IGS_SPLIT_SCHEDULING_POWER_OF_TWO : smallest service time between two
+ random workers, which avoids herding on a single worker when service
+ times are noisy
+ • IGS_SPLIT_SCHEDULING_KEY_AFFINITY : works having the same key always go
+ to the same worker, so that workers can keep a state per key. Keys are
+ spread on workers by consistent hashing : when a worker joins or leaves,
+ only the keys of its share of the ring move. Works wait for the credit
+ of their worker, in order. The key is the one set with igs_split_set_key
+ for the output or, by default, the first bytes of the value as set with
+ igs_split_set_key_prefix (whole value when zero).*/
+typedef enum {
+    IGS_SPLIT_SCHEDULING_CREDIT = 0,
+    IGS_SPLIT_SCHEDULING_LATENCY,
+    IGS_SPLIT_SCHEDULING_POWER_OF_TWO,
+    IGS_SPLIT_SCHEDULING_KEY_AFFINITY
+} igs_split_scheduling_t;
+INGESCAPE_EXPORT void igs_split_set_scheduling(igs_split_scheduling_t scheduling);
+INGESCAPE_EXPORT igs_split_scheduling_t igs_split_scheduling(void);
+INGESCAPE_EXPORT void igs_split_set_key_prefix(size_t prefix_length);
+INGESCAPE_EXPORT size_t igs_split_key_prefix(void);
+INGESCAPE_EXPORT void igs_split_set_key(const char *output_name, const char *key); //key for next values of this output, NULL to use values again
+
+/*As a splitter, our agent keeps the works sent to a worker until they
+ are acknowledged. When the worker leaves, or when works are not
+ acknowledged within the work timeout, they are queued again, in front
+ of the other works, to be sent to a worker (at-least-once delivery).
+ Each work is requeued at most max_retries times before being dropped.
+ Timeout is disabled by default (zero) : works are requeued only when
+ their worker leaves. NB: when no worker remains, works wait in the
+ queue for a new worker.*/
+INGESCAPE_EXPORT void igs_split_set_work_timeout(unsigned int timeout_ms);
+INGESCAPE_EXPORT unsigned int igs_split_work_timeout(void);
+INGESCAPE_EXPORT void igs_split_set_max_retries(unsigned int max_retries);
+INGESCAPE_EXPORT unsigned int igs_split_max_retries(void);
+INGESCAPE_EXPORT size_t igs_split_requeued(const char *output_name); //number of works requeued for this output
+
+/*Workers running in the same process as their splitter do not use the
+ network : works are pushed in memory to a pool of threads writing the
+ inputs of the workers, and acknowledged directly. Use several threads
+ to run the workers of a process on several cores. NB: worker callbacks
+ are then called from these threads, possibly at the same time for
+ different workers. Changing the number of threads restarts the pool.*/
+INGESCAPE_EXPORT void igs_split_set_local_threads(size_t threads_nb);
+INGESCAPE_EXPORT size_t igs_split_local_threads(void);
+
+typedef struct {
+    char *worker_uuid;
+    char *input_name;
+    int credit;
+    size_t works_in_flight; //sent and not acknowledged yet
+    size_t works_done; //acknowledged
+    double service_time; //EWMA in milliseconds per work, zero if not measured yet
+    double service_time_max; //in milliseconds per work
+} igs_split_worker_stats_t;
+INGESCAPE_EXPORT igs_split_worker_stats_t * igs_split_workers_stats(const char *output_name,
+                                                                    size_t *workers_nbr); //returned value must be freed using igs_split_free_workers_stats
+INGESCAPE_EXPORT void igs_split_free_workers_stats(igs_split_worker_stats_t *stats, size_t workers_nbr);
 
 /*When mapping other agents, it is possible to ask the mapped
  agents to send us their current output values through a dedicated
@@ -447,6 +615,8 @@ INGESCAPE_EXPORT bool igs_mapping_outputs_request(void);
 
 //services arguments
 //When a service call is received, service arguments are provided as a chained list.
+//This list is read-only and only valid during the service callback : strings and
+//data may point directly into the received message.
 struct _igs_service_arg_t{
     char *name;
     igs_iop_value_type_t type;
@@ -483,6 +653,58 @@ INGESCAPE_EXPORT igs_result_t igs_service_call (const char *agent_name_or_uuid,
                                                 const char *service_name,
                                                 igs_service_arg_t **list,
                                                 const char *token);
+/*call of the same service on many agents : targets are agent names, uuids or
+ name patterns where '*' matches any sequence of characters. Arguments are
+ encoded once and agents hosted by the same peer are called with a single
+ message. The list is destroyed in any case.*/
+INGESCAPE_EXPORT igs_result_t igs_service_call_bulk (const char **targets,
+                                                     size_t targets_nbr,
+                                                     const char *service_name,
+                                                     igs_service_arg_t **list,
+                                                     const char *token);
+
+/*asynchronous call of a service expecting a reply
+ The call receives a unique id, passed as token to the called service, which
+ replies using igs_service_reply with the sender uuid and token it received.
+ A call completes when replied, after timeout_ms (zero for no timeout), when
+ cancelled or when rejected by the callee. If a callback is passed, it is
+ called once on completion and the reply arguments are destroyed afterwards.
+ Without callback, igs_service_call_wait shall be used to get the reply.
+ When the call cannot be sent, zero is returned and the callback is not called.
+ Latencies of replied calls are kept per service name in histograms of
+ IGS_SERVICE_LATENCY_BUCKETS buckets : bucket 0 for less than 1 ms, bucket n
+ for [2^(n-1), 2^n[ ms and the last bucket for longer latencies.
+ NB: timeouts are checked by the ingescape loop, i.e. after igs_start, and
+ by igs_service_call_wait, which shall not be called from ingescape callbacks
+ because replies from remote agents are received by the ingescape loop.*/
+typedef enum {
+    IGS_SERVICE_CALL_PENDING = 0,
+    IGS_SERVICE_CALL_REPLIED,
+    IGS_SERVICE_CALL_TIMED_OUT,
+    IGS_SERVICE_CALL_FAILED,
+    IGS_SERVICE_CALL_CANCELLED
+} igs_service_call_status_t;
+typedef void (igs_service_reply_fn)(uint64_t call_id,
+                                    igs_service_call_status_t status,
+                                    igs_service_arg_t *first_argument,
+                                    size_t args_nbr,
+                                    void *my_data);
+INGESCAPE_EXPORT uint64_t igs_service_call_async (const char *agent_name_or_uuid,
+                                                  const char *service_name,
+                                                  igs_service_arg_t **list,
+                                                  unsigned int timeout_ms,
+                                                  igs_service_reply_fn cb,
+                                                  void *my_data); //returns call id or zero if call failed
+//blocks until the call completes, reply must be destroyed by the caller
+INGESCAPE_EXPORT igs_service_call_status_t igs_service_call_wait (uint64_t call_id,
+                                                                  igs_service_arg_t **reply);
+INGESCAPE_EXPORT void igs_service_call_cancel (uint64_t call_id);
+INGESCAPE_EXPORT igs_result_t igs_service_reply (const char *caller_agent_uuid,
+                                                 const char *token,
+                                                 igs_service_arg_t **list);
+INGESCAPE_EXPORT size_t igs_service_latencies (const char *service_name,
+                                               size_t *histogram,
+                                               size_t buckets_nbr); //returns number of replied calls
 
 /*create /remove / edit a service offered by our agent
  Warning: only one callback can be attached to a service (further attempts will be ignored
@@ -501,6 +723,25 @@ INGESCAPE_EXPORT igs_result_t igs_service_arg_add(const char *service_name, cons
 INGESCAPE_EXPORT igs_result_t igs_service_arg_remove(const char *service_name,
                                                      const char *arg_name); //removes first occurence of an argument with this name
 
+/*By default, calls received from other peers are executed one at a time, in the
+ ingescape thread. A concurrent service runs up to max_in_flight calls at the
+ same time on worker threads, and queues up to queue_capacity further calls.
+ Calls beyond that are rejected immediately (asynchronous callers complete as
+ IGS_SERVICE_CALL_FAILED). Calls from agents in our own process keep running
+ synchronously in the caller's thread. Use zero max_in_flight to go back to the
+ default : calls already queued still run on a worker, one at a time, and new
+ calls are queued behind them until the queue is empty. Concurrent callbacks
+ must be thread-safe.*/
+INGESCAPE_EXPORT igs_result_t igs_service_set_concurrency(const char *service_name,
+                                                          size_t max_in_flight,
+                                                          size_t queue_capacity);
+//executed and rejected calls, average time spent in queue and in the callback
+INGESCAPE_EXPORT igs_result_t igs_service_metrics(const char *service_name,
+                                                  size_t *executed,
+                                                  size_t *rejected,
+                                                  double *average_queue_time_ms,
+                                                  double *average_run_time_ms);
+
 //introspection for services and their arguments
 INGESCAPE_EXPORT size_t igs_service_count(void);
 INGESCAPE_EXPORT bool igs_service_exists(const char *name);
@@ -785,6 +1026,92 @@ INGESCAPE_EXPORT void  igs_net_raise_sockets_limit(void); //UNIX only, to be cal
 //Set high water marks (HWM) for the publish/subscribe sockets.
 //Setting HWM to 0 means that they are disabled.
 INGESCAPE_EXPORT void igs_net_set_high_water_marks(int hwm_value);
+/*Split dispatches and service calls are notified on the channel of our
+ agents for editors, once per call by default, which doubles network
+ traffic for intensive splits and services. With a period, calls are
+ aggregated per edge and reported every period milliseconds, with their
+ number of calls, calls/s and bytes/s. A period of zero restores the
+ notification of each call (default).*/
+INGESCAPE_EXPORT void igs_net_set_telemetry_period(unsigned int period); //in milliseconds
+INGESCAPE_EXPORT unsigned int igs_net_telemetry_period(void);
+/*Changes to the definitions and mappings of our agents are propagated to
+ peers by the ingescape thread as soon as they happen. Changes made within
+ IGS_DEFAULT_UPDATE_DEBOUNCE milliseconds are coalesced in a single update.
+ A debounce of zero propagates changes immediately.*/
+INGESCAPE_EXPORT void igs_net_set_update_debounce(unsigned int debounce); //in milliseconds
+INGESCAPE_EXPORT unsigned int igs_net_update_debounce(void);
+/*LAZY DEFINITIONS
+ By default, each peer joining the platform receives the full definition
+ and mapping of all our agents, and parses those of all the other agents.
+ With lazy definitions, other peers only send us the name and a digest
+ of their agents' definitions. Full definitions and mappings are fetched
+ when our agents map or split to these agents or call their services, or
+ when igs_net_fetch_definition is used, e.g. by editors. Until then,
+ remote agents have definitions without any IOP or service.
+ Lazy definitions must be enabled before starting ingescape.*/
+INGESCAPE_EXPORT void igs_net_set_lazy_definitions(bool enabled);
+INGESCAPE_EXPORT bool igs_net_lazy_definitions(void);
+INGESCAPE_EXPORT igs_result_t igs_net_fetch_definition(const char *agent_name_or_uuid);
+/*Definitions received from remote agents can be stored in a directory,
+ one file per definition SHA-1 digest. With lazy definitions, remote agents
+ whose definition digest is found in this directory get their definition
+ without fetching it, e.g. after a restart, and only their mapping is
+ requested. Passing NULL disables the cache, which is the default. The
+ cache path must be set before starting ingescape.*/
+INGESCAPE_EXPORT void igs_net_set_definitions_cache_path(const char *path);
+INGESCAPE_EXPORT char * igs_net_definitions_cache_path(void); // caller owns returned value
+/*By default, remote definitions are kept complete, as editors need them.
+ Other agents only use the outputs and services of remote agents: the lean
+ mode drops remote parameters, inputs, descriptions and constraints for
+ definitions received afterwards. The footprint is the approximate memory
+ used by remote definitions, shared definitions being counted once, to be
+ divided by nb_remote_agents for the average per remote agent.*/
+INGESCAPE_EXPORT void igs_net_set_lean_remote_definitions(bool enabled);
+INGESCAPE_EXPORT bool igs_net_lean_remote_definitions(void);
+INGESCAPE_EXPORT size_t igs_net_remote_definitions_footprint(size_t *nb_remote_agents); //in bytes
+
+/*INBOUND QUEUE
+ By default, publications received from mapped agents are written
+ immediately into our inputs. When our input callbacks cannot keep up
+ with the received publications, these accumulate in the sockets until
+ the HWM is reached, adding latency without any control on what is lost.
+ A bounded inbound queue can be enabled to decide what to drop:
+ • IGS_QUEUE_DROP_OLDEST : the oldest queued value is discarded
+ • IGS_QUEUE_DROP_NEWEST : the newly received value is discarded
+ • IGS_QUEUE_COALESCE : a queued value for the same input is replaced
+ by the new one, the oldest queued value is discarded if none exists
+ • IGS_QUEUE_BLOCK : nothing is dropped, the queue is processed before
+ accepting new values, which pushes back pressure to the sockets
+ Setting capacity to zero disables the queue (default).*/
+typedef enum {
+    IGS_QUEUE_DROP_OLDEST = 0,
+    IGS_QUEUE_DROP_NEWEST,
+    IGS_QUEUE_COALESCE,
+    IGS_QUEUE_BLOCK
+} igs_queue_policy_t;
+INGESCAPE_EXPORT void igs_inbound_queue_set(size_t capacity, igs_queue_policy_t policy);
+INGESCAPE_EXPORT size_t igs_inbound_queue_size(void); //number of values waiting to be written
+INGESCAPE_EXPORT size_t igs_inbound_queue_dropped(void); //number of values dropped since start
+
+/*SPLIT QUEUES
+ Values written to our outputs which are split between workers are
+ queued until a worker has enough credit to receive them. Each split
+ output has its own bounded queue of IGS_DEFAULT_SPLIT_QUEUE_CAPACITY
+ entries by default. When the queue is full, the policy applies:
+ • IGS_QUEUE_DROP_OLDEST (default) : the oldest queued value is discarded
+ • IGS_QUEUE_DROP_NEWEST : the new value is discarded
+ • IGS_QUEUE_COALESCE : the new value replaces the queued value having the
+ same split key (see igs_split_set_key), or the newest queued value
+ when the output has no split key. The oldest queued value is discarded
+ if none matches.
+ • IGS_QUEUE_BLOCK : the thread writing the output waits until a worker
+ frees room in the queue, or drops the new value after 500 ms. Worker
+ acknowledgments are received by the ingescape thread : outputs written
+ from ingescape callbacks never block and drop the new value instead.
+ Setting capacity to zero restores the default capacity.*/
+INGESCAPE_EXPORT void igs_split_queue_set(size_t capacity, igs_queue_policy_t policy);
+INGESCAPE_EXPORT size_t igs_split_queue_size(const char *output_name); //number of values waiting for a worker
+INGESCAPE_EXPORT size_t igs_split_queue_dropped(const char *output_name); //number of values dropped for this output
 
 
 /*PERFORMANCE CHECK
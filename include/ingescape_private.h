@@ -19,6 +19,7 @@
 
 #include "uthash/uthash.h"
 #include "uthash/utlist.h"
+#include "uthash/utringbuffer.h"
 
 #if defined (__WINDOWS__)
     #ifndef WIN32_LEAN_AND_MEAN
@@ -61,6 +62,30 @@ typedef CRITICAL_SECTION igs_mutex_t;
 #   define IGS_MUTEX_DESTROY(m) DeleteCriticalSection (&m)
 #endif
 
+//  Condition variable macros, waited with an igs_mutex_t
+#if defined (__UNIX__)
+typedef pthread_cond_t igs_cond_t;
+#   define IGS_COND_INIT(c)         pthread_cond_init (&c, NULL)
+#   define IGS_COND_BROADCAST(c)    pthread_cond_broadcast (&c)
+#   define IGS_COND_DESTROY(c)      pthread_cond_destroy (&c)
+#elif defined (__WINDOWS__)
+typedef CONDITION_VARIABLE igs_cond_t;
+#   define IGS_COND_INIT(c)         InitializeConditionVariable (&c)
+#   define IGS_COND_BROADCAST(c)    WakeAllConditionVariable (&c)
+#   define IGS_COND_DESTROY(c)
+#endif
+
+//  Thread identification macros
+#if defined (__UNIX__)
+typedef pthread_t igs_thread_id_t;
+#   define IGS_THREAD_SELF()        pthread_self ()
+#   define IGS_THREAD_EQUAL(a, b)   pthread_equal (a, b)
+#elif defined (__WINDOWS__)
+typedef DWORD igs_thread_id_t;
+#   define IGS_THREAD_SELF()        GetCurrentThreadId ()
+#   define IGS_THREAD_EQUAL(a, b)   ((a) == (b))
+#endif
+
 typedef struct igs_core_context igs_core_context_t;
 
 //////////////////  IOP/SERVICE STRUCTURES AND ENUMS   //////////////////
@@ -72,6 +97,20 @@ typedef struct igs_observe_wrapper{
     struct igs_observe_wrapper *next;
 } igs_observe_wrapper_t;
 
+typedef struct igs_inputs_batch_wrapper{
+    igsagent_inputs_batch_fn *callback_ptr;
+    void* data;
+    struct igs_inputs_batch_wrapper *prev;
+    struct igs_inputs_batch_wrapper *next;
+} igs_inputs_batch_wrapper_t;
+
+// input changed during the current batch
+typedef struct igs_batched_input{
+    char *name;
+    struct igs_batched_input *prev;
+    struct igs_batched_input *next;
+} igs_batched_input_t;
+
 typedef enum {
     IGS_CONSTRAINT_MIN = 0,
     IGS_CONSTRAINT_MAX,
@@ -125,21 +164,97 @@ typedef struct igs_iop{
     } value;
     size_t value_size;
     bool is_muted;
+    bool is_batched;
     igs_observe_wrapper_t *callbacks;
     igs_constraint_t *constraint;
+    UT_ringbuffer *history; //of igs_iop_sample_t, NULL when disabled
+    char *split_key; //key for split affinity, NULL to use the value
     UT_hash_handle hh;         /* makes this structure hashable */
 } igs_iop_t;
 
+// received call waiting for or running on a service worker thread
+typedef struct igs_service_job{
+    char *callee_uuid;
+    char *service_name;
+    char *caller_name;
+    char *caller_uuid;
+    char *token;
+    igs_service_arg_t *arguments; //owned copy
+    size_t nb_args;
+    igsagent_service_fn *cb;
+    void *cb_data;
+    int64_t queued_at; //usecs
+    struct igs_service_job *next;
+} igs_service_job_t;
+
 typedef struct igs_service{
     char * name;
     char * description;
     igsagent_service_fn *cb;
     void *cb_data;
     igs_service_arg_t *arguments;
+    igs_service_arg_t *arguments_view; //reused to read packed calls, see service_view_packed_arguments
+    size_t arguments_view_size;
+    //concurrent execution, zero max_in_flight executing in the ingescape thread
+    size_t max_in_flight;
+    size_t queue_capacity;
+    size_t in_flight;
+    igs_service_job_t *queue;
+    size_t queue_size;
+    //metrics
+    size_t executed;
+    size_t rejected;
+    int64_t total_queue_time; //usecs
+    int64_t total_run_time; //usecs
     struct igs_service *reply;
     UT_hash_handle hh;
 } igs_service_t;
 
+// Packed service arguments travel in a single frame : an igs_packed_args_t
+// header, one igs_packed_arg_t per argument, then the values, each one
+// starting on an 8 bytes boundary. Bools use one byte, strings keep their
+// terminating zero.
+typedef struct igs_packed_args{
+    uint32_t nb_args;
+    uint32_t reserved;
+} igs_packed_args_t;
+typedef struct igs_packed_arg{
+    uint32_t type;
+    uint32_t offset; //from the beginning of the frame
+    uint32_t size;
+    uint32_t reserved;
+} igs_packed_arg_t;
+
+// asynchronous service call waiting for its reply
+typedef struct igs_service_call{
+    uint64_t id;
+    char *caller_uuid;
+    char *service_name;
+    int64_t start; //ms, monotonic
+    int64_t deadline; //ms, monotonic, zero for no deadline
+    igs_service_call_status_t status;
+    igs_service_arg_t *reply;
+    igsagent_service_reply_fn *cb;
+    void *cb_data;
+    UT_hash_handle hh;
+} igs_service_call_t;
+
+// latencies of the replied calls of a service
+typedef struct igs_service_latencies{
+    char *service_name;
+    size_t histogram[IGS_SERVICE_LATENCY_BUCKETS];
+    size_t replies;
+    UT_hash_handle hh;
+} igs_service_latencies_t;
+
+// element of a definition or mapping as last sent to peers, used to compute deltas
+typedef struct igs_delta_entry{
+    char *key; //iop: "<iop type>:<name>", map element: its id
+    uint64_t signature; //hash of the attributes sent in deltas
+    UT_hash_handle hh;
+} igs_delta_entry_t;
+
+#define IGS_DEFINITION_DIGEST_LENGTH 41 //hexadecimal SHA-1 of definition strings
 typedef struct igs_definition{
     char* name;
     char* family;
@@ -149,6 +264,13 @@ typedef struct igs_definition{
     igs_iop_t* inputs_table;
     igs_iop_t* outputs_table;
     igs_service_t *services_table;
+    //interned remote definitions are immutable and shared by all the
+    //remote agents having the same definition string, see definition_intern
+    char *content;
+    char content_digest[IGS_DEFINITION_DIGEST_LENGTH];
+    bool is_lean; //see definition_make_lean
+    size_t refcount; //zero for definitions that are not interned
+    UT_hash_handle hh;
 } igs_definition_t;
 
 typedef struct igs_map{
@@ -156,6 +278,20 @@ typedef struct igs_map{
     char* from_input;
     char* to_agent;
     char* to_output;
+    igs_reducer_t reducer;
+    size_t window_samples;
+    unsigned int window_ms;
+    //reducer state
+    size_t window_count;
+    size_t window_numeric_count;
+    int64_t window_start;
+    double window_accumulator;
+    double reduced_value;
+    //latest value of a time window, for LAST and non-numeric values
+    bool window_has_value;
+    igs_iop_value_type_t window_value_type;
+    void *window_value;
+    size_t window_value_size;
     UT_hash_handle hh;
 } igs_map_t;
 
@@ -177,14 +313,6 @@ typedef struct igs_mapping_filter {
     struct igs_mapping_filter *next, *prev;
 } igs_mapping_filter_t;
 
-typedef struct igs_worker{
-    char *input_name;
-    char *agent_uuid;
-    int credit;
-    struct igs_worker *next;
-    int uses;
-}igs_worker_t;
-
 typedef struct igs_queued_works{
     igs_iop_value_type_t value_type;
     union {
@@ -195,19 +323,115 @@ typedef struct igs_queued_works{
         void* data;
     } value;
     size_t value_size;
-    struct igs_queued_works *next;
+    uint64_t key_hash; //for split affinity, if has_key_hash
+    bool has_key_hash;
+    bool has_split_key; //key_hash comes from the split key of the output
+    unsigned int retries; //number of times the work has been requeued
+    //STRING and DATA values are copied into buffer,
+    //which is kept and reused by the next works in the same slot
+    void *buffer;
+    size_t buffer_size;
 }igs_queued_work_t;
 
+//message of works sent to a worker, kept until acknowledged
+//to requeue its works if the worker leaves or times out
+typedef struct igs_split_dispatch{
+    int64_t timestamp; //usecs
+    igs_queued_work_t *works; //owns the buffers of its works
+    size_t works_nb;
+    size_t works_acknowledged;
+    struct igs_split_dispatch *next, *prev;
+}igs_split_dispatch_t;
+
+typedef struct igs_worker{
+    char *key; //agent_uuid.input_name
+    char *input_name;
+    char *agent_uuid;
+    int credit;
+    int uses;
+    size_t batch_size; //max number of works per message
+    bool is_local; //agent in our context, served by our split threads
+    //service time measurement
+    igs_split_dispatch_t *dispatches; //messages not acknowledged yet, oldest first
+    size_t works_in_flight;
+    size_t works_expired; //timed out, their late acknowledgments are ignored
+    size_t works_done;
+    int64_t service_time; //EWMA in usecs per work, zero if not measured yet
+    int64_t service_time_max; //usecs per work
+    size_t heap_index; //position in the splitter workers heap
+    struct igs_splitter *splitter;
+    struct igs_worker *agent_prev, *agent_next; //workers of the same agent
+    UT_hash_handle hh;
+}igs_worker_t;
+
+//workers of an agent in all our splitters, to find them by agent uuid
+typedef struct igs_split_agent{
+    char *agent_uuid;
+    igs_worker_t *workers; //linked by agent_prev and agent_next
+    UT_hash_handle hh;
+}igs_split_agent_t;
+
+//virtual node of a worker on the consistent hashing ring of a splitter
+typedef struct igs_split_vnode{
+    uint64_t hash;
+    igs_worker_t *worker;
+}igs_split_vnode_t;
+
 typedef struct igs_splitter{
+    char *key; //agent_uuid.output_name
     char *agent_uuid;
     char *output_name;
-    igs_worker_t *workers_list;
+    igs_worker_t *workers; //hash table indexed by worker key
+    //binary heap of workers ordered according to scheduling :
+    //the best worker to receive work is always at index 0
+    igs_split_scheduling_t scheduling;
+    igs_worker_t **workers_heap;
+    size_t workers_heap_size;
+    size_t workers_heap_capacity;
+    int workers_max_uses; //new workers start with it
+    //consistent hashing ring for key affinity, sorted by hash,
+    //rebuilt lazily when workers join or leave
+    igs_split_vnode_t *ring;
+    size_t ring_size;
+    bool ring_is_dirty;
+    size_t key_prefix;
+    //ring buffer of queued works
     igs_queued_work_t *queued_works;
-    struct igs_splitter *next;
+    size_t queue_head;
+    size_t queue_size;
+    size_t queue_capacity;
+    igs_queue_policy_t queue_policy;
+    size_t queue_dropped;
+    //redelivery of works sent to workers
+    unsigned int work_timeout; //ms, zero to disable
+    unsigned int max_retries;
+    size_t works_requeued;
+    UT_hash_handle hh;
 }igs_splitter_t;
 
 //////////////////  NETWORK  STRUCTURES AND ENUMS   //////////////////
 
+// calls aggregated between two telemetry reports on an agent channel,
+// indexed by their notification
+typedef struct igs_telemetry_edge {
+    char *label;
+    char *channel;
+    size_t calls;
+    size_t bytes;
+    UT_hash_handle hh;
+} igs_telemetry_edge_t;
+
+// value received from a mapped agent, waiting in the
+// inbound queue of one of our agents
+typedef struct igs_inbound_value {
+    char *input_name;
+    igs_iop_value_type_t value_type;
+    void *value;
+    size_t value_size;
+    struct igs_inbound_value *prev;
+    struct igs_inbound_value *next;
+} igs_inbound_value_t;
+
 typedef struct igs_zyre_peer {
     char *peer_id;
     char *name;
@@ -215,18 +439,38 @@ typedef struct igs_zyre_peer {
     int reconnected;
     bool has_joined_private_channel;
     char *protocol;
+    bool supports_packed_services;
+    bool supports_bulk_services;
+    bool supports_deltas;
+    bool lazy_definitions; //peer only wants summaries of the definitions it did not fetch
+    zhash_t *fetched_definitions; //uuids of our agents whose definition was fetched by the peer
+    zlist_t *remote_agents; //agents running in this peer
     UT_hash_handle hh;
 } igs_zyre_peer_t;
 
+// entry of a name index : several agents or peers can share a name
+typedef struct igs_name_index{
+    char *name;
+    zlist_t *items;
+    UT_hash_handle hh;
+} igs_name_index_t;
+
 // remote agent we are subscribing to
 typedef struct igs_remote_agent{
     char *uuid;
     igs_zyre_peer_t *peer;
     igs_core_context_t *context;
     igs_definition_t *definition;
+    char *indexed_name; //name in the remote agents index of our context
     bool shall_send_outputs_request;
     igs_mapping_t *mapping;
     igs_mapping_filter_t *mapping_filters;
+    uint64_t definition_version; //zero until announced by a peer supporting deltas
+    uint64_t mapping_version;
+    //lazy definitions : only the name is known until the definition is fetched
+    bool definition_is_summary;
+    bool definition_requested;
+    char definition_digest[IGS_DEFINITION_DIGEST_LENGTH];
     int timer_id;
     UT_hash_handle hh;
 } igs_remote_agent_t;
@@ -333,6 +577,12 @@ struct _igsagent_t {
     igs_agent_event_wrapper_t *agent_event_callbacks;
     bool enforce_constraints;
 
+    // inputs batch
+    igs_inputs_batch_wrapper_t *inputs_batch_callbacks;
+    igs_batched_input_t *batched_inputs;
+    size_t batched_inputs_nbr;
+    int inputs_batch_depth;
+
     // definition
     char *definition_path;
     igs_definition_t* definition;
@@ -344,9 +594,43 @@ struct _igsagent_t {
     //network
     bool network_need_to_send_definition_update;
     bool network_need_to_send_mapping_update;
+    //serialized forms shared by all peers, per protocol (legacy for v2/v3 peers)
+    char *network_definition_json;
+    char *network_definition_json_legacy;
+    char *network_mapping_json;
+    char *network_mapping_json_legacy;
+    //versions and last sent state for delta updates
+    uint64_t network_definition_version;
+    uint64_t network_mapping_version;
+    bool network_definition_sent;
+    uint64_t network_sent_definition_header; //name, family, description, version, services
+    igs_delta_entry_t *network_sent_iops;
+    bool network_mapping_sent;
+    uint64_t network_sent_splits;
+    igs_delta_entry_t *network_sent_maps;
     bool network_request_outputs_from_mapped_agents;
     bool network_activation_during_runtime;
 
+    // inbound queue (disabled when capacity is zero)
+    igs_inbound_value_t *inbound_queue;
+    size_t inbound_queue_size;
+    size_t inbound_queue_capacity;
+    igs_queue_policy_t inbound_queue_policy;
+    size_t inbound_queue_dropped;
+    bool inbound_queue_is_draining;
+
+    // split queues of our outputs (default capacity when zero)
+    size_t split_queue_capacity;
+    igs_queue_policy_t split_queue_policy;
+    // as a worker, number of split values accepted per message
+    size_t split_batch_size;
+    // as a splitter, how workers are chosen
+    igs_split_scheduling_t split_scheduling;
+    size_t split_key_prefix; //bytes of values used as key, zero for whole value
+    unsigned int split_work_timeout;
+    unsigned int split_max_retries;
+    igs_service_latencies_t *service_latencies; //hash table indexed by service name
+
     bool is_whole_agent_muted;
     igs_mute_wrapper_t *mute_callbacks;
 
@@ -391,6 +675,24 @@ typedef struct igs_core_context {
     unsigned int network_agent_timeout;
     unsigned int network_publishing_port;
     unsigned int network_log_stream_port;
+    unsigned int network_telemetry_period; //ms, zero to notify each call
+    unsigned int network_update_debounce; //ms, delay coalescing definition and mapping updates
+    size_t network_inbound_queues; //our agents with an enabled inbound queue
+    bool network_lazy_definitions; //remote definitions are fetched only when needed
+    bool network_lean_remote_definitions; //remote definitions keep outputs and services only
+    igs_definition_t *interned_definitions; //shared remote definitions, by content hash
+    char *network_definitions_cache_path; //directory storing interned definitions, NULL if disabled
+    zactor_t *network_definitions_cache; //reads and writes the cache directory for the loop
+    zlist_t *network_dirty_agents; //uuids of agents with updates to propagate
+    bool network_updates_signaled; //a propagation request is pending in the updates socket
+    zsock_t *network_updates_sender; //PUSH used by any thread under the updates lock
+    zsock_t *network_updates_receiver; //PULL read by the ingescape loop
+    bool network_reducers_timer_armed; //time windows of mapping reducers are checked
+    bool network_updates_timer_armed;
+    int64_t network_telemetry_last_report;
+    igs_telemetry_edge_t *network_telemetry_edges;
+    int network_telemetry_timer_id;
+    unsigned int network_telemetry_timer_period; //ms, zero if the report timer is not armed
     bool network_shall_raise_file_descriptors_limit;
     bool external_stop;
     bool is_frozen;
@@ -435,11 +737,26 @@ typedef struct igs_core_context {
     char *network_ipc_full_path;
     char *network_ipc_endpoint;
     igs_zyre_peer_t *zyre_peers;
+    igs_name_index_t *zyre_peers_by_name;
     igs_channels_wrapper_t *zyre_callbacks;
     igsagent_t *agents;
     zhash_t *created_agents;
     igs_remote_agent_t *remote_agents; // those our agents subscribed to
-    igs_splitter_t *splitters;
+    igs_name_index_t *remote_agents_by_name;
+    igs_service_call_t *service_calls; //pending asynchronous calls, indexed by id
+    zlist_t *service_workers; //threads running concurrent services
+    zlist_t *service_idle_workers;
+    uint64_t service_calls_counter;
+    bool service_deadlines_timer_armed; //only while some calls have a deadline
+    igs_splitter_t *splitters; //hash table indexed by splitter key
+    igs_split_agent_t *split_agents; //hash table indexed by worker agent uuid
+    //split works for workers in our context are pushed to a pool of threads
+    bool split_local_workers_are_dirty;
+    size_t split_local_threads_nb;
+    zactor_t **split_local_threads;
+    size_t split_local_threads_started;
+    zsock_t *split_local_pusher;
+    bool split_timeouts_timer_armed; //only while some agents have a work timeout
     zactor_t *network_actor;
     zyre_t *node;
     zsock_t *publisher;
@@ -447,6 +764,8 @@ typedef struct igs_core_context {
     zsock_t *inproc_publisher;
     zsock_t *logger;
     zloop_t *loop;
+    igs_thread_id_t loop_thread;
+    bool loop_is_running;
 
 } igs_core_context_t;
 
@@ -462,27 +781,63 @@ void core_init_context(void);
 
 // definition
 INGESCAPE_EXPORT void definition_free_definition (igs_definition_t **definition);
+igs_definition_t *definition_intern (igs_core_context_t *context, const char *content);
+void definition_release (igs_core_context_t *context, igs_definition_t **definition);
+void definition_make_private (igs_core_context_t *context, igs_definition_t **definition);
+igs_definition_t *definition_intern_known (igs_core_context_t *context, const char *digest);
+void definition_digest (const char *content, char *digest);
+void definition_cache_start (igs_core_context_t *context);
+void definition_cache_stop (igs_core_context_t *context);
+bool definition_cache_load (igs_core_context_t *context, const char *uuid, const char *digest);
+void definition_make_lean (igs_definition_t *definition);
+size_t definition_footprint (igs_definition_t *definition);
 INGESCAPE_EXPORT void definition_free_constraint (igs_constraint_t **constraint);
+void s_definition_free_iop (igs_iop_t **iop);
 
 // mapping
 INGESCAPE_EXPORT void mapping_free_mapping (igs_mapping_t **map);
 igs_map_t* mapping_create_mapping_element(const char * from_input,
                                           const char *to_agent,
                                           const char* to_output);
+void s_mapping_free_mapping_element (igs_map_t **map_elmt);
 INGESCAPE_EXPORT bool mapping_is_equal(const char *first_str, const char *second_str);
 
 uint64_t s_djb2_hash (unsigned char *str);
 bool mapping_check_input_output_compatibility(igsagent_t *agent, igs_iop_t *found_input, igs_iop_t *found_output);
+#define IGS_REDUCERS_CHECK_PERIOD 10 //ms
+const char *mapping_reducer_to_string (igs_reducer_t reducer);
+igs_reducer_t mapping_reducer_from_string (const char *reducer);
+//returns true when a reduced value is ready to be written to the input,
+//in which case value_type, value and size are replaced by the reduced value
+//owned by the mapping element (model lock must be held)
+bool mapping_reduce (igs_map_t *map_elmt, igs_iop_value_type_t *value_type,
+                     void **value, size_t *size);
+//returns true when the time window of a mapping element has expired with
+//a reduced value to write, which is then allocated in value and shall be
+//freed by the caller (an expired window is closed in any case)
+bool mapping_flush_window (igs_map_t *map_elmt, int64_t now,
+                           igs_iop_value_type_t *value_type,
+                           void **value, size_t *size);
 
 // split
 void split_free_split_element (igs_split_t **split_elmt);
 igs_split_t* split_create_split_element(const char * from_input,
                                         const char *to_agent,
                                         const char* to_output);
-void split_add_work_to_queue(igs_core_context_t *context, char* agent_uuid, const igs_iop_t *output);
+//returns the output, looked up again if the model was unlocked to wait
+//for room in the queue, or NULL if the agent or the output do not exist anymore
+const igs_iop_t* split_add_work_to_queue(igs_core_context_t *context, char* agent_uuid, const igs_iop_t *output);
 void split_remove_worker(igs_core_context_t *context, char *worker_uuid, char *input_name);
 int split_message_from_worker(char *command, zmsg_t *msg, igs_core_context_t *context);
-int split_message_from_splitter(zmsg_t *msg, igs_core_context_t *context);
+int split_message_from_splitter(zmsg_t *msg, igs_core_context_t *context, bool is_batch);
+void split_send_worker_hello(igsagent_t *agent, const char *input_name,
+                             const char *output_name, const char *splitter_agent);
+#define IGS_SPLIT_QUEUE_BLOCK_TIMEOUT 500 //ms
+#define IGS_SPLIT_SERVICE_TIME_EWMA_ALPHA 0.2
+#define IGS_SPLIT_VNODES_PER_WORKER 64
+#define IGS_SPLIT_TIMEOUTS_CHECK_PERIOD 100 //ms
+int split_check_timeouts (zloop_t *loop, int timer_id, void *arg);
+void split_stop_local_threads (igs_core_context_t *context);
 
 // model
 uint8_t* s_model_string_to_bytes (char* string);
@@ -493,22 +848,42 @@ char* model_get_iop_value_as_string (igs_iop_t* iop); //caller owns returned val
 #define IGS_MODEL_READ_WRITE_MUTEX_DEBUG 0
 void model_read_write_lock(const char *function, int line);
 void model_read_write_unlock(const char *function, int line);
+// inputs written between begin and end are notified once to batch
+// observers, model lock must be held when calling these functions
+void model_inputs_batch_begin(igsagent_t *agent);
+void model_inputs_batch_end(igsagent_t *agent);
+void model_free_history(UT_ringbuffer **history);
 igs_constraint_t* s_model_parse_constraint(igs_iop_value_type_t type,
                                            const char *expression,char **error);
 
 // network
 #define IGS_PRIVATE_CHANNEL "INGESCAPE_PRIVATE"
 #define IGS_DEFAULT_AGENT_NAME "no_name"
+#define IGS_INBOUND_QUEUE_MAX_BURST 1000
 igs_result_t network_publish_output (igsagent_t *agent, const igs_iop_t *iop);
+//remote agents and peers matching a name or an id, in a list to be
+//destroyed by the caller
+zlist_t *network_find_remote_agents (igs_core_context_t *context, const char *name_or_uuid);
+zlist_t *network_find_zyre_peers (igs_core_context_t *context, const char *name_or_peer_id);
+void network_clear_serialization_cache (igsagent_t *agent);
+void network_clear_delta_state (igsagent_t *agent);
+// set the update flag and wake up the ingescape loop to propagate it
+void network_request_definition_update (igsagent_t *agent);
+void network_request_mapping_update (igsagent_t *agent);
+void network_request_timers_update (igs_core_context_t *context);
+void network_fetch_remote_definition (igs_remote_agent_t *remote_agent);
+bool network_is_loop_thread (igs_core_context_t *context);
+void network_telemetry_add (igs_core_context_t *context, const char *channel,
+                            size_t bytes, const char *format, ...) CHECK_PRINTF (4);
 
 // parser
-INGESCAPE_EXPORT igs_definition_t *parser_parse_definition_from_node (igs_json_node_t **json);
 INGESCAPE_EXPORT igs_definition_t* parser_load_definition (const char* json_str);
 INGESCAPE_EXPORT igs_definition_t* parser_load_definition_from_path (const char* file_path);
 INGESCAPE_EXPORT char* parser_export_definition(igs_definition_t* def);
 INGESCAPE_EXPORT char* parser_export_definition_legacy(igs_definition_t* def);
 INGESCAPE_EXPORT char* parser_export_mapping(igs_mapping_t* mapping);
 INGESCAPE_EXPORT char* parser_export_mapping_legacy(igs_mapping_t* mapping);
+void parser_constraint_expression (igs_iop_t *iop, char *expression, size_t size);
 INGESCAPE_EXPORT igs_mapping_t* parser_load_mapping (const char* json_str);
 INGESCAPE_EXPORT igs_mapping_t* parser_load_mapping_from_path (const char* load_file);
 
@@ -523,11 +898,30 @@ void s_unlock_zyre_peer(const char *function, int line);
 
 // service
 void service_free_service(igs_service_t *t);
+void s_service_free_service_arguments (igs_service_arg_t *args);
 INGESCAPE_EXPORT igs_result_t service_add_values_to_arguments_from_message(const char *name, igs_service_arg_t *arg, zmsg_t *msg);
 igs_result_t service_copy_arguments(igs_service_arg_t *source, igs_service_arg_t *destination);
 void service_free_values_in_arguments(igs_service_arg_t *arg);
 void service_log_received_service(igsagent_t *agent, const char *caller_agent_name, const char *caller_agentuuid,
                                   const char *service_name, igs_service_arg_t *list);
+#define IGS_SERVICE_CALL_TOKEN_PREFIX "igs_call#"
+#define IGS_SERVICE_DEADLINES_CHECK_PERIOD 100
+bool service_has_deadlines (igs_core_context_t *context);
+int service_check_deadlines (zloop_t *loop, int timer_id, void *arg);
+int service_message_from_callee (zmsg_t *msg, igs_core_context_t *context, bool rejected);
+void service_free_latencies (igs_service_latencies_t **latencies);
+void service_free_calls (igs_core_context_t *context);
+void service_execute_received_call (igs_core_context_t *context, igsagent_t *callee,
+                                    igs_service_t *service, const char *caller_name,
+                                    const char *caller_uuid, const char *token,
+                                    igs_service_arg_t *args, size_t nb_args);
+void service_stop_workers (igs_core_context_t *context);
+int service_worker_done (zloop_t *loop, zsock_t *reader, void *arg);
+int service_message_bulk (zmsg_t *msg, igs_core_context_t *context, const char *peer_name);
+zframe_t *service_pack_arguments (igs_service_arg_t *list);
+igs_result_t service_view_packed_arguments (igs_service_t *service, zframe_t *frame,
+                                            igs_service_arg_t **view_args, size_t *nb_args);
+void service_cancel_calls (igsagent_t *agent);
 
 // agent
 void s_agent_propagate_agent_event(igs_agent_event_t event, const char *uuid, const char *name, void *event_data);
@@ -576,6 +970,27 @@ void s_agent_propagate_agent_event(igs_agent_event_t event, const char *uuid, co
 #define SET_PARAMETER_MSG "SET_PARAMETER"
 #define CALL_SERVICE_MSG "SERVICE"
 #define CALL_SERVICE_MSG_DEPRECATED "CALL" // DEPRECATED since ingescape 3.0 that uses protocol v4
+#define SERVICE_REPLY_MSG "SERVICE_REPLY"
+#define SERVICE_REJECTED_MSG "SERVICE_REJECTED"
+#define CALL_SERVICE_PACKED_MSG "SERVICE_PACKED"
+#define SERVICE_PACKING_HEADER "service_packing"
+#define CALL_SERVICE_BULK_MSG "SERVICE_BULK" // callee uuids separated by spaces, packed arguments
+#define SERVICE_BULK_HEADER "service_bulk"
+// versioned definition and mapping deltas
+#define DEFINITION_DELTA_MSG "DEFINITION_DELTA"
+#define MAPPING_DELTA_MSG "MAPPING_DELTA"
+#define DELTA_SYNC_REQUEST_MSG "DELTA_SYNC_REQUEST"
+#define DELTAS_HEADER "deltas"
+#define DELTA_IOP_ADDED "IOP_ADDED" // iop type, name, value type, description, constraint, raw value
+#define DELTA_IOP_CHANGED "IOP_CHANGED"
+#define DELTA_IOP_REMOVED "IOP_REMOVED"
+#define DELTA_MAP_ADDED "MAP_ADDED"
+#define DELTA_MAP_REMOVED "MAP_REMOVED"
+
+// lazy remote definitions
+#define DEFINITION_SUMMARY_MSG "DEFINITION_SUMMARY" // uuid, name, definition digest, version
+#define DEFINITION_REQUEST_MSG "DEFINITION_REQUEST" // uuid, "mapping" when the definition is known
+#define LAZY_DEFINITIONS_HEADER "lazy_definitions"
 
 
 #define MAP_MSG "MAP"
@@ -589,6 +1004,7 @@ void s_agent_propagate_agent_event(igs_agent_event_t event, const char *uuid, co
 #define WORKER_GOODBYE_MSG "WORKER_GOODBYE"
 #define WORKER_READY_MSG "WORKER_READY"
 #define SPLITTER_WORK_MSG "SPLITTER_WORK"
+#define SPLITTER_WORKS_MSG "SPLITTER_WORKS"
 
 #define SET_DEFINITION_PATH_MSG "SET_DEFINITION_PATH"
 #define DEFINITION_FILE_PATH_MSG "DEFINITION_FILE_PATH"
@@ -167,47 +167,40 @@ igs_result_t igs_channel_whisper_str (const char *agent_name_or_agent_id_or_peer
     }
     bool has_sent = false;
     int res = IGS_SUCCESS;
-    // we iterate first on agents
-    igs_remote_agent_t *agent, *tmp_agent;
-    HASH_ITER (hh, core_context->remote_agents, agent, tmp_agent)
-    {
-        if (streq (agent->definition->name, agent_name_or_agent_id_or_peerid)
-            || streq (agent->uuid, agent_name_or_agent_id_or_peerid)) {
-            char content[IGS_MAX_STRING_MSG_LENGTH] = "";
-            va_list list;
-            va_start (list, msg);
-            vsnprintf (content, IGS_MAX_STRING_MSG_LENGTH - 1, msg, list);
-            va_end (list);
-            s_lock_zyre_peer (__FUNCTION__, __LINE__);
-            zmsg_t *msg_to_send = zmsg_new ();
-            zmsg_addstr (msg_to_send, content);
-            zmsg_addstr (msg_to_send, agent->uuid);
-            if (zyre_whisper (core_context->node, agent->peer->peer_id, &msg_to_send) != 0)
-                res = IGS_FAILURE;
-            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-            has_sent = true;
-            // NB: no break to support multiple agents with same name
-        }
+    char content[IGS_MAX_STRING_MSG_LENGTH] = "";
+    va_list list;
+    va_start (list, msg);
+    vsnprintf (content, IGS_MAX_STRING_MSG_LENGTH - 1, msg, list);
+    va_end (list);
+    // we look first for agents
+    // NB: several agents may have the same name
+    zlist_t *agents = network_find_remote_agents (core_context, agent_name_or_agent_id_or_peerid);
+    igs_remote_agent_t *agent = zlist_first (agents);
+    while (agent) {
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        zmsg_t *msg_to_send = zmsg_new ();
+        zmsg_addstr (msg_to_send, content);
+        zmsg_addstr (msg_to_send, agent->uuid);
+        if (zyre_whisper (core_context->node, agent->peer->peer_id, &msg_to_send) != 0)
+            res = IGS_FAILURE;
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        has_sent = true;
+        agent = zlist_next (agents);
     }
+    zlist_destroy (&agents);
 
-    // if no agent found, we iterate on peers
+    // if no agent found, we look for peers
     if (!has_sent) {
-        igs_zyre_peer_t *el, *tmp;
-        HASH_ITER (hh, core_context->zyre_peers, el, tmp)
-        {
-            if (streq (el->name, agent_name_or_agent_id_or_peerid)
-                || streq (el->peer_id, agent_name_or_agent_id_or_peerid)) {
-                char content[IGS_MAX_STRING_MSG_LENGTH] = "";
-                va_list list;
-                va_start (list, msg);
-                vsnprintf (content, IGS_MAX_STRING_MSG_LENGTH - 1, msg, list);
-                va_end (list);
-                s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                if (zyre_whispers (core_context->node, el->peer_id, "%s", content) != 0)
-                    res = IGS_FAILURE;
-                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-            }
+        zlist_t *peers = network_find_zyre_peers (core_context, agent_name_or_agent_id_or_peerid);
+        igs_zyre_peer_t *el = zlist_first (peers);
+        while (el) {
+            s_lock_zyre_peer (__FUNCTION__, __LINE__);
+            if (zyre_whispers (core_context->node, el->peer_id, "%s", content) != 0)
+                res = IGS_FAILURE;
+            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+            el = zlist_next (peers);
         }
+        zlist_destroy (&peers);
     }
     return res;
 }
@@ -222,41 +215,39 @@ igs_result_t igs_channel_whisper_data (const char *agent_name_or_agent_id_or_pee
     }
     bool has_sent = false;
     igs_result_t res = IGS_SUCCESS;
-    // we iterate first on agents
-    igs_remote_agent_t *agent, *tmp_agent;
-    HASH_ITER (hh, core_context->remote_agents, agent, tmp_agent)
-    {
-        if (streq (agent->definition->name, agent_name_or_agent_id_or_peerid)
-            || streq (agent->uuid, agent_name_or_agent_id_or_peerid)) {
+    // we look first for agents
+    // NB: several agents may have the same name
+    zlist_t *agents = network_find_remote_agents (core_context, agent_name_or_agent_id_or_peerid);
+    igs_remote_agent_t *agent = zlist_first (agents);
+    while (agent) {
+        zframe_t *frame = zframe_new (data, size);
+        zmsg_t *msg = zmsg_new ();
+        zmsg_append (msg, &frame);
+        zmsg_addstr (msg, agent->uuid);
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        if (zyre_whisper (core_context->node, agent->peer->peer_id, &msg) != 0)
+            res = IGS_FAILURE;
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        has_sent = true;
+        agent = zlist_next (agents);
+    }
+    zlist_destroy (&agents);
+
+    // if no agent found, we look for peers
+    if (!has_sent) {
+        zlist_t *peers = network_find_zyre_peers (core_context, agent_name_or_agent_id_or_peerid);
+        igs_zyre_peer_t *el = zlist_first (peers);
+        while (el) {
             zframe_t *frame = zframe_new (data, size);
             zmsg_t *msg = zmsg_new ();
             zmsg_append (msg, &frame);
-            zmsg_addstr (msg, agent->uuid);
             s_lock_zyre_peer (__FUNCTION__, __LINE__);
-            if (zyre_whisper (core_context->node, agent->peer->peer_id, &msg) != 0)
+            if (zyre_whisper (core_context->node, el->peer_id, &msg) != 0)
                 res = IGS_FAILURE;
             s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-            has_sent = true;
-            // NB: no break to support multiple agents with same name
-        }
-    }
-
-    // if no agent found, we iterate on peers
-    if (!has_sent) {
-        igs_zyre_peer_t *el, *tmp;
-        HASH_ITER (hh, core_context->zyre_peers, el, tmp)
-        {
-            if (streq (el->name, agent_name_or_agent_id_or_peerid)
-                || streq (el->peer_id, agent_name_or_agent_id_or_peerid)) {
-                zframe_t *frame = zframe_new (data, size);
-                zmsg_t *msg = zmsg_new ();
-                zmsg_append (msg, &frame);
-                s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                if (zyre_whisper (core_context->node, el->peer_id, &msg) != 0)
-                    res = IGS_FAILURE;
-                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-            }
+            el = zlist_next (peers);
         }
+        zlist_destroy (&peers);
     }
     return res;
 }
@@ -273,38 +264,36 @@ igs_result_t igs_channel_whisper_zmsg (const char *agent_name_or_agent_id_or_pee
     }
     bool has_sent = false;
     igs_result_t res = IGS_SUCCESS;
-    // we iterate first on agents
-    igs_remote_agent_t *agent, *tmp_agent;
-    HASH_ITER (hh, core_context->remote_agents, agent, tmp_agent)
-    {
-        if (streq (agent->definition->name, agent_name_or_agent_id_or_peer_id)
-            || streq (agent->uuid, agent_name_or_agent_id_or_peer_id)) {
+    // we look first for agents
+    // NB: several agents may have the same name
+    zlist_t *agents = network_find_remote_agents (core_context, agent_name_or_agent_id_or_peer_id);
+    igs_remote_agent_t *agent = zlist_first (agents);
+    while (agent) {
+        zmsg_t *dup = zmsg_dup (*msg_p);
+        zmsg_addstr ( dup, agent->uuid); // add agent uuid at the end of the message
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        if (zyre_whisper (core_context->node, agent->peer->peer_id, &dup) != 0)
+            res = IGS_FAILURE;
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        has_sent = true;
+        agent = zlist_next (agents);
+    }
+    zlist_destroy (&agents);
+
+    // if no agent found, we look for peers
+    if (!has_sent) {
+        zlist_t *peers = network_find_zyre_peers (core_context, agent_name_or_agent_id_or_peer_id);
+        igs_zyre_peer_t *el = zlist_first (peers);
+        while (el) {
             zmsg_t *dup = zmsg_dup (*msg_p);
-            zmsg_addstr ( dup, agent->uuid); // add agent uuid at the end of the message
             s_lock_zyre_peer (__FUNCTION__, __LINE__);
-            if (zyre_whisper (core_context->node, agent->peer->peer_id, &dup) != 0)
+            if (zyre_whisper (core_context->node, el->peer_id, &dup) != 0)
                 res = IGS_FAILURE;
             s_unlock_zyre_peer (__FUNCTION__, __LINE__);
             has_sent = true;
-            // NB: no break to support multiple agents with same name
-        }
-    }
-
-    // if no agent found, we iterate on peers
-    if (!has_sent) {
-        igs_zyre_peer_t *el, *tmp;
-        HASH_ITER (hh, core_context->zyre_peers, el, tmp)
-        {
-            if (streq (el->name, agent_name_or_agent_id_or_peer_id)
-                || streq (el->peer_id, agent_name_or_agent_id_or_peer_id)) {
-                zmsg_t *dup = zmsg_dup (*msg_p);
-                s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                if (zyre_whisper (core_context->node, el->peer_id, &dup) != 0)
-                    res = IGS_FAILURE;
-                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
-                has_sent = true;
-            }
+            el = zlist_next (peers);
         }
+        zlist_destroy (&peers);
     }
 
     if (has_sent)
@@ -53,6 +53,19 @@ typedef struct
     UT_hash_handle hh;
 } service_cb_wrapper_t;
 
+typedef struct
+{
+    igs_service_reply_fn *cb;
+    void *my_data;
+} service_reply_cb_wrapper_t;
+
+typedef struct observe_inputs_batch_cb_wrapper
+{
+    igs_inputs_batch_fn *cb;
+    void *my_data;
+    struct observe_inputs_batch_cb_wrapper *next;
+} observe_inputs_batch_cb_wrapper_t;
+
 typedef struct observe_mute_cb_wrapper
 {
     igs_mute_fn *cb;
@@ -71,6 +84,7 @@ observed_iop_t *observed_inputs = NULL;
 observed_iop_t *observed_outputs = NULL;
 observed_iop_t *observed_parameters = NULL;
 service_cb_wrapper_t *service_cb_wrappers = NULL;
+observe_inputs_batch_cb_wrapper_t *inputs_batch_cb_wrappers = NULL;
 observe_mute_cb_wrapper_t *mute_cb_wrappers = NULL;
 observe_agent_events_cb_wrapper_t *agent_event_cb_wrappers = NULL;
 
@@ -95,6 +109,8 @@ void core_init_context ()
         core_context->log_file_max_line_length = IGS_MAX_LOG_LENGTH;
         core_context->network_shall_raise_file_descriptors_limit = true;
         core_context->network_ipc_folder_path = strdup (IGS_DEFAULT_IPC_FOLDER_PATH);
+        core_context->split_local_threads_nb = IGS_DEFAULT_SPLIT_LOCAL_THREADS;
+        core_context->network_update_debounce = IGS_DEFAULT_UPDATE_DEBOUNCE;
     }
 }
 
@@ -135,6 +151,7 @@ void igs_clear_context (void)
     if (core_context != NULL) {
         igs_stop ();
         igs_monitor_stop ();
+        split_stop_local_threads (core_context);
         if (core_context->created_agents) {
             igsagent_t *a =
               (igsagent_t *) zhash_first (core_context->created_agents);
@@ -145,6 +162,7 @@ void igs_clear_context (void)
             zhash_destroy (&core_context->created_agents);
         }
         core_agent = NULL;
+        service_free_calls (core_context);
         // delete core agent callback wrappers
         observed_iop_t *observed_iop, *observed_iop_tmp;
         HASH_ITER (hh, observed_inputs, observed_iop, observed_iop_tmp)
@@ -169,6 +187,15 @@ void igs_clear_context (void)
             HASH_DEL (service_cb_wrappers, service_cb_wrapper);
             s_core_free_service_cb_wrapper (&service_cb_wrapper);
         }
+        observe_inputs_batch_cb_wrapper_t *batch_cb_wrapper = NULL,
+                                          *batch_cb_wrapper_tmp = NULL;
+        LL_FOREACH_SAFE (inputs_batch_cb_wrappers, batch_cb_wrapper,
+                         batch_cb_wrapper_tmp)
+        {
+            LL_DELETE (inputs_batch_cb_wrappers, batch_cb_wrapper);
+            free (batch_cb_wrapper);
+            batch_cb_wrapper = NULL;
+        }
         observe_mute_cb_wrapper_t *mute_cb_wrapper = NULL,
                                   *mute_cb_wrapper_tmp = NULL;
         LL_FOREACH_SAFE (mute_cb_wrappers, mute_cb_wrapper, mute_cb_wrapper_tmp)
@@ -204,6 +231,9 @@ void igs_clear_context (void)
             free (stop_elt);
         }
         zhash_destroy (&core_context->brokers);
+        zlist_destroy (&core_context->network_dirty_agents);
+        if (core_context->network_definitions_cache_path)
+            free (core_context->network_definitions_cache_path);
 
         if (core_context->security_auth)
             zactor_destroy (&(core_context->security_auth));
@@ -585,6 +615,54 @@ void igs_parameter_set_description(const char *name, const char *description)
     return igsagent_parameter_set_description (core_agent, name, description);
 }
 
+igs_result_t igs_input_set_history (const char *name, size_t depth)
+{
+    core_init_agent ();
+    return igsagent_input_set_history (core_agent, name, depth);
+}
+
+igs_result_t igs_output_set_history (const char *name, size_t depth)
+{
+    core_init_agent ();
+    return igsagent_output_set_history (core_agent, name, depth);
+}
+
+igs_result_t igs_parameter_set_history (const char *name, size_t depth)
+{
+    core_init_agent ();
+    return igsagent_parameter_set_history (core_agent, name, depth);
+}
+
+size_t igs_input_history (const char *name, size_t max_samples, int64_t since,
+                          const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                          const igs_iop_sample_t **second_part, size_t *second_part_nbr)
+{
+    core_init_agent ();
+    return igsagent_input_history (core_agent, name, max_samples, since,
+                                   first_part, first_part_nbr,
+                                   second_part, second_part_nbr);
+}
+
+size_t igs_output_history (const char *name, size_t max_samples, int64_t since,
+                           const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                           const igs_iop_sample_t **second_part, size_t *second_part_nbr)
+{
+    core_init_agent ();
+    return igsagent_output_history (core_agent, name, max_samples, since,
+                                    first_part, first_part_nbr,
+                                    second_part, second_part_nbr);
+}
+
+size_t igs_parameter_history (const char *name, size_t max_samples, int64_t since,
+                              const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                              const igs_iop_sample_t **second_part, size_t *second_part_nbr)
+{
+    core_init_agent ();
+    return igsagent_parameter_history (core_agent, name, max_samples, since,
+                                       first_part, first_part_nbr,
+                                       second_part, second_part_nbr);
+}
+
 void igs_clear_input (const char *name)
 {
     core_init_agent ();
@@ -677,6 +755,31 @@ void igs_observe_parameter (const char *name, igs_iop_fn cb, void *my_data)
                                  wrap);
 }
 
+void core_observe_inputs_batch_callback (igsagent_t *agent,
+                                         const igs_iop_value_t *inputs,
+                                         size_t inputs_nbr,
+                                         void *my_data)
+{
+    IGS_UNUSED (agent)
+    observe_inputs_batch_cb_wrapper_t *wrap =
+      (observe_inputs_batch_cb_wrapper_t *) my_data;
+    wrap->cb (inputs, inputs_nbr, wrap->my_data);
+}
+
+void igs_observe_inputs_batch (igs_inputs_batch_fn cb, void *my_data)
+{
+    assert (cb);
+    core_init_agent ();
+    observe_inputs_batch_cb_wrapper_t *wrap =
+      (observe_inputs_batch_cb_wrapper_t *) zmalloc (
+        sizeof (observe_inputs_batch_cb_wrapper_t));
+    wrap->cb = cb;
+    wrap->my_data = my_data;
+    LL_APPEND (inputs_batch_cb_wrappers, wrap); // store wrapper to delete it later
+    igsagent_observe_inputs_batch (core_agent,
+                                   core_observe_inputs_batch_callback, wrap);
+}
+
 void igs_output_mute (const char *name)
 {
     core_init_agent ();
@@ -963,6 +1066,29 @@ uint64_t igs_mapping_add (const char *from_our_input,
     return igsagent_mapping_add (core_agent, from_our_input, to_agent,
                                   with_output);
 }
+
+uint64_t igs_mapping_add_with_reducer (const char *from_our_input,
+                                       const char *to_agent,
+                                       const char *with_output,
+                                       igs_reducer_t reducer,
+                                       size_t window_samples,
+                                       unsigned int window_ms)
+{
+    core_init_agent ();
+    return igsagent_mapping_add_with_reducer (core_agent, from_our_input,
+                                              to_agent, with_output, reducer,
+                                              window_samples, window_ms);
+}
+
+igs_result_t igs_mapping_set_reducer (uint64_t id,
+                                      igs_reducer_t reducer,
+                                      size_t window_samples,
+                                      unsigned int window_ms)
+{
+    core_init_agent ();
+    return igsagent_mapping_set_reducer (core_agent, id, reducer,
+                                         window_samples, window_ms);
+}
 // returns mapping id or zero or below if creation failed
 igs_result_t igs_mapping_remove_with_id (uint64_t the_id)
 {
@@ -1011,8 +1137,123 @@ igs_result_t igs_split_remove_with_name (const char *from_our_input,
                                              to_agent, with_output);
 }
 
+void igs_split_set_batch_size (size_t batch_size)
+{
+    core_init_agent ();
+    igsagent_split_set_batch_size (core_agent, batch_size);
+}
+
+size_t igs_split_batch_size (void)
+{
+    core_init_agent ();
+    return igsagent_split_batch_size (core_agent);
+}
+
+void igs_split_set_scheduling (igs_split_scheduling_t scheduling)
+{
+    core_init_agent ();
+    igsagent_split_set_scheduling (core_agent, scheduling);
+}
+
+igs_split_scheduling_t igs_split_scheduling (void)
+{
+    core_init_agent ();
+    return igsagent_split_scheduling (core_agent);
+}
+
+void igs_split_set_key_prefix (size_t prefix_length)
+{
+    core_init_agent ();
+    igsagent_split_set_key_prefix (core_agent, prefix_length);
+}
+
+size_t igs_split_key_prefix (void)
+{
+    core_init_agent ();
+    return igsagent_split_key_prefix (core_agent);
+}
+
+void igs_split_set_key (const char *output_name, const char *key)
+{
+    core_init_agent ();
+    igsagent_split_set_key (core_agent, output_name, key);
+}
+
+void igs_split_set_work_timeout (unsigned int timeout_ms)
+{
+    core_init_agent ();
+    igsagent_split_set_work_timeout (core_agent, timeout_ms);
+}
+
+unsigned int igs_split_work_timeout (void)
+{
+    core_init_agent ();
+    return igsagent_split_work_timeout (core_agent);
+}
+
+void igs_split_set_max_retries (unsigned int max_retries)
+{
+    core_init_agent ();
+    igsagent_split_set_max_retries (core_agent, max_retries);
+}
+
+unsigned int igs_split_max_retries (void)
+{
+    core_init_agent ();
+    return igsagent_split_max_retries (core_agent);
+}
+
+size_t igs_split_requeued (const char *output_name)
+{
+    core_init_agent ();
+    return igsagent_split_requeued (core_agent, output_name);
+}
+
+igs_split_worker_stats_t *igs_split_workers_stats (const char *output_name,
+                                                   size_t *workers_nbr)
+{
+    core_init_agent ();
+    return igsagent_split_workers_stats (core_agent, output_name, workers_nbr);
+}
+
 // admin
 
+void igs_inbound_queue_set (size_t capacity, igs_queue_policy_t policy)
+{
+    core_init_agent ();
+    igsagent_inbound_queue_set (core_agent, capacity, policy);
+}
+
+size_t igs_inbound_queue_size (void)
+{
+    core_init_agent ();
+    return igsagent_inbound_queue_size (core_agent);
+}
+
+size_t igs_inbound_queue_dropped (void)
+{
+    core_init_agent ();
+    return igsagent_inbound_queue_dropped (core_agent);
+}
+
+void igs_split_queue_set (size_t capacity, igs_queue_policy_t policy)
+{
+    core_init_agent ();
+    igsagent_split_queue_set (core_agent, capacity, policy);
+}
+
+size_t igs_split_queue_size (const char *output_name)
+{
+    core_init_agent ();
+    return igsagent_split_queue_size (core_agent, output_name);
+}
+
+size_t igs_split_queue_dropped (const char *output_name)
+{
+    core_init_agent ();
+    return igsagent_split_queue_dropped (core_agent, output_name);
+}
+
 void igs_mapping_set_outputs_request (bool notify)
 {
     core_init_agent ();
@@ -1098,6 +1339,70 @@ igs_result_t igs_service_call (const char *agent_name_oruuid,
                                    list, token);
 }
 
+igs_result_t igs_service_call_bulk (const char **targets,
+                                    size_t targets_nbr,
+                                    const char *service_name,
+                                    igs_service_arg_t **list,
+                                    const char *token)
+{
+    core_init_agent ();
+    return igsagent_service_call_bulk (core_agent, targets, targets_nbr,
+                                       service_name, list, token);
+}
+
+// reply callbacks are called exactly once per call
+void core_service_reply_callback (igsagent_t *agent,
+                                  uint64_t call_id,
+                                  igs_service_call_status_t status,
+                                  igs_service_arg_t *first_argument,
+                                  size_t args_nbr,
+                                  void *my_data)
+{
+    IGS_UNUSED (agent)
+    service_reply_cb_wrapper_t *wrap = (service_reply_cb_wrapper_t *) my_data;
+    wrap->cb (call_id, status, first_argument, args_nbr, wrap->my_data);
+    free (wrap);
+}
+
+uint64_t igs_service_call_async (const char *agent_name_or_uuid,
+                                 const char *service_name,
+                                 igs_service_arg_t **list,
+                                 unsigned int timeout_ms,
+                                 igs_service_reply_fn cb,
+                                 void *my_data)
+{
+    core_init_agent ();
+    if (!cb)
+        return igsagent_service_call_async (core_agent, agent_name_or_uuid, service_name,
+                                            list, timeout_ms, NULL, NULL);
+    service_reply_cb_wrapper_t *wrap =
+      (service_reply_cb_wrapper_t *) zmalloc (sizeof (service_reply_cb_wrapper_t));
+    wrap->cb = cb;
+    wrap->my_data = my_data;
+    uint64_t call_id = igsagent_service_call_async (core_agent, agent_name_or_uuid, service_name,
+                                                    list, timeout_ms, core_service_reply_callback, wrap);
+    if (!call_id)
+        // callback will never be called
+        free (wrap);
+    return call_id;
+}
+
+igs_result_t igs_service_reply (const char *caller_agent_uuid,
+                                const char *token,
+                                igs_service_arg_t **list)
+{
+    core_init_agent ();
+    return igsagent_service_reply (core_agent, caller_agent_uuid, token, list);
+}
+
+size_t igs_service_latencies (const char *service_name,
+                              size_t *histogram,
+                              size_t buckets_nbr)
+{
+    core_init_agent ();
+    return igsagent_service_latencies (core_agent, service_name, histogram, buckets_nbr);
+}
+
 void core_service_callback (igsagent_t *agent,
                             const char *sender_agent_name,
                             const char *sender_agentuuid,
@@ -1130,6 +1435,26 @@ igs_service_init (const char *name, igs_service_fn cb, void *my_data)
                                    wrap);
 }
 
+igs_result_t igs_service_set_concurrency (const char *service_name,
+                                          size_t max_in_flight,
+                                          size_t queue_capacity)
+{
+    core_init_agent ();
+    return igsagent_service_set_concurrency (core_agent, service_name,
+                                             max_in_flight, queue_capacity);
+}
+
+igs_result_t igs_service_metrics (const char *service_name,
+                                  size_t *executed,
+                                  size_t *rejected,
+                                  double *average_queue_time_ms,
+                                  double *average_run_time_ms)
+{
+    core_init_agent ();
+    return igsagent_service_metrics (core_agent, service_name, executed, rejected,
+                                     average_queue_time_ms, average_run_time_ms);
+}
+
 igs_result_t igs_service_remove (const char *name)
 {
     assert (name);
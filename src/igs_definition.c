@@ -61,6 +61,10 @@ void s_definition_free_iop (igs_iop_t **iop)
     }
     if ((*iop)->constraint)
         definition_free_constraint(&(*iop)->constraint);
+    if ((*iop)->history)
+        model_free_history (&(*iop)->history);
+    if ((*iop)->split_key)
+        free((*iop)->split_key);
     if ((*iop)->description)
         free((*iop)->description);
 
@@ -221,10 +225,359 @@ void definition_free_definition (igs_definition_t **def)
         HASH_DEL ((*def)->services_table, service);
         service_free_service (service);
     }
+    if ((*def)->content)
+        free ((*def)->content);
     free (*def);
     *def = NULL;
 }
 
+// lean remote definitions only keep what mappings and service calls use
+void definition_make_lean (igs_definition_t *definition)
+{
+    assert (definition);
+    definition->is_lean = true;
+    if (definition->description) {
+        free (definition->description);
+        definition->description = NULL;
+    }
+    igs_iop_t *iop, *tmp_iop;
+    HASH_ITER (hh, definition->params_table, iop, tmp_iop){
+        HASH_DEL (definition->params_table, iop);
+        s_definition_free_iop (&iop);
+    }
+    HASH_ITER (hh, definition->inputs_table, iop, tmp_iop){
+        HASH_DEL (definition->inputs_table, iop);
+        s_definition_free_iop (&iop);
+    }
+    HASH_ITER (hh, definition->outputs_table, iop, tmp_iop){
+        if (iop->description) {
+            free (iop->description);
+            iop->description = NULL;
+        }
+        if (iop->constraint)
+            definition_free_constraint (&iop->constraint);
+    }
+    igs_service_t *service, *tmp_service;
+    HASH_ITER (hh, definition->services_table, service, tmp_service){
+        if (service->description) {
+            free (service->description);
+            service->description = NULL;
+        }
+        if (service->reply && service->reply->description) {
+            free (service->reply->description);
+            service->reply->description = NULL;
+        }
+    }
+}
+
+size_t s_string_footprint (const char *str)
+{
+    return (str) ? strlen (str) + 1 : 0;
+}
+
+size_t s_iops_footprint (igs_iop_t *table)
+{
+    size_t size = (table) ? sizeof (UT_hash_table)
+                            + table->hh.tbl->num_buckets * sizeof (UT_hash_bucket) : 0;
+    igs_iop_t *iop, *tmp;
+    HASH_ITER (hh, table, iop, tmp){
+        size += sizeof (igs_iop_t) + s_string_footprint (iop->name)
+                + s_string_footprint (iop->description);
+        igs_constraint_t *constraint = iop->constraint;
+        if (constraint) {
+            size += sizeof (igs_constraint_t);
+            if (constraint->type == IGS_CONSTRAINT_REGEXP)
+                size += s_string_footprint (constraint->regexp.string);
+        }
+    }
+    return size;
+}
+
+size_t s_service_args_footprint (igs_service_arg_t *arguments)
+{
+    size_t size = 0;
+    igs_service_arg_t *arg = NULL;
+    LL_FOREACH (arguments, arg)
+        size += sizeof (igs_service_arg_t) + s_string_footprint (arg->name);
+    return size;
+}
+
+// approximate heap size of a definition, excluding compiled regexps
+size_t definition_footprint (igs_definition_t *definition)
+{
+    assert (definition);
+    size_t size = sizeof (igs_definition_t) + s_string_footprint (definition->name)
+                  + s_string_footprint (definition->family)
+                  + s_string_footprint (definition->description)
+                  + s_string_footprint (definition->version)
+                  + s_string_footprint (definition->content);
+    size += s_iops_footprint (definition->params_table);
+    size += s_iops_footprint (definition->inputs_table);
+    size += s_iops_footprint (definition->outputs_table);
+    if (definition->services_table)
+        size += sizeof (UT_hash_table)
+                + definition->services_table->hh.tbl->num_buckets * sizeof (UT_hash_bucket);
+    igs_service_t *service, *tmp;
+    HASH_ITER (hh, definition->services_table, service, tmp){
+        size += sizeof (igs_service_t) + s_string_footprint (service->name)
+                + s_string_footprint (service->description)
+                + s_service_args_footprint (service->arguments);
+        if (service->reply)
+            size += sizeof (igs_service_t) + s_string_footprint (service->reply->name)
+                    + s_string_footprint (service->reply->description)
+                    + s_service_args_footprint (service->reply->arguments);
+    }
+    return size;
+}
+
+// hexadecimal SHA-1 of a definition string, identifying interned definitions
+void definition_digest (const char *content, char *digest)
+{
+    assert (content);
+    assert (digest);
+    zdigest_t *sha1 = zdigest_new ();
+    assert (sha1);
+    zdigest_update (sha1, (const byte *) content, strlen (content));
+    snprintf (digest, IGS_DEFINITION_DIGEST_LENGTH, "%s", zdigest_string (sha1));
+    zdigest_destroy (&sha1);
+}
+
+/* Persistent cache of interned definitions, one file per content digest.
+ Files are read and written by an actor so that the ingescape loop never
+ waits for the disk : the loop sends LOAD <uuid> <digest> and receives
+ LOADED <uuid> <digest> <content>, the content being empty if the file is
+ missing or corrupted, and sends STORE <digest> <content> without reply. */
+void s_definition_cache_file (const char *directory, const char *digest,
+                              char *path, size_t size)
+{
+    snprintf (path, size, "%s/%s.json", directory, digest);
+}
+
+char *s_definition_cache_read (const char *directory, const char *digest)
+{
+    char path[IGS_MAX_PATH_LENGTH] = "";
+    s_definition_cache_file (directory, digest, path, IGS_MAX_PATH_LENGTH);
+    if (!zsys_file_exists (path))
+        return NULL;
+    ssize_t size = zsys_file_size (path);
+    zfile_t *file = zfile_new (NULL, path);
+    if (size <= 0 || file == NULL || zfile_input (file) != 0) {
+        zfile_destroy (&file);
+        igs_warn ("could not read definitions cache file %s", path);
+        return NULL;
+    }
+    zchunk_t *data = zfile_read (file, (size_t) size, 0);
+    zfile_destroy (&file);
+    char *content = (data) ? zchunk_strdup (data) : NULL;
+    zchunk_destroy (&data);
+    char content_digest[IGS_DEFINITION_DIGEST_LENGTH] = "";
+    if (content)
+        definition_digest (content, content_digest);
+    if (!content || strneq (content_digest, digest)) {
+        igs_warn ("definitions cache file %s is corrupted : ignoring it", path);
+        free (content);
+        return NULL;
+    }
+    return content;
+}
+
+void s_definition_cache_write (const char *directory, const char *digest,
+                               const char *content)
+{
+    char path[IGS_MAX_PATH_LENGTH] = "";
+    s_definition_cache_file (directory, digest, path, IGS_MAX_PATH_LENGTH);
+    if (zsys_file_exists (path))
+        return;
+    char tmp_path[IGS_MAX_PATH_LENGTH + 4] = "";
+    snprintf (tmp_path, IGS_MAX_PATH_LENGTH + 4, "%s.tmp", path);
+    FILE *fp = fopen (tmp_path, "w");
+    if (fp == NULL) {
+        igs_warn ("could not write definitions cache file %s", tmp_path);
+        return;
+    }
+    fputs (content, fp);
+    fclose (fp);
+    // file becomes visible to later runs only once complete
+    if (rename (tmp_path, path) != 0)
+        remove (tmp_path);
+}
+
+void s_definition_cache_actor (zsock_t *pipe, void *args)
+{
+    char *directory = (char *) args;
+    assert (directory);
+    zsock_signal (pipe, 0);
+    while (true) {
+        zmsg_t *msg = zmsg_recv (pipe);
+        if (!msg)
+            break; // interrupted
+        char *command = zmsg_popstr (msg);
+        if (command && streq (command, "LOAD")) {
+            char *uuid = zmsg_popstr (msg);
+            char *digest = zmsg_popstr (msg);
+            if (uuid && digest) {
+                char *content = s_definition_cache_read (directory, digest);
+                zstr_sendx (pipe, "LOADED", uuid, digest, (content) ? content : "", NULL);
+                free (content);
+            }
+            free (uuid);
+            free (digest);
+        }
+        else
+        if (command && streq (command, "STORE")) {
+            char *digest = zmsg_popstr (msg);
+            char *content = zmsg_popstr (msg);
+            if (digest && content)
+                s_definition_cache_write (directory, digest, content);
+            free (digest);
+            free (content);
+        }
+        else {
+            // $TERM or unexpected
+            free (command);
+            zmsg_destroy (&msg);
+            break;
+        }
+        free (command);
+        zmsg_destroy (&msg);
+    }
+    free (directory);
+}
+
+// called when starting, before the ingescape loop
+void definition_cache_start (igs_core_context_t *context)
+{
+    assert (context);
+    if (!context->network_definitions_cache_path || context->network_definitions_cache)
+        return;
+    context->network_definitions_cache =
+      zactor_new (s_definition_cache_actor, strdup (context->network_definitions_cache_path));
+    assert (context->network_definitions_cache);
+}
+
+// called when stopping, after the ingescape loop : pending files are written
+void definition_cache_stop (igs_core_context_t *context)
+{
+    assert (context);
+    zactor_destroy (&context->network_definitions_cache);
+}
+
+/* Asks the cache for an unknown definition digest announced for a remote
+ agent. Returns false if the cache is disabled. The answer is handled by
+ the ingescape loop. */
+bool definition_cache_load (igs_core_context_t *context, const char *uuid, const char *digest)
+{
+    assert (context);
+    assert (uuid);
+    assert (digest);
+    if (!context->network_definitions_cache)
+        return false;
+    zstr_sendx (context->network_definitions_cache, "LOAD", uuid, digest, NULL);
+    return true;
+}
+
+void s_definition_cache_store (igs_core_context_t *context, igs_definition_t *definition)
+{
+    assert (context);
+    assert (definition);
+    if (!context->network_definitions_cache || !definition->content)
+        return;
+    zstr_sendx (context->network_definitions_cache, "STORE", definition->content_digest,
+                definition->content, NULL);
+}
+
+/* Returns the shared definition parsed from this definition string, parsing
+ it only if no remote agent uses it yet. Interned definitions are identified
+ by the SHA-1 digest of their string, which lean definitions do not keep.
+ Interned definitions shall not be modified and shall be released with
+ definition_release. */
+igs_definition_t *definition_intern (igs_core_context_t *context, const char *content)
+{
+    assert (context);
+    assert (content);
+    char digest[IGS_DEFINITION_DIGEST_LENGTH] = "";
+    definition_digest (content, digest);
+    igs_definition_t *interned = NULL;
+    HASH_FIND_STR (context->interned_definitions, digest, interned);
+    if (interned && interned->is_lean == context->network_lean_remote_definitions) {
+        interned->refcount++;
+        return interned;
+    }
+    igs_definition_t *definition = parser_load_definition (content);
+    // NB: definitions interned before the lean mode changed are not shared
+    if (definition && definition->name && !interned) {
+        definition->content = strdup (content);
+        snprintf (definition->content_digest, IGS_DEFINITION_DIGEST_LENGTH, "%s", digest);
+        definition->refcount = 1;
+        HASH_ADD_STR (context->interned_definitions, content_digest, definition);
+        s_definition_cache_store (context, definition);
+    }
+    if (definition && definition->name && context->network_lean_remote_definitions) {
+        definition_make_lean (definition);
+        if (definition->content) {
+            free (definition->content);
+            definition->content = NULL;
+        }
+    }
+    if (definition && definition->name)
+        igs_debug ("definition of %s uses %zu bytes in %s mode", definition->name,
+                   definition_footprint (definition),
+                   (context->network_lean_remote_definitions) ? "lean" : "full");
+    return definition;
+}
+
+/* Returns the shared definition for a definition digest announced by a
+ peer if a remote agent already uses it, NULL otherwise, in which case it
+ may be found in the persistent cache, see definition_cache_load. */
+igs_definition_t *definition_intern_known (igs_core_context_t *context, const char *digest)
+{
+    assert (context);
+    assert (digest);
+    igs_definition_t *interned = NULL;
+    HASH_FIND_STR (context->interned_definitions, digest, interned);
+    if (!interned || interned->is_lean != context->network_lean_remote_definitions)
+        return NULL;
+    interned->refcount++;
+    return interned;
+}
+
+void definition_release (igs_core_context_t *context, igs_definition_t **definition)
+{
+    assert (context);
+    assert (definition);
+    assert (*definition);
+    if ((*definition)->refcount > 0) {
+        if (--(*definition)->refcount > 0) {
+            *definition = NULL;
+            return;
+        }
+        HASH_DEL (context->interned_definitions, *definition);
+    }
+    definition_free_definition (definition);
+}
+
+// copy-on-write for remote definitions modified in place, e.g. by deltas
+void definition_make_private (igs_core_context_t *context, igs_definition_t **definition)
+{
+    assert (context);
+    assert (definition);
+    assert (*definition);
+    if ((*definition)->refcount == 0)
+        return;
+    igs_definition_t *copy = NULL;
+    if ((*definition)->content)
+        copy = parser_load_definition ((*definition)->content);
+    else {
+        // lean definitions are copied through their export
+        char *json = parser_export_definition (*definition);
+        copy = parser_load_definition (json);
+        free (json);
+    }
+    assert (copy);
+    definition_release (context, definition);
+    *definition = copy;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // PUBLIC API
 ////////////////////////////////////////////////////////////////////////
@@ -251,7 +604,7 @@ void igsagent_clear_definition (igsagent_t *agent)
         agent->definition->name = strdup (IGS_DEFAULT_AGENT_NAME);
         // igsagent_debug(agent, "Use default name '%s'", IGS_DEFAULT_AGENT_NAME);
     }
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
     model_read_write_unlock (__FUNCTION__, __LINE__);
 }
 
@@ -298,7 +651,7 @@ void igsagent_set_family (igsagent_t *agent, const char *family)
     if (agent->definition->family != NULL)
         free (agent->definition->family);
     agent->definition->family = s_strndup (family, IGS_MAX_FAMILY_LENGTH);
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
 }
 
 void igsagent_definition_set_description (igsagent_t *agent,
@@ -311,7 +664,7 @@ void igsagent_definition_set_description (igsagent_t *agent,
         free (agent->definition->description);
     agent->definition->description =
       s_strndup (description, IGS_MAX_DESCRIPTION_LENGTH);
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
 }
 
 void igsagent_definition_set_version (igsagent_t *agent, const char *version)
@@ -322,7 +675,7 @@ void igsagent_definition_set_version (igsagent_t *agent, const char *version)
     if (agent->definition->version != NULL)
         free (agent->definition->version);
     agent->definition->version = s_strndup (version, IGS_MAX_VERSION_LENGTH);
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
 }
 
 igs_result_t igsagent_input_create (igsagent_t *agent,
@@ -338,7 +691,7 @@ igs_result_t igsagent_input_create (igsagent_t *agent,
       definition_create_iop (agent, name, IGS_INPUT_T, value_type, value, size);
     if (!iop)
         return IGS_FAILURE;
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
     return IGS_SUCCESS;
 }
 
@@ -355,7 +708,7 @@ igs_result_t igsagent_output_create (igsagent_t *agent,
                                             value_type, value, size);
     if (!iop)
         return IGS_FAILURE;
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
     return IGS_SUCCESS;
 }
 
@@ -372,7 +725,7 @@ igs_result_t igsagent_parameter_create (igsagent_t *agent,
                                             value_type, value, size);
     if (!iop)
         return IGS_FAILURE;
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
     return IGS_SUCCESS;
 }
 
@@ -394,7 +747,7 @@ igs_result_t igsagent_input_remove (igsagent_t *agent, const char *name)
     }
     HASH_DEL (agent->definition->inputs_table, iop);
     s_definition_free_iop (&iop);
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
     model_read_write_unlock (__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
 }
@@ -417,7 +770,7 @@ igs_result_t igsagent_output_remove (igsagent_t *agent, const char *name)
     }
     HASH_DEL (agent->definition->outputs_table, iop);
     s_definition_free_iop (&iop);
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
     model_read_write_unlock (__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
 }
@@ -440,7 +793,7 @@ igs_result_t igsagent_parameter_remove (igsagent_t *agent, const char *name)
     }
     HASH_DEL (agent->definition->params_table, iop);
     s_definition_free_iop (&iop);
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
     model_read_write_unlock (__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
 }
@@ -40,6 +40,8 @@ void s_mapping_free_mapping_element (igs_map_t **map_elmt)
         free ((*map_elmt)->to_agent);
     if ((*map_elmt)->to_output)
         free ((*map_elmt)->to_output);
+    if ((*map_elmt)->window_value)
+        free ((*map_elmt)->window_value);
     free (*map_elmt);
     *map_elmt = NULL;
 }
@@ -115,12 +117,15 @@ bool mapping_is_equal (const char *first_str, const char *second_str)
     }
     //comparing ids
     //NB: comparing ids (which are hashes) is sufficient to compare
-    //the whole entries.
+    //the whole entries, except for reducers which are not part of the ids.
     igs_map_t *elmt, *tmp, *second_elmt;
     HASH_ITER (hh, first->map_elements, elmt, tmp){
         second_elmt = NULL;
         HASH_FIND (hh, second->map_elements, &elmt->id, sizeof (uint64_t), second_elmt);
-        if (!second_elmt){
+        if (!second_elmt
+            || elmt->reducer != second_elmt->reducer
+            || elmt->window_samples != second_elmt->window_samples
+            || elmt->window_ms != second_elmt->window_ms){
             res = false;
             goto END;
         }
@@ -182,6 +187,196 @@ bool mapping_check_input_output_compatibility (igsagent_t *agent,
     return is_compatible;
 }
 
+const char *mapping_reducer_to_string (igs_reducer_t reducer)
+{
+    switch (reducer) {
+        case IGS_REDUCER_DECIMATE:
+            return "decimate";
+        case IGS_REDUCER_AVERAGE:
+            return "average";
+        case IGS_REDUCER_MIN:
+            return "min";
+        case IGS_REDUCER_MAX:
+            return "max";
+        case IGS_REDUCER_LAST:
+            return "last";
+        default:
+            return NULL;
+    }
+}
+
+igs_reducer_t mapping_reducer_from_string (const char *reducer)
+{
+    if (!reducer)
+        return IGS_REDUCER_NONE;
+    if (streq (reducer, "decimate"))
+        return IGS_REDUCER_DECIMATE;
+    if (streq (reducer, "average"))
+        return IGS_REDUCER_AVERAGE;
+    if (streq (reducer, "min"))
+        return IGS_REDUCER_MIN;
+    if (streq (reducer, "max"))
+        return IGS_REDUCER_MAX;
+    if (streq (reducer, "last"))
+        return IGS_REDUCER_LAST;
+    return IGS_REDUCER_NONE;
+}
+
+// Keeps a copy of the latest value of a time window, to be delivered when
+// the window is flushed without a new value
+void s_mapping_keep_window_value (igs_map_t *map_elmt,
+                                  igs_iop_value_type_t value_type,
+                                  void *value, size_t size)
+{
+    assert (map_elmt);
+    if (!value)
+        size = 0;
+    if (!map_elmt->window_value || map_elmt->window_value_size != size) {
+        if (map_elmt->window_value)
+            free (map_elmt->window_value);
+        map_elmt->window_value = (size > 0) ? zmalloc (size) : NULL;
+    }
+    if (size > 0)
+        memcpy (map_elmt->window_value, value, size);
+    map_elmt->window_value_type = value_type;
+    map_elmt->window_value_size = size;
+    map_elmt->window_has_value = true;
+}
+
+void s_mapping_reset_window (igs_map_t *map_elmt)
+{
+    assert (map_elmt);
+    map_elmt->window_count = 0;
+    map_elmt->window_has_value = false;
+    if (map_elmt->window_value) {
+        free (map_elmt->window_value);
+        map_elmt->window_value = NULL;
+    }
+    map_elmt->window_value_size = 0;
+}
+
+bool mapping_reduce (igs_map_t *map_elmt, igs_iop_value_type_t *value_type,
+                     void **value, size_t *size)
+{
+    assert (map_elmt);
+    assert (value_type);
+    assert (value);
+    assert (size);
+    if (map_elmt->reducer == IGS_REDUCER_NONE)
+        return true;
+
+    // NB: a time window that has expired is closed by mapping_flush_window,
+    // before this value, which opens a new window
+    if (map_elmt->window_count == 0) {
+        map_elmt->window_start = zclock_mono ();
+        map_elmt->window_numeric_count = 0;
+        map_elmt->window_accumulator = 0;
+    }
+    map_elmt->window_count++;
+
+    // accumulate numeric values for the reducers that need it
+    bool is_numeric = true;
+    double d = 0;
+    if (*value_type == IGS_INTEGER_T && *value && *size >= sizeof (int))
+        d = (double) *(int *) (*value);
+    else if (*value_type == IGS_DOUBLE_T && *value && *size >= sizeof (double))
+        d = *(double *) (*value);
+    else if (*value_type == IGS_BOOL_T && *value && *size >= sizeof (bool))
+        d = (*(bool *) (*value)) ? 1 : 0;
+    else
+        is_numeric = false;
+    if (is_numeric) {
+        if (map_elmt->window_numeric_count == 0)
+            map_elmt->window_accumulator = d;
+        else if (map_elmt->reducer == IGS_REDUCER_AVERAGE)
+            map_elmt->window_accumulator += d;
+        else if (map_elmt->reducer == IGS_REDUCER_MIN
+                 && d < map_elmt->window_accumulator)
+            map_elmt->window_accumulator = d;
+        else if (map_elmt->reducer == IGS_REDUCER_MAX
+                 && d > map_elmt->window_accumulator)
+            map_elmt->window_accumulator = d;
+        map_elmt->window_numeric_count++;
+    }
+
+    bool is_first = (map_elmt->window_count == 1);
+    bool is_closing = (map_elmt->window_samples > 0
+                       && map_elmt->window_count >= map_elmt->window_samples);
+    if (is_closing)
+        s_mapping_reset_window (map_elmt);
+    else
+    if (map_elmt->window_ms > 0 && map_elmt->reducer != IGS_REDUCER_DECIMATE
+        && (map_elmt->reducer == IGS_REDUCER_LAST || !is_numeric))
+        s_mapping_keep_window_value (map_elmt, *value_type, *value, *size);
+
+    switch (map_elmt->reducer) {
+        case IGS_REDUCER_DECIMATE:
+            // first value of the window passes through, others are dropped
+            return is_first;
+        case IGS_REDUCER_AVERAGE:
+        case IGS_REDUCER_MIN:
+        case IGS_REDUCER_MAX:
+            if (!is_closing)
+                return false;
+            if (map_elmt->window_numeric_count == 0)
+                return true; // non-numeric values : behave like LAST
+            map_elmt->reduced_value = map_elmt->window_accumulator;
+            if (map_elmt->reducer == IGS_REDUCER_AVERAGE)
+                map_elmt->reduced_value /= (double) map_elmt->window_numeric_count;
+            *value_type = IGS_DOUBLE_T;
+            *value = &map_elmt->reduced_value;
+            *size = sizeof (double);
+            return true;
+        case IGS_REDUCER_LAST:
+        default:
+            // the value closing the window is the last one
+            return is_closing;
+    }
+}
+
+bool mapping_flush_window (igs_map_t *map_elmt, int64_t now,
+                           igs_iop_value_type_t *value_type,
+                           void **value, size_t *size)
+{
+    assert (map_elmt);
+    assert (value_type);
+    assert (value);
+    assert (size);
+    *value = NULL;
+    *size = 0;
+    if (map_elmt->reducer == IGS_REDUCER_NONE || map_elmt->window_ms == 0
+        || map_elmt->window_count == 0
+        || now - map_elmt->window_start < (int64_t) map_elmt->window_ms)
+        return false;
+    bool res = false;
+    if ((map_elmt->reducer == IGS_REDUCER_AVERAGE
+         || map_elmt->reducer == IGS_REDUCER_MIN
+         || map_elmt->reducer == IGS_REDUCER_MAX)
+        && map_elmt->window_numeric_count > 0) {
+        double reduced = map_elmt->window_accumulator;
+        if (map_elmt->reducer == IGS_REDUCER_AVERAGE)
+            reduced /= (double) map_elmt->window_numeric_count;
+        *value_type = IGS_DOUBLE_T;
+        *value = zmalloc (sizeof (double));
+        memcpy (*value, &reduced, sizeof (double));
+        *size = sizeof (double);
+        res = true;
+    }
+    else
+    if (map_elmt->reducer != IGS_REDUCER_DECIMATE && map_elmt->window_has_value) {
+        // ownership of the kept value is transferred to the caller
+        *value_type = map_elmt->window_value_type;
+        *value = map_elmt->window_value;
+        *size = map_elmt->window_value_size;
+        map_elmt->window_value = NULL;
+        res = true;
+    }
+    // NB: with IGS_REDUCER_DECIMATE, the first value of the window
+    // has already been delivered
+    s_mapping_reset_window (map_elmt);
+    return res;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // PUBLIC API
 ////////////////////////////////////////////////////////////////////////
@@ -216,7 +411,7 @@ igs_result_t igsagent_mapping_load_str (igsagent_t *agent,
         if (agent->mapping)
             mapping_free_mapping (&agent->mapping);
         agent->mapping = tmp;
-        agent->network_need_to_send_mapping_update = true;
+        network_request_mapping_update (agent);
         model_read_write_unlock (__FUNCTION__, __LINE__);
     }
     return IGS_SUCCESS;
@@ -243,7 +438,7 @@ igs_result_t igsagent_mapping_load_file (igsagent_t *agent,
         mapping_free_mapping (&agent->mapping);
     agent->mapping_path = s_strndup (file_path, IGS_MAX_PATH_LENGTH - 1);
     agent->mapping = tmp;
-    agent->network_need_to_send_mapping_update = true;
+    network_request_mapping_update (agent);
     model_read_write_unlock (__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
 }
@@ -263,7 +458,7 @@ void igsagent_clear_mappings (igsagent_t *agent)
         mapping_free_mapping (&agent->mapping);
     agent->mapping =
       (struct igs_mapping *) zmalloc (sizeof (struct igs_mapping));
-    agent->network_need_to_send_mapping_update = true;
+    network_request_mapping_update (agent);
     model_read_write_unlock (__FUNCTION__, __LINE__);
 }
 
@@ -283,7 +478,7 @@ void igsagent_clear_mappings_with_agent (igsagent_t *agent,
             if (streq (elmt->to_agent, agent_name)) {
                 HASH_DEL (agent->mapping->map_elements, elmt);
                 s_mapping_free_mapping_element (&elmt);
-                agent->network_need_to_send_mapping_update = true;
+                network_request_mapping_update (agent);
             }
         }
         model_read_write_unlock (__FUNCTION__, __LINE__);
@@ -323,15 +518,49 @@ size_t igsagent_mapping_count (igsagent_t *agent)
     return res;
 }
 
-uint64_t igsagent_mapping_add (igsagent_t *agent,
-                                     const char *from_our_input,
-                                     const char *to_agent,
-                                     const char *with_output)
+// Model lock must be held when calling this function
+void s_mapping_set_reducer (igsagent_t *agent,
+                            igs_map_t *map_elmt,
+                            igs_reducer_t reducer,
+                            size_t window_samples,
+                            unsigned int window_ms)
+{
+    assert (agent);
+    assert (map_elmt);
+    if (reducer == IGS_REDUCER_NONE) {
+        window_samples = 0;
+        window_ms = 0;
+    }
+    if (map_elmt->reducer == reducer
+        && map_elmt->window_samples == window_samples
+        && map_elmt->window_ms == window_ms)
+        return;
+    // the pending window, if any, is dropped
+    map_elmt->reducer = reducer;
+    map_elmt->window_samples = window_samples;
+    map_elmt->window_ms = window_ms;
+    s_mapping_reset_window (map_elmt);
+    network_request_mapping_update (agent);
+}
+
+static uint64_t s_mapping_add (igsagent_t *agent,
+                               const char *from_our_input,
+                               const char *to_agent,
+                               const char *with_output,
+                               bool with_reducer,
+                               igs_reducer_t reducer,
+                               size_t window_samples,
+                               unsigned int window_ms)
 {
     assert (agent);
     assert (from_our_input && strlen (from_our_input) > 0);
     assert (to_agent && strlen (to_agent) > 0);
     assert (with_output && strlen (with_output) > 0);
+    if (reducer != IGS_REDUCER_NONE && window_samples == 0 && window_ms == 0) {
+        igsagent_error (agent, "reducer on %s->%s.%s requires a number of samples and/or a duration",
+                        from_our_input, to_agent, with_output);
+        return 0;
+    }
     // from_our_input
     char *reviewed_from_our_input =
       s_strndup (from_our_input, IGS_MAX_IOP_NAME_LENGTH);
@@ -423,9 +652,17 @@ uint64_t igsagent_mapping_add (igsagent_t *agent,
 
         igs_map_t *new = mapping_create_mapping_element (reviewed_from_our_input, reviewed_to_agent, reviewed_with_output);
         new->id = hash;
+        if (reducer != IGS_REDUCER_NONE) {
+            new->reducer = reducer;
+            new->window_samples = window_samples;
+            new->window_ms = window_ms;
+        }
         HASH_ADD (hh, agent->mapping->map_elements, id, sizeof (uint64_t), new);
-        agent->network_need_to_send_mapping_update = true;
-    } else
+        network_request_mapping_update (agent);
+    } else if (with_reducer)
+        // element exists : update its reducer
+        s_mapping_set_reducer (agent, tmp, reducer, window_samples, window_ms);
+    else
         igsagent_warn (agent,
                        "mapping combination %s->%s.%s already exists : will not be duplicated",
                        reviewed_from_our_input, reviewed_to_agent,
@@ -437,6 +674,59 @@ uint64_t igsagent_mapping_add (igsagent_t *agent,
     return hash;
 }
 
+uint64_t igsagent_mapping_add (igsagent_t *agent,
+                                     const char *from_our_input,
+                                     const char *to_agent,
+                                     const char *with_output)
+{
+    return s_mapping_add (agent, from_our_input, to_agent, with_output,
+                          false, IGS_REDUCER_NONE, 0, 0);
+}
+
+uint64_t igsagent_mapping_add_with_reducer (igsagent_t *agent,
+                                            const char *from_our_input,
+                                            const char *to_agent,
+                                            const char *with_output,
+                                            igs_reducer_t reducer,
+                                            size_t window_samples,
+                                            unsigned int window_ms)
+{
+    return s_mapping_add (agent, from_our_input, to_agent, with_output,
+                          true, reducer, window_samples, window_ms);
+}
+
+igs_result_t igsagent_mapping_set_reducer (igsagent_t *agent,
+                                           uint64_t the_id,
+                                           igs_reducer_t reducer,
+                                           size_t window_samples,
+                                           unsigned int window_ms)
+{
+    assert (agent);
+    assert (the_id > 0);
+    if (reducer != IGS_REDUCER_NONE && window_samples == 0 && window_ms == 0) {
+        igsagent_error (agent, "reducer requires a number of samples and/or a duration");
+        return IGS_FAILURE;
+    }
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent || !(agent->uuid)) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return IGS_FAILURE;
+    }
+    igs_map_t *el = NULL;
+    if (agent->mapping && agent->mapping->map_elements)
+        HASH_FIND (hh, agent->mapping->map_elements, &the_id, sizeof (uint64_t), el);
+    if (el == NULL) {
+        igsagent_error (agent, "id %llu is not part of the current mapping",
+                        (unsigned long long) the_id);
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return IGS_FAILURE;
+    }
+    s_mapping_set_reducer (agent, el, reducer, window_samples, window_ms);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
 igs_result_t igsagent_mapping_remove_with_id (igsagent_t *agent,
                                                uint64_t the_id)
 {
@@ -462,7 +752,7 @@ igs_result_t igsagent_mapping_remove_with_id (igsagent_t *agent,
     }
     HASH_DEL (agent->mapping->map_elements, el);
     s_mapping_free_mapping_element (&el);
-    agent->network_need_to_send_mapping_update = true;
+    network_request_mapping_update (agent);
     model_read_write_unlock (__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
 }
@@ -511,7 +801,7 @@ igs_result_t igsagent_mapping_remove_with_name (igsagent_t *agent,
     }
     HASH_DEL (agent->mapping->map_elements, tmp);
     s_mapping_free_mapping_element (&tmp);
-    agent->network_need_to_send_mapping_update = true;
+    network_request_mapping_update (agent);
     model_read_write_unlock (__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
 }
@@ -14,6 +14,7 @@
 #include "ingescape_private.h"
 #include "uthash/utlist.h"
 #include <czmq.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -143,6 +144,181 @@ void s_model_run_observe_callbacks_for_iop (igsagent_t *agent,
     }
 }
 
+void s_model_add_input_to_batch (igsagent_t *agent, igs_iop_t *iop)
+{
+    assert (agent);
+    assert (iop);
+    if (!iop->is_batched) {
+        igs_batched_input_t *batched =
+          (igs_batched_input_t *) zmalloc (sizeof (igs_batched_input_t));
+        batched->name = strdup (iop->name);
+        DL_APPEND (agent->batched_inputs, batched);
+        agent->batched_inputs_nbr++;
+        iop->is_batched = true;
+    }
+}
+
+void s_model_run_inputs_batch_callbacks (igsagent_t *agent)
+{
+    assert (agent);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent->uuid || !agent->batched_inputs) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    igs_iop_value_t *inputs = (igs_iop_value_t *) zmalloc (
+      agent->batched_inputs_nbr * sizeof (igs_iop_value_t));
+    size_t inputs_nbr = 0;
+    igs_batched_input_t *batched, *tmp;
+    DL_FOREACH_SAFE (agent->batched_inputs, batched, tmp){
+        igs_iop_t *iop = NULL;
+        if (agent->definition)
+            HASH_FIND_STR (agent->definition->inputs_table, batched->name, iop);
+        // NB: input may have been removed since it was written
+        if (iop && iop->is_batched) {
+            iop->is_batched = false;
+            // NB: values are copied because the input may be written or removed
+            // while callbacks run unlocked
+            void *value = NULL;
+            switch (iop->value_type) {
+                case IGS_INTEGER_T:
+                    value = &(iop->value.i);
+                    break;
+                case IGS_DOUBLE_T:
+                    value = &(iop->value.d);
+                    break;
+                case IGS_BOOL_T:
+                    value = &(iop->value.b);
+                    break;
+                case IGS_STRING_T:
+                    value = iop->value.s;
+                    break;
+                case IGS_DATA_T:
+                    value = iop->value.data;
+                    break;
+                default:
+                    break;
+            }
+            inputs[inputs_nbr].name = strdup (iop->name);
+            inputs[inputs_nbr].value_type = iop->value_type;
+            inputs[inputs_nbr].value_size = iop->value_size;
+            if (iop->value_type == IGS_STRING_T)
+                inputs[inputs_nbr].value = (value) ? strdup ((char *) value) : NULL;
+            else
+            if (value && iop->value_size > 0) {
+                inputs[inputs_nbr].value = malloc (iop->value_size);
+                assert (inputs[inputs_nbr].value);
+                memcpy (inputs[inputs_nbr].value, value, iop->value_size);
+            }
+            else {
+                inputs[inputs_nbr].value = NULL;
+                inputs[inputs_nbr].value_size = 0;
+            }
+            inputs_nbr++;
+        }
+        DL_DELETE (agent->batched_inputs, batched);
+        free (batched->name);
+        free (batched);
+    }
+    agent->batched_inputs_nbr = 0;
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    if (inputs_nbr > 0) {
+        igs_inputs_batch_wrapper_t *cb;
+        DL_FOREACH (agent->inputs_batch_callbacks, cb)
+            cb->callback_ptr (agent, inputs, inputs_nbr, cb->data);
+    }
+    for (size_t i = 0; i < inputs_nbr; i++) {
+        free ((char *) inputs[i].name);
+        free (inputs[i].value);
+    }
+    free (inputs);
+}
+
+void model_inputs_batch_begin (igsagent_t *agent)
+{
+    assert (agent);
+    agent->inputs_batch_depth++;
+}
+
+void model_inputs_batch_end (igsagent_t *agent)
+{
+    assert (agent);
+    // check that this agent has not been destroyed when we were unlocked
+    if (!agent->uuid)
+        return;
+    assert (agent->inputs_batch_depth > 0);
+    agent->inputs_batch_depth--;
+    if (agent->inputs_batch_depth == 0 && agent->batched_inputs) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        s_model_run_inputs_batch_callbacks (agent);
+        model_read_write_lock (__FUNCTION__, __LINE__);
+    }
+}
+
+void s_model_free_sample (void *elt)
+{
+    igs_iop_sample_t *sample = (igs_iop_sample_t *) elt;
+    if (sample->type == IGS_STRING_T && sample->s)
+        free (sample->s);
+    else
+    if (sample->type == IGS_DATA_T && sample->data)
+        free (sample->data);
+}
+
+static const UT_icd s_model_sample_icd = {sizeof (igs_iop_sample_t), NULL, NULL, s_model_free_sample};
+
+// NB: utringbuffer_free and utringbuffer_eltptr compare unsigned indexes
+// to zero, samples are reached through their position in the ring memory.
+void model_free_history (UT_ringbuffer **history)
+{
+    assert (history);
+    assert (*history);
+    UT_ringbuffer *ring = *history;
+    unsigned nb = (ring->f) ? ring->n : ring->i;
+    for (unsigned i = 0; i < nb; i++)
+        s_model_free_sample (_utringbuffer_internalptr (ring, i));
+    free (ring->d);
+    free (ring);
+    *history = NULL;
+}
+
+void s_model_add_sample_to_history (igs_iop_t *iop)
+{
+    assert (iop);
+    assert (iop->history);
+    igs_iop_sample_t sample;
+    memset (&sample, 0, sizeof (igs_iop_sample_t));
+    sample.timestamp = zclock_usecs ();
+    sample.type = iop->value_type;
+    sample.size = iop->value_size;
+    switch (iop->value_type) {
+        case IGS_INTEGER_T:
+            sample.i = iop->value.i;
+            break;
+        case IGS_DOUBLE_T:
+            sample.d = iop->value.d;
+            break;
+        case IGS_BOOL_T:
+            sample.b = iop->value.b;
+            break;
+        case IGS_STRING_T:
+            sample.s = (iop->value.s) ? strdup (iop->value.s) : NULL;
+            break;
+        case IGS_DATA_T:
+            if (iop->value.data && iop->value_size > 0) {
+                sample.data = zmalloc (iop->value_size);
+                memcpy (sample.data, iop->value.data, iop->value_size);
+            }
+            break;
+        default:
+            break;
+    }
+    // NB: sample memory is now owned by the ring buffer, which
+    // frees the oldest sample when it is full
+    utringbuffer_push_back (iop->history, &sample);
+}
+
 const igs_iop_t *model_write_iop (igsagent_t *agent, const char *name,
                                   igs_iop_type_t type, igs_iop_value_type_t value_type,
                                   void *value, size_t size)
@@ -693,10 +869,21 @@ const igs_iop_t *model_write_iop (igsagent_t *agent, const char *name,
         igsagent_debug (agent, "set %s %s to %s", log_iop_type, name,
                         log_iop_value);
         free (log_iop_value);
-        
+
+        if (iop->history)
+            s_model_add_sample_to_history (iop);
+
+        bool shall_run_batch = false;
+        if (type == IGS_INPUT_T && agent->inputs_batch_callbacks) {
+            s_model_add_input_to_batch (agent, iop);
+            shall_run_batch = (agent->inputs_batch_depth == 0);
+        }
         model_read_write_unlock (__FUNCTION__, __LINE__);
         // handle iop callbacks
         s_model_run_observe_callbacks_for_iop (agent, iop, out_value, out_size);
+        // written outside of a batch : notify batch observers immediately
+        if (shall_run_batch)
+            s_model_run_inputs_batch_callbacks (agent);
     }else
         model_read_write_unlock (__FUNCTION__, __LINE__);
     return iop;
@@ -1467,9 +1654,10 @@ igs_constraint_t* s_model_parse_constraint(igs_iop_value_type_t type,
                                            const char *expression,char **error){
     assert(expression);
     assert(error);
-    const char *min_exp = "min ([+-]?(\\d*[.])?\\d+)";
-    const char *max_exp = "max ([+-]?(\\d*[.])?\\d+)";
-    const char *range_exp = "\\[([+-]?(\\d*[.])?\\d+)\\s*,\\s*([+-]?(\\d*[.])?\\d+)\\]";
+    //numbers may have an exponent, as in constraints of definition deltas
+    const char *min_exp = "min ([+-]?(\\d*[.])?\\d+([eE][+-]?\\d+)?)";
+    const char *max_exp = "max ([+-]?(\\d*[.])?\\d+([eE][+-]?\\d+)?)";
+    const char *range_exp = "\\[([+-]?(\\d*[.])?\\d+([eE][+-]?\\d+)?)\\s*,\\s*([+-]?(\\d*[.])?\\d+([eE][+-]?\\d+)?)\\]";
     const char *regexp = "~ ([^\n]+)";
     const char *exp1 = NULL;
     const char *exp2 = NULL;
@@ -1502,7 +1690,7 @@ igs_constraint_t* s_model_parse_constraint(igs_iop_value_type_t type,
     }else if (zrex_eq(rex, expression, range_exp)){
         //FIXME: apply verifications on values to check that min <= max
         exp1 = zrex_hit(rex, 1);
-        exp2 = zrex_hit(rex, 3);
+        exp2 = zrex_hit(rex, 4);
         if (type == IGS_INTEGER_T){
             c = (igs_constraint_t *)calloc(1, sizeof(igs_constraint_t));
             c->type = IGS_CONSTRAINT_RANGE;
@@ -1637,6 +1825,127 @@ void s_model_set_description(igsagent_t *self, igs_iop_type_t type,
     iop->description = s_strndup(description, IGS_MAX_LOG_LENGTH);
 }
 
+igs_result_t s_model_set_history (igsagent_t *self, igs_iop_type_t type,
+                                  const char *name, size_t depth)
+{
+    assert(self);
+    assert(name);
+    if (depth > UINT_MAX) {
+        igsagent_error (self, "history depth for %s is too large", name);
+        return IGS_FAILURE;
+    }
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igs_iop_t *iop = model_find_iop_by_name (self, name, type);
+    if (!iop) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return IGS_FAILURE;
+    }
+    if (iop->history)
+        model_free_history (&iop->history);
+    if (depth > 0)
+        utringbuffer_new (iop->history, (unsigned) depth, &s_model_sample_icd);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
+size_t s_model_history (igsagent_t *self, igs_iop_type_t type,
+                        const char *name, size_t max_samples, int64_t since,
+                        const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                        const igs_iop_sample_t **second_part, size_t *second_part_nbr)
+{
+    assert(self);
+    assert(name);
+    assert(first_part);
+    assert(first_part_nbr);
+    assert(second_part);
+    assert(second_part_nbr);
+    *first_part = NULL;
+    *second_part = NULL;
+    *first_part_nbr = 0;
+    *second_part_nbr = 0;
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igs_iop_t *iop = model_find_iop_by_name (self, name, type);
+    if (!iop) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return 0;
+    }
+    if (!iop->history) {
+        igsagent_warn (self, "%s has no history", name);
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return 0;
+    }
+    UT_ringbuffer *ring = iop->history;
+    size_t len = utringbuffer_len (ring);
+    size_t nb = (max_samples == 0 || max_samples > len) ? len : max_samples;
+    // position of the oldest sample in the ring memory
+    size_t oldest = (utringbuffer_full (ring)) ? ring->i : 0;
+    igs_iop_sample_t *samples = (igs_iop_sample_t *) ring->d;
+    // samples are walked from the newest to apply the time limit
+    if (since > 0) {
+        size_t kept = 0;
+        while (kept < nb) {
+            igs_iop_sample_t *sample = samples + (oldest + len - 1 - kept) % ring->n;
+            if (sample->timestamp < since)
+                break;
+            kept++;
+        }
+        nb = kept;
+    }
+    if (nb > 0) {
+        // position of the oldest sample of the window in the ring memory
+        size_t start = (oldest + len - nb) % ring->n;
+        *first_part = samples + start;
+        if (start + nb <= ring->n)
+            *first_part_nbr = nb;
+        else {
+            *first_part_nbr = ring->n - start;
+            *second_part = samples;
+            *second_part_nbr = nb - *first_part_nbr;
+        }
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return nb;
+}
+
+igs_result_t igsagent_input_set_history (igsagent_t *self, const char *name, size_t depth)
+{
+    return s_model_set_history (self, IGS_INPUT_T, name, depth);
+}
+
+igs_result_t igsagent_output_set_history (igsagent_t *self, const char *name, size_t depth)
+{
+    return s_model_set_history (self, IGS_OUTPUT_T, name, depth);
+}
+
+igs_result_t igsagent_parameter_set_history (igsagent_t *self, const char *name, size_t depth)
+{
+    return s_model_set_history (self, IGS_PARAMETER_T, name, depth);
+}
+
+size_t igsagent_input_history (igsagent_t *self, const char *name, size_t max_samples, int64_t since,
+                               const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                               const igs_iop_sample_t **second_part, size_t *second_part_nbr)
+{
+    return s_model_history (self, IGS_INPUT_T, name, max_samples, since,
+                            first_part, first_part_nbr, second_part, second_part_nbr);
+}
+
+size_t igsagent_output_history (igsagent_t *self, const char *name, size_t max_samples, int64_t since,
+                                const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                                const igs_iop_sample_t **second_part, size_t *second_part_nbr)
+{
+    return s_model_history (self, IGS_OUTPUT_T, name, max_samples, since,
+                            first_part, first_part_nbr, second_part, second_part_nbr);
+}
+
+size_t igsagent_parameter_history (igsagent_t *self, const char *name, size_t max_samples, int64_t since,
+                                   const igs_iop_sample_t **first_part, size_t *first_part_nbr,
+                                   const igs_iop_sample_t **second_part, size_t *second_part_nbr)
+{
+    return s_model_history (self, IGS_PARAMETER_T, name, max_samples, since,
+                            first_part, first_part_nbr, second_part, second_part_nbr);
+}
+
 void igsagent_constraints_enforce(igsagent_t *self, bool enforce)
 {
     self->enforce_constraints = enforce;
@@ -1985,6 +2294,19 @@ void igsagent_observe_parameter (igsagent_t *agent,
     s_model_observe (agent, name, IGS_PARAMETER_T, cb, my_data);
 }
 
+void igsagent_observe_inputs_batch (igsagent_t *agent,
+                                    igsagent_inputs_batch_fn cb,
+                                    void *my_data)
+{
+    assert (agent);
+    assert (cb);
+    igs_inputs_batch_wrapper_t *new_callback =
+      (igs_inputs_batch_wrapper_t *) zmalloc (sizeof (igs_inputs_batch_wrapper_t));
+    new_callback->callback_ptr = cb;
+    new_callback->data = my_data;
+    DL_APPEND (agent->inputs_batch_callbacks, new_callback);
+}
+
 // --------------------------------  MUTE ------------------------------------//
 
 void igsagent_output_mute (igsagent_t *agent, const char *name)
@@ -103,6 +103,171 @@ void s_unsubscribe_to_remote_agent_output (igs_remote_agent_t *remote_agent,
     }
 }
 
+////////////////////////////////////////////////////////////////////////
+// Inbound queues
+////////////////////////////////////////////////////////////////////////
+
+void s_free_inbound_value (igs_inbound_value_t **queued)
+{
+    assert (queued);
+    assert (*queued);
+    if ((*queued)->input_name)
+        free ((*queued)->input_name);
+    if ((*queued)->value)
+        free ((*queued)->value);
+    free (*queued);
+    *queued = NULL;
+}
+
+void s_set_inbound_value (igs_inbound_value_t *queued,
+                          igs_iop_value_type_t value_type,
+                          void *value,
+                          size_t size)
+{
+    assert (queued);
+    if (queued->value)
+        free (queued->value);
+    queued->value = NULL;
+    queued->value_type = value_type;
+    queued->value_size = size;
+    if (value && size > 0) {
+        queued->value = zmalloc (size);
+        memcpy (queued->value, value, size);
+    }
+}
+
+// Writes queued values into the inputs of an agent, in their order of arrival.
+// Model lock must be held when calling this function. It is released while
+// writing each input and held again when the function returns.
+void s_drain_inbound_queue (igsagent_t *agent)
+{
+    assert (agent);
+    agent->inbound_queue_is_draining = true;
+    do {
+        // all the values drained together are notified as a single batch
+        model_inputs_batch_begin (agent);
+        while (agent->uuid && agent->inbound_queue) {
+            igs_inbound_value_t *queued = agent->inbound_queue;
+            DL_DELETE (agent->inbound_queue, queued);
+            agent->inbound_queue_size--;
+            model_read_write_unlock (__FUNCTION__, __LINE__);
+            model_write_iop (agent, queued->input_name, IGS_INPUT_T,
+                             queued->value_type, queued->value, queued->value_size);
+            model_read_write_lock (__FUNCTION__, __LINE__);
+            s_free_inbound_value (&queued);
+        }
+        model_inputs_batch_end (agent);
+        // NB: batch observers may have received new values in our queue
+    } while (agent->uuid && agent->inbound_queue);
+    // check that this agent has not been destroyed when we were unlocked
+    if (agent->uuid)
+        agent->inbound_queue_is_draining = false;
+}
+
+void s_drain_inbound_queues (igs_core_context_t *context)
+{
+    assert (context);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igsagent_t *agent, *tmp_agent;
+    HASH_ITER (hh, context->agents, agent, tmp_agent){
+        // NB: a queue already being drained, by another thread or
+        // lower in our call stack, will handle the new values itself
+        if (agent->uuid && agent->inbound_queue
+            && !agent->inbound_queue_is_draining)
+            s_drain_inbound_queue (agent);
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+bool s_has_inbound_queues (igs_core_context_t *context)
+{
+    assert (context);
+    // NB: read without the model lock, a stale value only
+    // delays the reading of a burst to the next publication
+    return (context->network_inbound_queues > 0);
+}
+
+// Writes a received value into an input of an agent or stores it in the
+// agent inbound queue, according to the queue policy, when the queue is enabled.
+// Model lock must be held when calling this function and is held when it returns.
+void s_write_or_queue_input (igsagent_t *agent,
+                             const char *input_name,
+                             igs_iop_value_type_t value_type,
+                             void *value,
+                             size_t size)
+{
+    assert (agent);
+    assert (input_name);
+    igs_inbound_value_t *queued = NULL;
+    if (agent->inbound_queue_capacity == 0) {
+        if (agent->inbound_queue) {
+            // the queue was disabled while being drained : new values
+            // are queued behind the older ones to keep their order
+            queued = (igs_inbound_value_t *) zmalloc (sizeof (igs_inbound_value_t));
+            queued->input_name = strdup (input_name);
+            s_set_inbound_value (queued, value_type, value, size);
+            DL_APPEND (agent->inbound_queue, queued);
+            agent->inbound_queue_size++;
+            return;
+        }
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        model_write_iop (agent, input_name, IGS_INPUT_T, value_type, value,
+                         size);
+        model_read_write_lock (__FUNCTION__, __LINE__);
+        return;
+    }
+
+    if (agent->inbound_queue_policy == IGS_QUEUE_COALESCE) {
+        DL_FOREACH (agent->inbound_queue, queued){
+            if (streq (queued->input_name, input_name))
+                break;
+        }
+        if (queued) {
+            // the pending value is replaced by the new one
+            s_set_inbound_value (queued, value_type, value, size);
+            agent->inbound_queue_dropped++;
+            return;
+        }
+    }
+
+    if (agent->inbound_queue_size >= agent->inbound_queue_capacity) {
+        switch (agent->inbound_queue_policy) {
+            case IGS_QUEUE_DROP_NEWEST:
+                igsagent_debug (agent, "inbound queue is full : dropping new value for %s",
+                                input_name);
+                agent->inbound_queue_dropped++;
+                return;
+            case IGS_QUEUE_BLOCK:
+                // NB: when the queue is already being drained, i.e. when we are
+                // called from one of its input callbacks or concurrently with
+                // another thread, the queue temporarily exceeds its capacity.
+                if (!agent->inbound_queue_is_draining)
+                    s_drain_inbound_queue (agent);
+                // check that this agent has not been destroyed when we were unlocked
+                if (!agent->uuid)
+                    return;
+                break;
+            case IGS_QUEUE_DROP_OLDEST:
+            case IGS_QUEUE_COALESCE:
+            default:
+                queued = agent->inbound_queue;
+                igsagent_debug (agent, "inbound queue is full : dropping oldest value for %s",
+                                queued->input_name);
+                DL_DELETE (agent->inbound_queue, queued);
+                s_free_inbound_value (&queued);
+                agent->inbound_queue_size--;
+                agent->inbound_queue_dropped++;
+                break;
+        }
+    }
+
+    queued = (igs_inbound_value_t *) zmalloc (sizeof (igs_inbound_value_t));
+    queued->input_name = strdup (input_name);
+    s_set_inbound_value (queued, value_type, value, size);
+    DL_APPEND (agent->inbound_queue, queued);
+    agent->inbound_queue_size++;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // ZMQ callbacks
 ////////////////////////////////////////////////////////////////////////
@@ -132,6 +297,9 @@ void s_handle_publication_from_remote_agent (zmsg_t *msg,
         if (!agent || !agent->uuid || (strlen (agent->uuid) == 0))
             continue;
 
+        // all the inputs written from this publication are
+        // notified as a single batch
+        model_inputs_batch_begin (agent);
         zmsg_t *dup = zmsg_dup (msg);
         size_t msg_size = zmsg_size (dup);
         char *output = NULL;
@@ -215,22 +383,28 @@ void s_handle_publication_from_remote_agent (zmsg_t *msg,
                                            elmt->to_output);
                         else {
                             // we have a fully matching mapping element : write from received
-                            // output to our input
-                            if (value_type == IGS_STRING_T) {
-                                model_read_write_unlock (__FUNCTION__, __LINE__);
-                                model_write_iop (agent, elmt->from_input,
-                                                 IGS_INPUT_T, value_type, value,
-                                                 strlen (value) + 1);
-                                model_read_write_lock (__FUNCTION__, __LINE__);
-
-                            }
-                            else {
-                                model_read_write_unlock (__FUNCTION__, __LINE__);
-                                model_write_iop (agent, elmt->from_input,
-                                                 IGS_INPUT_T, value_type, data,
-                                                 size);
-                                model_read_write_lock (__FUNCTION__, __LINE__);
+                            // output to our input (or to our inbound queue), possibly
+                            // through the reducer of the mapping element
+                            igs_iop_value_type_t flushed_type = IGS_UNKNOWN_T;
+                            void *flushed_value = NULL;
+                            size_t flushed_size = 0;
+                            if (mapping_flush_window (elmt, zclock_mono (), &flushed_type,
+                                                      &flushed_value, &flushed_size)) {
+                                // the expired window of the reducer is delivered before
+                                // this value, which opens a new window
+                                s_write_or_queue_input (agent, elmt->from_input, flushed_type,
+                                                        flushed_value, flushed_size);
+                                free (flushed_value);
+                                if (!agent->uuid)
+                                    break;
                             }
+                            igs_iop_value_type_t reduced_type = value_type;
+                            void *reduced_value = (value_type == IGS_STRING_T) ? (void *) value : data;
+                            size_t reduced_size = (value_type == IGS_STRING_T) ? strlen (value) + 1 : size;
+                            if (mapping_reduce (elmt, &reduced_type, &reduced_value, &reduced_size))
+                                s_write_or_queue_input (agent, elmt->from_input,
+                                                        reduced_type, reduced_value,
+                                                        reduced_size);
                             if (!agent->uuid)
                                 break;
                         }
@@ -245,6 +419,123 @@ void s_handle_publication_from_remote_agent (zmsg_t *msg,
             output = NULL;
         }
         zmsg_destroy (&dup);
+        model_inputs_batch_end (agent);
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+bool network_is_loop_thread (igs_core_context_t *context)
+{
+    assert (context);
+    return (context->loop_is_running
+            && IGS_THREAD_EQUAL (context->loop_thread, IGS_THREAD_SELF ()));
+}
+
+// Timer callback closing the time windows of our mapping reducers which have
+// expired without receiving a new value. The timer ends itself when our
+// mappings do not use time windows anymore.
+int s_flush_reducers (zloop_t *loop, int timer_id, void *arg)
+{
+    igs_core_context_t *context = (igs_core_context_t *) arg;
+    assert (context);
+    bool has_time_windows = false;
+    int64_t now = zclock_mono ();
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igsagent_t *agent, *tmp_agent;
+    HASH_ITER (hh, context->agents, agent, tmp_agent){
+        if (!agent->uuid || !agent->mapping)
+            continue;
+        model_inputs_batch_begin (agent);
+        igs_map_t *elmt, *tmp;
+        HASH_ITER (hh, agent->mapping->map_elements, elmt, tmp){
+            if (elmt->reducer == IGS_REDUCER_NONE || elmt->window_ms == 0)
+                continue;
+            has_time_windows = true;
+            igs_iop_value_type_t value_type = IGS_UNKNOWN_T;
+            void *value = NULL;
+            size_t size = 0;
+            if (mapping_flush_window (elmt, now, &value_type, &value, &size)) {
+                s_write_or_queue_input (agent, elmt->from_input, value_type,
+                                        value, size);
+                free (value);
+                // check that this agent has not been destroyed when we were unlocked
+                if (!agent->uuid)
+                    break;
+            }
+        }
+        model_inputs_batch_end (agent);
+    }
+    if (!has_time_windows) {
+        zloop_timer_end (loop, timer_id);
+        context->network_reducers_timer_armed = false;
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    s_drain_inbound_queues (context);
+    return 0;
+}
+
+// Arms the timer closing the time windows of our mapping reducers, when
+// needed. Shall be called from the ingescape loop.
+void s_arm_reducers_timer (igs_core_context_t *context)
+{
+    assert (context);
+    assert (context->loop);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    if (!context->network_reducers_timer_armed) {
+        igsagent_t *agent, *tmp_agent;
+        HASH_ITER (hh, context->agents, agent, tmp_agent){
+            if (!agent->mapping)
+                continue;
+            igs_map_t *elmt, *tmp;
+            HASH_ITER (hh, agent->mapping->map_elements, elmt, tmp){
+                if (elmt->reducer != IGS_REDUCER_NONE && elmt->window_ms > 0) {
+                    context->network_reducers_timer_armed = true;
+                    break;
+                }
+            }
+            if (context->network_reducers_timer_armed)
+                break;
+        }
+        if (context->network_reducers_timer_armed)
+            zloop_timer (context->loop, IGS_REDUCERS_CHECK_PERIOD, 0,
+                         s_flush_reducers, context);
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+// Arms the timer checking the timeouts of our split works, when some of
+// our agents have a work timeout. Shall be called from the ingescape loop.
+void s_arm_split_timeouts_timer (igs_core_context_t *context)
+{
+    assert (context);
+    assert (context->loop);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    if (!context->split_timeouts_timer_armed) {
+        igsagent_t *agent, *tmp_agent;
+        HASH_ITER (hh, context->agents, agent, tmp_agent){
+            if (agent->split_work_timeout > 0) {
+                context->split_timeouts_timer_armed = true;
+                break;
+            }
+        }
+        if (context->split_timeouts_timer_armed)
+            zloop_timer (context->loop, IGS_SPLIT_TIMEOUTS_CHECK_PERIOD, 0,
+                         split_check_timeouts, context);
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+// Arms the timer checking the deadlines of our service calls, when some
+// of them have a deadline. Shall be called from the ingescape loop.
+void s_arm_service_deadlines_timer (igs_core_context_t *context)
+{
+    assert (context);
+    assert (context->loop);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    if (!context->service_deadlines_timer_armed && service_has_deadlines (context)) {
+        context->service_deadlines_timer_armed = true;
+        zloop_timer (context->loop, IGS_SERVICE_DEADLINES_CHECK_PERIOD, 0,
+                     service_check_deadlines, context);
     }
     model_read_write_unlock (__FUNCTION__, __LINE__);
 }
@@ -275,11 +566,9 @@ int s_trigger_outputs_request_to_newcomer (zloop_t *loop,
     return 0;
 }
 
-// manage incoming messages from one of the remote agents we subscribed to
-int s_manage_remote_publication (zloop_t *loop, zsock_t *socket, void *arg)
+// read one publication from one of the remote agents we subscribed to
+int s_receive_remote_publication (zsock_t *socket, igs_core_context_t *context)
 {
-    IGS_UNUSED (loop)
-    igs_core_context_t *context = (igs_core_context_t *) arg;
     assert (socket);
     assert (context);
 
@@ -318,6 +607,126 @@ int s_manage_remote_publication (zloop_t *loop, zsock_t *socket, void *arg)
     return 0;
 }
 
+// manage incoming messages from one of the remote agents we subscribed to
+int s_manage_remote_publication (zloop_t *loop, zsock_t *socket, void *arg)
+{
+    IGS_UNUSED (loop)
+    igs_core_context_t *context = (igs_core_context_t *) arg;
+    assert (socket);
+    assert (context);
+
+    s_receive_remote_publication (socket, context);
+    if (s_has_inbound_queues (context)) {
+        // read the publications already waiting in the socket before
+        // writing our inputs so that inbound queue policies apply
+        // to the whole burst instead of letting it pile up in ZMQ.
+        size_t burst = 1;
+        while (burst < IGS_INBOUND_QUEUE_MAX_BURST
+               && (zsock_events (socket) & ZMQ_POLLIN)) {
+            s_receive_remote_publication (socket, context);
+            burst++;
+        }
+        s_drain_inbound_queues (context);
+    }
+    return 0;
+}
+
+void s_name_index_add (igs_name_index_t **index, const char *name, void *item)
+{
+    assert (index);
+    assert (name);
+    assert (item);
+    igs_name_index_t *entry = NULL;
+    HASH_FIND_STR (*index, name, entry);
+    if (entry == NULL) {
+        entry = (igs_name_index_t *) zmalloc (sizeof (igs_name_index_t));
+        entry->name = strdup (name);
+        entry->items = zlist_new ();
+        HASH_ADD_KEYPTR (hh, *index, entry->name, strlen (entry->name), entry);
+    }
+    zlist_append (entry->items, item);
+}
+
+void s_name_index_remove (igs_name_index_t **index, const char *name, void *item)
+{
+    assert (index);
+    assert (name);
+    assert (item);
+    igs_name_index_t *entry = NULL;
+    HASH_FIND_STR (*index, name, entry);
+    if (entry == NULL)
+        return;
+    zlist_remove (entry->items, item);
+    if (zlist_size (entry->items) == 0) {
+        HASH_DEL (*index, entry);
+        zlist_destroy (&entry->items);
+        free (entry->name);
+        free (entry);
+    }
+}
+
+void s_add_zyre_peer (igs_core_context_t *context, igs_zyre_peer_t *zyre_peer)
+{
+    assert (context);
+    assert (zyre_peer);
+    assert (zyre_peer->peer_id);
+    assert (zyre_peer->name);
+    zyre_peer->remote_agents = zlist_new ();
+    HASH_ADD_STR (context->zyre_peers, peer_id, zyre_peer);
+    s_name_index_add (&context->zyre_peers_by_name, zyre_peer->name, zyre_peer);
+}
+
+void s_remove_zyre_peer (igs_core_context_t *context, igs_zyre_peer_t *zyre_peer)
+{
+    assert (context);
+    assert (zyre_peer);
+    HASH_DEL (context->zyre_peers, zyre_peer);
+    s_name_index_remove (&context->zyre_peers_by_name, zyre_peer->name, zyre_peer);
+}
+
+void s_add_remote_agent (igs_core_context_t *context, igs_remote_agent_t *remote_agent)
+{
+    assert (context);
+    assert (remote_agent);
+    assert (remote_agent->peer);
+    assert (remote_agent->definition);
+    HASH_ADD_STR (context->remote_agents, uuid, remote_agent);
+    remote_agent->indexed_name = strdup (remote_agent->definition->name);
+    s_name_index_add (&context->remote_agents_by_name, remote_agent->indexed_name, remote_agent);
+    zlist_append (remote_agent->peer->remote_agents, remote_agent);
+}
+
+void s_remove_remote_agent (igs_core_context_t *context, igs_remote_agent_t *remote_agent)
+{
+    assert (context);
+    assert (remote_agent);
+    HASH_DEL (context->remote_agents, remote_agent);
+    if (remote_agent->indexed_name) {
+        s_name_index_remove (&context->remote_agents_by_name, remote_agent->indexed_name, remote_agent);
+        free (remote_agent->indexed_name);
+        remote_agent->indexed_name = NULL;
+    }
+    if (remote_agent->peer && remote_agent->peer->remote_agents)
+        zlist_remove (remote_agent->peer->remote_agents, remote_agent);
+}
+
+// to be called when the definition of a remote agent has changed
+void s_reindex_remote_agent (igs_core_context_t *context, igs_remote_agent_t *remote_agent)
+{
+    assert (context);
+    assert (remote_agent);
+    assert (remote_agent->definition);
+    if (remote_agent->indexed_name
+        && streq (remote_agent->indexed_name, remote_agent->definition->name))
+        return;
+    if (remote_agent->indexed_name) {
+        s_name_index_remove (&context->remote_agents_by_name, remote_agent->indexed_name, remote_agent);
+        free (remote_agent->indexed_name);
+    }
+    remote_agent->indexed_name = strdup (remote_agent->definition->name);
+    s_name_index_add (&context->remote_agents_by_name, remote_agent->indexed_name, remote_agent);
+}
+
 void s_clean_and_free_zyre_peer (igs_zyre_peer_t **zyre_peer, zloop_t *loop)
 {
     assert (zyre_peer);
@@ -331,6 +740,10 @@ void s_clean_and_free_zyre_peer (igs_zyre_peer_t **zyre_peer, zloop_t *loop)
         free ((*zyre_peer)->name);
     if ((*zyre_peer)->protocol != NULL)
         free ((*zyre_peer)->protocol);
+    if ((*zyre_peer)->remote_agents != NULL)
+        zlist_destroy (&(*zyre_peer)->remote_agents);
+    if ((*zyre_peer)->fetched_definitions != NULL)
+        zhash_destroy (&(*zyre_peer)->fetched_definitions);
     if ((*zyre_peer)->subscriber != NULL) {
         zloop_reader_end (loop, (*zyre_peer)->subscriber);
         zsock_destroy (&((*zyre_peer)->subscriber));
@@ -382,11 +795,54 @@ void s_subscribe_to_remote_agent_output (igs_remote_agent_t *remote_agent,
     }
 }
 
+// asks the peer of a remote agent for its full definition and mapping
+void network_fetch_remote_definition (igs_remote_agent_t *remote_agent)
+{
+    assert (remote_agent);
+    if (!remote_agent->definition_is_summary || remote_agent->definition_requested
+        || !remote_agent->peer || !remote_agent->context->node)
+        return;
+    igs_debug ("fetching definition of %s(%s)", remote_agent->definition->name,
+               remote_agent->uuid);
+    remote_agent->definition_requested = true;
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    zmsg_t *msg = zmsg_new ();
+    zmsg_addstr (msg, DEFINITION_REQUEST_MSG);
+    zmsg_addstr (msg, remote_agent->uuid);
+    zyre_whisper (remote_agent->context->node, remote_agent->peer->peer_id, &msg);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+}
+
+// true if the mapping or splits of our agent involve the remote agent
+bool s_agent_needs_remote_definition (igsagent_t *agent, igs_remote_agent_t *remote_agent)
+{
+    if (!agent->mapping)
+        return false;
+    igs_map_t *map, *map_tmp;
+    HASH_ITER (hh, agent->mapping->map_elements, map, map_tmp){
+        if (streq (remote_agent->definition->name, map->to_agent)
+            || streq (map->to_agent, "*"))
+            return true;
+    }
+    igs_split_t *split, *split_tmp;
+    HASH_ITER (hh, agent->mapping->split_elements, split, split_tmp){
+        if (streq (remote_agent->definition->name, split->to_agent))
+            return true;
+    }
+    return false;
+}
+
 int s_network_configure_mapping_to_remote_agent (
   igsagent_t *agent, igs_remote_agent_t *remote_agent)
 {
     assert (agent);
     assert (remote_agent);
+    if (remote_agent->definition_is_summary) {
+        // outputs are unknown until the definition is fetched
+        if (s_agent_needs_remote_definition (agent, remote_agent))
+            network_fetch_remote_definition (remote_agent);
+        return 0;
+    }
     igs_map_t *el, *tmp;
     if (agent->mapping != NULL) {
         HASH_ITER (hh, agent->mapping->map_elements, el, tmp)
@@ -433,52 +889,492 @@ int s_network_configure_mapping_to_remote_agent (
             }
         }
     }
-    return 0;
+    return 0;
+}
+
+void s_clear_definition_json (igsagent_t *agent)
+{
+    assert (agent);
+    if (agent->network_definition_json) {
+        free (agent->network_definition_json);
+        agent->network_definition_json = NULL;
+    }
+    if (agent->network_definition_json_legacy) {
+        free (agent->network_definition_json_legacy);
+        agent->network_definition_json_legacy = NULL;
+    }
+}
+
+void s_clear_mapping_json (igsagent_t *agent)
+{
+    assert (agent);
+    if (agent->network_mapping_json) {
+        free (agent->network_mapping_json);
+        agent->network_mapping_json = NULL;
+    }
+    if (agent->network_mapping_json_legacy) {
+        free (agent->network_mapping_json_legacy);
+        agent->network_mapping_json_legacy = NULL;
+    }
+}
+
+void network_clear_serialization_cache (igsagent_t *agent)
+{
+    s_clear_definition_json (agent);
+    s_clear_mapping_json (agent);
+}
+
+// Definition exported once for all the peers using the same protocol.
+// Cache is cleared when the definition update is sent.
+const char *s_definition_json_for_peer (igsagent_t *agent, igs_zyre_peer_t *peer)
+{
+    assert (agent);
+    assert (peer);
+    if (peer->protocol
+        && (streq (peer->protocol, "v2") || streq (peer->protocol, "v3"))) {
+        if (!agent->network_definition_json_legacy)
+            agent->network_definition_json_legacy = parser_export_definition_legacy (agent->definition);
+        return agent->network_definition_json_legacy;
+    }
+    if (!agent->network_definition_json)
+        agent->network_definition_json = parser_export_definition (agent->definition);
+    return agent->network_definition_json;
+}
+
+// Mapping exported once for all the peers using the same protocol.
+// Cache is cleared when the mapping update is sent.
+const char *s_mapping_json_for_peer (igsagent_t *agent, igs_zyre_peer_t *peer)
+{
+    assert (agent);
+    assert (peer);
+    if (peer->protocol && streq (peer->protocol, "v2")) {
+        if (!agent->network_mapping_json_legacy)
+            agent->network_mapping_json_legacy = parser_export_mapping_legacy (agent->mapping);
+        return agent->network_mapping_json_legacy;
+    }
+    if (!agent->network_mapping_json)
+        agent->network_mapping_json = parser_export_mapping (agent->mapping);
+    return agent->network_mapping_json;
+}
+
+void s_send_definition_to_zyre_peer (igsagent_t *agent,
+                                     const char *peer,
+                                     const char *def,
+                                     bool notif)
+{
+    assert (agent);
+    assert (agent->context);
+    assert (agent->context->node);
+    assert (peer);
+    assert (def);
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    zmsg_t *msg = zmsg_new ();
+    zmsg_addstr (msg, EXTERNAL_DEFINITION_MSG);
+    zmsg_addstr (msg, def);
+    zmsg_addstr (msg, agent->uuid);
+    zmsg_addstr (msg, agent->definition->name);
+    if (notif) {
+        // Agent has been activated during runtime: we must
+        // indicate that our peer already knows the distant peer
+        zmsg_addstr (msg, "1");
+    }
+    zyre_whisper (core_context->node, peer, &msg);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+}
+
+void s_send_mapping_to_zyre_peer (igsagent_t *agent,
+                                  const char *peer,
+                                  const char *mapping)
+{
+    assert (agent);
+    assert (agent->context);
+    assert (agent->context->node);
+    assert (peer);
+    assert (mapping);
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    zmsg_t *msg = zmsg_new ();
+    zmsg_addstr (msg, EXTERNAL_MAPPING_MSG);
+    zmsg_addstr (msg, mapping);
+    zmsg_addstr (msg, agent->uuid);
+    zyre_whisper (core_context->node, peer, &msg);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+}
+
+// djb2 continued over successive fields, NULL fields being hashed as empty
+uint64_t s_delta_hash (uint64_t hash, const char *str)
+{
+    if (str) {
+        int c;
+        while ((c = (unsigned char) *str++))
+            hash = ((hash << 5) + hash) + c;
+    }
+    return ((hash << 5) + hash) + '|';
+}
+
+uint64_t s_delta_hash_number (uint64_t hash, long long number)
+{
+    char buffer[32] = "";
+    snprintf (buffer, sizeof (buffer), "%lld", number);
+    return s_delta_hash (hash, buffer);
+}
+
+void s_delta_free_entries (igs_delta_entry_t **entries)
+{
+    assert (entries);
+    igs_delta_entry_t *entry, *tmp;
+    HASH_ITER (hh, *entries, entry, tmp){
+        HASH_DEL (*entries, entry);
+        free (entry->key);
+        free (entry);
+    }
+    *entries = NULL;
+}
+
+void s_delta_add_entry (igs_delta_entry_t **entries, const char *key, uint64_t signature)
+{
+    igs_delta_entry_t *entry = (igs_delta_entry_t *) zmalloc (sizeof (igs_delta_entry_t));
+    entry->key = strdup (key);
+    entry->signature = signature;
+    HASH_ADD_STR (*entries, key, entry);
+}
+
+void network_clear_delta_state (igsagent_t *agent)
+{
+    assert (agent);
+    agent->network_definition_sent = false;
+    agent->network_mapping_sent = false;
+    s_delta_free_entries (&agent->network_sent_iops);
+    s_delta_free_entries (&agent->network_sent_maps);
+}
+
+igs_iop_t **s_delta_iop_table (igs_definition_t *definition, igs_iop_type_t type)
+{
+    switch (type) {
+        case IGS_INPUT_T:
+            return &definition->inputs_table;
+        case IGS_OUTPUT_T:
+            return &definition->outputs_table;
+        case IGS_PARAMETER_T:
+            return &definition->params_table;
+        default:
+            return NULL;
+    }
+}
+
+// everything in a definition that deltas do not carry
+uint64_t s_delta_definition_header (igs_definition_t *definition)
+{
+    uint64_t hash = 5381;
+    hash = s_delta_hash (hash, definition->name);
+    hash = s_delta_hash (hash, definition->family);
+    hash = s_delta_hash (hash, definition->description);
+    hash = s_delta_hash (hash, definition->version);
+    igs_service_t *service, *tmp;
+    HASH_ITER (hh, definition->services_table, service, tmp){
+        hash = s_delta_hash (hash, service->name);
+        hash = s_delta_hash (hash, service->description);
+        igs_service_arg_t *arg = NULL;
+        LL_FOREACH (service->arguments, arg){
+            hash = s_delta_hash (hash, arg->name);
+            hash = s_delta_hash_number (hash, arg->type);
+        }
+        if (service->reply) {
+            hash = s_delta_hash (hash, service->reply->name);
+            LL_FOREACH (service->reply->arguments, arg){
+                hash = s_delta_hash (hash, arg->name);
+                hash = s_delta_hash_number (hash, arg->type);
+            }
+        }
+    }
+    return hash;
+}
+
+uint64_t s_delta_iop_signature (igs_iop_t *iop)
+{
+    char constraint[IGS_MAX_LOG_LENGTH] = "";
+    parser_constraint_expression (iop, constraint, IGS_MAX_LOG_LENGTH);
+    uint64_t hash = 5381;
+    hash = s_delta_hash_number (hash, iop->value_type);
+    hash = s_delta_hash (hash, iop->description);
+    return s_delta_hash (hash, constraint);
+}
+
+uint64_t s_delta_map_signature (igs_map_t *map)
+{
+    uint64_t hash = 5381;
+    hash = s_delta_hash (hash, map->from_input);
+    hash = s_delta_hash (hash, map->to_agent);
+    hash = s_delta_hash (hash, map->to_output);
+    hash = s_delta_hash_number (hash, map->reducer);
+    hash = s_delta_hash_number (hash, (long long) map->window_samples);
+    return s_delta_hash_number (hash, map->window_ms);
+}
+
+uint64_t s_delta_splits_signature (igs_mapping_t *mapping)
+{
+    uint64_t hash = 5381;
+    if (!mapping)
+        return hash;
+    igs_split_t *split, *tmp;
+    HASH_ITER (hh, mapping->split_elements, split, tmp){
+        hash = s_delta_hash (hash, split->from_input);
+        hash = s_delta_hash (hash, split->to_agent);
+        hash = s_delta_hash (hash, split->to_output);
+    }
+    return hash;
+}
+
+void s_delta_add_iop_op (zmsg_t *ops, const char *op, igs_iop_t *iop)
+{
+    char constraint[IGS_MAX_LOG_LENGTH] = "";
+    parser_constraint_expression (iop, constraint, IGS_MAX_LOG_LENGTH);
+    zmsg_addstr (ops, op);
+    zmsg_addstrf (ops, "%d", iop->type);
+    zmsg_addstr (ops, iop->name);
+    zmsg_addstrf (ops, "%d", iop->value_type);
+    zmsg_addstr (ops, (iop->description) ? iop->description : "");
+    zmsg_addstr (ops, constraint);
+    // value as in full definitions : inputs do not have one
+    const void *value = NULL;
+    size_t size = 0;
+    if (iop->type != IGS_INPUT_T) {
+        switch (iop->value_type) {
+            case IGS_INTEGER_T:
+                value = &iop->value.i;
+                size = sizeof (int);
+                break;
+            case IGS_DOUBLE_T:
+                value = &iop->value.d;
+                size = sizeof (double);
+                break;
+            case IGS_BOOL_T:
+                value = &iop->value.b;
+                size = sizeof (bool);
+                break;
+            case IGS_STRING_T:
+                value = iop->value.s;
+                size = (iop->value.s) ? strlen (iop->value.s) + 1 : 0;
+                break;
+            case IGS_DATA_T:
+                value = iop->value.data;
+                size = (iop->value.data) ? iop->value_size : 0;
+                break;
+            default:
+                break;
+        }
+    }
+    zmsg_addmem (ops, value, size);
+}
+
+// sets the value received with an IOP_ADDED or IOP_CHANGED operation
+void s_delta_set_iop_value (igs_iop_t *iop, zframe_t *frame)
+{
+    byte *value = zframe_data (frame);
+    size_t size = zframe_size (frame);
+    switch (iop->value_type) {
+        case IGS_INTEGER_T:
+            if (size == sizeof (int))
+                memcpy (&iop->value.i, value, sizeof (int));
+            break;
+        case IGS_DOUBLE_T:
+            if (size == sizeof (double))
+                memcpy (&iop->value.d, value, sizeof (double));
+            break;
+        case IGS_BOOL_T:
+            if (size == sizeof (bool))
+                iop->value.b = (value[0] != 0);
+            break;
+        case IGS_STRING_T:
+            if (size > 0 && value[size - 1] == '\0')
+                iop->value.s = strdup ((char *) value);
+            break;
+        case IGS_DATA_T:
+            if (size > 0) {
+                iop->value.data = malloc (size);
+                assert (iop->value.data);
+                memcpy (iop->value.data, value, size);
+                iop->value_size = size;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/* Compares the definition with the one last sent and updates the latter.
+ Returns the delta operations, or NULL if a full definition must be sent. */
+zmsg_t *s_definition_delta (igsagent_t *agent)
+{
+    assert (agent);
+    assert (agent->definition);
+    igs_delta_entry_t *iops = NULL;
+    char key[IGS_MAX_IOP_NAME_LENGTH + 16] = "";
+    for (igs_iop_type_t type = IGS_INPUT_T; type <= IGS_PARAMETER_T; type++) {
+        igs_iop_t **table = s_delta_iop_table (agent->definition, type);
+        igs_iop_t *iop, *tmp;
+        HASH_ITER (hh, *table, iop, tmp){
+            snprintf (key, sizeof (key), "%d:%s", type, iop->name);
+            s_delta_add_entry (&iops, key, s_delta_iop_signature (iop));
+        }
+    }
+    uint64_t header = s_delta_definition_header (agent->definition);
+    zmsg_t *ops = NULL;
+    if (agent->network_definition_sent && header == agent->network_sent_definition_header) {
+        ops = zmsg_new ();
+        igs_delta_entry_t *entry, *tmp, *previous;
+        HASH_ITER (hh, iops, entry, tmp){
+            HASH_FIND_STR (agent->network_sent_iops, entry->key, previous);
+            if (previous && previous->signature == entry->signature)
+                continue;
+            igs_iop_type_t type = (igs_iop_type_t) atoi (entry->key);
+            igs_iop_t *iop = NULL;
+            HASH_FIND_STR (*s_delta_iop_table (agent->definition, type),
+                           strchr (entry->key, ':') + 1, iop);
+            assert (iop);
+            s_delta_add_iop_op (ops, (previous) ? DELTA_IOP_CHANGED : DELTA_IOP_ADDED, iop);
+        }
+        HASH_ITER (hh, agent->network_sent_iops, entry, tmp){
+            HASH_FIND_STR (iops, entry->key, previous);
+            if (previous)
+                continue;
+            zmsg_addstr (ops, DELTA_IOP_REMOVED);
+            zmsg_addstrf (ops, "%d", atoi (entry->key));
+            zmsg_addstr (ops, strchr (entry->key, ':') + 1);
+        }
+    }
+    s_delta_free_entries (&agent->network_sent_iops);
+    agent->network_sent_iops = iops;
+    agent->network_sent_definition_header = header;
+    agent->network_definition_sent = true;
+    return ops;
+}
+
+/* Compares the mapping with the one last sent and updates the latter.
+ Returns the delta operations, or NULL if a full mapping must be sent. */
+zmsg_t *s_mapping_delta (igsagent_t *agent)
+{
+    assert (agent);
+    igs_delta_entry_t *maps = NULL;
+    char key[32] = "";
+    if (agent->mapping) {
+        igs_map_t *map, *tmp;
+        HASH_ITER (hh, agent->mapping->map_elements, map, tmp){
+            snprintf (key, sizeof (key), "%llu", (unsigned long long) map->id);
+            s_delta_add_entry (&maps, key, s_delta_map_signature (map));
+        }
+    }
+    uint64_t splits = s_delta_splits_signature (agent->mapping);
+    zmsg_t *ops = NULL;
+    if (agent->network_mapping_sent && agent->mapping && splits == agent->network_sent_splits) {
+        ops = zmsg_new ();
+        igs_delta_entry_t *entry, *tmp, *previous;
+        HASH_ITER (hh, maps, entry, tmp){
+            HASH_FIND_STR (agent->network_sent_maps, entry->key, previous);
+            if (previous && previous->signature == entry->signature)
+                continue;
+            uint64_t id = strtoull (entry->key, NULL, 10);
+            igs_map_t *map = NULL;
+            HASH_FIND (hh, agent->mapping->map_elements, &id, sizeof (uint64_t), map);
+            assert (map);
+            zmsg_addstr (ops, DELTA_MAP_ADDED);
+            zmsg_addstr (ops, entry->key);
+            zmsg_addstr (ops, map->from_input);
+            zmsg_addstr (ops, map->to_agent);
+            zmsg_addstr (ops, map->to_output);
+            zmsg_addstrf (ops, "%d", map->reducer);
+            zmsg_addstrf (ops, "%zu", map->window_samples);
+            zmsg_addstrf (ops, "%u", map->window_ms);
+        }
+        HASH_ITER (hh, agent->network_sent_maps, entry, tmp){
+            HASH_FIND_STR (maps, entry->key, previous);
+            if (previous)
+                continue;
+            zmsg_addstr (ops, DELTA_MAP_REMOVED);
+            zmsg_addstr (ops, entry->key);
+        }
+    }
+    s_delta_free_entries (&agent->network_sent_maps);
+    agent->network_sent_maps = maps;
+    agent->network_sent_splits = splits;
+    agent->network_mapping_sent = true;
+    return ops;
 }
 
-void s_send_definition_to_zyre_peer (igsagent_t *agent,
-                                     const char *peer,
-                                     const char *def,
-                                     bool notif)
+// base version zero announces the version of a full definition or mapping
+void s_send_delta_to_zyre_peer (igsagent_t *agent,
+                                const char *peer,
+                                const char *title,
+                                uint64_t base_version,
+                                uint64_t version,
+                                zmsg_t *ops)
 {
     assert (agent);
-    assert (agent->context);
-    assert (agent->context->node);
     assert (peer);
-    assert (def);
+    assert (title);
+    zmsg_t *msg = (ops) ? zmsg_dup (ops) : zmsg_new ();
+    zmsg_pushstrf (msg, "%llu", (unsigned long long) version);
+    zmsg_pushstrf (msg, "%llu", (unsigned long long) base_version);
+    zmsg_pushstr (msg, agent->uuid);
+    zmsg_pushstr (msg, title);
     s_lock_zyre_peer (__FUNCTION__, __LINE__);
-    zmsg_t *msg = zmsg_new ();
-    zmsg_addstr (msg, EXTERNAL_DEFINITION_MSG);
-    zmsg_addstr (msg, def);
-    zmsg_addstr (msg, agent->uuid);
-    zmsg_addstr (msg, agent->definition->name);
-    if (notif) {
-        // Agent has been activated during runtime: we must
-        // indicate that our peer already knows the distant peer
-        zmsg_addstr (msg, "1");
-    }
     zyre_whisper (core_context->node, peer, &msg);
     s_unlock_zyre_peer (__FUNCTION__, __LINE__);
 }
 
-void s_send_mapping_to_zyre_peer (igsagent_t *agent,
-                                  const char *peer,
-                                  const char *mapping)
+// peers using lazy definitions receive summaries until they fetch ours
+bool s_peer_wants_summary (igs_zyre_peer_t *peer, igsagent_t *agent)
+{
+    return peer->lazy_definitions
+           && !(peer->fetched_definitions
+                && zhash_lookup (peer->fetched_definitions, agent->uuid));
+}
+
+void s_send_definition_summary_to_zyre_peer (igsagent_t *agent,
+                                             igs_zyre_peer_t *peer,
+                                             bool is_for_activation)
 {
     assert (agent);
-    assert (agent->context);
-    assert (agent->context->node);
+    assert (agent->definition);
     assert (peer);
-    assert (mapping);
-    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    const char *definition_str = s_definition_json_for_peer (agent, peer);
+    char digest[IGS_DEFINITION_DIGEST_LENGTH] = "";
+    definition_digest ((definition_str) ? definition_str : "", digest);
     zmsg_t *msg = zmsg_new ();
-    zmsg_addstr (msg, EXTERNAL_MAPPING_MSG);
-    zmsg_addstr (msg, mapping);
+    zmsg_addstr (msg, DEFINITION_SUMMARY_MSG);
     zmsg_addstr (msg, agent->uuid);
-    zyre_whisper (core_context->node, peer, &msg);
+    zmsg_addstr (msg, agent->definition->name);
+    zmsg_addstr (msg, digest);
+    zmsg_addstrf (msg, "%llu", (unsigned long long) agent->network_definition_version);
+    if (is_for_activation)
+        zmsg_addstr (msg, "1");
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    zyre_whisper (core_context->node, peer->peer_id, &msg);
     s_unlock_zyre_peer (__FUNCTION__, __LINE__);
 }
 
+// full definition and mapping, followed by their versions for peers supporting deltas
+void s_send_definition_and_mapping_to_zyre_peer (igsagent_t *agent, igs_zyre_peer_t *peer)
+{
+    assert (agent);
+    assert (peer);
+    // definition is sent to every newcomer on the channel (whether it is a
+    // ingescape agent or not)
+    const char *definition_str = s_definition_json_for_peer (agent, peer);
+    s_send_definition_to_zyre_peer (agent, peer->peer_id,
+                                    (definition_str) ? definition_str : "", false);
+    // and so is our mapping
+    const char *mapping_str = s_mapping_json_for_peer (agent, peer);
+    s_send_mapping_to_zyre_peer (agent, peer->peer_id,
+                                 (mapping_str) ? mapping_str : "");
+    // peers supporting deltas learn the versions they now hold
+    if (peer->supports_deltas) {
+        s_send_delta_to_zyre_peer (agent, peer->peer_id, DEFINITION_DELTA_MSG, 0,
+                                   agent->network_definition_version, NULL);
+        s_send_delta_to_zyre_peer (agent, peer->peer_id, MAPPING_DELTA_MSG, 0,
+                                   agent->network_mapping_version, NULL);
+    }
+}
+
 void s_send_state_to (igsagent_t *agent,
                       const char *peer_or_channel,
                       bool is_for_peer)
@@ -615,7 +1511,7 @@ void s_clean_and_free_remote_agent (igs_remote_agent_t **remote_agent)
 
     // clean the agent definition & mapping
     if ((*remote_agent)->definition != NULL)
-        definition_free_definition (&(*remote_agent)->definition);
+        definition_release ((*remote_agent)->context, &(*remote_agent)->definition);
     if ((*remote_agent)->mapping != NULL)
         mapping_free_mapping (&(*remote_agent)->mapping);
 
@@ -641,6 +1537,441 @@ void s_clean_and_free_remote_agent (igs_remote_agent_t **remote_agent)
 }
 
 // manage messages received on the private channel
+void s_request_delta_sync (igs_remote_agent_t *remote, const char *peer, const char *kind)
+{
+    igs_warn ("missed %s update from %s(%s): requesting it again",
+              kind, remote->definition->name, remote->uuid);
+    zmsg_t *msg = zmsg_new ();
+    zmsg_addstr (msg, DELTA_SYNC_REQUEST_MSG);
+    zmsg_addstr (msg, remote->uuid);
+    zmsg_addstr (msg, kind);
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    zyre_whisper (remote->context->node, peer, &msg);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+}
+
+/* Pops uuid, base and new versions of a delta message. Returns the remote agent
+ if its operations shall be applied, NULL if the message is only an announce,
+ is not valid or if the remote agent needs to be resynchronized. */
+igs_remote_agent_t *s_delta_remote_agent (zmsg_t *msg,
+                                          igs_core_context_t *context,
+                                          const char *peer,
+                                          bool is_definition)
+{
+    char *uuid = zmsg_popstr (msg);
+    char *base_str = zmsg_popstr (msg);
+    char *version_str = zmsg_popstr (msg);
+    igs_remote_agent_t *remote = NULL;
+    if (uuid)
+        HASH_FIND_STR (context->remote_agents, uuid, remote);
+    if (!remote || !base_str || !version_str) {
+        igs_error ("invalid delta message received for agent %s: rejecting",
+                   (uuid) ? uuid : "(null)");
+        remote = NULL;
+    }
+    else {
+        uint64_t base = strtoull (base_str, NULL, 10);
+        uint64_t version = strtoull (version_str, NULL, 10);
+        uint64_t *current = (is_definition) ? &remote->definition_version
+                                            : &remote->mapping_version;
+        if (base == 0) {
+            // announce following a full definition or mapping
+            *current = version;
+            remote = NULL;
+        }
+        else
+        if (base != *current) {
+            s_request_delta_sync (remote, peer, (is_definition) ? "definition" : "mapping");
+            remote = NULL;
+        }
+        else
+            *current = version;
+    }
+    free (uuid);
+    free (base_str);
+    free (version_str);
+    return remote;
+}
+
+// operations are idempotent : added elements replace existing ones and
+// removing missing elements is ignored
+void s_network_message_definition_delta (zmsg_t *msg,
+                                         igs_core_context_t *context,
+                                         const char *peer)
+{
+    assert (msg);
+    assert (context);
+    assert (peer);
+    igs_remote_agent_t *remote = s_delta_remote_agent (msg, context, peer, true);
+    if (!remote)
+        return;
+    definition_make_private (context, &remote->definition);
+    char *op = NULL;
+    while ((op = zmsg_popstr (msg))) {
+        bool is_removal = streq (op, DELTA_IOP_REMOVED);
+        char *type_str = zmsg_popstr (msg);
+        char *iop_name = zmsg_popstr (msg);
+        char *value_type = (is_removal) ? NULL : zmsg_popstr (msg);
+        char *description = (is_removal) ? NULL : zmsg_popstr (msg);
+        char *constraint = (is_removal) ? NULL : zmsg_popstr (msg);
+        zframe_t *value = (is_removal) ? NULL : zmsg_pop (msg);
+        igs_iop_t **table = (type_str) ? s_delta_iop_table (remote->definition,
+                                                            atoi (type_str)) : NULL;
+        if (!table || !iop_name || (!is_removal && !value)) {
+            igs_error ("invalid %s operation in definition delta for %s(%s): ignoring",
+                       op, remote->definition->name, remote->uuid);
+        }
+        else {
+            igs_iop_t *iop = NULL;
+            HASH_FIND_STR (*table, iop_name, iop);
+            if (iop) {
+                HASH_DEL (*table, iop);
+                s_definition_free_iop (&iop);
+            }
+            if (!is_removal) {
+                iop = (igs_iop_t *) zmalloc (sizeof (igs_iop_t));
+                iop->type = (igs_iop_type_t) atoi (type_str);
+                iop->value_type = (igs_iop_value_type_t) atoi (value_type);
+                iop->name = strdup (iop_name);
+                if (strlen (description) > 0)
+                    iop->description = strdup (description);
+                if (strlen (constraint) > 0) {
+                    char *error = NULL;
+                    iop->constraint = s_model_parse_constraint (iop->value_type,
+                                                                constraint, &error);
+                    if (error) {
+                        igs_error ("%s", error);
+                        free (error);
+                    }
+                }
+                s_delta_set_iop_value (iop, value);
+                HASH_ADD_STR (*table, name, iop);
+            }
+        }
+        free (op);
+        free (type_str);
+        free (iop_name);
+        free (value_type);
+        free (description);
+        free (constraint);
+        zframe_destroy (&value);
+    }
+    if (context->network_lean_remote_definitions)
+        definition_make_lean (remote->definition);
+    igs_debug ("applied definition delta for %s(%s), now at version %llu",
+               remote->definition->name, remote->uuid,
+               (unsigned long long) remote->definition_version);
+    igsagent_t *agent, *tmp;
+    HASH_ITER (hh, context->agents, agent, tmp)
+        s_network_configure_mapping_to_remote_agent (agent, remote);
+    s_agent_propagate_agent_event (IGS_AGENT_UPDATED_DEFINITION, remote->uuid,
+                                   remote->definition->name, NULL);
+}
+
+void s_network_message_mapping_delta (zmsg_t *msg,
+                                      igs_core_context_t *context,
+                                      const char *peer)
+{
+    assert (msg);
+    assert (context);
+    assert (peer);
+    igs_remote_agent_t *remote = s_delta_remote_agent (msg, context, peer, false);
+    if (!remote)
+        return;
+    if (!remote->mapping)
+        remote->mapping = (igs_mapping_t *) zmalloc (sizeof (igs_mapping_t));
+    char *op = NULL;
+    while ((op = zmsg_popstr (msg))) {
+        bool is_removal = streq (op, DELTA_MAP_REMOVED);
+        char *id_str = zmsg_popstr (msg);
+        char *from_input = (is_removal) ? NULL : zmsg_popstr (msg);
+        char *to_agent = (is_removal) ? NULL : zmsg_popstr (msg);
+        char *to_output = (is_removal) ? NULL : zmsg_popstr (msg);
+        char *reducer = (is_removal) ? NULL : zmsg_popstr (msg);
+        char *window_samples = (is_removal) ? NULL : zmsg_popstr (msg);
+        char *window_ms = (is_removal) ? NULL : zmsg_popstr (msg);
+        if (!id_str || (!is_removal && !window_ms)) {
+            igs_error ("invalid %s operation in mapping delta for %s(%s): ignoring",
+                       op, remote->definition->name, remote->uuid);
+        }
+        else {
+            uint64_t id = strtoull (id_str, NULL, 10);
+            igs_map_t *map = NULL;
+            HASH_FIND (hh, remote->mapping->map_elements, &id, sizeof (uint64_t), map);
+            if (map) {
+                HASH_DEL (remote->mapping->map_elements, map);
+                s_mapping_free_mapping_element (&map);
+            }
+            if (!is_removal) {
+                map = mapping_create_mapping_element (from_input, to_agent, to_output);
+                map->id = id;
+                map->reducer = (igs_reducer_t) atoi (reducer);
+                map->window_samples = (size_t) strtoull (window_samples, NULL, 10);
+                map->window_ms = (unsigned int) strtoul (window_ms, NULL, 10);
+                HASH_ADD (hh, remote->mapping->map_elements, id, sizeof (uint64_t), map);
+            }
+        }
+        free (op);
+        free (id_str);
+        free (from_input);
+        free (to_agent);
+        free (to_output);
+        free (reducer);
+        free (window_samples);
+        free (window_ms);
+    }
+    igs_debug ("applied mapping delta for %s(%s), now at version %llu",
+               remote->definition->name, remote->uuid,
+               (unsigned long long) remote->mapping_version);
+    s_agent_propagate_agent_event (IGS_AGENT_UPDATED_MAPPING, remote->uuid,
+                                   remote->definition->name, NULL);
+}
+
+// a peer missed one of our deltas : send it a full definition or mapping
+void s_network_message_delta_sync_request (zmsg_t *msg,
+                                           igs_core_context_t *context,
+                                           const char *peer)
+{
+    assert (msg);
+    assert (context);
+    assert (peer);
+    char *uuid = zmsg_popstr (msg);
+    char *kind = zmsg_popstr (msg);
+    igs_zyre_peer_t *zyre_peer = NULL;
+    HASH_FIND_STR (context->zyre_peers, peer, zyre_peer);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igsagent_t *agent = NULL;
+    if (uuid)
+        HASH_FIND_STR (context->agents, uuid, agent);
+    if (agent && agent->uuid && kind && zyre_peer) {
+        if (streq (kind, "definition")) {
+            if (agent->network_need_to_send_definition_update)
+                s_clear_definition_json (agent);
+            const char *definition_str = s_definition_json_for_peer (agent, zyre_peer);
+            s_send_definition_to_zyre_peer (agent, peer,
+                                            (definition_str) ? definition_str : "", false);
+            s_send_delta_to_zyre_peer (agent, peer, DEFINITION_DELTA_MSG, 0,
+                                       agent->network_definition_version, NULL);
+        }
+        else
+        if (streq (kind, "mapping")) {
+            if (agent->network_need_to_send_mapping_update)
+                s_clear_mapping_json (agent);
+            const char *mapping_str = s_mapping_json_for_peer (agent, zyre_peer);
+            s_send_mapping_to_zyre_peer (agent, peer, (mapping_str) ? mapping_str : "");
+            s_send_delta_to_zyre_peer (agent, peer, MAPPING_DELTA_MSG, 0,
+                                       agent->network_mapping_version, NULL);
+        }
+    }
+    else
+        igs_warn ("cannot serve delta sync request for agent %s",
+                  (uuid) ? uuid : "(null)");
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    free (uuid);
+    free (kind);
+}
+
+void s_send_worker_hellos (igs_core_context_t *context, igs_remote_agent_t *remote_agent)
+{
+    igsagent_t *elt_agent, *tmp_agent;
+    HASH_ITER (hh, context->agents, elt_agent, tmp_agent)
+    {
+        bool found_split_element = false;
+        char *input_split_element;
+        char *output_split_element;
+        igs_split_t *elt, *tmp_split;
+        HASH_ITER (hh, elt_agent->mapping->split_elements,
+                   elt, tmp_split)
+        {
+            if (elt
+                && streq (elt->to_agent,
+                          remote_agent->definition->name)) {
+                found_split_element = true;
+                input_split_element = elt->from_input;
+                output_split_element = elt->to_output;
+                break;
+            }
+        }
+        if (found_split_element)
+            split_send_worker_hello (elt_agent, input_split_element,
+                                     output_split_element,
+                                     remote_agent->uuid);
+    }
+}
+
+igs_definition_t *s_summary_definition (const char *name)
+{
+    igs_definition_t *definition = (igs_definition_t *) zmalloc (sizeof (igs_definition_t));
+    definition->name = strdup (name);
+    return definition;
+}
+
+// asks the peer of a remote agent whose definition we already know for its mapping
+void s_request_remote_mapping (igs_remote_agent_t *remote_agent)
+{
+    assert (remote_agent);
+    if (!remote_agent->peer || !remote_agent->context->node)
+        return;
+    s_lock_zyre_peer (__FUNCTION__, __LINE__);
+    zmsg_t *msg = zmsg_new ();
+    zmsg_addstr (msg, DEFINITION_REQUEST_MSG);
+    zmsg_addstr (msg, remote_agent->uuid);
+    zmsg_addstr (msg, "mapping");
+    zyre_whisper (remote_agent->context->node, remote_agent->peer->peer_id, &msg);
+    s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+}
+
+// a summarized remote agent gets a definition known by digest
+void s_set_known_remote_definition (igs_core_context_t *context,
+                                    igs_remote_agent_t *remote_agent,
+                                    igs_definition_t *definition)
+{
+    igs_definition_t *old_def = remote_agent->definition;
+    remote_agent->definition = definition;
+    definition_release (context, &old_def);
+    s_reindex_remote_agent (context, remote_agent);
+    remote_agent->definition_is_summary = false;
+    remote_agent->definition_requested = false;
+    s_request_remote_mapping (remote_agent);
+    s_send_worker_hellos (context, remote_agent);
+}
+
+/* Remote agents announced by a summary only have a name until their
+ definition is fetched because our agents map or split to them, call
+ their services or because igs_net_fetch_definition is used. Definitions
+ used by other remote agents are known immediately, and those found in
+ the persistent cache are known once loaded, see s_manage_definitions_cache.
+ In both cases, only the mapping is requested to the peer. */
+void s_network_message_definition_summary (zmsg_t *msg,
+                                           igs_core_context_t *context,
+                                           igs_zyre_peer_t *zyre_peer)
+{
+    assert (msg);
+    assert (context);
+    assert (zyre_peer);
+    char *uuid = zmsg_popstr (msg);
+    char *remote_agent_name = zmsg_popstr (msg);
+    char *digest = zmsg_popstr (msg);
+    char *version_str = zmsg_popstr (msg);
+    char *notification = zmsg_popstr (msg);
+    if (!uuid || !remote_agent_name || !digest || !version_str
+        || strlen (digest) != IGS_DEFINITION_DIGEST_LENGTH - 1) {
+        igs_error ("invalid %s message received from %s(%s): rejecting",
+                   DEFINITION_SUMMARY_MSG, zyre_peer->name, zyre_peer->peer_id);
+        free (uuid);
+        free (remote_agent_name);
+        free (digest);
+        free (version_str);
+        free (notification);
+        return;
+    }
+    igs_remote_agent_t *remote_agent = NULL;
+    HASH_FIND_STR (context->remote_agents, uuid, remote_agent);
+    igs_definition_t *known_definition = NULL;
+    bool is_new_digest = false;
+    if (remote_agent == NULL) {
+        remote_agent = (igs_remote_agent_t *) zmalloc (sizeof (igs_remote_agent_t));
+        remote_agent->context = context;
+        remote_agent->uuid = strdup (uuid);
+        remote_agent->peer = zyre_peer;
+        remote_agent->definition = s_summary_definition (remote_agent_name);
+        remote_agent->definition_is_summary = true;
+        snprintf (remote_agent->definition_digest, IGS_DEFINITION_DIGEST_LENGTH, "%s", digest);
+        s_add_remote_agent (context, remote_agent);
+        igs_debug ("registering summarized agent %s(%s)", uuid, remote_agent_name);
+        s_agent_propagate_agent_event (IGS_AGENT_ENTERED, uuid, remote_agent_name, NULL);
+        if (notification)
+            s_agent_propagate_agent_event (IGS_AGENT_KNOWS_US, uuid,
+                                           remote_agent_name, NULL);
+        // notify remote agent that our agents knows it
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        zmsg_t *msg_know = zmsg_new ();
+        zmsg_addstr (msg_know, REMOTE_PEER_KNOWS_AGENT_MSG);
+        zmsg_addstr (msg_know, uuid);
+        zyre_whisper (context->node, zyre_peer->peer_id, &msg_know);
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        is_new_digest = true;
+    }
+    else
+    if (strneq (remote_agent->definition_digest, digest)) {
+        // definition changed : keep its name only until it is needed again
+        igs_definition_t *old_def = remote_agent->definition;
+        remote_agent->definition = s_summary_definition (remote_agent_name);
+        definition_release (context, &old_def);
+        s_reindex_remote_agent (context, remote_agent);
+        remote_agent->definition_is_summary = true;
+        remote_agent->definition_requested = false;
+        snprintf (remote_agent->definition_digest, IGS_DEFINITION_DIGEST_LENGTH, "%s", digest);
+        is_new_digest = true;
+        s_agent_propagate_agent_event (IGS_AGENT_UPDATED_DEFINITION, uuid,
+                                       remote_agent_name, NULL);
+    }
+    remote_agent->definition_version = strtoull (version_str, NULL, 10);
+    if (is_new_digest) {
+        known_definition = definition_intern_known (context, digest);
+        if (known_definition)
+            s_set_known_remote_definition (context, remote_agent, known_definition);
+        else
+        if (definition_cache_load (context, uuid, digest))
+            // no fetch until the cache has answered
+            remote_agent->definition_requested = true;
+    }
+    // fetch the definition if our agents need it
+    igsagent_t *agent, *tmp;
+    HASH_ITER (hh, context->agents, agent, tmp)
+        s_network_configure_mapping_to_remote_agent (agent, remote_agent);
+    free (uuid);
+    free (remote_agent_name);
+    free (digest);
+    free (version_str);
+    free (notification);
+}
+
+void s_network_message_definition_request (zmsg_t *msg,
+                                           igs_core_context_t *context,
+                                           igs_zyre_peer_t *zyre_peer)
+{
+    assert (msg);
+    assert (context);
+    assert (zyre_peer);
+    char *uuid = zmsg_popstr (msg);
+    // peers already knowing our definition by its digest only need the mapping
+    char *kind = zmsg_popstr (msg);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igsagent_t *agent = NULL;
+    if (uuid)
+        HASH_FIND_STR (context->agents, uuid, agent);
+    if (agent && agent->uuid) {
+        if (!zyre_peer->fetched_definitions)
+            zyre_peer->fetched_definitions = zhash_new ();
+        zhash_insert (zyre_peer->fetched_definitions, agent->uuid, agent);
+        // pending updates mean our serialized forms are outdated
+        if (agent->network_need_to_send_definition_update)
+            s_clear_definition_json (agent);
+        if (agent->network_need_to_send_mapping_update)
+            s_clear_mapping_json (agent);
+        if (kind && streq (kind, "mapping")) {
+            const char *mapping_str = s_mapping_json_for_peer (agent, zyre_peer);
+            s_send_mapping_to_zyre_peer (agent, zyre_peer->peer_id,
+                                         (mapping_str) ? mapping_str : "");
+            if (zyre_peer->supports_deltas) {
+                s_send_delta_to_zyre_peer (agent, zyre_peer->peer_id, DEFINITION_DELTA_MSG, 0,
+                                           agent->network_definition_version, NULL);
+                s_send_delta_to_zyre_peer (agent, zyre_peer->peer_id, MAPPING_DELTA_MSG, 0,
+                                           agent->network_mapping_version, NULL);
+            }
+        }
+        else
+            s_send_definition_and_mapping_to_zyre_peer (agent, zyre_peer);
+    }
+    else
+        igs_warn ("%s(%s) requested the definition of unknown agent %s",
+                  zyre_peer->name, zyre_peer->peer_id, (uuid) ? uuid : "(null)");
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    free (uuid);
+    free (kind);
+}
+
 int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
 {
     IGS_UNUSED (socket)
@@ -669,8 +2000,8 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
         if (zyre_peer == NULL) {
             zyre_peer = (igs_zyre_peer_t *) zmalloc (sizeof (igs_zyre_peer_t));
             zyre_peer->peer_id = s_strndup (peerUUID, IGS_MAX_PEER_ID_LENGTH);
-            HASH_ADD_STR (context->zyre_peers, peer_id, zyre_peer);
             zyre_peer->name = s_strndup (name, IGS_MAX_AGENT_NAME_LENGTH);
+            s_add_zyre_peer (context, zyre_peer);
             zlist_t *keys = zhash_keys (headers);
             size_t s = zlist_size (keys);
             if (s > 0) {
@@ -689,6 +2020,14 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
             const char *protocol_version = zyre_event_header (zyre_event, "protocol");
             if (protocol_version)
                 zyre_peer->protocol = s_strndup (protocol_version, 16);
+            const char *service_packing = zyre_event_header (zyre_event, SERVICE_PACKING_HEADER);
+            zyre_peer->supports_packed_services = (service_packing && streq (service_packing, "1"));
+            const char *service_bulk = zyre_event_header (zyre_event, SERVICE_BULK_HEADER);
+            zyre_peer->supports_bulk_services = (service_bulk && streq (service_bulk, "1"));
+            const char *deltas = zyre_event_header (zyre_event, DELTAS_HEADER);
+            zyre_peer->supports_deltas = (deltas && streq (deltas, "1"));
+            const char *lazy_definitions = zyre_event_header (zyre_event, LAZY_DEFINITIONS_HEADER);
+            zyre_peer->lazy_definitions = (lazy_definitions && streq (lazy_definitions, "1"));
 
             const char *publisher_port = zyre_event_header (zyre_event, "publisher");
             if (publisher_port) {
@@ -802,39 +2141,18 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
             assert (zyre_peer);
 
             igsagent_t *agent, *tmp;
-            char *definition_str = NULL;
-            char *mapping_str = NULL;
             HASH_ITER (hh, context->agents, agent, tmp)
             {
-                // definition is sent to every newcomer on the channel (whether it is a
-                // ingescape agent or not)
-                if (zyre_peer->protocol
-                    && (streq (zyre_peer->protocol, "v2")
-                        || streq (zyre_peer->protocol, "v3")))
-                    definition_str = parser_export_definition_legacy (agent->definition);
+                // pending updates mean our serialized forms are outdated
+                if (agent->network_need_to_send_definition_update)
+                    s_clear_definition_json (agent);
+                if (agent->network_need_to_send_mapping_update)
+                    s_clear_mapping_json (agent);
+                // peers using lazy definitions fetch them when they need them
+                if (s_peer_wants_summary (zyre_peer, agent))
+                    s_send_definition_summary_to_zyre_peer (agent, zyre_peer, false);
                 else
-                    definition_str =
-                      parser_export_definition (agent->definition);
-                if (definition_str) {
-                    s_send_definition_to_zyre_peer (agent, peerUUID,
-                                                    definition_str, false);
-                    free (definition_str);
-                    definition_str = NULL;
-                }
-                else
-                    s_send_definition_to_zyre_peer (agent, peerUUID, "", false);
-                // and so is our mapping
-                if (zyre_peer->protocol && streq (zyre_peer->protocol, "v2"))
-                    mapping_str = parser_export_mapping_legacy (agent->mapping);
-                else
-                    mapping_str = parser_export_mapping (agent->mapping);
-                if (mapping_str) {
-                    s_send_mapping_to_zyre_peer (agent, peerUUID, mapping_str);
-                    free (mapping_str);
-                    mapping_str = NULL;
-                }
-                else
-                    s_send_mapping_to_zyre_peer (agent, peerUUID, "");
+                    s_send_definition_and_mapping_to_zyre_peer (agent, zyre_peer);
                 // and so is the state of our internal variables
                 s_send_state_to (agent, peerUUID, true);
             }
@@ -933,8 +2251,10 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
                 if (remote) {
                     igs_debug ("<-%s (%s) exited", remote->definition->name,
                                uuid);
+                    model_read_write_lock (__FUNCTION__, __LINE__);
                     split_remove_worker (context, uuid, NULL);
-                    HASH_DEL (context->remote_agents, remote);
+                    model_read_write_unlock (__FUNCTION__, __LINE__);
+                    s_remove_remote_agent (context, remote);
                     s_agent_propagate_agent_event (
                       IGS_AGENT_EXITED, uuid, remote->definition->name, NULL);
                     s_clean_and_free_remote_agent (&remote);
@@ -978,13 +2298,16 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
                 {
                     // iterate on all remote agents *for this peer* : all its agents know
                     // this agent
-                    igs_remote_agent_t *r, *rtmp;
-                    HASH_ITER (hh, core_context->remote_agents, r, rtmp)
-                    {
-                        if (streq (r->peer->peer_id, peerUUID))
+                    igs_zyre_peer_t *zyre_peer = NULL;
+                    HASH_FIND_STR (context->zyre_peers, peerUUID, zyre_peer);
+                    if (zyre_peer) {
+                        igs_remote_agent_t *r = zlist_first (zyre_peer->remote_agents);
+                        while (r) {
                             cb->callback_ptr (agent, IGS_AGENT_KNOWS_US,
                                               r->uuid, r->definition->name,
                                               NULL, cb->my_data);
+                            r = zlist_next (zyre_peer->remote_agents);
+                        }
                     }
                 }
             } // else agent has disappeared on our side (disabled or destroyed)
@@ -1027,11 +2350,13 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
                 return 0;
             }
 
-            // Load definition from string content
+            // Load definition from string content, shared with the other
+            // remote agents having the same definition
             igs_definition_t *new_definition =
-              parser_load_definition (str_definition);
+              definition_intern (context, str_definition);
             if (new_definition && new_definition->name) {
                 bool is_agent_new = false;
+                bool was_summary = false;
                 igs_remote_agent_t *remote_agent = NULL;
                 HASH_FIND_STR (context->remote_agents, uuid, remote_agent);
                 if (remote_agent == NULL) {
@@ -1044,7 +2369,7 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
                     assert (zyre_peer);
                     remote_agent->peer = zyre_peer;
                     remote_agent->definition = new_definition;
-                    HASH_ADD_STR (context->remote_agents, uuid, remote_agent);
+                    s_add_remote_agent (context, remote_agent);
                     igs_debug ("registering agent %s(%s)", uuid,
                                remote_agent_name);
                     is_agent_new = true;
@@ -1064,9 +2389,18 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
 
                     igs_definition_t *old_def = remote_agent->definition;
                     remote_agent->definition = new_definition;
-                    definition_free_definition (&old_def);
+                    definition_release (context, &old_def);
+                    s_reindex_remote_agent (context, remote_agent);
+                    was_summary = remote_agent->definition_is_summary;
+                    remote_agent->definition_is_summary = false;
+                    remote_agent->definition_requested = false;
                 }
                 assert (remote_agent);
+                if (new_definition->refcount > 0)
+                    snprintf (remote_agent->definition_digest, IGS_DEFINITION_DIGEST_LENGTH,
+                              "%s", new_definition->content_digest);
+                else
+                    definition_digest (str_definition, remote_agent->definition_digest);
 
                 igs_debug ("store definition for remote agent %s(%s)",
                            remote_agent->definition->name, remote_agent->uuid);
@@ -1102,43 +2436,16 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
 
                     // Send ready message for splitter creation if a split exist with
                     // the new remote agent.
-                    igsagent_t *elt_agent, *tmp_agent;
-                    HASH_ITER (hh, context->agents, elt_agent, tmp_agent)
-                    {
-                        bool found_split_element = false;
-                        char *input_split_element;
-                        char *output_split_element;
-                        igs_split_t *elt, *tmp_split;
-                        HASH_ITER (hh, elt_agent->mapping->split_elements,
-                                   elt, tmp_split)
-                        {
-                            if (elt
-                                && streq (elt->to_agent,
-                                          remote_agent->definition->name)) {
-                                found_split_element = true;
-                                input_split_element = elt->from_input;
-                                output_split_element = elt->to_output;
-                                break;
-                            }
-                        }
-                        if (found_split_element) {
-                            zmsg_t *ready_message = zmsg_new ();
-                            zmsg_addstr (ready_message, WORKER_HELLO_MSG);
-                            zmsg_addstr (ready_message, elt_agent->uuid);
-                            zmsg_addstr (ready_message, input_split_element);
-                            zmsg_addstr (ready_message,
-                                         output_split_element);
-                            zmsg_addstrf (ready_message, "%i",
-                                          IGS_DEFAULT_WORKER_CREDIT);
-                            igs_channel_whisper_zmsg (remote_agent->uuid,
-                                                      &ready_message);
-                        }
-                    }
+                    s_send_worker_hellos (context, remote_agent);
                 }
-                else
+                else {
+                    // summarized remote agents are complete only now
+                    if (was_summary)
+                        s_send_worker_hellos (context, remote_agent);
                     s_agent_propagate_agent_event (IGS_AGENT_UPDATED_DEFINITION,
                                                    uuid, remote_agent_name,
                                                    NULL);
+                }
             }
             else {
                 if (new_definition && !new_definition->name)
@@ -1157,6 +2464,25 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
             free (remote_agent_name);
         }
         else
+        if (streq (title, DEFINITION_DELTA_MSG))
+            s_network_message_definition_delta (msg_duplicate, context, peerUUID);
+        else
+        if (streq (title, MAPPING_DELTA_MSG))
+            s_network_message_mapping_delta (msg_duplicate, context, peerUUID);
+        else
+        if (streq (title, DELTA_SYNC_REQUEST_MSG))
+            s_network_message_delta_sync_request (msg_duplicate, context, peerUUID);
+        else
+        if (streq (title, DEFINITION_SUMMARY_MSG) || streq (title, DEFINITION_REQUEST_MSG)) {
+            igs_zyre_peer_t *zyre_peer = NULL;
+            HASH_FIND_STR (context->zyre_peers, peerUUID, zyre_peer);
+            assert (zyre_peer);
+            if (streq (title, DEFINITION_SUMMARY_MSG))
+                s_network_message_definition_summary (msg_duplicate, context, zyre_peer);
+            else
+                s_network_message_definition_request (msg_duplicate, context, zyre_peer);
+        }
+        else
         if (streq (title, EXTERNAL_MAPPING_MSG)) {
             // identify remote agent
             char *str_mapping = zmsg_popstr (msg_duplicate);
@@ -1333,7 +2659,7 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
                     s_network_configure_mapping_to_remote_agent (agent,
                                                                   remote);
                 }
-                agent->network_need_to_send_mapping_update = true;
+                network_request_mapping_update (agent);
             }
             free (str_mapping);
             free (uuid);
@@ -1468,6 +2794,7 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
                            remote_agent->definition->name, remote_agent->uuid);
                 s_handle_publication_from_remote_agent (msg_duplicate,
                                                       remote_agent);
+                s_drain_inbound_queues (context);
                 zmsg_destroy (&msg_duplicate);
                 free (uuid);
             }
@@ -2556,6 +3883,7 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
             }
             else
             if (streq (title, CALL_SERVICE_MSG)
+                || streq (title, CALL_SERVICE_PACKED_MSG)
                 || streq (title, CALL_SERVICE_MSG_DEPRECATED)) {
 
                 // identify agent
@@ -2624,25 +3952,33 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
                                    service_name, service);
                     if (service != NULL) {
                         if (service->cb) {
-                            s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                            zyre_shouts (context->node,
-                                         callee_agent->igs_channel,
-                                         "CALLED %s from %s (%s)", service_name,
-                                         caller_name, caller_uuid);
-                            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+                            network_telemetry_add (context, callee_agent->igs_channel,
+                                                   zmsg_content_size (msg_duplicate),
+                                                   "CALLED %s from %s (%s)", service_name,
+                                                   caller_name, caller_uuid);
                             size_t nb_args = 0;
                             igs_service_arg_t *_arg = NULL;
-                            LL_COUNT (service->arguments, _arg, nb_args);
-                            if (service_add_values_to_arguments_from_message (service_name,
-                                                                              service->arguments,
-                                                                              msg_duplicate) == IGS_SUCCESS) {
-                                if (core_context->enable_service_logging)
-                                    service_log_received_service (callee_agent, caller_name, caller_uuid, service_name, service->arguments);
-                                (service->cb) (callee_agent, caller_name,
-                                               caller_uuid, service_name,
-                                               service->arguments, nb_args,
-                                               token, service->cb_data);
-                                service_free_values_in_arguments (service->arguments);
+                            if (streq (title, CALL_SERVICE_PACKED_MSG)) {
+                                // arguments are read in place from the received frame
+                                zframe_t *packed = zmsg_pop (msg_duplicate);
+                                if (packed
+                                    && service_view_packed_arguments (service, packed, &_arg,
+                                                                      &nb_args) == IGS_SUCCESS)
+                                    service_execute_received_call (context, callee_agent, service,
+                                                                   caller_name, caller_uuid, token,
+                                                                   _arg, nb_args);
+                                zframe_destroy (&packed);
+                            }
+                            else {
+                                LL_COUNT (service->arguments, _arg, nb_args);
+                                if (service_add_values_to_arguments_from_message (service_name,
+                                                                                  service->arguments,
+                                                                                  msg_duplicate) == IGS_SUCCESS) {
+                                    service_execute_received_call (context, callee_agent, service,
+                                                                   caller_name, caller_uuid, token,
+                                                                   service->arguments, nb_args);
+                                    service_free_values_in_arguments (service->arguments);
+                                }
                             }
                         }
                         else
@@ -2736,7 +4072,19 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
                 split_message_from_worker (title, msg_duplicate, context);
             else
             if (streq (title, SPLITTER_WORK_MSG))
-                split_message_from_splitter (msg_duplicate, context);
+                split_message_from_splitter (msg_duplicate, context, false);
+            else
+            if (streq (title, SPLITTER_WORKS_MSG))
+                split_message_from_splitter (msg_duplicate, context, true);
+            else
+            if (streq (title, SERVICE_REPLY_MSG))
+                service_message_from_callee (msg_duplicate, context, false);
+            else
+            if (streq (title, SERVICE_REJECTED_MSG))
+                service_message_from_callee (msg_duplicate, context, true);
+            else
+            if (streq (title, CALL_SERVICE_BULK_MSG))
+                service_message_bulk (msg_duplicate, context, name);
         }
         free (title);
     }
@@ -2882,152 +4230,267 @@ int s_manage_zyre_incoming (zloop_t *loop, zsock_t *socket, void *arg)
                 // the agent is reconnected
                 zyre_peer->reconnected--;
             }
-            else {
-                igs_remote_agent_t *remote, *tmpremote;
-                HASH_ITER (hh, context->remote_agents, remote, tmpremote)
-                {
-                    // destroy all remote agents attached to this peer
-                    if (streq (remote->peer->peer_id, zyre_peer->peer_id)) {
-                        HASH_DEL (context->remote_agents, remote);
-                        split_remove_worker (context, remote->uuid, NULL);
-                        s_agent_propagate_agent_event (IGS_AGENT_EXITED, remote->uuid,
-                                                       remote->definition->name, NULL);
-                        s_clean_and_free_remote_agent (&remote);
-                    }
-                }
-                HASH_DEL (context->zyre_peers, zyre_peer);
-                s_agent_propagate_agent_event (IGS_PEER_EXITED, peerUUID, name, NULL);
-                s_clean_and_free_zyre_peer (&zyre_peer, loop);
+            else {
+                // destroy all remote agents attached to this peer
+                igs_remote_agent_t *remote = zlist_first (zyre_peer->remote_agents);
+                while (remote) {
+                    s_remove_remote_agent (context, remote);
+                    model_read_write_lock (__FUNCTION__, __LINE__);
+                    split_remove_worker (context, remote->uuid, NULL);
+                    model_read_write_unlock (__FUNCTION__, __LINE__);
+                    s_agent_propagate_agent_event (IGS_AGENT_EXITED, remote->uuid,
+                                                   remote->definition->name, NULL);
+                    s_clean_and_free_remote_agent (&remote);
+                    remote = zlist_first (zyre_peer->remote_agents);
+                }
+                s_remove_zyre_peer (context, zyre_peer);
+                s_agent_propagate_agent_event (IGS_PEER_EXITED, peerUUID, name, NULL);
+                s_clean_and_free_zyre_peer (&zyre_peer, loop);
+            }
+        }
+    }
+
+    // handle callbacks
+    // NB: as explained earlier, agent may be NULL
+    // depending on the event type.
+    igs_channels_wrapper_t *elt;
+    DL_FOREACH (context->zyre_callbacks, elt){
+        if (zyre_event){
+            zmsg_t *dup = zmsg_dup (msg);
+            elt->callback_ptr (event, peerUUID, name, address, group, headers,
+                               dup, elt->my_data);
+            zmsg_destroy (&dup);
+        }else{
+            igs_error ("previous callback certainly destroyed the zyre event : next "
+                       "callbacks will not be executed");
+            break;
+        }
+    }
+    zmsg_destroy (&msg_duplicate);
+    zyre_event_destroy (&zyre_event);
+    return 0;
+}
+
+/*
+ Updates mutex protects the queue of agents with definition or mapping
+ updates to propagate, filled by any thread, and the updates socket used to
+ wake up the ingescape loop when this queue is not empty. The actor pipe is
+ not used for this because it belongs to the thread calling igs_start and
+ igs_stop, and to the application reading igs_pipe_to_ingescape.
+ */
+igs_mutex_t s_updates_mutex;
+static bool s_updates_mutex_initialized = false;
+
+void s_updates_lock (void)
+{
+    if (!s_updates_mutex_initialized) {
+        IGS_MUTEX_INIT (s_updates_mutex);
+        s_updates_mutex_initialized = true;
+    }
+    IGS_MUTEX_LOCK (s_updates_mutex);
+}
+
+void s_updates_unlock (void)
+{
+    assert (s_updates_mutex_initialized);
+    IGS_MUTEX_UNLOCK (s_updates_mutex);
+}
+
+// updates lock shall be held when calling this function
+void s_signal_updates (igs_core_context_t *context)
+{
+    assert (context);
+    if (!context->network_updates_signaled
+        && context->network_updates_sender
+        && context->network_dirty_agents
+        && zlist_size (context->network_dirty_agents) > 0) {
+        context->network_updates_signaled = true;
+        zstr_send (context->network_updates_sender, "PROPAGATE_UPDATES");
+    }
+}
+
+void s_request_update (igsagent_t *agent)
+{
+    assert (agent);
+    assert (agent->uuid);
+    core_init_context ();
+    s_updates_lock ();
+    if (!core_context->network_dirty_agents) {
+        core_context->network_dirty_agents = zlist_new ();
+        zlist_autofree (core_context->network_dirty_agents);
+        zlist_comparefn (core_context->network_dirty_agents, (zlist_compare_fn *) strcmp);
+    }
+    if (!zlist_exists (core_context->network_dirty_agents, agent->uuid))
+        zlist_append (core_context->network_dirty_agents, agent->uuid);
+    s_signal_updates (core_context);
+    s_updates_unlock ();
+}
+
+// asks the ingescape loop to arm the timers needed by new settings or calls
+void network_request_timers_update (igs_core_context_t *context)
+{
+    assert (context);
+    s_updates_lock ();
+    if (context->network_updates_sender)
+        zstr_send (context->network_updates_sender, "ARM_TIMERS");
+    s_updates_unlock ();
+}
+
+void network_request_definition_update (igsagent_t *agent)
+{
+    assert (agent);
+    agent->network_need_to_send_definition_update = true;
+    s_request_update (agent);
+}
+
+void network_request_mapping_update (igsagent_t *agent)
+{
+    assert (agent);
+    agent->network_need_to_send_mapping_update = true;
+    s_request_update (agent);
+}
+
+// (Re)send the definition of one of our agents to agents present on the
+// private channel
+void s_propagate_definition_update (igs_core_context_t *context, const char *uuid)
+{
+    assert (context);
+    assert (uuid);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igsagent_t *agent = NULL;
+    HASH_FIND_STR (context->agents, uuid, agent);
+    // agent may have been deactivated or destroyed since it was queued
+    if (!agent || !(agent->uuid) || !agent->network_need_to_send_definition_update) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    // definition changed : export it again, once per protocol,
+    // and send only what changed to peers supporting deltas
+    s_clear_definition_json (agent);
+    zmsg_t *ops = s_definition_delta (agent);
+    if (ops && agent->network_activation_during_runtime)
+        zmsg_destroy (&ops);
+    if (!ops || zmsg_size (ops) > 0) {
+        uint64_t base_version = agent->network_definition_version++;
+        igs_zyre_peer_t *p, *ptmp;
+        HASH_ITER (hh, context->zyre_peers, p, ptmp)
+        {
+            if (!p->has_joined_private_channel)
+                continue;
+            if (s_peer_wants_summary (p, agent)) {
+                s_send_definition_summary_to_zyre_peer (
+                  agent, p, agent->network_activation_during_runtime);
+                continue;
+            }
+            if (ops && p->supports_deltas) {
+                s_send_delta_to_zyre_peer (agent, p->peer_id, DEFINITION_DELTA_MSG,
+                                           base_version,
+                                           agent->network_definition_version, ops);
+                continue;
             }
+            const char *definition_str = s_definition_json_for_peer (agent, p);
+            if (definition_str)
+                s_send_definition_to_zyre_peer (
+                  agent, p->peer_id, definition_str,
+                  agent->network_activation_during_runtime);
+            if (p->supports_deltas)
+                s_send_delta_to_zyre_peer (agent, p->peer_id, DEFINITION_DELTA_MSG, 0,
+                                           agent->network_definition_version, NULL);
         }
     }
-
-    // handle callbacks
-    // NB: as explained earlier, agent may be NULL
-    // depending on the event type.
-    igs_channels_wrapper_t *elt;
-    DL_FOREACH (context->zyre_callbacks, elt){
-        if (zyre_event){
-            zmsg_t *dup = zmsg_dup (msg);
-            elt->callback_ptr (event, peerUUID, name, address, group, headers,
-                               dup, elt->my_data);
-            zmsg_destroy (&dup);
-        }else{
-            igs_error ("previous callback certainly destroyed the zyre event : next "
-                       "callbacks will not be executed");
-            break;
-        }
-    }
-    zmsg_destroy (&msg_duplicate);
-    zyre_event_destroy (&zyre_event);
-    return 0;
+    zmsg_destroy (&ops);
+    agent->network_activation_during_runtime = false; // reset flag if needed
+    // NB: this is not optimal to resend state details on definition change
+    // but it is the cleanest way to send state on after-start agent
+    // activation. State details are still sent individually when they change.
+    s_send_state_to (agent, IGS_PRIVATE_CHANNEL, false);
+    agent->network_need_to_send_definition_update = false;
+    // when definition changes, mapping may need to be updated as well,
+    // which is done right after by s_propagate_updates
+    agent->network_need_to_send_mapping_update = true;
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    s_agent_propagate_agent_event (IGS_AGENT_UPDATED_DEFINITION,
+                                   agent->uuid, agent->definition->name,
+                                   NULL);
 }
 
-// Timer callback to (re)send our definition to agents present on the private
-// channel
-int trigger_definition_update (zloop_t *loop, int timer_id, void *arg)
+
+// Update and (re)send the mapping of one of our agents to agents on the
+// private channel
+void s_propagate_mapping_update (igs_core_context_t *context, const char *uuid)
 {
-    IGS_UNUSED (loop)
-    IGS_UNUSED (timer_id)
-    igs_core_context_t *context = (igs_core_context_t *) arg;
     assert (context);
-    
+    assert (uuid);
     model_read_write_lock (__FUNCTION__, __LINE__);
-    igsagent_t *agent, *tmp;
-    HASH_ITER (hh, context->agents, agent, tmp){
-        if (agent->network_need_to_send_definition_update) {
-            // check that this agent has not been destroyed when we were locked
-            if (!agent || !(agent->uuid)) {
+    igsagent_t *agent = NULL;
+    HASH_FIND_STR (context->agents, uuid, agent);
+    // agent may have been deactivated or destroyed since it was queued
+    if (!agent || !(agent->uuid) || !agent->network_need_to_send_mapping_update) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    // mapping changed : export it again, once per protocol,
+    // and send only what changed to peers supporting deltas
+    s_clear_mapping_json (agent);
+    zmsg_t *ops = s_mapping_delta (agent);
+    if (!ops || zmsg_size (ops) > 0) {
+        uint64_t base_version = agent->network_mapping_version++;
+        igs_zyre_peer_t *p, *ptmp;
+        HASH_ITER (hh, context->zyre_peers, p, ptmp)
+        {
+            // peers using lazy definitions get our mapping with our definition
+            if (!p->has_joined_private_channel || s_peer_wants_summary (p, agent))
+                continue;
+            if (ops && p->supports_deltas) {
+                s_send_delta_to_zyre_peer (agent, p->peer_id, MAPPING_DELTA_MSG,
+                                           base_version,
+                                           agent->network_mapping_version, ops);
                 continue;
             }
-            char *definition_str = NULL;
-            igs_zyre_peer_t *p, *ptmp;
-            HASH_ITER (hh, context->zyre_peers, p, ptmp)
-            {
-                if (p->has_joined_private_channel) {
-                    if (p->protocol
-                        && (streq (p->protocol, "v2")
-                            || streq (p->protocol, "v3")))
-                        definition_str = parser_export_definition_legacy (agent->definition);
-                    else
-                        definition_str =
-                          parser_export_definition (agent->definition);
-                    if (definition_str) {
-                        s_send_definition_to_zyre_peer (
-                          agent, p->peer_id, definition_str,
-                          agent->network_activation_during_runtime);
-                        free (definition_str);
-                        definition_str = NULL;
-                    }
-                }
-            }
-            agent->network_activation_during_runtime = false; // reset flag if needed
-            free (definition_str);
-            // NB: this is not optimal to resend state details on definition change
-            // but it is the cleanest way to send state on after-start agent
-            // activation. State details are still sent individually when they change.
-            s_send_state_to (agent, IGS_PRIVATE_CHANNEL, false);
-            agent->network_need_to_send_definition_update = false;
-            model_read_write_unlock (__FUNCTION__, __LINE__);
-            s_agent_propagate_agent_event (IGS_AGENT_UPDATED_DEFINITION,
-                                           agent->uuid, agent->definition->name,
-                                           NULL);
-            model_read_write_lock (__FUNCTION__, __LINE__);
-            // when definition changes, mapping may need to be updated as well
-            agent->network_need_to_send_mapping_update = true;
+            const char *mapping_str = s_mapping_json_for_peer (agent, p);
+            if (mapping_str)
+                s_send_mapping_to_zyre_peer (agent, p->peer_id, mapping_str);
+            if (p->supports_deltas)
+                s_send_delta_to_zyre_peer (agent, p->peer_id, MAPPING_DELTA_MSG, 0,
+                                           agent->network_mapping_version, NULL);
         }
     }
+    zmsg_destroy (&ops);
+    igs_remote_agent_t *remote, *rtmp;
+    HASH_ITER (hh, context->remote_agents, remote, rtmp)
+    {
+        s_network_configure_mapping_to_remote_agent (agent, remote);
+    }
+    agent->network_need_to_send_mapping_update = false;
     model_read_write_unlock (__FUNCTION__, __LINE__);
-    return 0;
+    s_agent_propagate_agent_event (IGS_AGENT_UPDATED_MAPPING,
+                                   agent->uuid, agent->definition->name,
+                                   NULL);
 }
 
-// Timer callback to update and (re)send our mapping to agents on the private
-// channel
-int s_trigger_mapping_update (zloop_t *loop, int timer_id, void *arg)
+// Propagates the updates queued by network_request_definition_update and
+// network_request_mapping_update, once the debounce delay has elapsed
+int s_propagate_updates (zloop_t *loop, int timer_id, void *arg)
 {
     IGS_UNUSED (loop)
     IGS_UNUSED (timer_id)
     igs_core_context_t *context = (igs_core_context_t *) arg;
     assert (context);
-
-    igsagent_t *agent, *tmp;
-    HASH_ITER (hh, context->agents, agent, tmp){
-        if (agent->network_need_to_send_mapping_update) {
-            model_read_write_lock (__FUNCTION__, __LINE__);
-            // check that this agent has not been destroyed when we were locked
-            if (!agent || !(agent->uuid)) {
-                model_read_write_unlock (__FUNCTION__, __LINE__);
-                return 0;
-            }
-            char *mapping_str = NULL;
-            igs_zyre_peer_t *p, *ptmp;
-            HASH_ITER (hh, context->zyre_peers, p, ptmp)
-            {
-                if (p->has_joined_private_channel) {
-                    if (p->protocol && streq (p->protocol, "v2"))
-                        mapping_str = parser_export_mapping_legacy (agent->mapping);
-                    else
-                        mapping_str = parser_export_mapping (agent->mapping);
-                    if (mapping_str) {
-                        s_send_mapping_to_zyre_peer (agent, p->peer_id,
-                                                     mapping_str);
-                        free (mapping_str);
-                        mapping_str = NULL;
-                    }
-                }
-            }
-            igs_remote_agent_t *remote, *rtmp;
-            HASH_ITER (hh, context->remote_agents, remote, rtmp)
-            {
-                s_network_configure_mapping_to_remote_agent (agent, remote);
-            }
-            agent->network_need_to_send_mapping_update = false;
-            model_read_write_unlock (__FUNCTION__, __LINE__);
-            s_agent_propagate_agent_event (IGS_AGENT_UPDATED_MAPPING,
-                                           agent->uuid, agent->definition->name,
-                                           NULL);
-        }
+    context->network_updates_timer_armed = false;
+    s_updates_lock ();
+    zlist_t *dirty_agents = context->network_dirty_agents;
+    context->network_dirty_agents = NULL;
+    context->network_updates_signaled = false;
+    s_updates_unlock ();
+    if (!dirty_agents)
+        return 0;
+    const char *uuid = zlist_first (dirty_agents);
+    while (uuid) {
+        s_propagate_definition_update (context, uuid);
+        s_propagate_mapping_update (context, uuid);
+        uuid = zlist_next (dirty_agents);
     }
+    zlist_destroy (&dirty_agents);
     return 0;
 }
 
@@ -3054,11 +4517,111 @@ void s_network_unlock (void)
     IGS_MUTEX_UNLOCK (s_network_mutex);
 }
 
+/*
+ Telemetry mutex protects the edges aggregated between two reports, which
+ are added by any thread calling services or dispatching split works.
+ */
+igs_mutex_t s_telemetry_mutex;
+static bool s_telemetry_mutex_initialized = false;
+
+void s_telemetry_lock (void)
+{
+    if (!s_telemetry_mutex_initialized) {
+        IGS_MUTEX_INIT (s_telemetry_mutex);
+        s_telemetry_mutex_initialized = true;
+    }
+    IGS_MUTEX_LOCK (s_telemetry_mutex);
+}
+
+void s_telemetry_unlock (void)
+{
+    assert (s_telemetry_mutex_initialized);
+    IGS_MUTEX_UNLOCK (s_telemetry_mutex);
+}
+
+void s_telemetry_free_edge (igs_telemetry_edge_t **edge)
+{
+    assert (edge);
+    assert (*edge);
+    free ((*edge)->label);
+    free ((*edge)->channel);
+    free (*edge);
+    *edge = NULL;
+}
+
+void s_telemetry_clear (igs_core_context_t *context)
+{
+    assert (context);
+    s_telemetry_lock ();
+    igs_telemetry_edge_t *edge, *tmp;
+    HASH_ITER (hh, context->network_telemetry_edges, edge, tmp){
+        HASH_DEL (context->network_telemetry_edges, edge);
+        s_telemetry_free_edge (&edge);
+    }
+    s_telemetry_unlock ();
+}
+
+// report aggregated calls on agent channels at the telemetry period
+int s_report_telemetry (zloop_t *loop, int timer_id, void *arg)
+{
+    IGS_UNUSED (loop)
+    IGS_UNUSED (timer_id)
+    igs_core_context_t *context = (igs_core_context_t *) arg;
+    assert (context);
+    int64_t now = zclock_mono ();
+    int64_t elapsed = now - context->network_telemetry_last_report;
+    if (elapsed <= 0)
+        return 0;
+    context->network_telemetry_last_report = now;
+    s_telemetry_lock ();
+    igs_telemetry_edge_t *edge, *tmp;
+    HASH_ITER (hh, context->network_telemetry_edges, edge, tmp){
+        if (edge->calls == 0) {
+            // edge unused since last report
+            HASH_DEL (context->network_telemetry_edges, edge);
+            s_telemetry_free_edge (&edge);
+            continue;
+        }
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        zyre_shouts (context->node, edge->channel, "%s (%zu calls, %.1f calls/s, %.1f bytes/s)",
+                     edge->label, edge->calls,
+                     (double) edge->calls * 1000.0 / (double) elapsed,
+                     (double) edge->bytes * 1000.0 / (double) elapsed);
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        edge->calls = 0;
+        edge->bytes = 0;
+    }
+    s_telemetry_unlock ();
+    return 0;
+}
+
+// Arms the telemetry report timer at the telemetry period, or ends it
+// when aggregation is disabled. Shall be called from the ingescape loop.
+void s_arm_telemetry_timer (igs_core_context_t *context)
+{
+    assert (context);
+    assert (context->loop);
+    unsigned int period = context->network_telemetry_period;
+    if (period == context->network_telemetry_timer_period)
+        return;
+    if (context->network_telemetry_timer_period > 0) {
+        // report calls aggregated with the previous period
+        s_report_telemetry (context->loop, context->network_telemetry_timer_id, context);
+        zloop_timer_end (context->loop, context->network_telemetry_timer_id);
+    }
+    context->network_telemetry_timer_period = period;
+    if (period > 0) {
+        context->network_telemetry_last_report = zclock_mono ();
+        context->network_telemetry_timer_id = zloop_timer (context->loop, period, 0,
+                                                           s_report_telemetry, context);
+    }
+}
+
 // manage messages from the parent thread
 int s_manage_parent (zloop_t *loop, zsock_t *pipe, void *arg)
 {
-    IGS_UNUSED (loop)
-    IGS_UNUSED (arg)
+    igs_core_context_t *context = (igs_core_context_t *) arg;
+    assert (context);
 
     zmsg_t *msg = zmsg_recv (pipe);
     assert (msg);
@@ -3079,6 +4642,78 @@ int s_manage_parent (zloop_t *loop, zsock_t *pipe, void *arg)
     return 0;
 }
 
+// manage requests sent by any thread through the updates socket
+int s_manage_updates (zloop_t *loop, zsock_t *receiver, void *arg)
+{
+    igs_core_context_t *context = (igs_core_context_t *) arg;
+    assert (context);
+    char *command = zstr_recv (receiver);
+    if (command == NULL)
+        return 0;
+    if (streq (command, "PROPAGATE_UPDATES")) {
+        // mapping updates may have added time windows to our reducers
+        s_arm_reducers_timer (context);
+        // changes occurring during the debounce delay are coalesced
+        if (context->network_update_debounce == 0)
+            s_propagate_updates (loop, 0, context);
+        else
+        if (!context->network_updates_timer_armed) {
+            zloop_timer (loop, context->network_update_debounce, 1,
+                         s_propagate_updates, context);
+            context->network_updates_timer_armed = true;
+        }
+    } else if (streq (command, "ARM_TIMERS")) {
+        s_arm_split_timeouts_timer (context);
+        s_arm_service_deadlines_timer (context);
+        s_arm_telemetry_timer (context);
+    }
+    free (command);
+    return 0;
+}
+
+// manage definitions loaded from the persistent cache for summarized remote agents
+int s_manage_definitions_cache (zloop_t *loop, zsock_t *cache, void *arg)
+{
+    IGS_UNUSED (loop)
+    igs_core_context_t *context = (igs_core_context_t *) arg;
+    assert (context);
+    char *command = NULL, *uuid = NULL, *digest = NULL, *content = NULL;
+    if (zstr_recvx (cache, &command, &uuid, &digest, &content, NULL) < 0)
+        return 0;
+    igs_remote_agent_t *remote_agent = NULL;
+    if (command && streq (command, "LOADED") && uuid && digest && content)
+        HASH_FIND_STR (context->remote_agents, uuid, remote_agent);
+    // the agent may have left or changed its definition in the meantime
+    if (remote_agent && remote_agent->definition_is_summary
+        && streq (remote_agent->definition_digest, digest)) {
+        igs_definition_t *definition = (strlen (content) > 0)
+                                         ? definition_intern (context, content) : NULL;
+        if (definition && definition->name) {
+            igs_debug ("definition of remote agent %s(%s) found in cache",
+                       remote_agent->definition->name, uuid);
+            char *remote_agent_name = strdup (definition->name);
+            s_set_known_remote_definition (context, remote_agent, definition);
+            s_agent_propagate_agent_event (IGS_AGENT_UPDATED_DEFINITION, uuid,
+                                           remote_agent_name, NULL);
+            free (remote_agent_name);
+        }
+        else {
+            if (definition)
+                definition_release (context, &definition);
+            // not in cache : fetch it if needed
+            remote_agent->definition_requested = false;
+        }
+        igsagent_t *agent, *tmp;
+        HASH_ITER (hh, context->agents, agent, tmp)
+            s_network_configure_mapping_to_remote_agent (agent, remote_agent);
+    }
+    free (command);
+    free (uuid);
+    free (digest);
+    free (content);
+    return 0;
+}
+
 static void s_run_loop (zsock_t *mypipe, void *args)
 {
     s_network_lock ();
@@ -3118,6 +4753,12 @@ static void s_run_loop (zsock_t *mypipe, void *args)
         agent->network_need_to_send_definition_update = false;
         agent->network_activation_during_runtime = false;
     }
+    s_updates_lock ();
+    if (context->network_dirty_agents)
+        zlist_purge (context->network_dirty_agents);
+    context->network_updates_signaled = false;
+    context->network_updates_timer_armed = false;
+    s_updates_unlock ();
 
     // start zyre now that everything is set
     s_lock_zyre_peer (__FUNCTION__, __LINE__);
@@ -3134,18 +4775,33 @@ static void s_run_loop (zsock_t *mypipe, void *args)
     zloop_set_verbose (context->loop, false);
     zloop_reader (context->loop, mypipe, s_manage_parent, context);
     zloop_reader_set_tolerant (context->loop, mypipe);
+    assert (context->network_updates_receiver);
+    zloop_reader (context->loop, context->network_updates_receiver,
+                  s_manage_updates, context);
+    if (context->network_definitions_cache)
+        zloop_reader (context->loop, zactor_sock (context->network_definitions_cache),
+                      s_manage_definitions_cache, context);
     zloop_reader (context->loop, zyre_socket (context->node),
                   s_manage_zyre_incoming, context);
     zloop_reader_set_tolerant (context->loop, zyre_socket (context->node));
-    zloop_timer (context->loop, 1000, 0, trigger_definition_update, context);
-    zloop_timer (context->loop, 1000, 0, s_trigger_mapping_update, context);
+    context->split_timeouts_timer_armed = false;
+    s_arm_split_timeouts_timer (context);
+    context->service_deadlines_timer_armed = false;
+    s_arm_service_deadlines_timer (context);
+    context->network_telemetry_timer_period = 0;
+    s_arm_telemetry_timer (context);
+    context->network_reducers_timer_armed = false;
+    s_arm_reducers_timer (context);
 
     zsock_signal (mypipe, 0);
     s_network_unlock ();
 
     /////////////////////
     igs_debug ("loop starting");
+    context->loop_thread = IGS_THREAD_SELF ();
+    context->loop_is_running = true;
     zloop_start (context->loop); // returns when one of the pollers returns -1
+    context->loop_is_running = false;
     /////////////////////
 
     s_network_lock ();
@@ -3154,17 +4810,19 @@ static void s_run_loop (zsock_t *mypipe, void *args)
     igs_remote_agent_t *remote, *tmpremote;
     HASH_ITER (hh, context->remote_agents, remote, tmpremote)
     {
-        HASH_DEL (context->remote_agents, remote);
+        s_remove_remote_agent (context, remote);
         s_clean_and_free_remote_agent (&remote);
     }
 
     igs_zyre_peer_t *zyre_peer, *tmp_peer;
     HASH_ITER (hh, context->zyre_peers, zyre_peer, tmp_peer)
     {
-        HASH_DEL (context->zyre_peers, zyre_peer);
+        s_remove_zyre_peer (context, zyre_peer);
         s_clean_and_free_zyre_peer (&zyre_peer, context->loop);
     }
+    service_stop_workers (context);
     zloop_destroy (&context->loop);
+    s_telemetry_clear (context);
 
     igs_timer_t *current_timer, *tmp_timer;
     HASH_ITER (hh, context->timers, current_timer, tmp_timer)
@@ -3346,6 +5004,11 @@ void s_init_loop (igs_core_context_t *context)
       context->node, "ingescape", "v%d.%d.%d", (int) igs_version () / 10000,
       (int) (igs_version () % 10000) / 100, (int) (igs_version () % 100));
     zyre_set_header (context->node, "protocol", "v%d", igs_protocol ());
+    zyre_set_header (context->node, SERVICE_PACKING_HEADER, "1");
+    zyre_set_header (context->node, SERVICE_BULK_HEADER, "1");
+    zyre_set_header (context->node, DELTAS_HEADER, "1");
+    if (context->network_lazy_definitions)
+        zyre_set_header (context->node, LAZY_DEFINITIONS_HEADER, "1");
     s_unlock_zyre_peer (__FUNCTION__, __LINE__);
 
     // Add stored headers to zyre
@@ -3561,14 +5224,113 @@ void s_init_loop (igs_core_context_t *context)
     s_unlock_zyre_peer (__FUNCTION__, __LINE__);
     s_network_unlock ();
 
-    if (can_continue)
+    if (can_continue) {
+        char updates_endpoint[IGS_IP_ADDRESS_LENGTH] = "";
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        snprintf (updates_endpoint, IGS_IP_ADDRESS_LENGTH, "inproc://%s-updates",
+                  zyre_uuid (context->node));
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        s_updates_lock ();
+        context->network_updates_receiver = zsock_new_pull (updates_endpoint);
+        assert (context->network_updates_receiver);
+        context->network_updates_sender = zsock_new_push (updates_endpoint);
+        assert (context->network_updates_sender);
+        // never block the requesting thread if the loop has stopped reading
+        zsock_set_sndtimeo (context->network_updates_sender, 0);
+        s_updates_unlock ();
+        definition_cache_start (context);
         context->network_actor = zactor_new (s_run_loop, context);
+        // wake up the loop for changes made while it was starting
+        s_updates_lock ();
+        s_signal_updates (context);
+        s_updates_unlock ();
+    }
 }
 
 ////////////////////////////////////////////////////////////////////////
 // PRIVATE API
 ////////////////////////////////////////////////////////////////////////
 
+zlist_t *network_find_remote_agents (igs_core_context_t *context, const char *name_or_uuid)
+{
+    assert (context);
+    assert (name_or_uuid);
+    zlist_t *res = zlist_new ();
+    igs_remote_agent_t *remote_agent = NULL;
+    HASH_FIND_STR (context->remote_agents, name_or_uuid, remote_agent);
+    if (remote_agent)
+        zlist_append (res, remote_agent);
+    igs_name_index_t *entry = NULL;
+    HASH_FIND_STR (context->remote_agents_by_name, name_or_uuid, entry);
+    if (entry) {
+        igs_remote_agent_t *item = zlist_first (entry->items);
+        while (item) {
+            if (item != remote_agent)
+                zlist_append (res, item);
+            item = zlist_next (entry->items);
+        }
+    }
+    return res;
+}
+
+zlist_t *network_find_zyre_peers (igs_core_context_t *context, const char *name_or_peer_id)
+{
+    assert (context);
+    assert (name_or_peer_id);
+    zlist_t *res = zlist_new ();
+    igs_zyre_peer_t *zyre_peer = NULL;
+    HASH_FIND_STR (context->zyre_peers, name_or_peer_id, zyre_peer);
+    if (zyre_peer)
+        zlist_append (res, zyre_peer);
+    igs_name_index_t *entry = NULL;
+    HASH_FIND_STR (context->zyre_peers_by_name, name_or_peer_id, entry);
+    if (entry) {
+        igs_zyre_peer_t *item = zlist_first (entry->items);
+        while (item) {
+            if (item != zyre_peer)
+                zlist_append (res, item);
+            item = zlist_next (entry->items);
+        }
+    }
+    return res;
+}
+
+// Notifies a call on an agent channel, immediately or aggregated with the
+// other calls having the same notification until next telemetry report.
+void network_telemetry_add (igs_core_context_t *context, const char *channel,
+                            size_t bytes, const char *format, ...)
+{
+    assert (context);
+    assert (channel);
+    assert (format);
+    if (context->node == NULL)
+        return;
+    char label[IGS_MAX_STRING_MSG_LENGTH] = "";
+    va_list list;
+    va_start (list, format);
+    vsnprintf (label, IGS_MAX_STRING_MSG_LENGTH, format, list);
+    va_end (list);
+    if (context->network_telemetry_period == 0) {
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        zyre_shouts (context->node, channel, "%s", label);
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        return;
+    }
+    s_telemetry_lock ();
+    igs_telemetry_edge_t *edge = NULL;
+    HASH_FIND_STR (context->network_telemetry_edges, label, edge);
+    if (edge == NULL) {
+        edge = (igs_telemetry_edge_t *) zmalloc (sizeof (igs_telemetry_edge_t));
+        edge->label = strdup (label);
+        edge->channel = strdup (channel);
+        HASH_ADD_KEYPTR (hh, context->network_telemetry_edges, edge->label,
+                         strlen (edge->label), edge);
+    }
+    edge->calls++;
+    edge->bytes += bytes;
+    s_telemetry_unlock ();
+}
+
 igs_result_t network_publish_output (igsagent_t *agent, const igs_iop_t *iop)
 {
     assert (agent);
@@ -3582,9 +5344,10 @@ igs_result_t network_publish_output (igsagent_t *agent, const igs_iop_t *iop)
     if (!agent->is_whole_agent_muted && !iop->is_muted
         && !agent->context->is_frozen) {
         model_read_write_lock (__FUNCTION__, __LINE__);
-        split_add_work_to_queue (agent->context, agent->uuid, iop);
-        // check that this agent has not been destroyed when we were locked
-        if (!agent || !(agent->uuid)) {
+        iop = split_add_work_to_queue (agent->context, agent->uuid, iop);
+        // check that this agent and its output have not been destroyed
+        // when we were locked
+        if (!agent || !(agent->uuid) || !iop) {
             model_read_write_unlock (__FUNCTION__, __LINE__);
             return IGS_SUCCESS;
         }
@@ -3690,6 +5453,7 @@ igs_result_t network_publish_output (igsagent_t *agent, const igs_iop_t *iop)
             fake_remote->definition->name = agent->definition->name;
             model_read_write_unlock (__FUNCTION__, __LINE__); // to avoid deadlock inside s_handle_publication_from_remote_agent
             s_handle_publication_from_remote_agent (msg_quater, fake_remote);
+            s_drain_inbound_queues (core_context);
             free (fake_remote->definition);
             free (fake_remote);
         }
@@ -3970,6 +5734,12 @@ void igs_stop ()
             zstr_send (core_context->network_actor, "STOP_LOOP");
         }
         zactor_destroy (&core_context->network_actor);
+        // the loop has stopped reading requests from other threads
+        s_updates_lock ();
+        zsock_destroy (&core_context->network_updates_sender);
+        zsock_destroy (&core_context->network_updates_receiver);
+        s_updates_unlock ();
+        definition_cache_stop (core_context);
 #if defined(__WINDOWS__)
         // On Windows, if we don't call zsys_shutdown, the application will crash on
         // exit (WSASTARTUP assertion failure) NB: Monitoring also uses a zactor, we
@@ -4040,7 +5810,8 @@ void igsagent_set_name (igsagent_t *agent, const char *name)
           name, n);
     char *previous = agent->definition->name;
     agent->definition->name = n;
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
+    core_context->split_local_workers_are_dirty = true;
     
     if (agent->igs_channel)
         free (agent->igs_channel);
@@ -4854,6 +6625,170 @@ void igs_net_set_high_water_marks (int hwm_value)
     core_context->network_hwm_value = hwm_value;
 }
 
+void igs_net_set_telemetry_period (unsigned int period)
+{
+    core_init_context ();
+    core_context->network_telemetry_period = period;
+    network_request_timers_update (core_context);
+}
+
+unsigned int igs_net_telemetry_period (void)
+{
+    core_init_context ();
+    return core_context->network_telemetry_period;
+}
+
+void igs_net_set_lazy_definitions (bool enabled)
+{
+    core_init_context ();
+    if (core_context->network_actor)
+        igs_warn ("lazy definitions will be applied at next start");
+    core_context->network_lazy_definitions = enabled;
+}
+
+bool igs_net_lazy_definitions (void)
+{
+    core_init_context ();
+    return core_context->network_lazy_definitions;
+}
+
+igs_result_t igs_net_fetch_definition (const char *agent_name_or_uuid)
+{
+    core_init_context ();
+    assert (agent_name_or_uuid);
+    if (!core_context->node) {
+        igs_error ("ingescape must be started to fetch definitions");
+        return IGS_FAILURE;
+    }
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    zlist_t *remote_agents = network_find_remote_agents (core_context, agent_name_or_uuid);
+    size_t nb = zlist_size (remote_agents);
+    igs_remote_agent_t *remote_agent = zlist_first (remote_agents);
+    while (remote_agent) {
+        network_fetch_remote_definition (remote_agent);
+        remote_agent = zlist_next (remote_agents);
+    }
+    zlist_destroy (&remote_agents);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    if (nb == 0) {
+        igs_error ("no remote agent with name or uuid '%s'", agent_name_or_uuid);
+        return IGS_FAILURE;
+    }
+    return IGS_SUCCESS;
+}
+
+void igs_net_set_definitions_cache_path (const char *path)
+{
+    core_init_context ();
+    if (core_context->network_actor)
+        igs_warn ("definitions cache path will be applied at next start");
+    if (core_context->network_definitions_cache_path) {
+        free (core_context->network_definitions_cache_path);
+        core_context->network_definitions_cache_path = NULL;
+    }
+    if (path == NULL)
+        return;
+    if (!zsys_file_exists (path) && zsys_dir_create ("%s", path) != 0) {
+        igs_error ("could not create definitions cache directory %s", path);
+        return;
+    }
+    core_context->network_definitions_cache_path = s_strndup (path, IGS_MAX_PATH_LENGTH);
+}
+
+char *igs_net_definitions_cache_path (void)
+{
+    core_init_context ();
+    return (core_context->network_definitions_cache_path)
+             ? strdup (core_context->network_definitions_cache_path)
+             : NULL;
+}
+
+void igs_net_set_lean_remote_definitions (bool enabled)
+{
+    core_init_context ();
+    core_context->network_lean_remote_definitions = enabled;
+}
+
+bool igs_net_lean_remote_definitions (void)
+{
+    core_init_context ();
+    return core_context->network_lean_remote_definitions;
+}
+
+size_t igs_net_remote_definitions_footprint (size_t *nb_remote_agents)
+{
+    core_init_context ();
+    size_t footprint = 0;
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igs_remote_agent_t *remote, *tmp;
+    HASH_ITER (hh, core_context->remote_agents, remote, tmp){
+        // shared definitions are split between the agents using them
+        size_t size = definition_footprint (remote->definition);
+        footprint += (remote->definition->refcount > 1) ? size / remote->definition->refcount : size;
+    }
+    if (nb_remote_agents)
+        *nb_remote_agents = HASH_COUNT (core_context->remote_agents);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return footprint;
+}
+
+void igs_net_set_update_debounce (unsigned int debounce)
+{
+    core_init_context ();
+    core_context->network_update_debounce = debounce;
+}
+
+unsigned int igs_net_update_debounce (void)
+{
+    core_init_context ();
+    return core_context->network_update_debounce;
+}
+
+void igsagent_inbound_queue_set (igsagent_t *agent,
+                                 size_t capacity,
+                                 igs_queue_policy_t policy)
+{
+    assert (agent);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent->uuid) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    if (agent->inbound_queue_capacity == 0 && capacity > 0)
+        core_context->network_inbound_queues++;
+    else
+    if (agent->inbound_queue_capacity > 0 && capacity == 0)
+        core_context->network_inbound_queues--;
+    agent->inbound_queue_capacity = capacity;
+    agent->inbound_queue_policy = policy;
+    while (capacity > 0 && agent->inbound_queue_size > capacity) {
+        igs_inbound_value_t *queued = agent->inbound_queue;
+        DL_DELETE (agent->inbound_queue, queued);
+        s_free_inbound_value (&queued);
+        agent->inbound_queue_size--;
+        agent->inbound_queue_dropped++;
+    }
+    // when the queue is disabled, remaining values are written
+    // now so that they are not overtaken by the next ones
+    if (capacity == 0 && agent->inbound_queue
+        && !agent->inbound_queue_is_draining)
+        s_drain_inbound_queue (agent);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+size_t igsagent_inbound_queue_size (igsagent_t *agent)
+{
+    assert (agent);
+    return agent->inbound_queue_size;
+}
+
+size_t igsagent_inbound_queue_dropped (igsagent_t *agent)
+{
+    assert (agent);
+    return agent->inbound_queue_dropped;
+}
+
 void igs_net_raise_sockets_limit ()
 {
     core_init_context ();
@@ -10,12 +10,12 @@
     =========================================================================
 */
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 
 #include "ingescape_private.h"
 #include "yajl_gen.h"
-#include "yajl_tree.h"
 
 #define STR_DEFINITION "definition"
 #define STR_NAME "name"
@@ -38,6 +38,9 @@
 #define STR_FROM_INPUT "fromInput"
 #define STR_TO_AGENT "toAgent"
 #define STR_TO_OUTPUT "toOutput"
+#define STR_REDUCER "reducer"
+#define STR_WINDOW_SAMPLES "windowSamples"
+#define STR_WINDOW_MS "windowMs"
 
 //deprecated
 #define STR_LEGACY_MAPPING "mapping"
@@ -107,826 +110,736 @@ const char *s_value_type_to_string (igs_iop_value_type_t type)
 }
 
 //
-// Definition parsing
+// Streaming parsing
 //
-igs_definition_t *parser_parse_definition_from_node (igs_json_node_t **json)
+// Definitions and mappings are built in a single pass from the
+// igs_json_parse_from_* callbacks, without the intermediate JSON tree:
+// only the scalars of the IOP, service, argument or mapping element being
+// read are kept, and they are committed when their map closes.
+//
+#define PARSER_STREAM_MAX_DEPTH 16
+
+typedef enum {
+    PARSER_STREAM_IGNORED = 0,
+    PARSER_STREAM_ROOT,
+    PARSER_STREAM_DEFINITION,
+    PARSER_STREAM_INPUTS,
+    PARSER_STREAM_OUTPUTS,
+    PARSER_STREAM_PARAMETERS,
+    PARSER_STREAM_IOP,
+    PARSER_STREAM_SERVICES,
+    PARSER_STREAM_SERVICE,
+    PARSER_STREAM_SERVICE_ARGUMENTS,
+    PARSER_STREAM_REPLY,
+    PARSER_STREAM_REPLY_ARGUMENTS,
+    PARSER_STREAM_ARGUMENT,
+    PARSER_STREAM_LEGACY_MAPPING,
+    PARSER_STREAM_MAPPINGS,
+    PARSER_STREAM_LEGACY_MAPPINGS,
+    PARSER_STREAM_SPLITS,
+    PARSER_STREAM_ELEMENT
+} parser_stream_scope_t;
+
+// scalars of the element being read, first occurrence wins
+typedef struct parser_stream_fields {
+    char *name;
+    char *type;
+    char *constraint;
+    char *description;
+    igs_json_value_type_t value_type; // zero when there is no value
+    char *value;
+    bool value_bool;
+    char *from_input;
+    char *to_agent;
+    char *to_output;
+    char *reducer;
+    char *window_samples;
+    char *window_ms;
+} parser_stream_fields_t;
+
+typedef struct parser_stream {
+    parser_stream_scope_t scopes[PARSER_STREAM_MAX_DEPTH];
+    size_t depth;
+    size_t overflow; // containers nested deeper than PARSER_STREAM_MAX_DEPTH
+    char *key;
+    bool started;
+    bool complete;
+    bool invalid; // root is not a map
+    // definition
+    igs_definition_t *definition;
+    char *definition_name;
+    igs_service_t *service;
+    char *reply_name;
+    parser_stream_fields_t argument;
+    // mapping
+    igs_mapping_t *mapping;
+    bool has_mappings;
+    bool has_splits;
+    // current IOP, service or mapping element
+    parser_stream_fields_t item;
+} parser_stream_t;
+
+void s_stream_set_field (char **field, const char *value)
 {
-    assert (json);
-    assert (*json);
-    igs_definition_t *definition = NULL;
-    const char *description_path[] = {STR_DEFINITION, STR_DESCRIPTION, NULL};
-    const char *version_path[] = {STR_DEFINITION, STR_VERSION, NULL};
-    const char *inputs_path[] = {STR_DEFINITION, STR_INPUTS, NULL};
-    const char *outputs_path[] = {STR_DEFINITION, STR_OUTPUTS, NULL};
-    const char *parameters_path[] = {STR_DEFINITION, STR_PARAMETERS, NULL};
-    const char *services_path[] = {STR_DEFINITION, STR_SERVICES, NULL};
-    const char *alternate_service_path[] = {STR_DEFINITION,
-                                             STR_SERVICES_DEPRECATED, NULL};
-    const char *arguments_path[] = {STR_ARGUMENTS, NULL};
-    const char *agent_name_path[] = {STR_DEFINITION, STR_NAME, NULL};
-    const char *name_path[] = {STR_NAME, NULL};
-    const char *constraint_path[] = {STR_CONSTRAINT, NULL};
-    const char *iop_description_path[] = {STR_DESCRIPTION, NULL};
-    const char *family_path[] = {STR_DEFINITION, STR_FAMILY, NULL};
-    const char *type_path[] = {STR_TYPE, NULL};
-    const char *value_path[] = {STR_VALUE, NULL};
-    const char *reply_path[] = {STR_REPLY, NULL};
-
-    // name is mandatory
-    igs_json_node_t *name = igs_json_node_find (*json, agent_name_path);
-    if (name && name->type == IGS_JSON_STRING && name->u.string != NULL) {
-        char *n = s_strndup (name->u.string, IGS_MAX_AGENT_NAME_LENGTH);
-        if (strlen (name->u.string) > IGS_MAX_AGENT_NAME_LENGTH)
-            igs_warn ("definition name '%s' exceeds maximum size and will be "
-                      "truncated to '%s'",
-                      name->u.string, n);
-        bool space_in_name = false;
-        size_t length_ofn = strlen (n);
-        size_t i = 0;
-        for (i = 0; i < length_ofn; i++) {
-            if (n[i] == ' ') {
-                n[i] = '_';
-                space_in_name = true;
-            }
+    if (*field == NULL && value)
+        *field = strdup (value);
+}
+
+void s_stream_clear_fields (parser_stream_fields_t *fields)
+{
+    char **strings[] = {&fields->name, &fields->type, &fields->constraint,
+                        &fields->description, &fields->value,
+                        &fields->from_input, &fields->to_agent,
+                        &fields->to_output, &fields->reducer,
+                        &fields->window_samples, &fields->window_ms};
+    for (size_t i = 0; i < sizeof (strings) / sizeof (strings[0]); i++) {
+        if (*strings[i])
+            free (*strings[i]);
+    }
+    memset (fields, 0, sizeof (parser_stream_fields_t));
+}
+
+char *s_stream_corrected_name (const char *name, size_t max_length,
+                               const char *kind)
+{
+    char *corrected_name = s_strndup (name, max_length);
+    bool space_in_name = false;
+    size_t length_ofn = strlen (corrected_name);
+    for (size_t k = 0; k < length_ofn; k++) {
+        if (corrected_name[k] == ' ') {
+            corrected_name[k] = '_';
+            space_in_name = true;
         }
-        if (space_in_name)
-            igs_warn (
-              "spaces are not allowed in definition name: '%s' has been "
-              "changed to '%s'",
-              name->u.string, n);
-        definition = (igs_definition_t *) zmalloc (sizeof (igs_definition_t));
-        definition->name = n;
     }
-    else
-        return NULL;
+    if (space_in_name)
+        igs_warn ("Spaces are not allowed in %s name: %s has been renamed to %s",
+                  kind, name, corrected_name);
+    return corrected_name;
+}
 
-    // family
-    igs_json_node_t *family = igs_json_node_find (*json, family_path);
-    if (family && family->type == IGS_JSON_STRING && family->u.string != NULL)
-        definition->family = strdup (family->u.string);
-
-    // agent description
-    igs_json_node_t *description = igs_json_node_find (*json, description_path);
-    if (description && description->type == IGS_JSON_STRING && description->u.string != NULL)
-        definition->description = s_strndup (description->u.string, IGS_MAX_DESCRIPTION_LENGTH);
-
-    // version
-    igs_json_node_t *version = igs_json_node_find (*json, version_path);
-    if (version && version->type == IGS_JSON_STRING && version->u.string != NULL)
-        definition->version = strdup (version->u.string);
-
-    // inputs
-    igs_json_node_t *inputs = igs_json_node_find (*json, inputs_path);
-    if (inputs && inputs->type == IGS_JSON_ARRAY) {
-        for (size_t i = 0; i < inputs->u.array.len; i++) {
-            igs_json_node_t *iop_name = igs_json_node_find (inputs->u.array.values[i], name_path);
-            if (iop_name && iop_name->type == IGS_JSON_STRING && iop_name->u.string != NULL) {
-                igs_iop_t *iop = NULL;
-                char *corrected_name = s_strndup (iop_name->u.string, IGS_MAX_IOP_NAME_LENGTH);
-                bool space_in_name = false;
-                size_t length_ofn = strlen (corrected_name);
-                size_t k = 0;
-                for (k = 0; k < length_ofn; k++) {
-                    if (corrected_name[k] == ' ') {
-                        corrected_name[k] = '_';
-                        space_in_name = true;
-                    }
-                }
-                if (space_in_name)
-                    igs_warn ("Spaces are not allowed in IOP name: %s has been "
-                              "renamed to %s",
-                              iop_name->u.string, corrected_name);
-
-                HASH_FIND_STR (definition->inputs_table, corrected_name, iop);
-                if (iop) {
-                    igs_warn (
-                      "input with name '%s' already exists : ignoring new one",
-                      corrected_name);
-                    free (corrected_name);
-                    continue; // iop with this name already exists
-                }
+// strictly positive integer or zero
+long long s_stream_positive_integer (const char *number)
+{
+    if (number == NULL)
+        return 0;
+    char *end = NULL;
+    errno = 0;
+    long long res = strtoll (number, &end, 10);
+    if (errno != 0 || end == number || *end != '\0' || res <= 0)
+        return 0;
+    return res;
+}
 
-                iop = (igs_iop_t *) zmalloc (sizeof (igs_iop_t));
-                iop->type = IGS_INPUT_T;
-                iop->value_type = IGS_UNKNOWN_T;
-                iop->name = corrected_name;
-
-                igs_json_node_t *iop_type = igs_json_node_find (inputs->u.array.values[i], type_path);
-                if (iop_type && iop_type->type == IGS_JSON_STRING && iop_type->u.string)
-                    iop->value_type = s_string_to_value_type (iop_type->u.string);
-                
-                igs_json_node_t *constraint = igs_json_node_find (inputs->u.array.values[i], constraint_path);
-                if (constraint && constraint->type == IGS_JSON_STRING && constraint->u.string){
-                    char *error = NULL;
-                    iop->constraint = s_model_parse_constraint(iop->value_type, constraint->u.string, &error);
-                    if (error)
-                        igs_error ("%s", error);
-                }
-                
-                igs_json_node_t *iop_description = igs_json_node_find (inputs->u.array.values[i], iop_description_path);
-                if (iop_description && iop_description->type == IGS_JSON_STRING && iop_description->u.string){
-                    if (iop->description)
-                        free(iop->description);
-                    iop->description = s_strndup(iop_description->u.string, IGS_MAX_LOG_LENGTH);
-                }
+void s_stream_free_service (igs_service_t *service)
+{
+    igs_service_t *reply = service->reply;
+    if (service->description)
+        free (service->description);
+    service_free_service (service); // frees reply name and arguments
+    if (reply)
+        free (reply);
+}
 
-                //NB: inputs do not have initial value in definition => nothing to do here
-                HASH_ADD_STR (definition->inputs_table, name, iop);
+void s_stream_iop_value (igs_iop_t *iop, parser_stream_fields_t *fields)
+{
+    switch (iop->value_type) {
+        case IGS_INTEGER_T:
+            if (fields->value_type == IGS_JSON_NUMBER)
+                iop->value.i = (int) strtoll (fields->value, NULL, 10);
+            break;
+        case IGS_DOUBLE_T:
+            if (fields->value_type == IGS_JSON_NUMBER)
+                iop->value.d = strtod (fields->value, NULL);
+            break;
+        case IGS_BOOL_T:
+            if (fields->value_type == IGS_JSON_BOOL)
+                iop->value.b = fields->value_bool;
+            else
+            if (fields->value_type == IGS_JSON_STRING)
+                iop->value.b = s_string_to_boolean (fields->value);
+            break;
+        case IGS_STRING_T:
+            if (fields->value_type == IGS_JSON_STRING)
+                iop->value.s = strdup (fields->value);
+            break;
+        case IGS_IMPULSION_T:
+            // IMPULSION has no value
+            break;
+        case IGS_DATA_T:
+            // we store data as hexa string but we convert it to actual bytes
+            if (fields->value_type == IGS_JSON_STRING) {
+                iop->value.data = s_model_string_to_bytes (fields->value);
+                iop->value_size =
+                  (iop->value.data) ? strlen (fields->value) / 2 : 0;
             }
-        }
-    }else if(inputs)
-        igs_error ("inputs are not an array : ignoring");
-
-    // outputs
-    igs_json_node_t *outputs = igs_json_node_find (*json, outputs_path);
-    if (outputs && outputs->type == IGS_JSON_ARRAY) {
-        for (size_t i = 0; i < outputs->u.array.len; i++) {
-            igs_json_node_t *iop_name =
-              igs_json_node_find (outputs->u.array.values[i], name_path);
-            if (iop_name && iop_name->type == IGS_JSON_STRING && iop_name->u.string != NULL) {
-                igs_iop_t *iop = NULL;
-                char *corrected_name = s_strndup (iop_name->u.string, IGS_MAX_IOP_NAME_LENGTH);
-                bool space_in_name = false;
-                size_t length_ofn = strlen (corrected_name);
-                size_t k = 0;
-                for (k = 0; k < length_ofn; k++) {
-                    if (corrected_name[k] == ' ') {
-                        corrected_name[k] = '_';
-                        space_in_name = true;
-                    }
-                }
-                if (space_in_name)
-                    igs_warn ("Spaces are not allowed in IOP name: %s has been "
-                              "renamed to %s",
-                              iop_name->u.string, corrected_name);
-
-                HASH_FIND_STR (definition->outputs_table, corrected_name, iop);
-                if (iop) {
-                    igs_warn (
-                      "output with name '%s' already exists : ignoring new one",
-                      corrected_name);
-                    free (corrected_name);
-                    continue; // iop with this name already exists
-                }
-
-                iop = (igs_iop_t *) zmalloc (sizeof (igs_iop_t));
-                iop->type = IGS_OUTPUT_T;
-                iop->value_type = IGS_UNKNOWN_T;
-                iop->name = corrected_name;
-
-                igs_json_node_t *iop_type =
-                  igs_json_node_find (outputs->u.array.values[i], type_path);
-                if (iop_type && iop_type->type == IGS_JSON_STRING && iop_type->u.string != NULL)
-                    iop->value_type = s_string_to_value_type (iop_type->u.string);
-                
-                igs_json_node_t *constraint = igs_json_node_find (outputs->u.array.values[i], constraint_path);
-                if (constraint && constraint->type == IGS_JSON_STRING && constraint->u.string){
-                    char *error = NULL;
-                    iop->constraint = s_model_parse_constraint(iop->value_type, constraint->u.string, &error);
-                }
-                
-                igs_json_node_t *iop_description = igs_json_node_find (outputs->u.array.values[i], iop_description_path);
-                if (iop_description && iop_description->type == IGS_JSON_STRING && iop_description->u.string){
-                    if (iop->description)
-                        free(iop->description);
-                    iop->description = s_strndup(iop_description->u.string, IGS_MAX_LOG_LENGTH);
-                }
+            break;
+        default:
+            break;
+    }
+}
 
-                igs_json_node_t *iop_value = igs_json_node_find (outputs->u.array.values[i], value_path);
-                if (iop_value) {
-                    switch (iop->value_type) {
-                        case IGS_INTEGER_T:
-                            iop->value.i =
-                              (int) IGSYAJL_GET_INTEGER (iop_value);
-                            break;
-                        case IGS_DOUBLE_T:
-                            iop->value.d = IGSYAJL_GET_DOUBLE (iop_value);
-                            break;
-                        case IGS_BOOL_T:
-                            if (iop_value->type == IGS_JSON_TRUE)
-                                iop->value.b = true;
-                            else
-                            if (iop_value->type == IGS_JSON_TRUE)
-                                iop->value.b = false;
-                            else
-                            if (iop_value->type == IGS_JSON_STRING)
-                                iop->value.b =
-                                  s_string_to_boolean (iop_value->u.string);
-                            break;
-                        case IGS_STRING_T:
-                            iop->value.s = (IGSYAJL_IS_STRING (iop_value)
-                                              ? strdup (iop_value->u.string)
-                                              : NULL);
-                            break;
-                        case IGS_IMPULSION_T:
-                            // IMPULSION has no value
-                            break;
-                        case IGS_DATA_T:
-                            // we store data as hexa string but we convert it to actual bytes
-                            iop->value.data =
-                              (IGSYAJL_IS_STRING (iop_value)
-                                 ? s_model_string_to_bytes (iop_value->u.string)
-                                 : NULL);
-                            iop->value_size =
-                              (iop->value.data)
-                                ? strlen (iop_value->u.string) / 2
-                                : 0;
-                            break;
-                        default:
-                            break;
-                    }
+void s_stream_commit_iop (parser_stream_t *stream, parser_stream_scope_t array)
+{
+    parser_stream_fields_t *fields = &stream->item;
+    igs_iop_t **table = NULL;
+    igs_iop_type_t type = IGS_INPUT_T;
+    const char *kind = NULL;
+    switch (array) {
+        case PARSER_STREAM_INPUTS:
+            table = &stream->definition->inputs_table;
+            type = IGS_INPUT_T;
+            kind = "input";
+            break;
+        case PARSER_STREAM_OUTPUTS:
+            table = &stream->definition->outputs_table;
+            type = IGS_OUTPUT_T;
+            kind = "output";
+            break;
+        case PARSER_STREAM_PARAMETERS:
+            table = &stream->definition->params_table;
+            type = IGS_PARAMETER_T;
+            kind = "parameter";
+            break;
+        default:
+            break;
+    }
+    if (table && fields->name) {
+        igs_iop_t *iop = NULL;
+        char *corrected_name =
+          s_stream_corrected_name (fields->name, IGS_MAX_IOP_NAME_LENGTH, "IOP");
+        HASH_FIND_STR (*table, corrected_name, iop);
+        if (iop) {
+            igs_warn ("%s with name '%s' already exists : ignoring new one",
+                      kind, corrected_name);
+            free (corrected_name);
+        }
+        else {
+            iop = (igs_iop_t *) zmalloc (sizeof (igs_iop_t));
+            iop->type = type;
+            iop->value_type = IGS_UNKNOWN_T;
+            iop->name = corrected_name;
+            if (fields->type)
+                iop->value_type = s_string_to_value_type (fields->type);
+            if (fields->constraint) {
+                char *error = NULL;
+                iop->constraint = s_model_parse_constraint (
+                  iop->value_type, fields->constraint, &error);
+                if (error) {
+                    igs_error ("%s", error);
+                    free (error);
                 }
-                HASH_ADD_STR (definition->outputs_table, name, iop);
             }
+            if (fields->description)
+                iop->description =
+                  s_strndup (fields->description, IGS_MAX_LOG_LENGTH);
+            //NB: inputs do not have initial value in definition
+            if (type != IGS_INPUT_T && fields->value_type)
+                s_stream_iop_value (iop, fields);
+            HASH_ADD_STR (*table, name, iop);
         }
     }
-    else
-    if (outputs)
-        igs_error ("outputs are not an array : ignoring");
-
-    // parameters
-    igs_json_node_t *parameters = igs_json_node_find (*json, parameters_path);
-    if (parameters && parameters->type == IGS_JSON_ARRAY) {
-        for (size_t i = 0; i < parameters->u.array.len; i++) {
-            igs_json_node_t *iop_name =
-              igs_json_node_find (parameters->u.array.values[i], name_path);
-            if (iop_name && iop_name->type == IGS_JSON_STRING && iop_name->u.string != NULL) {
-                igs_iop_t *iop = NULL;
-                char *corrected_name = s_strndup (iop_name->u.string, IGS_MAX_IOP_NAME_LENGTH);
-                bool space_in_name = false;
-                size_t length_ofn = strlen (corrected_name);
-                size_t k = 0;
-                for (k = 0; k < length_ofn; k++) {
-                    if (corrected_name[k] == ' ') {
-                        corrected_name[k] = '_';
-                        space_in_name = true;
-                    }
-                }
-                if (space_in_name)
-                    igs_warn ("Spaces are not allowed in IOP name: %s has been "
-                              "renamed to %s",
-                              iop_name->u.string, corrected_name);
-
-                HASH_FIND_STR (definition->params_table, corrected_name, iop);
-                if (iop) {
-                    igs_warn ("parameter with name '%s' already exists : "
-                              "ignoring new one",
-                              corrected_name);
-                    free (corrected_name);
-                    continue; // iop with this name already exists
-                }
+    s_stream_clear_fields (fields);
+}
 
-                iop = (igs_iop_t *) zmalloc (sizeof (igs_iop_t));
-                iop->type = IGS_PARAMETER_T;
-                iop->value_type = IGS_UNKNOWN_T;
-                iop->name = corrected_name;
-
-                igs_json_node_t *iop_type =
-                  igs_json_node_find (parameters->u.array.values[i], type_path);
-                if (iop_type && iop_type->type == IGS_JSON_STRING && iop_type->u.string != NULL)
-                    iop->value_type = s_string_to_value_type (iop_type->u.string);
-                
-                igs_json_node_t *constraint = igs_json_node_find (parameters->u.array.values[i], constraint_path);
-                if (constraint && constraint->type == IGS_JSON_STRING && constraint->u.string){
-                    char *error = NULL;
-                    iop->constraint = s_model_parse_constraint(iop->value_type, constraint->u.string, &error);
-                }
-                
-                igs_json_node_t *iop_description = igs_json_node_find (parameters->u.array.values[i], iop_description_path);
-                if (iop_description && iop_description->type == IGS_JSON_STRING && iop_description->u.string){
-                    if (iop->description)
-                        free(iop->description);
-                    iop->description = s_strndup(iop_description->u.string, IGS_MAX_LOG_LENGTH);
-                }
+void s_stream_commit_argument (parser_stream_t *stream,
+                               parser_stream_scope_t array)
+{
+    parser_stream_fields_t *fields = &stream->argument;
+    igs_service_t *owner = (array == PARSER_STREAM_REPLY_ARGUMENTS)
+                             ? stream->service->reply
+                             : stream->service;
+    if (fields->name) {
+        igs_service_arg_t *new_arg =
+          (igs_service_arg_t *) zmalloc (sizeof (igs_service_arg_t));
+        new_arg->name = s_stream_corrected_name (
+          fields->name, IGS_MAX_IOP_NAME_LENGTH, "service argument");
+        if (fields->type)
+            new_arg->type = s_string_to_value_type (fields->type);
+        LL_APPEND (owner->arguments, new_arg);
+    }
+    s_stream_clear_fields (fields);
+}
 
-                igs_json_node_t *iop_value = igs_json_node_find (
-                        parameters->u.array.values[i], value_path);
-                if (iop_value) {
-                    switch (iop->value_type) {
-                        case IGS_INTEGER_T:
-                            iop->value.i =
-                              (int) IGSYAJL_GET_INTEGER (iop_value);
-                            break;
-                        case IGS_DOUBLE_T:
-                            iop->value.d = IGSYAJL_GET_DOUBLE (iop_value);
-                            break;
-                        case IGS_BOOL_T:
-                            if (iop_value->type == IGS_JSON_TRUE)
-                                iop->value.b = true;
-                            else
-                            if (iop_value->type == IGS_JSON_TRUE)
-                                iop->value.b = false;
-                            else
-                            if (iop_value->type == IGS_JSON_STRING)
-                                iop->value.b =
-                                  s_string_to_boolean (iop_value->u.string);
-                            break;
-                        case IGS_STRING_T:
-                            iop->value.s = (IGSYAJL_IS_STRING (iop_value)
-                                              ? strdup (iop_value->u.string)
-                                              : NULL);
-                            break;
-                        case IGS_IMPULSION_T:
-                            // IMPULSION has no value
-                            break;
-                        case IGS_DATA_T:
-                            // we store data as hexa string but we convert it to actual bytes
-                            iop->value.data =
-                              (IGSYAJL_IS_STRING (iop_value)
-                                 ? s_model_string_to_bytes (iop_value->u.string)
-                                 : NULL);
-                            break;
-                        default:
-                            break;
-                    }
-                }
-                HASH_ADD_STR (definition->params_table, name, iop);
-            }
+void s_stream_commit_reply (parser_stream_t *stream)
+{
+    igs_service_t *reply = stream->service->reply;
+    if (stream->reply_name) {
+        reply->name = s_stream_corrected_name (
+          stream->reply_name, IGS_MAX_IOP_NAME_LENGTH, "service reply");
+        free (stream->reply_name);
+        stream->reply_name = NULL;
+    }
+    else {
+        // a reply without name is ignored
+        s_service_free_service_arguments (reply->arguments);
+        free (reply);
+        stream->service->reply = NULL;
+    }
+}
+
+void s_stream_commit_service (parser_stream_t *stream)
+{
+    parser_stream_fields_t *fields = &stream->item;
+    igs_service_t *service = stream->service;
+    stream->service = NULL;
+    if (fields->name) {
+        igs_service_t *existing = NULL;
+        char *corrected_name = s_stream_corrected_name (
+          fields->name, IGS_MAX_IOP_NAME_LENGTH, "service");
+        HASH_FIND_STR (stream->definition->services_table, corrected_name,
+                       existing);
+        if (existing) {
+            igs_warn ("service with name '%s' already exists : ignoring new one",
+                      corrected_name);
+            free (corrected_name);
+            s_stream_free_service (service);
+        }
+        else {
+            service->name = corrected_name;
+            if (fields->description)
+                service->description = strdup (fields->description);
+            HASH_ADD_STR (stream->definition->services_table, name, service);
         }
     }
     else
-    if (parameters)
-        igs_error ("parameters are not an array : ignoring");
-
-    // services
-    igs_json_node_t *services = igs_json_node_find (*json, services_path);
-    if (services == NULL)
-        services = igs_json_node_find (*json, alternate_service_path);
-    if (services && services->type == IGS_JSON_ARRAY) {
-        for (size_t i = 0; i < services->u.array.len; i++) {
-            igs_json_node_t *service_name =
-              igs_json_node_find (services->u.array.values[i], name_path);
-            if (service_name && service_name->type == IGS_JSON_STRING && service_name->u.string != NULL) {
-                igs_service_t *service = NULL;
-                char *corrected_name = s_strndup (service_name->u.string, IGS_MAX_IOP_NAME_LENGTH);
-                bool space_in_name = false;
-                size_t length_ofn = strlen (corrected_name);
-                size_t k = 0;
-                for (k = 0; k < length_ofn; k++) {
-                    if (corrected_name[k] == ' ') {
-                        corrected_name[k] = '_';
-                        space_in_name = true;
-                    }
-                }
-                if (space_in_name)
-                    igs_warn (
-                      "Spaces are not allowed in service name: %s has been "
-                      "renamed to %s",
-                      service_name->u.string, corrected_name);
-                HASH_FIND_STR (definition->services_table, corrected_name,
-                               service);
-                if (service) {
-                    igs_warn ("service with name '%s' already exists : "
-                              "ignoring new one",
-                              corrected_name);
-                    free (corrected_name);
-                    continue; // service with this name already exists
-                }
-
-                service = (igs_service_t *) zmalloc (sizeof (igs_service_t));
-                service->name = corrected_name;
-
-                description = igs_json_node_find (services->u.array.values[i],
-                                                  description_path);
-                if (description && description->type == IGS_JSON_STRING && description->u.string != NULL)
-                    service->description = strdup (description->u.string);
-
-                igs_json_node_t *arguments = igs_json_node_find (
-                  services->u.array.values[i], arguments_path);
-                if (arguments && arguments->type == IGS_JSON_ARRAY) {
-                    for (size_t j = 0; j < arguments->u.array.len; j++) {
-                        if (arguments->u.array.values[j]
-                            && arguments->u.array.values[j]->type
-                                 == IGS_JSON_MAP) {
-                            igs_json_node_t *arg_name = igs_json_node_find (
-                              arguments->u.array.values[j], name_path);
-                            if (arg_name && arg_name->type == IGS_JSON_STRING
-                                && arg_name->u.string) {
-                                char *corrected_arg_name = s_strndup (
-                                  arg_name->u.string, IGS_MAX_IOP_NAME_LENGTH);
-                                bool space_in_arg_name = false;
-                                size_t arg_name_length =
-                                  strlen (corrected_arg_name);
-                                size_t arg_name_idx = 0;
-                                for (arg_name_idx = 0;
-                                     arg_name_idx < arg_name_length;
-                                     arg_name_idx++) {
-                                    if (corrected_arg_name[arg_name_idx]
-                                        == ' ') {
-                                        corrected_arg_name[arg_name_idx] = '_';
-                                        space_in_arg_name = true;
-                                    }
-                                }
-                                if (space_in_arg_name)
-                                    igs_warn ("Spaces are not allowed in "
-                                              "service argument name: "
-                                              "%s has been renamed to %s",
-                                              arg_name->u.string,
-                                              corrected_arg_name);
-
-                                igs_service_arg_t *new_arg =
-                                  (igs_service_arg_t *) zmalloc (
-                                    sizeof (igs_service_arg_t));
-                                new_arg->name = corrected_arg_name;
-                                igs_json_node_t *arg_type = igs_json_node_find (
-                                  arguments->u.array.values[j], type_path);
-                                if (arg_type
-                                    && arg_type->type == IGS_JSON_STRING
-                                    && arg_type->u.string)
-                                    new_arg->type = s_string_to_value_type (
-                                      arg_type->u.string);
-                                LL_APPEND (service->arguments, new_arg);
-                            }
-                        }
-                    }
-                }
+        s_stream_free_service (service);
+    s_stream_clear_fields (fields);
+}
 
-                igs_json_node_t *reply =
-                  igs_json_node_find (services->u.array.values[i], reply_path);
-                if (reply && reply->type == IGS_JSON_MAP) {
-                    igs_json_node_t *reply_name =
-                      igs_json_node_find (reply, name_path);
-                    if (reply_name && reply_name->type == IGS_JSON_STRING
-                        && reply_name->u.string) {
-                        char *corrected_reply_name = s_strndup (
-                          reply_name->u.string, IGS_MAX_IOP_NAME_LENGTH);
-                        bool space_in_reply_name = false;
-                        size_t reply_name_length =
-                          strlen (corrected_reply_name);
-                        size_t reply_name_idx = 0;
-                        for (reply_name_idx = 0;
-                             reply_name_idx < reply_name_length;
-                             reply_name_idx++) {
-                            if (corrected_reply_name[reply_name_idx] == ' ') {
-                                corrected_reply_name[reply_name_idx] = '_';
-                                space_in_reply_name = true;
-                            }
-                        }
-                        if (space_in_reply_name)
-                            igs_warn ("Spaces are not allowed in service "
-                                      "argument name: %s "
-                                      "has been renamed to %s",
-                                      reply_name->u.string,
-                                      corrected_reply_name);
-
-                        igs_service_t *my_reply =
-                          (igs_service_t *) zmalloc (sizeof (igs_service_t));
-                        my_reply->name = corrected_reply_name;
-
-                        arguments = igs_json_node_find (reply, arguments_path);
-                        if (arguments && arguments->type == IGS_JSON_ARRAY) {
-                            for (size_t j = 0; j < arguments->u.array.len;
-                                 j++) {
-                                if (arguments->u.array.values[j]
-                                    && arguments->u.array.values[j]->type
-                                         == IGS_JSON_MAP) {
-                                    igs_json_node_t *arg_name =
-                                      igs_json_node_find (
-                                        arguments->u.array.values[j],
-                                        name_path);
-                                    if (arg_name
-                                        && arg_name->type == IGS_JSON_STRING
-                                        && arg_name->u.string) {
-                                        char *corrected_reply_arg_name =
-                                          s_strndup (arg_name->u.string,
-                                                     IGS_MAX_IOP_NAME_LENGTH);
-                                        bool space_in_reply_arg_name = false;
-                                        size_t reply_arg_name_length =
-                                          strlen (corrected_reply_arg_name);
-                                        size_t reply_arg_name_idx = 0;
-                                        for (reply_arg_name_idx = 0;
-                                             reply_arg_name_idx
-                                             < reply_arg_name_length;
-                                             reply_arg_name_idx++) {
-                                            if (corrected_reply_arg_name
-                                                  [reply_arg_name_idx]
-                                                == ' ') {
-                                                corrected_reply_arg_name
-                                                  [reply_arg_name_idx] = '_';
-                                                space_in_reply_arg_name = true;
-                                            }
-                                        }
-                                        if (space_in_reply_arg_name)
-                                            igs_warn (
-                                              "Spaces are not allowed in "
-                                              "service argument "
-                                              "name: %s has been renamed to %s",
-                                              arg_name->u.string,
-                                              corrected_reply_arg_name);
-
-                                        igs_service_arg_t *new_arg =
-                                          (igs_service_arg_t *) zmalloc (
-                                            sizeof (igs_service_arg_t));
-                                        new_arg->name =
-                                          corrected_reply_arg_name;
-                                        igs_json_node_t *arg_type =
-                                          igs_json_node_find (
-                                            arguments->u.array.values[j],
-                                            type_path);
-                                        if (arg_type
-                                            && arg_type->type == IGS_JSON_STRING
-                                            && arg_type->u.string)
-                                            new_arg->type =
-                                              s_string_to_value_type (
-                                                arg_type->u.string);
-                                        LL_APPEND (my_reply->arguments,
-                                                   new_arg);
-                                    }
-                                }
-                            }
-                        }
-                        service->reply = my_reply;
+void s_stream_commit_element (parser_stream_t *stream,
+                              parser_stream_scope_t array)
+{
+    parser_stream_fields_t *fields = &stream->item;
+    bool is_split = (array == PARSER_STREAM_SPLITS);
+    const char *kind = (is_split) ? "split element" : "mapping element";
+    if (fields->from_input && fields->to_agent && fields->to_output) {
+        char *from_input = s_stream_corrected_name (
+          fields->from_input, IGS_MAX_IOP_NAME_LENGTH, kind);
+        char *to_agent = s_stream_corrected_name (
+          fields->to_agent, IGS_MAX_IOP_NAME_LENGTH, kind);
+        char *to_output = s_stream_corrected_name (
+          fields->to_output, IGS_MAX_IOP_NAME_LENGTH, kind);
+        size_t len = strlen (from_input) + strlen (to_agent)
+                     + strlen (to_output) + 3 + 1;
+        char *mashup = (char *) zmalloc (len * sizeof (char));
+        snprintf (mashup, len, "%s.%s.%s", from_input, to_agent, to_output);
+        uint64_t h = s_djb2_hash ((unsigned char *) mashup);
+        free (mashup);
+
+        if (is_split) {
+            igs_split_t *tmp = NULL;
+            HASH_FIND (hh, stream->mapping->split_elements, &h,
+                       sizeof (uint64_t), tmp);
+            if (tmp == NULL) {
+                igs_split_t *new = split_create_split_element (
+                  from_input, to_agent, to_output);
+                new->id = h;
+                HASH_ADD (hh, stream->mapping->split_elements, id,
+                          sizeof (uint64_t), new);
+            }
+            else
+                igs_error ("hash already exists for %s->%s.%s", from_input,
+                           to_agent, to_output);
+        }
+        else {
+            igs_map_t *tmp = NULL;
+            HASH_FIND (hh, stream->mapping->map_elements, &h,
+                       sizeof (uint64_t), tmp);
+            if (tmp == NULL) {
+                igs_map_t *new = mapping_create_mapping_element (
+                  from_input, to_agent, to_output);
+                new->id = h;
+                // optional reducer
+                if (fields->reducer) {
+                    new->window_samples = (size_t) s_stream_positive_integer (
+                      fields->window_samples);
+                    new->window_ms = (unsigned int) s_stream_positive_integer (
+                      fields->window_ms);
+                    new->reducer = mapping_reducer_from_string (fields->reducer);
+                    if (new->reducer == IGS_REDUCER_NONE)
+                        igs_warn ("unknown reducer '%s' for %s->%s.%s : ignored",
+                                  fields->reducer, from_input, to_agent,
+                                  to_output);
+                    else if (new->window_samples == 0 && new->window_ms == 0) {
+                        igs_warn ("reducer '%s' for %s->%s.%s has no window : ignored",
+                                  fields->reducer, from_input, to_agent,
+                                  to_output);
+                        new->reducer = IGS_REDUCER_NONE;
                     }
                 }
-                HASH_ADD_STR (definition->services_table, name, service);
+                HASH_ADD (hh, stream->mapping->map_elements, id,
+                          sizeof (uint64_t), new);
             }
+            else
+                igs_error ("hash already exists for %s->%s.%s", from_input,
+                           to_agent, to_output);
         }
+        free (from_input);
+        free (to_agent);
+        free (to_output);
     }
-    else
-    if (services)
-        igs_error ("services are not an array : ignoring");
-
-    igs_json_node_destroy (json);
-    return definition;
+    s_stream_clear_fields (fields);
 }
 
-//
-// Mapping parsing
-//
-igs_mapping_t *parser_parse_mapping_from_node (igs_json_node_t **json)
+void s_stream_open (parser_stream_t *stream, bool is_map)
 {
-    assert (json);
-    assert (*json);
-    igs_mapping_t *mapping = NULL;
-    const char *mappings_path[] = {STR_MAPPINGS, NULL};
-    const char *splits_path[] = {STR_SPLITS, NULL};
-    // const char *from_agent_path[] = {"fromAgent",NULL};
-    const char *from_input_path[] = {STR_FROM_INPUT, NULL};
-    const char *to_agent_path[] = {STR_TO_AGENT, NULL};
-    const char *to_output_path[] = {STR_TO_OUTPUT, NULL};
-    const char *alternate_mapping_path[] = {STR_LEGACY_MAPPING,
-                                             STR_LEGACY_MAPPINGS, NULL};
-    const char *alternate_from_input_path[] = {STR_LEGACY_FROM_INPUT, NULL};
-    const char *alternate_to_agent_path[] = {STR_LEGACY_TO_AGENT, NULL};
-    const char *alternate_to_output_path[] = {STR_LEGACY_TO_OUTPUT, NULL};
-
-    bool use_alternate = false;
-    igs_json_node_t *mappings = igs_json_node_find (*json, mappings_path);
-    igs_json_node_t *splits = igs_json_node_find (*json, splits_path);
-    if (mappings == NULL) {
-        mappings = igs_json_node_find (*json, alternate_mapping_path);
-        if (mappings && mappings->type == IGS_JSON_ARRAY)
-            use_alternate = true;
+    const char *key = stream->key;
+    parser_stream_scope_t scope = PARSER_STREAM_IGNORED;
+    if (stream->overflow > 0 || stream->depth == PARSER_STREAM_MAX_DEPTH) {
+        stream->overflow++;
+        return;
+    }
+    if (stream->depth == 0) {
+        stream->started = true;
+        if (is_map)
+            scope = PARSER_STREAM_ROOT;
         else
-        if (!(mappings && mappings->type == IGS_JSON_ARRAY)
-            && splits == NULL) {
-            igs_json_node_destroy (json);
-            return NULL;
+            stream->invalid = true;
+    }
+    else
+    if (is_map) {
+        switch (stream->scopes[stream->depth - 1]) {
+            case PARSER_STREAM_ROOT:
+                if (stream->definition && key && streq (key, STR_DEFINITION))
+                    scope = PARSER_STREAM_DEFINITION;
+                else
+                if (stream->mapping && key && streq (key, STR_LEGACY_MAPPING))
+                    scope = PARSER_STREAM_LEGACY_MAPPING;
+                break;
+            case PARSER_STREAM_INPUTS:
+            case PARSER_STREAM_OUTPUTS:
+            case PARSER_STREAM_PARAMETERS:
+                scope = PARSER_STREAM_IOP;
+                break;
+            case PARSER_STREAM_SERVICES:
+                scope = PARSER_STREAM_SERVICE;
+                stream->service = (igs_service_t *) zmalloc (sizeof (igs_service_t));
+                break;
+            case PARSER_STREAM_SERVICE:
+                if (key && streq (key, STR_REPLY) && stream->service->reply == NULL) {
+                    scope = PARSER_STREAM_REPLY;
+                    stream->service->reply =
+                      (igs_service_t *) zmalloc (sizeof (igs_service_t));
+                }
+                break;
+            case PARSER_STREAM_SERVICE_ARGUMENTS:
+            case PARSER_STREAM_REPLY_ARGUMENTS:
+                scope = PARSER_STREAM_ARGUMENT;
+                break;
+            case PARSER_STREAM_MAPPINGS:
+            case PARSER_STREAM_LEGACY_MAPPINGS:
+            case PARSER_STREAM_SPLITS:
+                scope = PARSER_STREAM_ELEMENT;
+                break;
+            default:
+                break;
         }
     }
-
-    mapping = (igs_mapping_t *) zmalloc (sizeof (igs_mapping_t));
-
-    // FIXME: we will not use from_agent in parsing because the received
-    // mappings should all imply our inputs. In the future, we could
-    // check from_agent to ensure this is us but this requires changing the
-    // internal API to attach parsing to a specific agent instance.
-    if (mappings != NULL) {
-        for (size_t i = 0; i < mappings->u.array.len; i++) {
-            if (mappings->u.array.values[i]->type != IGS_JSON_MAP)
-                continue;
-            char *from_input = NULL;
-            char *to_agent = NULL;
-            char *to_output = NULL;
-            igs_json_node_t *from_input_node = NULL;
-            igs_json_node_t *to_agent_node = NULL;
-            igs_json_node_t *to_output_node = NULL;
-            if (!use_alternate) {
-                from_input_node = igs_json_node_find (
-                  mappings->u.array.values[i], from_input_path);
-                to_agent_node = igs_json_node_find (mappings->u.array.values[i],
-                                                    to_agent_path);
-                to_output_node = igs_json_node_find (
-                  mappings->u.array.values[i], to_output_path);
-            }
-            else {
-                from_input_node = igs_json_node_find (
-                  mappings->u.array.values[i], alternate_from_input_path);
-                to_agent_node = igs_json_node_find (mappings->u.array.values[i],
-                                                    alternate_to_agent_path);
-                to_output_node = igs_json_node_find (
-                  mappings->u.array.values[i], alternate_to_output_path);
-            }
-            if (from_input_node && from_input_node->type == IGS_JSON_STRING
-                && from_input_node->u.string) {
-                char *corrected_name = s_strndup (from_input_node->u.string,
-                                                  IGS_MAX_IOP_NAME_LENGTH);
-                bool space_in_name = false;
-                size_t length_ofn = strlen (corrected_name);
-                size_t k = 0;
-                for (k = 0; k < length_ofn; k++) {
-                    if (corrected_name[k] == ' ') {
-                        corrected_name[k] = '_';
-                        space_in_name = true;
-                    }
+    else
+    if (key) {
+        switch (stream->scopes[stream->depth - 1]) {
+            case PARSER_STREAM_ROOT:
+                if (stream->mapping && streq (key, STR_MAPPINGS))
+                    scope = PARSER_STREAM_MAPPINGS;
+                else
+                if (stream->mapping && streq (key, STR_SPLITS))
+                    scope = PARSER_STREAM_SPLITS;
+                break;
+            case PARSER_STREAM_DEFINITION:
+                if (streq (key, STR_INPUTS))
+                    scope = PARSER_STREAM_INPUTS;
+                else
+                if (streq (key, STR_OUTPUTS))
+                    scope = PARSER_STREAM_OUTPUTS;
+                else
+                if (streq (key, STR_PARAMETERS))
+                    scope = PARSER_STREAM_PARAMETERS;
+                else
+                if (streq (key, STR_SERVICES) || streq (key, STR_SERVICES_DEPRECATED))
+                    scope = PARSER_STREAM_SERVICES;
+                break;
+            case PARSER_STREAM_SERVICE:
+                if (streq (key, STR_ARGUMENTS))
+                    scope = PARSER_STREAM_SERVICE_ARGUMENTS;
+                break;
+            case PARSER_STREAM_REPLY:
+                if (streq (key, STR_ARGUMENTS))
+                    scope = PARSER_STREAM_REPLY_ARGUMENTS;
+                break;
+            case PARSER_STREAM_LEGACY_MAPPING:
+                if (streq (key, STR_LEGACY_MAPPINGS)) {
+                    scope = PARSER_STREAM_LEGACY_MAPPINGS;
+                    stream->has_mappings = true;
                 }
-                if (space_in_name)
-                    igs_warn (
-                      "Spaces are not allowed in mapping element name: %s has "
-                      "been renamed to %s",
-                      from_input_node->u.string, corrected_name);
-                from_input = corrected_name;
-            }
-            if (to_agent_node && to_agent_node->type == IGS_JSON_STRING
-                && to_agent_node->u.string) {
-                char *corrected_name =
-                  s_strndup (to_agent_node->u.string, IGS_MAX_IOP_NAME_LENGTH);
-                bool space_in_name = false;
-                size_t length_ofn = strlen (corrected_name);
-                size_t k = 0;
-                for (k = 0; k < length_ofn; k++) {
-                    if (corrected_name[k] == ' ') {
-                        corrected_name[k] = '_';
-                        space_in_name = true;
-                    }
+                break;
+            default:
+                break;
+        }
+    }
+    stream->scopes[stream->depth++] = scope;
+}
+
+void s_stream_close (parser_stream_t *stream)
+{
+    if (stream->overflow > 0) {
+        stream->overflow--;
+        return;
+    }
+    if (stream->depth == 0)
+        return;
+    parser_stream_scope_t parent = (stream->depth > 1)
+                                     ? stream->scopes[stream->depth - 2]
+                                     : PARSER_STREAM_IGNORED;
+    switch (stream->scopes[stream->depth - 1]) {
+        case PARSER_STREAM_IOP:
+            s_stream_commit_iop (stream, parent);
+            break;
+        case PARSER_STREAM_ARGUMENT:
+            s_stream_commit_argument (stream, parent);
+            break;
+        case PARSER_STREAM_REPLY:
+            s_stream_commit_reply (stream);
+            break;
+        case PARSER_STREAM_SERVICE:
+            s_stream_commit_service (stream);
+            break;
+        case PARSER_STREAM_ELEMENT:
+            s_stream_commit_element (stream, parent);
+            break;
+        default:
+            break;
+    }
+    stream->depth--;
+    if (stream->depth == 0)
+        stream->complete = true;
+}
+
+void s_stream_scalar (parser_stream_t *stream,
+                      igs_json_value_type_t type,
+                      void *value)
+{
+    if (stream->depth == 0) {
+        // root is a scalar
+        stream->started = true;
+        stream->invalid = true;
+        stream->complete = true;
+        return;
+    }
+    const char *key = stream->key;
+    if (stream->overflow > 0 || key == NULL)
+        return;
+    const char *string = (type == IGS_JSON_STRING) ? (const char *) value : NULL;
+    parser_stream_fields_t *fields = &stream->item;
+    switch (stream->scopes[stream->depth - 1]) {
+        case PARSER_STREAM_DEFINITION:
+            if (string == NULL)
+                break;
+            if (streq (key, STR_NAME))
+                s_stream_set_field (&stream->definition_name, string);
+            else
+            if (streq (key, STR_FAMILY))
+                s_stream_set_field (&stream->definition->family, string);
+            else
+            if (streq (key, STR_DESCRIPTION) && stream->definition->description == NULL)
+                stream->definition->description =
+                  s_strndup (string, IGS_MAX_DESCRIPTION_LENGTH);
+            else
+            if (streq (key, STR_VERSION))
+                s_stream_set_field (&stream->definition->version, string);
+            break;
+        case PARSER_STREAM_ARGUMENT:
+            fields = &stream->argument;
+            // fall through
+        case PARSER_STREAM_IOP:
+        case PARSER_STREAM_SERVICE:
+            if (streq (key, STR_VALUE)) {
+                if (fields->value_type == 0) {
+                    fields->value_type = type;
+                    if (type == IGS_JSON_BOOL)
+                        fields->value_bool = (*(int *) value != 0);
+                    else
+                    if (value)
+                        fields->value = strdup ((const char *) value);
                 }
-                if (space_in_name)
-                    igs_warn (
-                      "Spaces are not allowed in mapping element name: %s has "
-                      "been renamed to %s",
-                      to_agent_node->u.string, corrected_name);
-                to_agent = corrected_name;
             }
-            if (to_output_node && to_output_node->type == IGS_JSON_STRING
-                && to_output_node->u.string) {
-                char *corrected_name =
-                  s_strndup (to_output_node->u.string, IGS_MAX_IOP_NAME_LENGTH);
-                bool space_in_name = false;
-                size_t length_ofn = strlen (corrected_name);
-                size_t k = 0;
-                for (k = 0; k < length_ofn; k++) {
-                    if (corrected_name[k] == ' ') {
-                        corrected_name[k] = '_';
-                        space_in_name = true;
-                    }
-                }
-                if (space_in_name)
-                    igs_warn (
-                      "Spaces are not allowed in mapping element name: %s has "
-                      "been renamed to %s",
-                      to_output_node->u.string, corrected_name);
-                to_output = corrected_name;
+            else
+            if (string == NULL)
+                break;
+            else
+            if (streq (key, STR_NAME))
+                s_stream_set_field (&fields->name, string);
+            else
+            if (streq (key, STR_TYPE))
+                s_stream_set_field (&fields->type, string);
+            else
+            if (streq (key, STR_CONSTRAINT))
+                s_stream_set_field (&fields->constraint, string);
+            else
+            if (streq (key, STR_DESCRIPTION))
+                s_stream_set_field (&fields->description, string);
+            break;
+        case PARSER_STREAM_REPLY:
+            if (string && streq (key, STR_NAME))
+                s_stream_set_field (&stream->reply_name, string);
+            break;
+        case PARSER_STREAM_ELEMENT: {
+            bool legacy = (stream->scopes[stream->depth - 2]
+                           == PARSER_STREAM_LEGACY_MAPPINGS);
+            if (string) {
+                if (streq (key, (legacy) ? STR_LEGACY_FROM_INPUT : STR_FROM_INPUT))
+                    s_stream_set_field (&fields->from_input, string);
+                else
+                if (streq (key, (legacy) ? STR_LEGACY_TO_AGENT : STR_TO_AGENT))
+                    s_stream_set_field (&fields->to_agent, string);
+                else
+                if (streq (key, (legacy) ? STR_LEGACY_TO_OUTPUT : STR_TO_OUTPUT))
+                    s_stream_set_field (&fields->to_output, string);
+                else
+                if (streq (key, STR_REDUCER))
+                    s_stream_set_field (&fields->reducer, string);
             }
-            if (from_input && to_agent && to_output) {
-                size_t len = strlen (from_input) + strlen (to_agent)
-                             + strlen (to_output) + 3 + 1;
-                char *mashup = (char *) zmalloc (len * sizeof (char));
-                strcpy (mashup, from_input);
-                strcat (mashup, "."); // separator
-                strcat (mashup, to_agent);
-                strcat (mashup, "."); // separator
-                strcat (mashup, to_output);
-                mashup[len - 1] = '\0';
-                uint64_t h = s_djb2_hash ((unsigned char *) mashup);
-                free (mashup);
-
-                igs_map_t *tmp = NULL;
-                HASH_FIND (hh, mapping->map_elements, &h,
-                           sizeof (uint64_t), tmp);
-                if (tmp == NULL) {
-                    // element does not exist yet : create and register it
-                    igs_map_t *new = mapping_create_mapping_element (
-                      from_input, to_agent, to_output);
-                    new->id = h;
-                    HASH_ADD (hh, mapping->map_elements, id,
-                              sizeof (uint64_t), new);
-                }
+            else
+            if (type == IGS_JSON_NUMBER) {
+                if (streq (key, STR_WINDOW_SAMPLES))
+                    s_stream_set_field (&fields->window_samples, (const char *) value);
                 else
-                    igs_error ("hash already exists for %s->%s.%s", from_input,
-                               to_agent, to_output);
+                if (streq (key, STR_WINDOW_MS))
+                    s_stream_set_field (&fields->window_ms, (const char *) value);
             }
-            if (from_input)
-                free (from_input);
-            if (to_agent)
-                free (to_agent);
-            if (to_output)
-                free (to_output);
+            break;
         }
+        default:
+            break;
     }
-    if (splits != NULL) {
-        for (size_t i = 0; i < splits->u.array.len; i++) {
-            if (splits->u.array.values[i]->type != IGS_JSON_MAP)
-                continue;
-            char *from_input = NULL;
-            char *to_agent = NULL;
-            char *to_output = NULL;
-            igs_json_node_t *from_input_node = NULL;
-            igs_json_node_t *to_agent_node = NULL;
-            igs_json_node_t *to_output_node = NULL;
-            from_input_node = igs_json_node_find (splits->u.array.values[i],
-                                                  from_input_path);
-            to_agent_node =
-              igs_json_node_find (splits->u.array.values[i], to_agent_path);
-            to_output_node =
-              igs_json_node_find (splits->u.array.values[i], to_output_path);
-
-            if (from_input_node && from_input_node->type == IGS_JSON_STRING
-                && from_input_node->u.string) {
-                char *corrected_name = s_strndup (from_input_node->u.string,
-                                                  IGS_MAX_IOP_NAME_LENGTH);
-                bool space_in_name = false;
-                size_t length_ofn = strlen (corrected_name);
-                size_t k = 0;
-                for (k = 0; k < length_ofn; k++) {
-                    if (corrected_name[k] == ' ') {
-                        corrected_name[k] = '_';
-                        space_in_name = true;
-                    }
-                }
-                if (space_in_name)
-                    igs_warn (
-                      "Spaces are not allowed in split element name: %s has "
-                      "been renamed to %s",
-                      from_input_node->u.string, corrected_name);
-                from_input = corrected_name;
-            }
-            if (to_agent_node && to_agent_node->type == IGS_JSON_STRING
-                && to_agent_node->u.string) {
-                char *corrected_name =
-                  s_strndup (to_agent_node->u.string, IGS_MAX_IOP_NAME_LENGTH);
-                bool space_in_name = false;
-                size_t length_ofn = strlen (corrected_name);
-                size_t k = 0;
-                for (k = 0; k < length_ofn; k++) {
-                    if (corrected_name[k] == ' ') {
-                        corrected_name[k] = '_';
-                        space_in_name = true;
-                    }
-                }
-                if (space_in_name)
-                    igs_warn (
-                      "Spaces are not allowed in split element name: %s has "
-                      "been renamed to %s",
-                      to_agent_node->u.string, corrected_name);
-                to_agent = corrected_name;
-            }
-            if (to_output_node && to_output_node->type == IGS_JSON_STRING
-                && to_output_node->u.string) {
-                char *corrected_name =
-                  s_strndup (to_output_node->u.string, IGS_MAX_IOP_NAME_LENGTH);
-                bool space_in_name = false;
-                size_t length_ofn = strlen (corrected_name);
-                size_t k = 0;
-                for (k = 0; k < length_ofn; k++) {
-                    if (corrected_name[k] == ' ') {
-                        corrected_name[k] = '_';
-                        space_in_name = true;
-                    }
-                }
-                if (space_in_name)
-                    igs_warn (
-                      "Spaces are not allowed in split element name: %s has "
-                      "been renamed to %s",
-                      to_output_node->u.string, corrected_name);
-                to_output = corrected_name;
-            }
-            if (from_input && to_agent && to_output) {
-                size_t len = strlen (from_input) + strlen (to_agent)
-                             + strlen (to_output) + 3 + 1;
-                char *mashup = (char *) zmalloc (len * sizeof (char));
-                strcpy (mashup, from_input);
-                strcat (mashup, "."); // separator
-                strcat (mashup, to_agent);
-                strcat (mashup, "."); // separator
-                strcat (mashup, to_output);
-                mashup[len - 1] = '\0';
-                uint64_t h = s_djb2_hash ((unsigned char *) mashup);
-                free (mashup);
-
-                igs_split_t *tmp = NULL;
-                HASH_FIND (hh, mapping->split_elements, &h,
-                           sizeof (uint64_t), tmp);
-                if (tmp == NULL) {
-                    // element does not exist yet : create and register it
-                    igs_split_t *new = split_create_split_element (
-                      from_input, to_agent, to_output);
-                    new->id = h;
-                    HASH_ADD (hh, mapping->split_elements, id,
-                              sizeof (uint64_t), new);
-                }
+}
+
+void s_stream_callback (igs_json_value_type_t type,
+                        void *value,
+                        size_t size,
+                        void *my_data)
+{
+    IGS_UNUSED (size)
+    parser_stream_t *stream = (parser_stream_t *) my_data;
+    if (stream->complete)
+        return; // trailing content
+    switch (type) {
+        case IGS_JSON_MAP:
+        case IGS_JSON_ARRAY:
+            s_stream_open (stream, type == IGS_JSON_MAP);
+            break;
+        case IGS_JSON_MAP_END:
+        case IGS_JSON_ARRAY_END:
+            s_stream_close (stream);
+            break;
+        case IGS_JSON_KEY:
+            if (stream->key)
+                free (stream->key);
+            stream->key = strdup ((const char *) value);
+            if (stream->mapping && stream->overflow == 0 && stream->depth == 1
+                && stream->scopes[0] == PARSER_STREAM_ROOT) {
+                // present keys are enough for a mapping, even empty
+                if (streq (stream->key, STR_MAPPINGS))
+                    stream->has_mappings = true;
                 else
-                    igs_error ("hash already exists for %s->%s.%s", from_input,
-                               to_agent, to_output);
+                if (streq (stream->key, STR_SPLITS))
+                    stream->has_splits = true;
             }
-            if (from_input)
-                free (from_input);
-            if (to_agent)
-                free (to_agent);
-            if (to_output)
-                free (to_output);
+            return;
+        default:
+            s_stream_scalar (stream, type, value);
+            break;
+    }
+    if (stream->key) {
+        free (stream->key);
+        stream->key = NULL;
+    }
+}
+
+// parses json_str, or the file at path when json_str is NULL,
+// and releases everything but the resulting definition or mapping
+bool s_stream_parse (parser_stream_t *stream, const char *json_str,
+                     const char *path)
+{
+    if (json_str)
+        igs_json_parse_from_str (json_str, s_stream_callback, stream);
+    else
+        igs_json_parse_from_file (path, s_stream_callback, stream);
+
+    bool res = true;
+    if (!stream->started || !stream->complete) {
+        if (json_str)
+            igs_error ("could not parse JSON string : '%s'", json_str);
+        else
+            igs_error ("could not parse JSON file '%s'", path);
+        res = false;
+    }
+    else
+    if (stream->invalid) {
+        if (json_str)
+            igs_error ("parsed JSON is not a map : '%s'", json_str);
+        else
+            igs_error ("parsed JSON at '%s' is not a map", path);
+        res = false;
+    }
+    if (stream->key)
+        free (stream->key);
+    if (stream->service)
+        s_stream_free_service (stream->service);
+    if (stream->reply_name)
+        free (stream->reply_name);
+    s_stream_clear_fields (&stream->argument);
+    s_stream_clear_fields (&stream->item);
+    return res;
+}
+
+igs_definition_t *s_stream_load_definition (const char *json_str,
+                                            const char *path)
+{
+    parser_stream_t stream;
+    memset (&stream, 0, sizeof (parser_stream_t));
+    stream.definition = (igs_definition_t *) zmalloc (sizeof (igs_definition_t));
+    igs_definition_t *definition = stream.definition;
+    if (!s_stream_parse (&stream, json_str, path) || !stream.definition_name) {
+        // name is mandatory
+        if (stream.definition_name)
+            free (stream.definition_name);
+        definition_free_definition (&definition);
+        return NULL;
+    }
+
+    char *n = s_strndup (stream.definition_name, IGS_MAX_AGENT_NAME_LENGTH);
+    if (strlen (stream.definition_name) > IGS_MAX_AGENT_NAME_LENGTH)
+        igs_warn ("definition name '%s' exceeds maximum size and will be "
+                  "truncated to '%s'",
+                  stream.definition_name, n);
+    bool space_in_name = false;
+    size_t length_ofn = strlen (n);
+    for (size_t i = 0; i < length_ofn; i++) {
+        if (n[i] == ' ') {
+            n[i] = '_';
+            space_in_name = true;
         }
     }
-    igs_json_node_destroy (json);
+    if (space_in_name)
+        igs_warn ("spaces are not allowed in definition name: '%s' has been "
+                  "changed to '%s'",
+                  stream.definition_name, n);
+    free (stream.definition_name);
+    definition->name = n;
+    return definition;
+}
+
+igs_mapping_t *s_stream_load_mapping (const char *json_str, const char *path)
+{
+    parser_stream_t stream;
+    memset (&stream, 0, sizeof (parser_stream_t));
+    stream.mapping = (igs_mapping_t *) zmalloc (sizeof (igs_mapping_t));
+    igs_mapping_t *mapping = stream.mapping;
+    if (!s_stream_parse (&stream, json_str, path)
+        || (!stream.has_mappings && !stream.has_splits)) {
+        mapping_free_mapping (&mapping);
+        return NULL;
+    }
     return mapping;
 }
 
@@ -936,65 +849,64 @@ igs_mapping_t *parser_parse_mapping_from_node (igs_json_node_t **json)
 igs_definition_t *parser_load_definition (const char *json_str)
 {
     assert (json_str);
-    igs_json_node_t *json = igs_json_node_parse_from_str (json_str);
-    if (!json) {
-        igs_error ("could not parse JSON string : '%s'", json_str);
-        return NULL;
-    }
-    if (json->type != IGS_JSON_MAP) {
-        igs_json_node_destroy (&json);
-        igs_error ("parsed JSON is not an array : '%s'", json_str);
-        return NULL;
-    }
-    return parser_parse_definition_from_node (&json); // will free json tree node
+    return s_stream_load_definition (json_str, NULL);
 }
 
 igs_definition_t *parser_load_definition_from_path (const char *path)
 {
     assert (path);
-    igs_json_node_t *json = igs_json_node_parse_from_file (path);
-    if (!json) {
-        igs_error ("could not parse JSON file '%s'", path);
-        return NULL;
-    }
-    if (json->type != IGS_JSON_MAP) {
-        igs_json_node_destroy (&json);
-        igs_error ("parsed JSON at '%s' is not a map", path);
-        return NULL;
-    }
-    return parser_parse_definition_from_node (&json); // will free json tree node
+    return s_stream_load_definition (NULL, path);
 }
 
 igs_mapping_t *parser_load_mapping (const char *json_str)
 {
     assert (json_str);
-    igs_json_node_t *json = igs_json_node_parse_from_str (json_str);
-    if (!json) {
-        igs_error ("could not parse JSON string : '%s'", json_str);
-        return NULL;
-    }
-    if (json->type != IGS_JSON_MAP) {
-        igs_json_node_destroy (&json);
-        igs_error ("parsed JSON is not an array : '%s'", json_str);
-        return NULL;
-    }
-    return parser_parse_mapping_from_node (&json); // will free json tree node
+    return s_stream_load_mapping (json_str, NULL);
 }
 
 igs_mapping_t *parser_load_mapping_from_path (const char *path)
 {
     assert (path);
-    igs_json_node_t *json = igs_json_node_parse_from_file (path);
-    if (!json) {
-        igs_error ("could not parse JSON file '%s'", path);
-        return NULL;
-    }
-    if (json->type != IGS_JSON_MAP) {
-        igs_json_node_destroy (&json);
-        igs_error ("parsed JSON at '%s' is not an array", path);
-        return NULL;
+    return s_stream_load_mapping (NULL, path);
+}
+
+// constraint of an iop as written in definitions, empty if none,
+// with doubles at full precision
+void parser_constraint_expression (igs_iop_t *iop, char *expression, size_t size)
+{
+    assert (iop);
+    assert (expression);
+    assert (size > 0);
+    expression[0] = '\0';
+    if (!iop->constraint)
+        return;
+    switch (iop->constraint->type) {
+        case IGS_CONSTRAINT_MIN:
+            if (iop->value_type == IGS_INTEGER_T)
+                snprintf (expression, size, "min %d", iop->constraint->min_int.min);
+            else if (iop->value_type == IGS_DOUBLE_T)
+                snprintf (expression, size, "min %.17g", iop->constraint->min_double.min);
+            break;
+        case IGS_CONSTRAINT_MAX:
+            if (iop->value_type == IGS_INTEGER_T)
+                snprintf (expression, size, "max %d", iop->constraint->max_int.max);
+            else if (iop->value_type == IGS_DOUBLE_T)
+                snprintf (expression, size, "max %.17g", iop->constraint->max_double.max);
+            break;
+        case IGS_CONSTRAINT_RANGE:
+            if (iop->value_type == IGS_INTEGER_T)
+                snprintf (expression, size, "[%d, %d]", iop->constraint->range_int.min,
+                          iop->constraint->range_int.max);
+            else if (iop->value_type == IGS_DOUBLE_T)
+                snprintf (expression, size, "[%.17g, %.17g]", iop->constraint->range_double.min,
+                          iop->constraint->range_double.max);
+            break;
+        case IGS_CONSTRAINT_REGEXP:
+            snprintf (expression, size, "~ %s", iop->constraint->regexp.string);
+            break;
+        default:
+            break;
     }
-    return parser_parse_mapping_from_node (&json); // will free json tree node
 }
 
 char *parser_export_definition (igs_definition_t *def)
@@ -1032,51 +944,10 @@ char *parser_export_definition (igs_definition_t *def)
             igs_json_add_string (json, iop->name);
         }
         char constraint_expression[IGS_MAX_LOG_LENGTH] = "";
-        if (iop->constraint){
-            if (iop->constraint->type == IGS_CONSTRAINT_MIN){
-                if (iop->value_type == IGS_INTEGER_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "min %d",
-                             iop->constraint->min_int.min);
-                    igs_json_add_string(json, constraint_expression);
-                }else if (iop->value_type == IGS_DOUBLE_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "min %f",
-                             iop->constraint->min_double.min);
-                    igs_json_add_string(json, constraint_expression);
-                }
-            }else if (iop->constraint->type == IGS_CONSTRAINT_MAX){
-                if (iop->value_type == IGS_INTEGER_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "max %d",
-                             iop->constraint->max_int.max);
-                    igs_json_add_string(json, constraint_expression);
-                }else if (iop->value_type == IGS_DOUBLE_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "max %f",
-                             iop->constraint->max_double.max);
-                    igs_json_add_string(json, constraint_expression);
-                }
-            }else if (iop->constraint->type == IGS_CONSTRAINT_RANGE){
-                if (iop->value_type == IGS_INTEGER_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "[%d, %d]",
-                             iop->constraint->range_int.min,
-                             iop->constraint->range_int.max);
-                    igs_json_add_string(json, constraint_expression);
-                }else if (iop->value_type == IGS_DOUBLE_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "[%f, %f]",
-                             iop->constraint->range_double.min,
-                             iop->constraint->range_double.max);
-                    igs_json_add_string(json, constraint_expression);
-                }
-            }else if (iop->constraint->type == IGS_CONSTRAINT_REGEXP){
-                igs_json_add_string (json, STR_CONSTRAINT);
-                snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "~ %s",
-                         iop->constraint->regexp.string);
-                igs_json_add_string(json, constraint_expression);
-            }
+        parser_constraint_expression (iop, constraint_expression, IGS_MAX_LOG_LENGTH);
+        if (strlen (constraint_expression) > 0) {
+            igs_json_add_string (json, STR_CONSTRAINT);
+            igs_json_add_string (json, constraint_expression);
         }
         if (iop->description){
             igs_json_add_string (json, STR_DESCRIPTION);
@@ -1135,51 +1006,10 @@ char *parser_export_definition (igs_definition_t *def)
                 break;
         }
         char constraint_expression[IGS_MAX_LOG_LENGTH] = "";
-        if (iop->constraint){
-            if (iop->constraint->type == IGS_CONSTRAINT_MIN){
-                if (iop->value_type == IGS_INTEGER_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "min %d",
-                             iop->constraint->min_int.min);
-                    igs_json_add_string(json, constraint_expression);
-                }else if (iop->value_type == IGS_DOUBLE_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "min %f",
-                             iop->constraint->min_double.min);
-                    igs_json_add_string(json, constraint_expression);
-                }
-            }else if (iop->constraint->type == IGS_CONSTRAINT_MAX){
-                if (iop->value_type == IGS_INTEGER_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "max %d",
-                             iop->constraint->max_int.max);
-                    igs_json_add_string(json, constraint_expression);
-                }else if (iop->value_type == IGS_DOUBLE_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "max %f",
-                             iop->constraint->max_double.max);
-                    igs_json_add_string(json, constraint_expression);
-                }
-            }else if (iop->constraint->type == IGS_CONSTRAINT_RANGE){
-                if (iop->value_type == IGS_INTEGER_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "[%d, %d]",
-                             iop->constraint->range_int.min,
-                             iop->constraint->range_int.max);
-                    igs_json_add_string(json, constraint_expression);
-                }else if (iop->value_type == IGS_DOUBLE_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "[%f, %f]",
-                             iop->constraint->range_double.min,
-                             iop->constraint->range_double.max);
-                    igs_json_add_string(json, constraint_expression);
-                }
-            }else if (iop->constraint->type == IGS_CONSTRAINT_REGEXP){
-                igs_json_add_string (json, STR_CONSTRAINT);
-                snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "~ %s",
-                         iop->constraint->regexp.string);
-                igs_json_add_string(json, constraint_expression);
-            }
+        parser_constraint_expression (iop, constraint_expression, IGS_MAX_LOG_LENGTH);
+        if (strlen (constraint_expression) > 0) {
+            igs_json_add_string (json, STR_CONSTRAINT);
+            igs_json_add_string (json, constraint_expression);
         }
         if (iop->description){
             igs_json_add_string (json, STR_DESCRIPTION);
@@ -1235,51 +1065,10 @@ char *parser_export_definition (igs_definition_t *def)
                 break;
         }
         char constraint_expression[IGS_MAX_LOG_LENGTH] = "";
-        if (iop->constraint){
-            if (iop->constraint->type == IGS_CONSTRAINT_MIN){
-                if (iop->value_type == IGS_INTEGER_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "min %d",
-                             iop->constraint->min_int.min);
-                    igs_json_add_string(json, constraint_expression);
-                }else if (iop->value_type == IGS_DOUBLE_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "min %f",
-                             iop->constraint->min_double.min);
-                    igs_json_add_string(json, constraint_expression);
-                }
-            }else if (iop->constraint->type == IGS_CONSTRAINT_MAX){
-                if (iop->value_type == IGS_INTEGER_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "max %d",
-                             iop->constraint->max_int.max);
-                    igs_json_add_string(json, constraint_expression);
-                }else if (iop->value_type == IGS_DOUBLE_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "max %f",
-                             iop->constraint->max_double.max);
-                    igs_json_add_string(json, constraint_expression);
-                }
-            }else if (iop->constraint->type == IGS_CONSTRAINT_RANGE){
-                if (iop->value_type == IGS_INTEGER_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "[%d, %d]",
-                             iop->constraint->range_int.min,
-                             iop->constraint->range_int.max);
-                    igs_json_add_string(json, constraint_expression);
-                }else if (iop->value_type == IGS_DOUBLE_T){
-                    igs_json_add_string (json, STR_CONSTRAINT);
-                    snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "[%f, %f]",
-                             iop->constraint->range_double.min,
-                             iop->constraint->range_double.max);
-                    igs_json_add_string(json, constraint_expression);
-                }
-            }else if (iop->constraint->type == IGS_CONSTRAINT_REGEXP){
-                igs_json_add_string (json, STR_CONSTRAINT);
-                snprintf(constraint_expression, IGS_MAX_LOG_LENGTH, "~ %s",
-                         iop->constraint->regexp.string);
-                igs_json_add_string(json, constraint_expression);
-            }
+        parser_constraint_expression (iop, constraint_expression, IGS_MAX_LOG_LENGTH);
+        if (strlen (constraint_expression) > 0) {
+            igs_json_add_string (json, STR_CONSTRAINT);
+            igs_json_add_string (json, constraint_expression);
         }
         if (iop->description){
             igs_json_add_string (json, STR_DESCRIPTION);
@@ -1607,6 +1396,18 @@ char *parser_export_mapping (igs_mapping_t *mapping)
             igs_json_add_string (json, STR_TO_OUTPUT);
             igs_json_add_string (json, elmt->to_output);
         }
+        if (elmt->reducer != IGS_REDUCER_NONE) {
+            igs_json_add_string (json, STR_REDUCER);
+            igs_json_add_string (json, mapping_reducer_to_string (elmt->reducer));
+            if (elmt->window_samples > 0) {
+                igs_json_add_string (json, STR_WINDOW_SAMPLES);
+                igs_json_add_int (json, (int64_t) elmt->window_samples);
+            }
+            if (elmt->window_ms > 0) {
+                igs_json_add_string (json, STR_WINDOW_MS);
+                igs_json_add_int (json, (int64_t) elmt->window_ms);
+            }
+        }
         igs_json_close_map (json);
     }
     igs_json_close_array (json);
@@ -1699,7 +1500,7 @@ igs_result_t igsagent_definition_load_str (igsagent_t *agent,
     igsagent_set_name (agent, tmp->name);
     definition_free_definition (&agent->definition);
     agent->definition = tmp;
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
     model_read_write_unlock (__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
 }
@@ -1727,7 +1528,7 @@ igs_result_t igsagent_definition_load_file (igsagent_t *agent,
     definition_free_definition (&agent->definition);
     agent->definition_path = s_strndup (file_path, IGS_MAX_PATH_LENGTH - 1);
     agent->definition = tmp;
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
     model_read_write_unlock (__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
 }
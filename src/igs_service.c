@@ -14,6 +14,8 @@
 #include "ingescape_private.h"
 #include "uthash/uthash.h"
 #include "uthash/utlist.h"
+#include <limits.h>
+#include <math.h>
 #include <stdio.h>
 #include <zyre.h>
 
@@ -37,12 +39,62 @@ void s_service_free_service_arguments (igs_service_arg_t *args)
     }
 }
 
+// size of argument values, as sent on the network
+size_t s_service_arguments_size (igs_service_arg_t *args)
+{
+    size_t res = 0;
+    igs_service_arg_t *arg = NULL;
+    LL_FOREACH (args, arg)
+    {
+        switch (arg->type) {
+            case IGS_BOOL_T:
+            case IGS_INTEGER_T:
+                res += sizeof (int);
+                break;
+            case IGS_DOUBLE_T:
+                res += sizeof (double);
+                break;
+            case IGS_STRING_T:
+                res += (arg->c) ? strlen (arg->c) + 1 : 0;
+                break;
+            case IGS_DATA_T:
+                res += arg->size;
+                break;
+            default:
+                break;
+        }
+    }
+    return res;
+}
+
+void s_service_free_job (igs_service_job_t **job)
+{
+    assert (job);
+    assert (*job);
+    free ((*job)->callee_uuid);
+    free ((*job)->service_name);
+    free ((*job)->caller_name);
+    free ((*job)->caller_uuid);
+    if ((*job)->token)
+        free ((*job)->token);
+    s_service_free_service_arguments ((*job)->arguments);
+    free (*job);
+    *job = NULL;
+}
+
 void service_free_service (igs_service_t *t)
 {
     if (t != NULL) {
+        igs_service_job_t *job, *tmp;
+        LL_FOREACH_SAFE (t->queue, job, tmp){
+            LL_DELETE (t->queue, job);
+            s_service_free_job (&job);
+        }
         if (t->name != NULL)
             free (t->name);
         s_service_free_service_arguments (t->arguments);
+        if (t->arguments_view)
+            free (t->arguments_view);
         if (t->reply != NULL) {
             if (t->reply->name != NULL)
                 free (t->reply->name);
@@ -101,6 +153,226 @@ igs_result_t service_add_values_to_arguments_from_message (const char *name,
     return IGS_SUCCESS;
 }
 
+#define IGS_PACKED_ALIGN(size) (((size) + 7) & ~((size_t) 7))
+
+size_t s_service_packed_value_size (igs_service_arg_t *arg)
+{
+    switch (arg->type) {
+        case IGS_BOOL_T:
+            return 1;
+        case IGS_INTEGER_T:
+            return sizeof (int);
+        case IGS_DOUBLE_T:
+            return sizeof (double);
+        case IGS_STRING_T:
+            return (arg->c) ? strlen (arg->c) + 1 : 0;
+        case IGS_DATA_T:
+            return arg->size;
+        default:
+            return 0;
+    }
+}
+
+zframe_t *service_pack_arguments (igs_service_arg_t *list)
+{
+    size_t nb_args = 0;
+    size_t total = sizeof (igs_packed_args_t);
+    igs_service_arg_t *arg = NULL;
+    LL_FOREACH (list, arg){
+        nb_args++;
+        total += sizeof (igs_packed_arg_t) + IGS_PACKED_ALIGN (s_service_packed_value_size (arg));
+    }
+    if (total > UINT32_MAX) {
+        igs_error ("service arguments are too large to be packed (%zu bytes)", total);
+        return NULL;
+    }
+    zframe_t *frame = zframe_new (NULL, total);
+    byte *data = zframe_data (frame);
+    memset (data, 0, total);
+    igs_packed_args_t *header = (igs_packed_args_t *) data;
+    header->nb_args = (uint32_t) nb_args;
+    igs_packed_arg_t *entry = (igs_packed_arg_t *) (data + sizeof (igs_packed_args_t));
+    size_t offset = sizeof (igs_packed_args_t) + nb_args * sizeof (igs_packed_arg_t);
+    LL_FOREACH (list, arg){
+        size_t size = s_service_packed_value_size (arg);
+        entry->type = (uint32_t) arg->type;
+        entry->offset = (uint32_t) offset;
+        entry->size = (uint32_t) size;
+        switch (arg->type) {
+            case IGS_BOOL_T:
+                data[offset] = (arg->b) ? 1 : 0;
+                break;
+            case IGS_INTEGER_T:
+                memcpy (data + offset, &arg->i, size);
+                break;
+            case IGS_DOUBLE_T:
+                memcpy (data + offset, &arg->d, size);
+                break;
+            case IGS_STRING_T:
+                if (size)
+                    memcpy (data + offset, arg->c, size);
+                break;
+            case IGS_DATA_T:
+                if (size)
+                    memcpy (data + offset, arg->data, size);
+                break;
+            default:
+                break;
+        }
+        offset += IGS_PACKED_ALIGN (size);
+        entry++;
+    }
+    return frame;
+}
+
+/* Reads a packed numeric argument into the view, converting between bool,
+ integer and double when the sender used another numeric type than the one
+ in our definition. Non-numeric, truncated and out of range values are
+ rejected. */
+igs_result_t s_service_packed_number (igs_packed_arg_t *entry,
+                                      byte *value,
+                                      igs_service_arg_t *view)
+{
+    double d = 0;
+    int i = 0;
+    switch (entry->type) {
+        case IGS_BOOL_T:
+            if (entry->size < 1)
+                return IGS_FAILURE;
+            i = (value[0]) ? 1 : 0;
+            d = i;
+            break;
+        case IGS_INTEGER_T:
+            if (entry->size < sizeof (int))
+                return IGS_FAILURE;
+            memcpy (&i, value, sizeof (int));
+            d = i;
+            break;
+        case IGS_DOUBLE_T:
+            if (entry->size < sizeof (double))
+                return IGS_FAILURE;
+            memcpy (&d, value, sizeof (double));
+            if (view->type == IGS_INTEGER_T) {
+                if (isnan (d) || d < (double) INT_MIN || d > (double) INT_MAX)
+                    return IGS_FAILURE;
+                i = (int) d;
+            }
+            break;
+        default:
+            return IGS_FAILURE;
+    }
+    switch (view->type) {
+        case IGS_BOOL_T:
+            view->b = (entry->type == IGS_DOUBLE_T) ? (fpclassify (d) != FP_ZERO) : (i != 0);
+            view->size = sizeof (bool);
+            break;
+        case IGS_INTEGER_T:
+            view->i = i;
+            view->size = sizeof (int);
+            break;
+        case IGS_DOUBLE_T:
+            view->d = d;
+            view->size = sizeof (double);
+            break;
+        default:
+            return IGS_FAILURE;
+    }
+    return IGS_SUCCESS;
+}
+
+/* Returns a read-only view of the packed arguments, following the types of
+ the service definition. Strings and data point into the frame, which must
+ outlive the view. The view array is owned by the service and reused. */
+igs_result_t service_view_packed_arguments (igs_service_t *service,
+                                            zframe_t *frame,
+                                            igs_service_arg_t **view_args,
+                                            size_t *nb_args)
+{
+    assert (service);
+    assert (frame);
+    assert (view_args);
+    assert (nb_args);
+    *view_args = NULL;
+    *nb_args = 0;
+    byte *data = zframe_data (frame);
+    size_t frame_size = zframe_size (frame);
+    if (frame_size < sizeof (igs_packed_args_t)) {
+        igs_error ("packed arguments for service %s are truncated", service->name);
+        return IGS_FAILURE;
+    }
+    igs_packed_args_t header;
+    memcpy (&header, data, sizeof (igs_packed_args_t));
+    size_t defined_nb_args = 0;
+    igs_service_arg_t *defined = NULL;
+    LL_COUNT (service->arguments, defined, defined_nb_args);
+    if (header.nb_args != defined_nb_args) {
+        igs_error ("arguments count do not match in received message for service %s "
+                   "(%u vs. %zu expected)", service->name, header.nb_args, defined_nb_args);
+        return IGS_FAILURE;
+    }
+    if (frame_size < sizeof (igs_packed_args_t) + defined_nb_args * sizeof (igs_packed_arg_t)) {
+        igs_error ("packed arguments for service %s are truncated", service->name);
+        return IGS_FAILURE;
+    }
+    if (defined_nb_args == 0)
+        return IGS_SUCCESS;
+    if (service->arguments_view_size < defined_nb_args) {
+        service->arguments_view = (igs_service_arg_t *) realloc (service->arguments_view,
+                                                                 defined_nb_args * sizeof (igs_service_arg_t));
+        assert (service->arguments_view);
+        service->arguments_view_size = defined_nb_args;
+    }
+    size_t i = 0;
+    LL_FOREACH (service->arguments, defined){
+        igs_packed_arg_t entry;
+        memcpy (&entry, data + sizeof (igs_packed_args_t) + i * sizeof (igs_packed_arg_t),
+                sizeof (igs_packed_arg_t));
+        if ((size_t) entry.offset + entry.size > frame_size) {
+            igs_error ("argument %s of service %s is out of the received frame",
+                       defined->name, service->name);
+            return IGS_FAILURE;
+        }
+        byte *value = data + entry.offset;
+        igs_service_arg_t *view = service->arguments_view + i;
+        memset (view, 0, sizeof (igs_service_arg_t));
+        view->name = defined->name;
+        view->type = defined->type;
+        switch (defined->type) {
+            case IGS_BOOL_T:
+            case IGS_INTEGER_T:
+            case IGS_DOUBLE_T:
+                if (s_service_packed_number (&entry, value, view) != IGS_SUCCESS) {
+                    igs_error ("argument %s of service %s cannot be converted to %s",
+                               defined->name, service->name,
+                               (defined->type == IGS_BOOL_T) ? "bool"
+                               : (defined->type == IGS_INTEGER_T) ? "integer" : "double");
+                    return IGS_FAILURE;
+                }
+                break;
+            case IGS_STRING_T:
+                if (entry.size > 0 && (entry.type != IGS_STRING_T || value[entry.size - 1] != '\0')) {
+                    igs_error ("argument %s of service %s is not a valid string",
+                               defined->name, service->name);
+                    return IGS_FAILURE;
+                }
+                view->c = (entry.size > 0) ? (char *) value : NULL;
+                view->size = entry.size;
+                break;
+            case IGS_DATA_T:
+                view->data = (entry.size > 0) ? value : NULL;
+                view->size = entry.size;
+                break;
+            default:
+                break;
+        }
+        view->next = (i + 1 < defined_nb_args) ? view + 1 : NULL;
+        i++;
+    }
+    *view_args = service->arguments_view;
+    *nb_args = defined_nb_args;
+    return IGS_SUCCESS;
+}
+
 igs_result_t service_copy_arguments (igs_service_arg_t *source,
                                      igs_service_arg_t *destination)
 {
@@ -246,6 +518,735 @@ void service_log_received_service (igsagent_t *agent,
     igsagent_debug (agent, "%s", service_log);
 }
 
+// network frame for an argument value
+zframe_t *s_service_arg_frame (igs_service_arg_t *arg)
+{
+    assert (arg);
+    zframe_t *frame = NULL;
+    switch (arg->type) {
+        case IGS_BOOL_T:
+            frame = zframe_new (&arg->b, sizeof (int));
+            break;
+        case IGS_INTEGER_T:
+            frame = zframe_new (&arg->i, sizeof (int));
+            break;
+        case IGS_DOUBLE_T:
+            frame = zframe_new (&arg->d, sizeof (double));
+            break;
+        case IGS_STRING_T: {
+            if (arg->c != NULL)
+                frame = zframe_new (arg->c, strlen (arg->c) + 1);
+            else
+                frame = zframe_new (NULL, 0);
+            break;
+        }
+        case IGS_DATA_T:
+            frame = zframe_new (arg->data, arg->size);
+            break;
+        default:
+            break;
+    }
+    return frame;
+}
+
+uint64_t s_service_call_id_from_token (const char *token)
+{
+    if (!token || strncmp (token, IGS_SERVICE_CALL_TOKEN_PREFIX,
+                           strlen (IGS_SERVICE_CALL_TOKEN_PREFIX)) != 0)
+        return 0;
+    return strtoull (token + strlen (IGS_SERVICE_CALL_TOKEN_PREFIX), NULL, 10);
+}
+
+// bucket 0 is below 1ms, bucket n covers [2^(n-1), 2^n[ ms, last bucket gets the rest
+size_t s_service_latency_bucket (int64_t latency_ms)
+{
+    size_t bucket = 0;
+    while (latency_ms > 0 && bucket < IGS_SERVICE_LATENCY_BUCKETS - 1) {
+        latency_ms >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void service_free_latencies (igs_service_latencies_t **latencies)
+{
+    assert (latencies);
+    igs_service_latencies_t *l, *tmp;
+    HASH_ITER (hh, *latencies, l, tmp){
+        HASH_DEL (*latencies, l);
+        free (l->service_name);
+        free (l);
+    }
+    *latencies = NULL;
+}
+
+/*
+ Completions of asynchronous calls are counted and signaled to the threads
+ blocked in igs_service_call_wait.
+ */
+igs_mutex_t s_service_calls_mutex;
+igs_cond_t s_service_calls_cond;
+static bool s_service_calls_sync_initialized = false;
+static uint64_t s_service_calls_completions = 0;
+
+void s_service_calls_lock (void)
+{
+    if (!s_service_calls_sync_initialized) {
+        IGS_MUTEX_INIT (s_service_calls_mutex);
+        IGS_COND_INIT (s_service_calls_cond);
+        s_service_calls_sync_initialized = true;
+    }
+    IGS_MUTEX_LOCK (s_service_calls_mutex);
+}
+
+void s_service_calls_unlock (void)
+{
+    assert (s_service_calls_sync_initialized);
+    IGS_MUTEX_UNLOCK (s_service_calls_mutex);
+}
+
+uint64_t s_service_calls_completions_count (void)
+{
+    s_service_calls_lock ();
+    uint64_t res = s_service_calls_completions;
+    s_service_calls_unlock ();
+    return res;
+}
+
+void s_service_calls_signal_completion (void)
+{
+    s_service_calls_lock ();
+    s_service_calls_completions++;
+    IGS_COND_BROADCAST (s_service_calls_cond);
+    s_service_calls_unlock ();
+}
+
+// waits until a call completes after completions were counted, or
+// timeout_ms has elapsed (no timeout if negative)
+void s_service_calls_wait_completion (uint64_t completions, int64_t timeout_ms)
+{
+    s_service_calls_lock ();
+    if (completions == s_service_calls_completions) {
+#if defined (__UNIX__)
+        if (timeout_ms < 0)
+            pthread_cond_wait (&s_service_calls_cond, &s_service_calls_mutex);
+        else {
+            struct timespec until;
+            clock_gettime (CLOCK_REALTIME, &until);
+            until.tv_sec += (time_t) (timeout_ms / 1000);
+            until.tv_nsec += (long) (timeout_ms % 1000) * 1000000;
+            if (until.tv_nsec >= 1000000000) {
+                until.tv_sec++;
+                until.tv_nsec -= 1000000000;
+            }
+            pthread_cond_timedwait (&s_service_calls_cond, &s_service_calls_mutex, &until);
+        }
+#elif defined (__WINDOWS__)
+        SleepConditionVariableCS (&s_service_calls_cond, &s_service_calls_mutex,
+                                  (timeout_ms < 0) ? INFINITE : (DWORD) timeout_ms);
+#endif
+    }
+    s_service_calls_unlock ();
+}
+
+void s_service_free_call (igs_service_call_t **call)
+{
+    assert (call);
+    assert (*call);
+    if ((*call)->caller_uuid)
+        free ((*call)->caller_uuid);
+    if ((*call)->service_name)
+        free ((*call)->service_name);
+    if ((*call)->reply)
+        s_service_free_service_arguments ((*call)->reply);
+    free (*call);
+    *call = NULL;
+}
+
+// Completes a pending call and takes ownership of reply.
+// Must be called without the model lock.
+void s_service_complete_call (uint64_t call_id,
+                              const char *caller_uuid,
+                              igs_service_call_status_t status,
+                              igs_service_arg_t *reply)
+{
+    assert (status != IGS_SERVICE_CALL_PENDING);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igs_service_call_t *call = NULL;
+    if (core_context)
+        HASH_FIND (hh, core_context->service_calls, &call_id, sizeof (uint64_t), call);
+    if (!call || call->status != IGS_SERVICE_CALL_PENDING
+        || (caller_uuid && !streq (caller_uuid, call->caller_uuid))) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        igs_debug ("no pending service call with id %llu (status %d ignored)",
+                   (unsigned long long) call_id, status);
+        s_service_free_service_arguments (reply);
+        return;
+    }
+    igsagent_t *caller = (core_context->created_agents) ?
+        zhash_lookup (core_context->created_agents, call->caller_uuid) : NULL;
+    if (caller && status == IGS_SERVICE_CALL_REPLIED) {
+        igs_service_latencies_t *latencies = NULL;
+        HASH_FIND_STR (caller->service_latencies, call->service_name, latencies);
+        if (!latencies) {
+            latencies = (igs_service_latencies_t *) zmalloc (sizeof (igs_service_latencies_t));
+            latencies->service_name = strdup (call->service_name);
+            HASH_ADD_STR (caller->service_latencies, service_name, latencies);
+        }
+        latencies->histogram[s_service_latency_bucket (zclock_mono () - call->start)]++;
+        latencies->replies++;
+    }
+    call->status = status;
+    call->reply = reply;
+    if (call->cb) {
+        HASH_DEL (core_context->service_calls, call);
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        size_t args_nbr = 0;
+        igs_service_arg_t *arg = NULL;
+        LL_COUNT (call->reply, arg, args_nbr);
+        call->cb (caller, call->id, call->status, call->reply, args_nbr, call->cb_data);
+        s_service_free_call (&call);
+    }
+    else {
+        // reply is kept until igs_service_call_wait
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        s_service_calls_signal_completion ();
+    }
+}
+
+// removes a call which could not be sent, without completing it
+bool s_service_discard_call (uint64_t call_id)
+{
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igs_service_call_t *call = NULL;
+    HASH_FIND (hh, core_context->service_calls, &call_id, sizeof (uint64_t), call);
+    if (call)
+        HASH_DEL (core_context->service_calls, call);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    if (!call)
+        return false;
+    s_service_free_call (&call);
+    return true;
+}
+
+// calls not collected by igs_service_call_wait when clearing the context
+void service_free_calls (igs_core_context_t *context)
+{
+    assert (context);
+    igs_service_call_t *call, *tmp;
+    HASH_ITER (hh, context->service_calls, call, tmp){
+        HASH_DEL (context->service_calls, call);
+        s_service_free_call (&call);
+    }
+}
+
+// ids of pending calls of an agent (all agents if NULL) or expired at now_ms (if not zero)
+uint64_t *s_service_pending_calls (const char *caller_uuid, int64_t now_ms, size_t *nb)
+{
+    assert (nb);
+    *nb = 0;
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    size_t count = HASH_COUNT (core_context->service_calls);
+    uint64_t *ids = (count) ? (uint64_t *) zmalloc (count * sizeof (uint64_t)) : NULL;
+    igs_service_call_t *call, *tmp;
+    HASH_ITER (hh, core_context->service_calls, call, tmp){
+        if (call->status != IGS_SERVICE_CALL_PENDING)
+            continue;
+        if (caller_uuid && !streq (call->caller_uuid, caller_uuid))
+            continue;
+        if (now_ms && (!call->deadline || call->deadline > now_ms))
+            continue;
+        ids[(*nb)++] = call->id;
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return ids;
+}
+
+// cancels the pending calls of an agent about to be destroyed
+void service_cancel_calls (igsagent_t *agent)
+{
+    assert (agent);
+    size_t nb = 0;
+    uint64_t *ids = s_service_pending_calls (agent->uuid, 0, &nb);
+    for (size_t i = 0; i < nb; i++)
+        s_service_complete_call (ids[i], NULL, IGS_SERVICE_CALL_CANCELLED, NULL);
+    if (ids)
+        free (ids);
+}
+
+// Model lock must be held when calling this function.
+bool service_has_deadlines (igs_core_context_t *context)
+{
+    assert (context);
+    igs_service_call_t *call, *tmp;
+    HASH_ITER (hh, context->service_calls, call, tmp){
+        if (call->status == IGS_SERVICE_CALL_PENDING && call->deadline)
+            return true;
+    }
+    return false;
+}
+
+int service_check_deadlines (zloop_t *loop, int timer_id, void *arg)
+{
+    igs_core_context_t *context = (igs_core_context_t *) arg;
+    assert (context);
+    size_t nb = 0;
+    uint64_t *ids = s_service_pending_calls (NULL, zclock_mono (), &nb);
+    for (size_t i = 0; i < nb; i++)
+        s_service_complete_call (ids[i], NULL, IGS_SERVICE_CALL_TIMED_OUT, NULL);
+    if (ids)
+        free (ids);
+    // timer is armed again when a call with a deadline is registered
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    if (!service_has_deadlines (context)) {
+        zloop_timer_end (loop, timer_id);
+        context->service_deadlines_timer_armed = false;
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return 0;
+}
+
+// SERVICE_REPLY message from a remote callee: caller uuid, token, then type and value frames
+int service_message_from_callee (zmsg_t *msg, igs_core_context_t *context, bool rejected)
+{
+    assert (msg);
+    assert (context);
+    char *caller_uuid = zmsg_popstr (msg);
+    char *token = zmsg_popstr (msg);
+    uint64_t call_id = s_service_call_id_from_token (token);
+    if (!caller_uuid || !call_id) {
+        igs_error ("invalid caller or token in service reply : rejecting");
+        if (caller_uuid)
+            free (caller_uuid);
+        if (token)
+            free (token);
+        return 1;
+    }
+    if (rejected) {
+        igs_warn ("service call %s was rejected by its callee", token);
+        s_service_complete_call (call_id, caller_uuid, IGS_SERVICE_CALL_FAILED, NULL);
+        free (caller_uuid);
+        free (token);
+        return 0;
+    }
+    igs_service_arg_t *reply = NULL;
+    while (zmsg_size (msg) >= 2) {
+        char *type_str = zmsg_popstr (msg);
+        zframe_t *frame = zmsg_pop (msg);
+        int type = (type_str) ? atoi (type_str) : 0;
+        size_t size = zframe_size (frame);
+        switch (type) {
+            case IGS_BOOL_T:
+            case IGS_INTEGER_T: {
+                int value = 0;
+                if (size >= sizeof (int))
+                    memcpy (&value, zframe_data (frame), sizeof (int));
+                if (type == IGS_BOOL_T)
+                    igs_service_args_add_bool (&reply, value);
+                else
+                    igs_service_args_add_int (&reply, value);
+            } break;
+            case IGS_DOUBLE_T: {
+                double value = 0;
+                if (size >= sizeof (double))
+                    memcpy (&value, zframe_data (frame), sizeof (double));
+                igs_service_args_add_double (&reply, value);
+            } break;
+            case IGS_STRING_T: {
+                char *value = (size) ? zframe_strdup (frame) : NULL;
+                igs_service_args_add_string (&reply, value);
+                if (value)
+                    free (value);
+            } break;
+            case IGS_DATA_T:
+                igs_service_args_add_data (&reply, zframe_data (frame), size);
+                break;
+            default:
+                igs_warn ("unsupported argument type %s in reply to %s", type_str, token);
+                break;
+        }
+        if (type_str)
+            free (type_str);
+        zframe_destroy (&frame);
+    }
+    s_service_complete_call (call_id, caller_uuid, IGS_SERVICE_CALL_REPLIED, reply);
+    free (caller_uuid);
+    free (token);
+    return 0;
+}
+
+
+void s_service_worker (zsock_t *pipe, void *args)
+{
+    IGS_UNUSED (args)
+    zsock_signal (pipe, 0);
+    while (true) {
+        zmsg_t *msg = zmsg_recv (pipe);
+        if (!msg)
+            break; // interrupted
+        char *command = zmsg_popstr (msg);
+        zframe_t *frame = zmsg_pop (msg);
+        zmsg_destroy (&msg);
+        if (!command || !streq (command, "JOB") || !frame
+            || zframe_size (frame) != sizeof (igs_service_job_t *)) {
+            // $TERM or unexpected
+            if (command)
+                free (command);
+            zframe_destroy (&frame);
+            break;
+        }
+        free (command);
+        igs_service_job_t *job = NULL;
+        memcpy (&job, zframe_data (frame), sizeof (igs_service_job_t *));
+        zframe_destroy (&frame);
+
+        int64_t started_at = zclock_usecs ();
+        model_read_write_lock (__FUNCTION__, __LINE__);
+        igsagent_t *callee = NULL;
+        HASH_FIND_STR (core_context->agents, job->callee_uuid, callee);
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        if (callee)
+            job->cb (callee, job->caller_name, job->caller_uuid, job->service_name,
+                     job->arguments, job->nb_args, job->token, job->cb_data);
+        int64_t queue_time = started_at - job->queued_at;
+        int64_t run_time = zclock_usecs () - started_at;
+
+        zmsg_t *done = zmsg_new ();
+        zmsg_addstr (done, "DONE");
+        zmsg_addstr (done, job->callee_uuid);
+        zmsg_addstr (done, job->service_name);
+        zmsg_addmem (done, &queue_time, sizeof (int64_t));
+        zmsg_addmem (done, &run_time, sizeof (int64_t));
+        zmsg_send (&done, pipe);
+        s_service_free_job (&job);
+    }
+}
+
+// Model lock must be held when calling this function.
+igs_service_t *s_service_find (igs_core_context_t *context, const char *agent_uuid,
+                               const char *service_name)
+{
+    igsagent_t *agent = NULL;
+    HASH_FIND_STR (context->agents, agent_uuid, agent);
+    if (!agent || !agent->definition)
+        return NULL;
+    igs_service_t *service = NULL;
+    HASH_FIND_STR (agent->definition->services_table, service_name, service);
+    return service;
+}
+
+// Model lock must be held when calling this function.
+void s_service_dispatch_jobs (igs_core_context_t *context, igs_service_t *service)
+{
+    assert (context);
+    assert (service);
+    // jobs queued before going back to sequential execution are drained
+    // one at a time on a worker
+    size_t max_in_flight = (service->max_in_flight) ? service->max_in_flight : 1;
+    while (service->queue && service->in_flight < max_in_flight) {
+        if (!context->service_workers) {
+            context->service_workers = zlist_new ();
+            context->service_idle_workers = zlist_new ();
+        }
+        zactor_t *worker = (zactor_t *) zlist_pop (context->service_idle_workers);
+        if (!worker) {
+            if (!context->loop || !network_is_loop_thread (context))
+                return; // jobs wait for a running one to complete
+            worker = zactor_new (s_service_worker, NULL);
+            assert (worker);
+            zlist_append (context->service_workers, worker);
+            zloop_reader (context->loop, zactor_sock (worker), service_worker_done, worker);
+        }
+        igs_service_job_t *job = service->queue;
+        LL_DELETE (service->queue, job);
+        service->queue_size--;
+        service->in_flight++;
+        zmsg_t *msg = zmsg_new ();
+        zmsg_addstr (msg, "JOB");
+        zmsg_addmem (msg, &job, sizeof (igs_service_job_t *));
+        zmsg_send (&msg, worker);
+    }
+}
+
+int service_worker_done (zloop_t *loop, zsock_t *reader, void *arg)
+{
+    IGS_UNUSED (loop)
+    zactor_t *worker = (zactor_t *) arg;
+    assert (worker);
+    zmsg_t *msg = zmsg_recv (reader);
+    if (!msg)
+        return 0;
+    char *command = zmsg_popstr (msg);
+    char *callee_uuid = zmsg_popstr (msg);
+    char *service_name = zmsg_popstr (msg);
+    zframe_t *queue_time = zmsg_pop (msg);
+    zframe_t *run_time = zmsg_pop (msg);
+    zmsg_destroy (&msg);
+    if (command && streq (command, "DONE") && callee_uuid && service_name
+        && queue_time && zframe_size (queue_time) == sizeof (int64_t)
+        && run_time && zframe_size (run_time) == sizeof (int64_t)) {
+        model_read_write_lock (__FUNCTION__, __LINE__);
+        zlist_append (core_context->service_idle_workers, worker);
+        igs_service_t *service = s_service_find (core_context, callee_uuid, service_name);
+        if (service) {
+            int64_t t = 0;
+            memcpy (&t, zframe_data (queue_time), sizeof (int64_t));
+            service->total_queue_time += t;
+            memcpy (&t, zframe_data (run_time), sizeof (int64_t));
+            service->total_run_time += t;
+            service->executed++;
+            if (service->in_flight > 0)
+                service->in_flight--;
+            s_service_dispatch_jobs (core_context, service);
+        }
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+    }
+    if (command)
+        free (command);
+    if (callee_uuid)
+        free (callee_uuid);
+    if (service_name)
+        free (service_name);
+    zframe_destroy (&queue_time);
+    zframe_destroy (&run_time);
+    return 0;
+}
+
+// only asynchronous callers can be told about rejections
+void s_service_reject_call (igs_core_context_t *context,
+                            const char *caller_uuid,
+                            const char *token)
+{
+    if (!s_service_call_id_from_token (token) || !context->node)
+        return;
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    zlist_t *remote_agents = network_find_remote_agents (context, caller_uuid);
+    igs_remote_agent_t *remote_agent = zlist_first (remote_agents);
+    if (remote_agent && remote_agent->peer) {
+        zmsg_t *msg = zmsg_new ();
+        zmsg_addstr (msg, SERVICE_REJECTED_MSG);
+        zmsg_addstr (msg, caller_uuid);
+        zmsg_addstr (msg, token);
+        s_lock_zyre_peer (__FUNCTION__, __LINE__);
+        zyre_whisper (context->node, remote_agent->peer->peer_id, &msg);
+        s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+    }
+    zlist_destroy (&remote_agents);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+// runs a call received from the network, in our thread or on a worker thread
+void service_execute_received_call (igs_core_context_t *context,
+                                    igsagent_t *callee,
+                                    igs_service_t *service,
+                                    const char *caller_name,
+                                    const char *caller_uuid,
+                                    const char *token,
+                                    igs_service_arg_t *args,
+                                    size_t nb_args)
+{
+    assert (context);
+    assert (callee);
+    assert (service);
+    assert (service->cb);
+    if (core_context->enable_service_logging)
+        service_log_received_service (callee, caller_name, caller_uuid, service->name, args);
+
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    if (service->max_in_flight == 0 && !service->queue) {
+        igsagent_service_fn *cb = service->cb;
+        void *cb_data = service->cb_data;
+        char *callee_uuid = strdup (callee->uuid);
+        char *service_name = strdup (service->name);
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        int64_t started_at = zclock_usecs ();
+        cb (callee, caller_name, caller_uuid, service_name, args, nb_args, token, cb_data);
+        int64_t run_time = zclock_usecs () - started_at;
+        // callee or service may have been destroyed when we were unlocked
+        model_read_write_lock (__FUNCTION__, __LINE__);
+        service = s_service_find (context, callee_uuid, service_name);
+        if (service) {
+            service->total_run_time += run_time;
+            service->executed++;
+        }
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        free (callee_uuid);
+        free (service_name);
+        return;
+    }
+    if (service->in_flight >= service->max_in_flight
+        && service->queue_size >= service->queue_capacity) {
+        service->rejected++;
+        // service may be destroyed as soon as we are unlocked
+        char *service_name = strdup (service->name);
+        size_t in_flight = service->in_flight;
+        size_t queue_size = service->queue_size;
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        igsagent_warn (callee, "service %s is saturated (%zu running, %zu queued) : call from %s(%s) rejected",
+                       service_name, in_flight, queue_size, caller_name, caller_uuid);
+        free (service_name);
+        s_service_reject_call (context, caller_uuid, token);
+        return;
+    }
+    igs_service_job_t *job = (igs_service_job_t *) zmalloc (sizeof (igs_service_job_t));
+    job->callee_uuid = strdup (callee->uuid);
+    job->service_name = strdup (service->name);
+    job->caller_name = strdup ((caller_name) ? caller_name : "");
+    job->caller_uuid = strdup ((caller_uuid) ? caller_uuid : "");
+    if (token)
+        job->token = strdup (token);
+    job->arguments = (args) ? igs_service_args_clone (args) : NULL;
+    job->nb_args = nb_args;
+    job->cb = service->cb;
+    job->cb_data = service->cb_data;
+    job->queued_at = zclock_usecs ();
+    LL_APPEND (service->queue, job);
+    service->queue_size++;
+    s_service_dispatch_jobs (context, service);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+// called when the ingescape loop stops : running calls are completed, queued ones dropped
+void service_stop_workers (igs_core_context_t *context)
+{
+    assert (context);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    zlist_t *workers = context->service_workers;
+    context->service_workers = NULL;
+    if (context->service_idle_workers)
+        zlist_destroy (&context->service_idle_workers);
+    igsagent_t *agent, *tmp_agent;
+    HASH_ITER (hh, context->agents, agent, tmp_agent){
+        if (!agent->definition)
+            continue;
+        igs_service_t *service, *tmp_service;
+        HASH_ITER (hh, agent->definition->services_table, service, tmp_service){
+            igs_service_job_t *job, *tmp_job;
+            LL_FOREACH_SAFE (service->queue, job, tmp_job){
+                LL_DELETE (service->queue, job);
+                s_service_free_job (&job);
+            }
+            service->queue_size = 0;
+            service->in_flight = 0;
+        }
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    if (workers) {
+        // workers may need the model lock to finish their current call
+        zactor_t *worker = zlist_pop (workers);
+        while (worker) {
+            if (context->loop)
+                zloop_reader_end (context->loop, zactor_sock (worker));
+            zactor_destroy (&worker);
+            worker = zlist_pop (workers);
+        }
+        zlist_destroy (&workers);
+    }
+}
+
+// '*' in pattern matches any sequence of characters
+bool s_service_name_matches (const char *pattern, const char *name)
+{
+    const char *star = NULL;
+    const char *backtrack = NULL;
+    while (*name) {
+        if (*pattern == '*') {
+            star = pattern++;
+            backtrack = name;
+        }
+        else
+        if (*pattern == *name) {
+            pattern++;
+            name++;
+        }
+        else
+        if (star) {
+            pattern = star + 1;
+            name = ++backtrack;
+        }
+        else
+            return false;
+    }
+    while (*pattern == '*')
+        pattern++;
+    return (*pattern == '\0');
+}
+
+// SERVICE_BULK message : one call for several agents of our process
+int service_message_bulk (zmsg_t *msg, igs_core_context_t *context, const char *peer_name)
+{
+    assert (msg);
+    assert (context);
+    char *caller_uuid = zmsg_popstr (msg);
+    char *callee_uuids = zmsg_popstr (msg);
+    char *service_name = zmsg_popstr (msg);
+    char *token = zmsg_popstr (msg);
+    zframe_t *packed = zmsg_pop (msg);
+    if (!caller_uuid || !callee_uuids || !service_name || !token || !packed) {
+        igs_error ("invalid %s message received from %s : rejecting",
+                   CALL_SERVICE_BULK_MSG, peer_name);
+        if (caller_uuid)
+            free (caller_uuid);
+        if (callee_uuids)
+            free (callee_uuids);
+        if (service_name)
+            free (service_name);
+        if (token)
+            free (token);
+        zframe_destroy (&packed);
+        return 1;
+    }
+    const char *caller_name = peer_name;
+    igs_remote_agent_t *caller_agent = NULL;
+    HASH_FIND_STR (context->remote_agents, caller_uuid, caller_agent);
+    if (caller_agent && caller_agent->definition)
+        caller_name = caller_agent->definition->name;
+    network_telemetry_add (context, IGS_PRIVATE_CHANNEL, zframe_size (packed),
+                           "CALLED %s from %s (%s) in bulk", service_name,
+                           caller_name, caller_uuid);
+
+    char *callee_uuid = callee_uuids;
+    while (callee_uuid) {
+        char *next = strchr (callee_uuid, ' ');
+        if (next)
+            *next++ = '\0';
+        igsagent_t *callee = NULL;
+        HASH_FIND_STR (context->agents, callee_uuid, callee);
+        igs_service_t *service = NULL;
+        if (callee && callee->definition)
+            HASH_FIND_STR (callee->definition->services_table, service_name, service);
+        if (!callee)
+            igs_error ("no callee agent with uuid '%s' in %s message received from %s",
+                       callee_uuid, CALL_SERVICE_BULK_MSG, peer_name);
+        else
+        if (!callee->definition)
+            igsagent_warn (callee, "agent %s has no definition to handle service %s",
+                           callee_uuid, service_name);
+        else
+        if (!service)
+            igsagent_warn (callee, "agent %s(%s) has no service named %s",
+                           callee->definition->name, callee_uuid, service_name);
+        else
+        if (!service->cb)
+            igsagent_warn (callee, "no defined callback to handle received service %s",
+                           service_name);
+        else {
+            igs_service_arg_t *args = NULL;
+            size_t nb_args = 0;
+            if (service_view_packed_arguments (service, packed, &args, &nb_args) == IGS_SUCCESS)
+                service_execute_received_call (context, callee, service, caller_name,
+                                               caller_uuid, token, args, nb_args);
+        }
+        callee_uuid = next;
+    }
+    free (caller_uuid);
+    free (callee_uuids);
+    free (service_name);
+    free (token);
+    zframe_destroy (&packed);
+    return 0;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // PUBLIC API
 ////////////////////////////////////////////////////////////////////////
@@ -394,7 +1395,7 @@ igs_result_t igsagent_service_init (igsagent_t *agent,
             t->name = s_strndup (name, IGS_MAX_STRING_MSG_LENGTH);
         }
         HASH_ADD_STR (agent->definition->services_table, name, t);
-        agent->network_need_to_send_definition_update = true;
+        network_request_definition_update (agent);
     }
     t->cb = cb;
     t->cb_data = my_data;
@@ -417,7 +1418,72 @@ igs_result_t igsagent_service_remove (igsagent_t *agent, const char *name)
     }
     HASH_DEL (agent->definition->services_table, t);
     service_free_service (t);
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
+    return IGS_SUCCESS;
+}
+
+igs_result_t igsagent_service_set_concurrency (igsagent_t *agent,
+                                               const char *service_name,
+                                               size_t max_in_flight,
+                                               size_t queue_capacity)
+{
+    assert (agent);
+    assert (service_name);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent || !(agent->uuid)) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return IGS_SUCCESS;
+    }
+    igs_service_t *service = NULL;
+    if (agent->definition)
+        HASH_FIND_STR (agent->definition->services_table, service_name, service);
+    if (!service) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        igsagent_error (agent, "service with name '%s' does not exist", service_name);
+        return IGS_FAILURE;
+    }
+    service->max_in_flight = max_in_flight;
+    service->queue_capacity = queue_capacity;
+    s_service_dispatch_jobs (agent->context, service);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return IGS_SUCCESS;
+}
+
+igs_result_t igsagent_service_metrics (igsagent_t *agent,
+                                       const char *service_name,
+                                       size_t *executed,
+                                       size_t *rejected,
+                                       double *average_queue_time_ms,
+                                       double *average_run_time_ms)
+{
+    assert (agent);
+    assert (service_name);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent || !(agent->uuid)) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return IGS_FAILURE;
+    }
+    igs_service_t *service = NULL;
+    if (agent->definition)
+        HASH_FIND_STR (agent->definition->services_table, service_name, service);
+    if (!service) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        igsagent_error (agent, "service with name '%s' does not exist", service_name);
+        return IGS_FAILURE;
+    }
+    if (executed)
+        *executed = service->executed;
+    if (rejected)
+        *rejected = service->rejected;
+    if (average_queue_time_ms)
+        *average_queue_time_ms = (service->executed) ?
+            (double) service->total_queue_time / (1000.0 * service->executed) : 0;
+    if (average_run_time_ms)
+        *average_run_time_ms = (service->executed) ?
+            (double) service->total_run_time / (1000.0 * service->executed) : 0;
+    model_read_write_unlock (__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
 }
 
@@ -480,7 +1546,7 @@ igs_result_t igsagent_service_arg_add (igsagent_t *agent,
     }
     a->type = type;
     LL_APPEND (t->arguments, a);
-    agent->network_need_to_send_definition_update = true;
+    network_request_definition_update (agent);
     return IGS_SUCCESS;
 }
 
@@ -516,7 +1582,7 @@ igs_result_t igsagent_service_arg_remove (igsagent_t *agent,
                 free (arg->c);
             free (arg);
             found = true;
-            agent->network_need_to_send_definition_update = true;
+            network_request_definition_update (agent);
             break;
         }
     }
@@ -592,6 +1658,73 @@ void s_service_log_sent_service (igsagent_t *agent,
     igsagent_debug (agent, "%s", service_log);
 }
 
+// Builds a service call for remote agents hosted by the peer of remote_agent.
+// Arguments are packed only once, in *packed, for peers supporting it.
+// Several callee uuids separated by spaces go in a single bulk message.
+zmsg_t *s_service_call_msg (igsagent_t *agent,
+                            igs_remote_agent_t *remote_agent,
+                            const char *callee_uuids,
+                            const char *service_name,
+                            const char *token,
+                            igs_service_arg_t *list,
+                            zframe_t **packed)
+{
+    assert (agent);
+    assert (remote_agent);
+    assert (callee_uuids);
+    assert (packed);
+    zmsg_t *msg = zmsg_new ();
+    bool use_packed = false;
+    if (remote_agent->peer->protocol
+        && (streq (remote_agent->peer->protocol, "v2")
+            || streq (remote_agent->peer->protocol, "v3"))) {
+        igs_warn ("Remote agent %s(%s) uses an older version of Ingescape with deprecated protocol. Please upgrade this agent.", remote_agent->definition->name, remote_agent->uuid);
+        zmsg_addstr (msg, CALL_SERVICE_MSG_DEPRECATED);
+    }
+    else
+    if (strchr (callee_uuids, ' ')) {
+        assert (remote_agent->peer->supports_bulk_services);
+        use_packed = true;
+        zmsg_addstr (msg, CALL_SERVICE_BULK_MSG);
+    }
+    else
+    if (remote_agent->peer->supports_packed_services) {
+        use_packed = true;
+        zmsg_addstr (msg, CALL_SERVICE_PACKED_MSG);
+    }
+    else
+        zmsg_addstr (msg, CALL_SERVICE_MSG);
+
+    zmsg_addstr (msg, agent->uuid);
+    zmsg_addstr (msg, callee_uuids);
+    zmsg_addstr (msg, service_name);
+    if (token)
+        zmsg_addstr (msg, token);
+    else
+        zmsg_addstr (msg, "");
+    if (use_packed) {
+        // all arguments in a single frame
+        if (!*packed)
+            *packed = service_pack_arguments (list);
+        if (!*packed) {
+            zmsg_destroy (&msg);
+            return NULL;
+        }
+        zframe_t *frame = zframe_dup (*packed);
+        zmsg_append (msg, &frame);
+    }
+    else {
+        igs_service_arg_t *arg = NULL;
+        LL_FOREACH (list, arg)
+        {
+            zframe_t *frame = s_service_arg_frame (arg);
+            assert (frame);
+            zmsg_add (msg, frame);
+        }
+    }
+    return msg;
+}
+
 igs_result_t igsagent_service_call (igsagent_t *agent,
                                      const char *agent_name_or_uuid,
                                      const char *service_name,
@@ -614,15 +1747,17 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
 
     // 1- iteration on remote agents
     if (core_context->node != NULL) {
-        igs_remote_agent_t *remote_agent = NULL, *tmp = NULL;
-        HASH_ITER (hh, agent->context->remote_agents, remote_agent, tmp)
+        zframe_t *packed = NULL; // arguments are packed once for all targets
+        zlist_t *remote_agents = network_find_remote_agents (agent->context, agent_name_or_uuid);
+        igs_remote_agent_t *remote_agent = NULL;
+        for (remote_agent = zlist_first (remote_agents); remote_agent;
+             remote_agent = zlist_next (remote_agents))
         {
-            if ((remote_agent->definition
-                 && streq (remote_agent->definition->name, agent_name_or_uuid))
-                || streq (remote_agent->uuid, agent_name_or_uuid)) {
+            if (remote_agent->definition) {
                 // we found a matching agent
-                igs_service_arg_t *arg = NULL;
                 found = true;
+                // lazy definitions : agents we call services on are worth knowing
+                network_fetch_remote_definition (remote_agent);
 
                 /*
          We remove verifications on the service on sender side to enable
@@ -656,61 +1791,18 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
             }
         }
         */
-                zmsg_t *msg = zmsg_new ();
-                if (remote_agent->peer->protocol
-                    && (streq (remote_agent->peer->protocol, "v2")
-                        || streq (remote_agent->peer->protocol, "v3"))) {
-                    igs_warn ("Remote agent %s(%s) uses an older version of Ingescape with deprecated protocol. Please upgrade this agent.", remote_agent->definition->name, remote_agent->uuid);
-                    zmsg_addstr (msg, CALL_SERVICE_MSG_DEPRECATED);
-                }
-                else
-                    zmsg_addstr (msg, CALL_SERVICE_MSG);
-
-                zmsg_addstr (msg, agent->uuid);
-                zmsg_addstr (msg, remote_agent->uuid);
-                zmsg_addstr (msg, service_name);
-                if (token)
-                    zmsg_addstr (msg, token);
-                else
-                    zmsg_addstr (msg, "");
-                if (list != NULL) {
-                    LL_FOREACH (*list, arg)
-                    {
-                        zframe_t *frame = NULL;
-                        switch (arg->type) {
-                            case IGS_BOOL_T:
-                                frame = zframe_new (&arg->b, sizeof (int));
-                                break;
-                            case IGS_INTEGER_T:
-                                frame = zframe_new (&arg->i, sizeof (int));
-                                break;
-                            case IGS_DOUBLE_T:
-                                frame = zframe_new (&arg->d, sizeof (double));
-                                break;
-                            case IGS_STRING_T: {
-                                if (arg->c != NULL)
-                                    frame =
-                                      zframe_new (arg->c, strlen (arg->c) + 1);
-                                else
-                                    frame = zframe_new (NULL, 0);
-                                break;
-                            }
-                            case IGS_DATA_T:
-                                frame = zframe_new (arg->data, arg->size);
-                                break;
-                            default:
-                                break;
-                        }
-                        assert (frame);
-                        zmsg_add (msg, frame);
-                    }
-                }
+                zmsg_t *msg = s_service_call_msg (agent, remote_agent, remote_agent->uuid,
+                                                  service_name, token,
+                                                  (list) ? *list : NULL, &packed);
+                if (!msg)
+                    continue;
+                network_telemetry_add (agent->context, agent->igs_channel,
+                                       zmsg_content_size (msg),
+                                       "SERVICE %s(%s) called %s.%s(%s)",
+                                       agent->definition->name, agent->uuid,
+                                       remote_agent->definition->name, service_name,
+                                       remote_agent->uuid);
                 s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                zyre_shouts (agent->context->node, agent->igs_channel,
-                             "SERVICE %s(%s) called %s.%s(%s)",
-                             agent->definition->name, agent->uuid,
-                             remote_agent->definition->name, service_name,
-                             remote_agent->uuid);
                 zyre_whisper (agent->context->node, remote_agent->peer->peer_id, &msg);
                 s_unlock_zyre_peer (__FUNCTION__, __LINE__);
                 if (core_context->enable_service_logging)
@@ -722,6 +1814,8 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
                                      remote_agent->uuid, service_name);
             }
         }
+        zlist_destroy (&remote_agents);
+        zframe_destroy (&packed);
     }
 
     // 2- iteration on local agents
@@ -781,15 +1875,12 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
                     }
                 }
 
-                s_lock_zyre_peer (__FUNCTION__, __LINE__);
-                if (core_context->node != NULL) {
-                    zyre_shouts (agent->context->node, agent->igs_channel,
-                                 "SERVICE %s(%s) called %s.%s(%s)",
-                                 agent->definition->name, agent->uuid,
-                                 local_agent->definition->name, service_name,
-                                 local_agent->uuid);
-                }
-                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+                network_telemetry_add (agent->context, agent->igs_channel,
+                                       (list) ? s_service_arguments_size (*list) : 0,
+                                       "SERVICE %s(%s) called %s.%s(%s)",
+                                       agent->definition->name, agent->uuid,
+                                       local_agent->definition->name, service_name,
+                                       local_agent->uuid);
 
                 if (core_context->enable_service_logging)
                     s_service_log_sent_service (agent, local_agent->definition->name, local_agent->uuid,
@@ -815,6 +1906,373 @@ igs_result_t igsagent_service_call (igsagent_t *agent,
     return IGS_SUCCESS;
 }
 
+igs_result_t igsagent_service_call_bulk (igsagent_t *agent,
+                                          const char **targets,
+                                          size_t targets_nbr,
+                                          const char *service_name,
+                                          igs_service_arg_t **list,
+                                          const char *token)
+{
+    assert (agent);
+    assert (targets || targets_nbr == 0);
+    assert (service_name);
+    assert ((list == NULL) || (*list != NULL));
+
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent || !(agent->uuid)) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return IGS_SUCCESS;
+    }
+
+    // resolve targets, each agent being called once
+    zhash_t *called = zhash_new ();
+    igs_name_index_t *peers = NULL; // remote agents grouped by peer id
+    zlist_t *local_uuids = zlist_new ();
+    zlist_autofree (local_uuids);
+    for (size_t i = 0; i < targets_nbr; i++) {
+        const char *target = targets[i];
+        if (!target)
+            continue;
+        bool is_pattern = (strchr (target, '*') != NULL);
+        zlist_t *remote_agents = NULL;
+        if (is_pattern) {
+            remote_agents = zlist_new ();
+            igs_remote_agent_t *remote, *rtmp;
+            HASH_ITER (hh, agent->context->remote_agents, remote, rtmp){
+                if (remote->definition
+                    && s_service_name_matches (target, remote->definition->name))
+                    zlist_append (remote_agents, remote);
+            }
+        }
+        else
+        if (core_context->node)
+            remote_agents = network_find_remote_agents (agent->context, target);
+        igs_remote_agent_t *remote_agent = (remote_agents) ? zlist_first (remote_agents) : NULL;
+        while (remote_agent) {
+            if (remote_agent->definition && remote_agent->peer
+                && !zhash_lookup (called, remote_agent->uuid)) {
+                zhash_insert (called, remote_agent->uuid, remote_agent);
+                network_fetch_remote_definition (remote_agent);
+                igs_name_index_t *peer = NULL;
+                HASH_FIND_STR (peers, remote_agent->peer->peer_id, peer);
+                if (!peer) {
+                    peer = (igs_name_index_t *) zmalloc (sizeof (igs_name_index_t));
+                    peer->name = strdup (remote_agent->peer->peer_id);
+                    peer->items = zlist_new ();
+                    HASH_ADD_STR (peers, name, peer);
+                }
+                zlist_append (peer->items, remote_agent);
+            }
+            remote_agent = zlist_next (remote_agents);
+        }
+        zlist_destroy (&remote_agents);
+        if (!agent->is_virtual) {
+            igsagent_t *local_agent, *atmp;
+            HASH_ITER (hh, agent->context->agents, local_agent, atmp){
+                if (!local_agent->definition || zhash_lookup (called, local_agent->uuid))
+                    continue;
+                if ((is_pattern && s_service_name_matches (target, local_agent->definition->name))
+                    || (!is_pattern && (streq (local_agent->definition->name, target)
+                                        || streq (local_agent->uuid, target)))) {
+                    zhash_insert (called, local_agent->uuid, local_agent);
+                    zlist_append (local_uuids, strdup (local_agent->uuid));
+                }
+            }
+        }
+    }
+    size_t found = zhash_size (called);
+    zhash_destroy (&called);
+
+    // one message per peer, arguments being packed once
+    zframe_t *packed = NULL;
+    igs_name_index_t *peer, *ptmp;
+    HASH_ITER (hh, peers, peer, ptmp){
+        HASH_DEL (peers, peer);
+        igs_remote_agent_t *first = zlist_first (peer->items);
+        if (zlist_size (peer->items) > 1 && first->peer->supports_bulk_services) {
+            size_t uuids_length = 0;
+            igs_remote_agent_t *remote_agent = NULL;
+            for (remote_agent = zlist_first (peer->items); remote_agent;
+                 remote_agent = zlist_next (peer->items))
+                uuids_length += strlen (remote_agent->uuid) + 1;
+            char *uuids = (char *) zmalloc (uuids_length);
+            for (remote_agent = zlist_first (peer->items); remote_agent;
+                 remote_agent = zlist_next (peer->items)) {
+                if (*uuids)
+                    strcat (uuids, " ");
+                strcat (uuids, remote_agent->uuid);
+            }
+            zmsg_t *msg = s_service_call_msg (agent, first, uuids, service_name, token,
+                                              (list) ? *list : NULL, &packed);
+            if (msg) {
+                network_telemetry_add (agent->context, agent->igs_channel,
+                                       zmsg_content_size (msg),
+                                       "SERVICE %s(%s) called %s on %zu agents of %s in bulk",
+                                       agent->definition->name, agent->uuid, service_name,
+                                       (size_t) zlist_size (peer->items), first->peer->name);
+                s_lock_zyre_peer (__FUNCTION__, __LINE__);
+                zyre_whisper (agent->context->node, first->peer->peer_id, &msg);
+                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+                igsagent_debug (agent, "calling %s on %zu agents of peer %s",
+                                service_name, (size_t) zlist_size (peer->items), first->peer->name);
+            }
+            free (uuids);
+        }
+        else {
+            // peer does not know bulk calls : one message per agent
+            igs_remote_agent_t *remote_agent = NULL;
+            for (remote_agent = zlist_first (peer->items); remote_agent;
+                 remote_agent = zlist_next (peer->items)) {
+                zmsg_t *msg = s_service_call_msg (agent, remote_agent, remote_agent->uuid,
+                                                  service_name, token,
+                                                  (list) ? *list : NULL, &packed);
+                if (!msg)
+                    continue;
+                network_telemetry_add (agent->context, agent->igs_channel,
+                                       zmsg_content_size (msg),
+                                       "SERVICE %s(%s) called %s.%s(%s)",
+                                       agent->definition->name, agent->uuid,
+                                       remote_agent->definition->name, service_name,
+                                       remote_agent->uuid);
+                s_lock_zyre_peer (__FUNCTION__, __LINE__);
+                zyre_whisper (agent->context->node, remote_agent->peer->peer_id, &msg);
+                s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+                igsagent_debug (agent, "calling %s(%s).%s",
+                                remote_agent->definition->name,
+                                remote_agent->uuid, service_name);
+            }
+        }
+        zlist_destroy (&peer->items);
+        free (peer->name);
+        free (peer);
+    }
+    zframe_destroy (&packed);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+
+    // local agents are called synchronously, with their own copy of the arguments
+    char *local_uuid = zlist_first (local_uuids);
+    while (local_uuid) {
+        igs_service_arg_t *copy = (list) ? igs_service_args_clone (*list) : NULL;
+        igsagent_service_call (agent, local_uuid, service_name, (copy) ? &copy : NULL, token);
+        local_uuid = zlist_next (local_uuids);
+    }
+    zlist_destroy (&local_uuids);
+
+    if ((list != NULL) && (*list != NULL)) {
+        s_service_free_service_arguments (*list);
+        *list = NULL;
+    }
+    if (!found) {
+        igsagent_error (agent, "could not find any agent matching the %zu targets of %s",
+                        targets_nbr, service_name);
+        return IGS_FAILURE;
+    }
+    return IGS_SUCCESS;
+}
+
+uint64_t igsagent_service_call_async (igsagent_t *agent,
+                                      const char *agent_name_or_uuid,
+                                      const char *service_name,
+                                      igs_service_arg_t **list,
+                                      unsigned int timeout_ms,
+                                      igsagent_service_reply_fn cb,
+                                      void *my_data)
+{
+    assert (agent);
+    assert (agent_name_or_uuid);
+    assert (service_name);
+    assert ((list == NULL) || (*list != NULL));
+
+    // register the call first : local callees may reply before
+    // igsagent_service_call returns
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent || !(agent->uuid)) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return 0;
+    }
+    igs_service_call_t *call = (igs_service_call_t *) zmalloc (sizeof (igs_service_call_t));
+    call->id = ++core_context->service_calls_counter;
+    call->caller_uuid = strdup (agent->uuid);
+    call->service_name = strdup (service_name);
+    call->start = zclock_mono ();
+    if (timeout_ms > 0)
+        call->deadline = call->start + (int64_t) timeout_ms;
+    call->status = IGS_SERVICE_CALL_PENDING;
+    call->cb = cb;
+    call->cb_data = my_data;
+    HASH_ADD (hh, core_context->service_calls, id, sizeof (uint64_t), call);
+    uint64_t call_id = call->id;
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    if (timeout_ms > 0)
+        network_request_timers_update (core_context);
+
+    char token[IGS_MAX_STRING_MSG_LENGTH] = "";
+    snprintf (token, IGS_MAX_STRING_MSG_LENGTH, "%s%llu",
+              IGS_SERVICE_CALL_TOKEN_PREFIX, (unsigned long long) call_id);
+    // calls which could not be sent are not completed : their callback
+    // is not called and zero is returned, unless a local callee already
+    // replied to them
+    if (igsagent_service_call (agent, agent_name_or_uuid, service_name, list, token) != IGS_SUCCESS
+        && s_service_discard_call (call_id))
+        return 0;
+    return call_id;
+}
+
+igs_service_call_status_t igs_service_call_wait (uint64_t call_id,
+                                                 igs_service_arg_t **reply)
+{
+    core_init_context ();
+    if (reply)
+        *reply = NULL;
+    while (true) {
+        // completions are counted before checking the call so that a
+        // completion occurring meanwhile is not missed
+        uint64_t completions = s_service_calls_completions_count ();
+        model_read_write_lock (__FUNCTION__, __LINE__);
+        igs_service_call_t *call = NULL;
+        HASH_FIND (hh, core_context->service_calls, &call_id, sizeof (uint64_t), call);
+        if (!call) {
+            model_read_write_unlock (__FUNCTION__, __LINE__);
+            igs_error ("no service call with id %llu waiting for completion",
+                       (unsigned long long) call_id);
+            return IGS_SERVICE_CALL_FAILED;
+        }
+        if (call->cb) {
+            model_read_write_unlock (__FUNCTION__, __LINE__);
+            igs_error ("service call %llu completes through its callback : cannot wait for it",
+                       (unsigned long long) call_id);
+            return IGS_SERVICE_CALL_FAILED;
+        }
+        if (call->status != IGS_SERVICE_CALL_PENDING) {
+            igs_service_call_status_t status = call->status;
+            HASH_DEL (core_context->service_calls, call);
+            if (reply) {
+                *reply = call->reply;
+                call->reply = NULL;
+            }
+            model_read_write_unlock (__FUNCTION__, __LINE__);
+            s_service_free_call (&call);
+            return status;
+        }
+        bool has_deadline = (call->deadline != 0);
+        int64_t remaining = (has_deadline) ? call->deadline - zclock_mono () : -1;
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        if (has_deadline && remaining <= 0)
+            s_service_complete_call (call_id, NULL, IGS_SERVICE_CALL_TIMED_OUT, NULL);
+        else
+            s_service_calls_wait_completion (completions, remaining);
+    }
+}
+
+void igs_service_call_cancel (uint64_t call_id)
+{
+    core_init_context ();
+    s_service_complete_call (call_id, NULL, IGS_SERVICE_CALL_CANCELLED, NULL);
+}
+
+igs_result_t igsagent_service_reply (igsagent_t *agent,
+                                      const char *caller_agent_uuid,
+                                      const char *token,
+                                      igs_service_arg_t **list)
+{
+    assert (agent);
+    assert (caller_agent_uuid);
+    assert ((list == NULL) || (*list != NULL));
+    uint64_t call_id = s_service_call_id_from_token (token);
+    if (!call_id) {
+        igsagent_error (agent, "token '%s' does not identify an asynchronous call : cannot reply",
+                        (token) ? token : "");
+        if (list)
+            igs_service_args_destroy (list);
+        return IGS_FAILURE;
+    }
+    igs_service_arg_t *reply = (list) ? *list : NULL;
+    if (list)
+        *list = NULL;
+
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent || !(agent->uuid)) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        s_service_free_service_arguments (reply);
+        return IGS_SUCCESS;
+    }
+
+    // 1- caller is one of our agents
+    igsagent_t *local_caller = NULL;
+    HASH_FIND_STR (core_context->agents, caller_agent_uuid, local_caller);
+    if (local_caller) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        s_service_complete_call (call_id, caller_agent_uuid, IGS_SERVICE_CALL_REPLIED, reply);
+        return IGS_SUCCESS;
+    }
+
+    // 2- caller is a remote agent
+    bool found = false;
+    if (core_context->node != NULL) {
+        zlist_t *remote_agents = network_find_remote_agents (core_context, caller_agent_uuid);
+        igs_remote_agent_t *remote_agent = zlist_first (remote_agents);
+        if (remote_agent && remote_agent->peer) {
+            found = true;
+            zmsg_t *msg = zmsg_new ();
+            zmsg_addstr (msg, SERVICE_REPLY_MSG);
+            zmsg_addstr (msg, caller_agent_uuid);
+            zmsg_addstr (msg, token);
+            igs_service_arg_t *arg = NULL;
+            LL_FOREACH (reply, arg)
+            {
+                zmsg_addstrf (msg, "%d", arg->type);
+                zframe_t *frame = s_service_arg_frame (arg);
+                assert (frame);
+                zmsg_append (msg, &frame);
+            }
+            network_telemetry_add (core_context, agent->igs_channel,
+                                   zmsg_content_size (msg),
+                                   "SERVICE %s(%s) replied to %s(%s)",
+                                   agent->definition->name, agent->uuid,
+                                   (remote_agent->definition) ? remote_agent->definition->name : "",
+                                   remote_agent->uuid);
+            s_lock_zyre_peer (__FUNCTION__, __LINE__);
+            zyre_whisper (core_context->node, remote_agent->peer->peer_id, &msg);
+            s_unlock_zyre_peer (__FUNCTION__, __LINE__);
+        }
+        zlist_destroy (&remote_agents);
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    s_service_free_service_arguments (reply);
+    if (!found) {
+        igsagent_error (agent, "could not find caller agent with UUID %s : reply not sent",
+                        caller_agent_uuid);
+        return IGS_FAILURE;
+    }
+    return IGS_SUCCESS;
+}
+
+size_t igsagent_service_latencies (igsagent_t *agent,
+                                   const char *service_name,
+                                   size_t *histogram,
+                                   size_t buckets_nbr)
+{
+    assert (agent);
+    assert (service_name);
+    assert (histogram || buckets_nbr == 0);
+    size_t res = 0;
+    if (histogram)
+        memset (histogram, 0, buckets_nbr * sizeof (size_t));
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igs_service_latencies_t *latencies = NULL;
+    HASH_FIND_STR (agent->service_latencies, service_name, latencies);
+    if (latencies) {
+        res = latencies->replies;
+        for (size_t i = 0; i < buckets_nbr && i < IGS_SERVICE_LATENCY_BUCKETS; i++)
+            histogram[i] = latencies->histogram[i];
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return res;
+}
+
 size_t igsagent_service_count (igsagent_t *agent)
 {
     if (agent->definition == NULL) {
@@ -33,48 +33,502 @@ void split_free_split_element (igs_split_t **split_elmt)
     *split_elmt = NULL;
 }
 
-void split_remove_worker (igs_core_context_t *context, char *uuid, char *input_name)
+char *s_split_make_key (const char *uuid, const char *name)
 {
-    assert(uuid);
-    assert(context);
-    igs_splitter_t *splitter;
-    igs_splitter_t *tmp;
-    LL_FOREACH_SAFE(context->splitters, splitter, tmp){
-        igs_worker_t *worker, *tmpWorker;
-        LL_FOREACH_SAFE(splitter->workers_list, worker, tmpWorker){
-            if (streq(uuid, worker->agent_uuid) &&
-                (!input_name || (input_name && streq(input_name, worker->input_name)))){
-                LL_DELETE(splitter->workers_list, worker);
-                free(worker->agent_uuid);
-                worker->agent_uuid = NULL;
-                free(worker->input_name);
-                worker->input_name = NULL;
-                free(worker);
+    assert (uuid);
+    assert (name);
+    size_t len = strlen (uuid) + strlen (name) + 1 + 1;
+    char *key = (char *) zmalloc (len * sizeof (char));
+    strcpy (key, uuid);
+    strcat (key, "."); // separator
+    strcat (key, name);
+    key[len - 1] = '\0';
+    return key;
+}
+
+igs_splitter_t *s_split_find_splitter (igs_core_context_t *context,
+                                       const char *agent_uuid,
+                                       const char *output_name)
+{
+    assert (context);
+    if (!context->splitters)
+        return NULL;
+    char *key = s_split_make_key (agent_uuid, output_name);
+    igs_splitter_t *splitter = NULL;
+    HASH_FIND_STR (context->splitters, key, splitter);
+    free (key);
+    return splitter;
+}
+
+// expected time for a worker to complete a new work, based on its
+// measured service time : works in flight are already limited by credit
+int64_t s_split_worker_expected_time (igs_worker_t *worker)
+{
+    return worker->service_time;
+}
+
+// workers heap : the worker to receive the next works is on top
+bool s_split_worker_is_better (igs_splitter_t *splitter, igs_worker_t *first, igs_worker_t *second)
+{
+    if (splitter->scheduling == IGS_SPLIT_SCHEDULING_LATENCY
+        && (first->credit > 0) == (second->credit > 0)){
+        // among workers with (or without) credit : smallest expected time
+        int64_t first_time = s_split_worker_expected_time (first);
+        int64_t second_time = s_split_worker_expected_time (second);
+        if (first_time != second_time)
+            return first_time < second_time;
+        return first->uses < second->uses;
+    }
+    // more credit, then less uses
+    return (first->credit > second->credit
+            || (first->credit == second->credit && first->uses < second->uses));
+}
+
+void s_split_heap_swap (igs_splitter_t *splitter, size_t i, size_t j)
+{
+    igs_worker_t *tmp = splitter->workers_heap[i];
+    splitter->workers_heap[i] = splitter->workers_heap[j];
+    splitter->workers_heap[j] = tmp;
+    splitter->workers_heap[i]->heap_index = i;
+    splitter->workers_heap[j]->heap_index = j;
+}
+
+void s_split_heap_sift_up (igs_splitter_t *splitter, size_t i)
+{
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!s_split_worker_is_better (splitter, splitter->workers_heap[i],
+                                       splitter->workers_heap[parent]))
+            break;
+        s_split_heap_swap (splitter, i, parent);
+        i = parent;
+    }
+}
+
+void s_split_heap_sift_down (igs_splitter_t *splitter, size_t i)
+{
+    while (true) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t best = i;
+        if (left < splitter->workers_heap_size
+            && s_split_worker_is_better (splitter, splitter->workers_heap[left],
+                                         splitter->workers_heap[best]))
+            best = left;
+        if (right < splitter->workers_heap_size
+            && s_split_worker_is_better (splitter, splitter->workers_heap[right],
+                                         splitter->workers_heap[best]))
+            best = right;
+        if (best == i)
+            break;
+        s_split_heap_swap (splitter, i, best);
+        i = best;
+    }
+}
+
+void s_split_heap_rebuild (igs_splitter_t *splitter)
+{
+    size_t i = splitter->workers_heap_size / 2;
+    while (i-- > 0)
+        s_split_heap_sift_down (splitter, i);
+}
+
+void s_split_heap_update (igs_splitter_t *splitter, igs_worker_t *worker)
+{
+    s_split_heap_sift_up (splitter, worker->heap_index);
+    s_split_heap_sift_down (splitter, worker->heap_index);
+}
+
+void s_split_heap_insert (igs_splitter_t *splitter, igs_worker_t *worker)
+{
+    if (splitter->workers_heap_size == splitter->workers_heap_capacity) {
+        splitter->workers_heap_capacity =
+          (splitter->workers_heap_capacity) ? 2 * splitter->workers_heap_capacity : 8;
+        splitter->workers_heap = (igs_worker_t **) realloc (
+          splitter->workers_heap,
+          splitter->workers_heap_capacity * sizeof (igs_worker_t *));
+        assert (splitter->workers_heap);
+    }
+    worker->heap_index = splitter->workers_heap_size;
+    splitter->workers_heap[splitter->workers_heap_size++] = worker;
+    s_split_heap_sift_up (splitter, worker->heap_index);
+}
+
+void s_split_heap_remove (igs_splitter_t *splitter, igs_worker_t *worker)
+{
+    size_t i = worker->heap_index;
+    assert (i < splitter->workers_heap_size);
+    size_t last = --splitter->workers_heap_size;
+    if (i != last) {
+        s_split_heap_swap (splitter, i, last);
+        s_split_heap_update (splitter, splitter->workers_heap[i]);
+    }
+    splitter->workers_heap[last] = NULL;
+}
+
+// FNV-1a hash, continued from a previous hash
+uint64_t s_split_hash (uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+#define IGS_SPLIT_HASH_INIT 14695981039346656037ULL
+
+int s_split_compare_vnodes (const void *first, const void *second)
+{
+    uint64_t first_hash = ((const igs_split_vnode_t *) first)->hash;
+    uint64_t second_hash = ((const igs_split_vnode_t *) second)->hash;
+    return (first_hash > second_hash) - (first_hash < second_hash);
+}
+
+void s_split_ring_rebuild (igs_splitter_t *splitter)
+{
+    splitter->ring_size = splitter->workers_heap_size * IGS_SPLIT_VNODES_PER_WORKER;
+    splitter->ring = (igs_split_vnode_t *) realloc (splitter->ring, (splitter->ring_size + 1) * sizeof (igs_split_vnode_t));
+    assert (splitter->ring);
+    size_t index = 0;
+    igs_worker_t *worker, *tmp;
+    HASH_ITER (hh, splitter->workers, worker, tmp){
+        // vnodes only depend on the worker key, so that they do not
+        // move when other workers join or leave
+        uint64_t worker_hash = s_split_hash (IGS_SPLIT_HASH_INIT, worker->key, strlen (worker->key));
+        for (uint32_t i = 0; i < IGS_SPLIT_VNODES_PER_WORKER; i++){
+            splitter->ring[index].hash = s_split_hash (worker_hash, &i, sizeof (uint32_t));
+            splitter->ring[index].worker = worker;
+            index++;
+        }
+    }
+    qsort (splitter->ring, splitter->ring_size, sizeof (igs_split_vnode_t), s_split_compare_vnodes);
+    splitter->ring_is_dirty = false;
+}
+
+// worker owning a key : first vnode at or after the key hash on the ring
+igs_worker_t *s_split_ring_find (igs_splitter_t *splitter, uint64_t key_hash)
+{
+    assert (splitter->workers_heap_size > 0);
+    if (splitter->ring_is_dirty || !splitter->ring)
+        s_split_ring_rebuild (splitter);
+    size_t low = 0;
+    size_t high = splitter->ring_size;
+    while (low < high){
+        size_t middle = low + (high - low) / 2;
+        if (splitter->ring[middle].hash < key_hash)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+    if (low == splitter->ring_size)
+        low = 0;
+    return splitter->ring[low].worker;
+}
+
+uint64_t s_split_work_key_hash (igs_splitter_t *splitter, igs_queued_work_t *work)
+{
+    if (!work->has_key_hash){
+        const void *data = NULL;
+        size_t size = 0;
+        switch (work->value_type) {
+            case IGS_INTEGER_T:
+                data = &work->value.i;
+                size = sizeof (int);
+                break;
+            case IGS_DOUBLE_T:
+                data = &work->value.d;
+                size = sizeof (double);
+                break;
+            case IGS_BOOL_T:
+                data = &work->value.b;
+                size = sizeof (bool);
+                break;
+            case IGS_STRING_T:
+                data = work->value.s;
+                size = strlen (work->value.s);
+                break;
+            case IGS_DATA_T:
+                data = work->value.data;
+                size = work->value_size;
+                break;
+            default:
+                break;
+        }
+        if (splitter->key_prefix > 0 && size > splitter->key_prefix)
+            size = splitter->key_prefix;
+        work->key_hash = s_split_hash (IGS_SPLIT_HASH_INIT, data, size);
+        work->has_key_hash = true;
+    }
+    return work->key_hash;
+}
+
+// queued works : ring buffer with slots reused from one work to another
+size_t s_split_queue_capacity_for_agent (igs_core_context_t *context, const char *agent_uuid)
+{
+    igsagent_t *agent = NULL;
+    HASH_FIND_STR (context->agents, agent_uuid, agent);
+    if (agent && agent->split_queue_capacity > 0)
+        return agent->split_queue_capacity;
+    return IGS_DEFAULT_SPLIT_QUEUE_CAPACITY;
+}
+
+igs_queued_work_t *s_split_queue_front (igs_splitter_t *splitter)
+{
+    if (splitter->queue_size == 0)
+        return NULL;
+    return &splitter->queued_works[splitter->queue_head];
+}
+
+void s_split_queue_pop (igs_splitter_t *splitter)
+{
+    assert (splitter->queue_size > 0);
+    splitter->queue_head = (splitter->queue_head + 1) % splitter->queue_capacity;
+    splitter->queue_size--;
+}
+
+void s_split_queue_set_work (igs_queued_work_t *work, const igs_iop_t *output)
+{
+    work->value_size = output->value_size;
+    work->value_type = output->value_type;
+    work->retries = 0;
+    work->has_key_hash = (output->split_key != NULL);
+    work->has_split_key = (output->split_key != NULL);
+    if (output->split_key)
+        work->key_hash = s_split_hash (IGS_SPLIT_HASH_INIT, output->split_key, strlen (output->split_key));
+    switch (output->value_type) {
+        case IGS_INTEGER_T:
+            work->value.i = output->value.i;
+            break;
+        case IGS_DOUBLE_T:
+            work->value.d = output->value.d;
+            break;
+        case IGS_BOOL_T:
+            work->value.b = output->value.b;
+            break;
+        case IGS_STRING_T:
+        case IGS_DATA_T:{
+            size_t size = (output->value_type == IGS_STRING_T) ? strlen (output->value.s) + 1 : output->value_size;
+            if (work->buffer_size < size || !work->buffer){
+                work->buffer = realloc (work->buffer, (size) ? size : 1);
+                assert (work->buffer);
+                work->buffer_size = size;
             }
+            if (size > 0)
+                memcpy (work->buffer, output->value.data, size);
+            work->value.data = work->buffer;
+            break;
         }
-        if(splitter->workers_list == NULL){
-            LL_DELETE(context->splitters, splitter);
-            free(splitter->agent_uuid);
-            splitter->agent_uuid = NULL;
-            free(splitter->output_name);
-            splitter->output_name = NULL;
-            igs_queued_work_t *work_elt, *work_tmp;
-            LL_FOREACH_SAFE(splitter->queued_works, work_elt, work_tmp){
-                LL_DELETE(splitter->queued_works, work_elt);
-                if(work_elt->value_type == IGS_DATA_T){
-                    free(work_elt->value.data);
-                    work_elt->value.data = NULL;
-                }else if(work_elt->value_type == IGS_STRING_T){
-                    free(work_elt->value.s);
-                    work_elt->value.s = NULL;
-                }
-                free(work_elt);
+        case IGS_IMPULSION_T:
+        default:
+            break;
+    }
+}
+
+void s_split_queue_push (igs_splitter_t *splitter, const igs_iop_t *output)
+{
+    assert (splitter->queue_size < splitter->queue_capacity);
+    size_t index = (splitter->queue_head + splitter->queue_size) % splitter->queue_capacity;
+    s_split_queue_set_work (&splitter->queued_works[index], output);
+    splitter->queue_size++;
+}
+
+// replace a queued work having the same key as the new value : same split
+// key if the output has one, any queued value of this output otherwise,
+// in which case the newest one is replaced to keep the order of the others
+bool s_split_queue_coalesce (igs_splitter_t *splitter, const igs_iop_t *output)
+{
+    if (splitter->queue_size == 0)
+        return false;
+    size_t i = splitter->queue_size;
+    if (output->split_key){
+        uint64_t key_hash = s_split_hash (IGS_SPLIT_HASH_INIT, output->split_key, strlen (output->split_key));
+        while (i-- > 0){
+            igs_queued_work_t *work = &splitter->queued_works[(splitter->queue_head + i) % splitter->queue_capacity];
+            if (work->has_split_key && work->key_hash == key_hash){
+                s_split_queue_set_work (work, output);
+                return true;
             }
-            free(splitter->queued_works);
-            splitter->queued_works = NULL;
-            free(splitter);
         }
+        return false;
+    }
+    igs_queued_work_t *newest = &splitter->queued_works[(splitter->queue_head + i - 1) % splitter->queue_capacity];
+    if (newest->has_split_key)
+        return false;
+    s_split_queue_set_work (newest, output);
+    return true;
+}
+
+// move a work (and its buffer) in front of the queue
+void s_split_queue_push_front (igs_splitter_t *splitter, igs_queued_work_t *work)
+{
+    assert (splitter->queue_size < splitter->queue_capacity);
+    size_t index = (splitter->queue_head + splitter->queue_capacity - 1) % splitter->queue_capacity;
+    igs_queued_work_t *slot = &splitter->queued_works[index];
+    if (slot->buffer)
+        free (slot->buffer);
+    *slot = *work;
+    work->buffer = NULL;
+    work->buffer_size = 0;
+    splitter->queue_head = index;
+    splitter->queue_size++;
+}
+
+void s_split_queue_resize (igs_splitter_t *splitter, size_t capacity)
+{
+    assert (capacity > 0);
+    if (capacity == splitter->queue_capacity)
+        return;
+    // oldest works are dropped when shrinking
+    while (splitter->queue_size > capacity){
+        s_split_queue_pop (splitter);
+        splitter->queue_dropped++;
+    }
+    igs_queued_work_t *works = (igs_queued_work_t *) zmalloc (capacity * sizeof (igs_queued_work_t));
+    size_t i = 0;
+    for (i = 0; i < splitter->queue_capacity; i++){
+        // keep pending works first, then the other slots and their buffers
+        igs_queued_work_t *slot = &splitter->queued_works[(splitter->queue_head + i) % splitter->queue_capacity];
+        if (i < capacity)
+            works[i] = *slot;
+        else if (slot->buffer)
+            free (slot->buffer);
+    }
+    if (splitter->queued_works)
+        free (splitter->queued_works);
+    splitter->queued_works = works;
+    splitter->queue_capacity = capacity;
+    splitter->queue_head = 0;
+}
+
+void s_split_free_dispatch (igs_split_dispatch_t **dispatch)
+{
+    assert (dispatch);
+    assert (*dispatch);
+    for (size_t i = 0; i < (*dispatch)->works_nb; i++){
+        if ((*dispatch)->works[i].buffer)
+            free ((*dispatch)->works[i].buffer);
+    }
+    free ((*dispatch)->works);
+    free (*dispatch);
+    *dispatch = NULL;
+}
+
+// works not acknowledged yet go back in front of the queue, unless they
+// reached their max number of retries
+void s_split_requeue_dispatch (igs_splitter_t *splitter, igs_split_dispatch_t **dispatch)
+{
+    assert (splitter);
+    assert (dispatch);
+    assert (*dispatch);
+    size_t i = (*dispatch)->works_nb;
+    while (i-- > (*dispatch)->works_acknowledged){
+        igs_queued_work_t *work = &(*dispatch)->works[i];
+        if (work->retries >= splitter->max_retries){
+            igs_warn ("split work for %s reached its max number of retries : dropping it", splitter->output_name);
+            splitter->queue_dropped++;
+        } else if (splitter->queue_size == splitter->queue_capacity){
+            igs_warn ("split queue for %s is full : dropping requeued work", splitter->output_name);
+            splitter->queue_dropped++;
+        } else {
+            work->retries++;
+            s_split_queue_push_front (splitter, work);
+            splitter->works_requeued++;
+        }
+    }
+    s_split_free_dispatch (dispatch);
+}
+
+void s_split_free_worker (igs_worker_t **worker)
+{
+    assert (worker);
+    assert (*worker);
+    igs_split_dispatch_t *dispatch, *tmp_dispatch;
+    DL_FOREACH_SAFE ((*worker)->dispatches, dispatch, tmp_dispatch){
+        DL_DELETE ((*worker)->dispatches, dispatch);
+        s_split_free_dispatch (&dispatch);
+    }
+    free ((*worker)->key);
+    free ((*worker)->agent_uuid);
+    free ((*worker)->input_name);
+    free (*worker);
+    *worker = NULL;
+}
+
+void s_split_free_splitter (igs_splitter_t **splitter)
+{
+    assert (splitter);
+    assert (*splitter);
+    igs_worker_t *worker, *tmp_worker;
+    HASH_ITER (hh, (*splitter)->workers, worker, tmp_worker){
+        HASH_DEL ((*splitter)->workers, worker);
+        s_split_free_worker (&worker);
+    }
+    if ((*splitter)->workers_heap)
+        free ((*splitter)->workers_heap);
+    if ((*splitter)->ring)
+        free ((*splitter)->ring);
+    for (size_t i = 0; i < (*splitter)->queue_capacity; i++){
+        if ((*splitter)->queued_works[i].buffer)
+            free ((*splitter)->queued_works[i].buffer);
+    }
+    if ((*splitter)->queued_works)
+        free ((*splitter)->queued_works);
+    free ((*splitter)->key);
+    free ((*splitter)->agent_uuid);
+    free ((*splitter)->output_name);
+    free (*splitter);
+    *splitter = NULL;
+}
+
+void s_split_index_worker (igs_core_context_t *context, igs_worker_t *worker)
+{
+    assert (context);
+    assert (worker);
+    igs_split_agent_t *split_agent = NULL;
+    HASH_FIND_STR (context->split_agents, worker->agent_uuid, split_agent);
+    if (!split_agent) {
+        split_agent = (igs_split_agent_t *) zmalloc (sizeof (igs_split_agent_t));
+        split_agent->agent_uuid = strdup (worker->agent_uuid);
+        HASH_ADD_KEYPTR (hh, context->split_agents, split_agent->agent_uuid,
+                         strlen (split_agent->agent_uuid), split_agent);
     }
+    DL_APPEND2 (split_agent->workers, worker, agent_prev, agent_next);
+}
+
+void s_split_unindex_worker (igs_core_context_t *context, igs_worker_t *worker)
+{
+    assert (context);
+    assert (worker);
+    igs_split_agent_t *split_agent = NULL;
+    HASH_FIND_STR (context->split_agents, worker->agent_uuid, split_agent);
+    if (!split_agent)
+        return;
+    DL_DELETE2 (split_agent->workers, worker, agent_prev, agent_next);
+    if (!split_agent->workers) {
+        HASH_DEL (context->split_agents, split_agent);
+        free (split_agent->agent_uuid);
+        free (split_agent);
+    }
+}
+
+void s_split_remove_worker_from_splitter (igs_core_context_t *context, igs_splitter_t *splitter,
+                                          igs_worker_t *worker)
+{
+    assert (context);
+    assert (splitter);
+    assert (worker);
+    // newest messages first so that works keep their order in the queue
+    while (worker->dispatches){
+        igs_split_dispatch_t *dispatch = worker->dispatches->prev;
+        DL_DELETE (worker->dispatches, dispatch);
+        s_split_requeue_dispatch (splitter, &dispatch);
+    }
+    HASH_DEL (splitter->workers, worker);
+    s_split_unindex_worker (context, worker);
+    s_split_heap_remove (splitter, worker);
+    splitter->ring_is_dirty = true;
+    s_split_free_worker (&worker);
 }
 
 igs_split_t *split_create_split_element (const char *from_input,
@@ -91,156 +545,234 @@ igs_split_t *split_create_split_element (const char *from_input,
     return new_split_elmt;
 }
 
-void s_split_trigger_send_message_to_worker (igs_core_context_t *context, char *agent_uuid, const igs_iop_t *output)
+void s_split_add_work_to_message (zmsg_t *msg, igs_queued_work_t *work)
+{
+    switch (work->value_type) {
+        case IGS_INTEGER_T:
+            zmsg_addmem(msg, &(work->value.i), sizeof(int));
+            break;
+        case IGS_DOUBLE_T:
+            zmsg_addmem(msg, &(work->value.d), sizeof(double));
+            break;
+        case IGS_BOOL_T:
+            zmsg_addmem(msg, &(work->value.b), sizeof(bool));
+            break;
+        case IGS_STRING_T:
+            zmsg_addstr(msg, work->value.s);
+            break;
+        case IGS_IMPULSION_T:
+            zmsg_addmem(msg, NULL, 0);
+            break;
+        case IGS_DATA_T:{
+            zframe_t *frame = zframe_new (work->value.data, work->value_size);
+            zmsg_append(msg, &frame);}
+            break;
+        default:
+            break;
+    }
+}
+
+void s_split_dispatch_works (igs_core_context_t *context, igs_splitter_t *splitter)
 {
     assert(context);
-    assert(agent_uuid);
-    assert(output);
+    assert(splitter);
+    // send queued works as long as workers have credit
+    while (splitter->queue_size > 0 && splitter->workers_heap_size > 0){
+        igs_queued_work_t *work = s_split_queue_front (splitter);
+        igs_worker_t *max_credit_worker = splitter->workers_heap[0];
+        if (splitter->scheduling == IGS_SPLIT_SCHEDULING_KEY_AFFINITY)
+            // works wait for the worker owning their key
+            max_credit_worker = s_split_ring_find (splitter, s_split_work_key_hash (splitter, work));
+        if(max_credit_worker->credit <= 0)
+            break;
+        if (splitter->scheduling == IGS_SPLIT_SCHEDULING_POWER_OF_TWO
+            && splitter->workers_heap_size > 1){
+            // best of two random workers having credit, if any
+            igs_worker_t *first = splitter->workers_heap[randof (splitter->workers_heap_size)];
+            igs_worker_t *second = splitter->workers_heap[randof (splitter->workers_heap_size)];
+            if (first->credit <= 0)
+                first = second;
+            if (second->credit <= 0)
+                second = first;
+            if (first->credit > 0)
+                max_credit_worker = (s_split_worker_expected_time (second) < s_split_worker_expected_time (first)) ? second : first;
+        }
+        // works sent in a single message must share the same value type
+        // (and the same worker for key affinity)
+        size_t max_works = (max_credit_worker->batch_size > 1) ? max_credit_worker->batch_size : 1;
+        if (max_works > (size_t) max_credit_worker->credit)
+            max_works = (size_t) max_credit_worker->credit;
+        size_t works_nb = 1;
+        while (works_nb < max_works && works_nb < splitter->queue_size){
+            igs_queued_work_t *next_work = &splitter->queued_works[(splitter->queue_head + works_nb) % splitter->queue_capacity];
+            if (next_work->value_type != work->value_type
+                || (splitter->scheduling == IGS_SPLIT_SCHEDULING_KEY_AFFINITY
+                    && s_split_ring_find (splitter, s_split_work_key_hash (splitter, next_work)) != max_credit_worker))
+                break;
+            works_nb++;
+        }
 
-    igs_splitter_t *splitter = NULL;
-    //FIXME: splitters should be stored in a hash and not a list, and searched by uuid
-    LL_FOREACH(context->splitters, splitter){
-        if(streq(splitter->agent_uuid, agent_uuid) && streq(splitter->output_name, output->name)){
-            igs_worker_t *worker = NULL;
-            igs_worker_t *max_credit_worker = NULL;
-            LL_FOREACH(splitter->workers_list, worker){
-                if(!max_credit_worker //init with 1st worker in list
-                   || max_credit_worker->credit < worker->credit //take worker with more credits
-                   || (max_credit_worker->credit == worker->credit //take worker with same credits but less uses
-                       && worker->uses < max_credit_worker->uses))
-                    max_credit_worker = worker;
-            }
-            if(max_credit_worker && max_credit_worker->credit > 0){
-                igs_queued_work_t *work = splitter->queued_works;
-                if(work){
-                    zmsg_t *readyMessage = zmsg_new();
-                    zmsg_addstr(readyMessage, SPLITTER_WORK_MSG);
-                    zmsg_addstr(readyMessage, splitter->agent_uuid );
-                    zmsg_addstr(readyMessage, max_credit_worker->input_name);
-                    zmsg_addstr(readyMessage, output->name);
-                    zmsg_addstrf(readyMessage, "%d", output->value_type);
-                    switch (output->value_type) {
-                        case IGS_INTEGER_T:
-                            zmsg_addmem(readyMessage, &(work->value.i), sizeof(int));
-                            break;
-                        case IGS_DOUBLE_T:
-                            zmsg_addmem(readyMessage, &(work->value.d), sizeof(double));
-                            break;
-                        case IGS_BOOL_T:
-                            zmsg_addmem(readyMessage, &(work->value.b), sizeof(bool));
-                            break;
-                        case IGS_STRING_T:
-                            zmsg_addstr(readyMessage, work->value.s);
-                            break;
-                        case IGS_IMPULSION_T:
-                            zmsg_addmem(readyMessage, NULL, 0);
-                            break;
-                        case IGS_DATA_T:{
-                            zframe_t *frame = zframe_new (work->value.data, work->value_size);
-                            zmsg_append(readyMessage, &frame);}
-                            break;
-                        default:
-                            break;
-                    }
-                    if (context->node != NULL) {
-                        igsagent_t *local_agent, *atmp;
-                        HASH_ITER(hh, context->agents, local_agent, atmp){
-                            if(streq(local_agent->uuid, agent_uuid)){
-                                igs_remote_agent_t *remote_agent, *rtmp;
-                                HASH_ITER(hh, context->remote_agents, remote_agent, rtmp){
-                                    if(streq(remote_agent->uuid, max_credit_worker->agent_uuid)){
-                                        zyre_shouts (context->node, local_agent->igs_channel,
-                                                     "SPLIT %s(%s).%s to %s(%s).%s",
-                                                     local_agent->definition->name,
-                                                     splitter->agent_uuid,
-                                                     output->name,
-                                                     remote_agent->definition->name,
-                                                     max_credit_worker->agent_uuid,
-                                                     max_credit_worker->input_name);
-                                    }
-                                }
-                            }
-                        }
-                    }
+        if (max_credit_worker->is_local && !context->split_local_pusher){
+            // local threads are (re)started with local workers refresh
+            context->split_local_workers_are_dirty = true;
+            break;
+        }
 
-                    igs_channel_whisper_zmsg(max_credit_worker->agent_uuid, &readyMessage);
-                    
-                    LL_DELETE(splitter->queued_works, work);
-                    switch(work->value_type){
-                        case IGS_STRING_T:
-                            free(work->value.s);
-                            work->value.s = NULL;
-                            break;
-                        case IGS_DATA_T:
-                            free(work->value.data);
-                            work->value.data = NULL;
-                            break;
-                        default:
-                            break;
-                    }
-                    free(work);
-                    max_credit_worker->uses++;
-                    max_credit_worker->credit--;
-                }
+        zmsg_t *readyMessage = zmsg_new();
+        zmsg_addstr(readyMessage, (works_nb > 1) ? SPLITTER_WORKS_MSG : SPLITTER_WORK_MSG);
+        zmsg_addstr(readyMessage, splitter->agent_uuid );
+        zmsg_addstr(readyMessage, max_credit_worker->input_name);
+        zmsg_addstr(readyMessage, splitter->output_name);
+        zmsg_addstrf(readyMessage, "%d", work->value_type);
+        if (works_nb > 1)
+            zmsg_addstrf(readyMessage, "%zu", works_nb);
+        // works are moved with their buffers to the dispatch, which keeps
+        // them until they are acknowledged
+        igs_split_dispatch_t *dispatch = (igs_split_dispatch_t *) zmalloc (sizeof (igs_split_dispatch_t));
+        dispatch->works = (igs_queued_work_t *) zmalloc (works_nb * sizeof (igs_queued_work_t));
+        dispatch->works_nb = works_nb;
+        for (size_t i = 0; i < works_nb; i++){
+            igs_queued_work_t *slot = s_split_queue_front (splitter);
+            s_split_add_work_to_message (readyMessage, slot);
+            dispatch->works[i] = *slot;
+            slot->buffer = NULL;
+            slot->buffer_size = 0;
+            s_split_queue_pop (splitter);
+        }
+        if (max_credit_worker->is_local){
+            // in-memory delivery to our split threads, with the worker uuid
+            // at the end as done by igs_channel_whisper_zmsg
+            zmsg_addstr(readyMessage, max_credit_worker->agent_uuid);
+            if (zmsg_send (&readyMessage, context->split_local_pusher) != 0){
+                // works go back in front of the queue, in order, without
+                // using the credit of the worker : next dispatch retries
+                igs_error ("could not push split works to local worker %s", max_credit_worker->agent_uuid);
+                zmsg_destroy (&readyMessage);
+                size_t i = works_nb;
+                while (i-- > 0)
+                    s_split_queue_push_front (splitter, &dispatch->works[i]);
+                s_split_free_dispatch (&dispatch);
+                break;
             }
-            break;
         }
+        igsagent_t *splitter_agent = NULL;
+        igs_remote_agent_t *remote_worker = NULL;
+        if (!max_credit_worker->is_local){
+            HASH_FIND_STR (context->agents, splitter->agent_uuid, splitter_agent);
+            HASH_FIND_STR (context->remote_agents, max_credit_worker->agent_uuid, remote_worker);
+        }
+        if (splitter_agent && remote_worker && remote_worker->definition){
+            size_t works_size = 0;
+            for (size_t i = 0; i < works_nb; i++)
+                works_size += dispatch->works[i].value_size;
+            network_telemetry_add (context, splitter_agent->igs_channel, works_size,
+                                   "SPLIT %s(%s).%s to %s(%s).%s",
+                                   splitter_agent->definition->name,
+                                   splitter->agent_uuid,
+                                   splitter->output_name,
+                                   remote_worker->definition->name,
+                                   max_credit_worker->agent_uuid,
+                                   max_credit_worker->input_name);
+        }
+
+        if (!max_credit_worker->is_local)
+            igs_channel_whisper_zmsg(max_credit_worker->agent_uuid, &readyMessage);
+        if (readyMessage)
+            zmsg_destroy (&readyMessage); // worker could not be reached
+        dispatch->timestamp = zclock_usecs ();
+        DL_APPEND (max_credit_worker->dispatches, dispatch);
+        max_credit_worker->works_in_flight += works_nb;
+        max_credit_worker->uses += (int) works_nb;
+        if (max_credit_worker->uses > splitter->workers_max_uses)
+            splitter->workers_max_uses = max_credit_worker->uses;
+        max_credit_worker->credit -= (int) works_nb;
+        s_split_heap_update (splitter, max_credit_worker);
     }
 }
 
-void split_add_work_to_queue (igs_core_context_t *context, char* agent_uuid, const igs_iop_t *output)
+void s_split_trigger_send_message_to_worker (igs_core_context_t *context, char *agent_uuid, const igs_iop_t *output)
 {
     assert(context);
     assert(agent_uuid);
     assert(output);
-    assert(output->name);
+    igs_splitter_t *splitter = s_split_find_splitter (context, agent_uuid, output->name);
+    if (splitter)
+        s_split_dispatch_works (context, splitter);
+}
 
-    if(context->splitters){
-        igs_splitter_t *splitter = NULL;
-        LL_FOREACH(context->splitters, splitter){
-            if(splitter->workers_list
-               && streq(splitter->agent_uuid, agent_uuid)
-               && streq(splitter->output_name, output->name)){
-                igs_queued_work_t *new_work = (igs_queued_work_t *) zmalloc (sizeof(igs_queued_work_t));
-                new_work->value_size = output->value_size;
-                new_work->value_type = output->value_type;
-                new_work->next = NULL;
-                switch (output->value_type) {
-                    case IGS_INTEGER_T:
-                        new_work->value.i = output->value.i;
-                        break;
-                    case IGS_DOUBLE_T:
-                        new_work->value.d = output->value.d;
-                        break;
-                    case IGS_BOOL_T:
-                        new_work->value.b = output->value.b;
-                        break;
-                    case IGS_STRING_T:
-                        new_work->value.s = strdup(output->value.s);
-                        break;
-                    case IGS_IMPULSION_T:
-                        break;
-                    case IGS_DATA_T:
-                        new_work->value.data = (void *)zmalloc( output->value_size);
-                        memcpy(new_work->value.data, output->value.data, output->value_size);
-                        break;
-                    default:
-                        break;
-                }
-                LL_APPEND(splitter->queued_works, new_work);
-            }
-        }
-        s_split_trigger_send_message_to_worker(context, agent_uuid, output);
+void split_remove_worker (igs_core_context_t *context, char *uuid, char *input_name)
+{
+    assert(uuid);
+    assert(context);
+    igs_split_agent_t *split_agent = NULL;
+    HASH_FIND_STR (context->split_agents, uuid, split_agent);
+    if (!split_agent)
+        return;
+    // all the workers are removed before their splitters dispatch works
+    // NB: split_agent is freed with its last worker
+    zlist_t *splitters = zlist_new ();
+    igs_worker_t *worker, *tmp_worker;
+    DL_FOREACH_SAFE2 (split_agent->workers, worker, tmp_worker, agent_next){
+        if (input_name && !streq (input_name, worker->input_name))
+            continue;
+        if (!zlist_exists (splitters, worker->splitter))
+            zlist_append (splitters, worker->splitter);
+        s_split_remove_worker_from_splitter (context, worker->splitter, worker);
+    }
+    igs_splitter_t *splitter = (igs_splitter_t *) zlist_first (splitters);
+    while (splitter) {
+        // splitters without workers are kept as long as they have works
+        if (splitter->workers == NULL && splitter->queue_size == 0) {
+            HASH_DEL (context->splitters, splitter);
+            s_split_free_splitter (&splitter);
+        } else
+            s_split_dispatch_works (context, splitter);
+        splitter = (igs_splitter_t *) zlist_next (splitters);
     }
+    zlist_destroy (&splitters);
 }
 
 ////////////////////////////////////////////////////////////////////////
 // Handler for message from worker or splitter
 ////////////////////////////////////////////////////////////////////////
 
+// update service time with the oldest messages sent to this worker
+void s_split_acknowledge_works (igs_worker_t *worker, size_t works_nb)
+{
+    int64_t now = zclock_usecs ();
+    // late acknowledgments of timed out works, which have been requeued
+    size_t expired = (works_nb < worker->works_expired) ? works_nb : worker->works_expired;
+    worker->works_expired -= expired;
+    works_nb -= expired;
+    while (works_nb > 0 && worker->dispatches){
+        igs_split_dispatch_t *dispatch = worker->dispatches;
+        size_t remaining = dispatch->works_nb - dispatch->works_acknowledged;
+        size_t acknowledged = (works_nb < remaining) ? works_nb : remaining;
+        dispatch->works_acknowledged += acknowledged;
+        works_nb -= acknowledged;
+        worker->works_in_flight -= (acknowledged < worker->works_in_flight) ? acknowledged : worker->works_in_flight;
+        worker->works_done += acknowledged;
+        if (dispatch->works_acknowledged == dispatch->works_nb){
+            // at least one usec so that zero keeps meaning not measured
+            int64_t service_time = (now - dispatch->timestamp) / (int64_t) dispatch->works_nb;
+            if (service_time < 1)
+                service_time = 1;
+            if (worker->service_time == 0)
+                worker->service_time = service_time;
+            else
+                worker->service_time = (int64_t) (IGS_SPLIT_SERVICE_TIME_EWMA_ALPHA * (double) service_time
+                                                  + (1 - IGS_SPLIT_SERVICE_TIME_EWMA_ALPHA) * (double) worker->service_time);
+            if (service_time > worker->service_time_max)
+                worker->service_time_max = service_time;
+            DL_DELETE (worker->dispatches, dispatch);
+            s_split_free_dispatch (&dispatch);
+        }
+    }
+}
 
 void s_split_add_credit_to_worker (igs_core_context_t *context, char* agent_uuid, igs_iop_t* output,
-                                   char* worker_uuid, char* input_name, int credit, bool new_worker)
+                                   char* worker_uuid, char* input_name, int credit, bool new_worker,
+                                   size_t batch_size)
 {
     assert(context);
     assert(agent_uuid);
@@ -249,48 +781,78 @@ void s_split_add_credit_to_worker (igs_core_context_t *context, char* agent_uuid
     assert(output);
     assert(output->name);
 
-    bool worker_found = false;
-    bool splitter_found = false;
-    igs_splitter_t *splitter;
-    LL_FOREACH(context->splitters, splitter){
-        if(streq(splitter->agent_uuid, agent_uuid)
-           && streq(splitter->output_name, output->name)){
-            igs_worker_t *worker = NULL;
-            int maxUses = 0;
-            LL_FOREACH(splitter->workers_list, worker){
-                if(streq(worker_uuid, worker->agent_uuid)
-                   && streq(input_name, worker->input_name)){
-                    worker->credit += credit;
-                    worker_found = true;
-                }
-                if (maxUses < worker->uses)
-                    maxUses = worker->uses;
-            }
-            if(!worker_found && new_worker){
-                igs_worker_t *new_w = (igs_worker_t *) zmalloc (sizeof(igs_worker_t));
-                new_w->agent_uuid = s_strndup(worker_uuid, strlen(worker_uuid));
-                new_w->input_name = s_strndup(input_name, strlen(input_name));
-                new_w->credit = credit;
-                new_w->uses = maxUses;
-                LL_APPEND(splitter->workers_list, new_w);
-            }
-            splitter_found = true;
-        }
+    igs_splitter_t *splitter = s_split_find_splitter (context, agent_uuid, output->name);
+    if(!splitter){
+        if (!new_worker)
+            return;
+        splitter = (igs_splitter_t *)zmalloc(sizeof(igs_splitter_t));
+        splitter->key = s_split_make_key (agent_uuid, output->name);
+        splitter->agent_uuid = s_strndup(agent_uuid, strlen(agent_uuid));
+        splitter->output_name = s_strndup(output->name, strlen(output->name));
+        igsagent_t *agent = NULL;
+        HASH_FIND_STR (context->agents, agent_uuid, agent);
+        if (agent){
+            splitter->queue_policy = agent->split_queue_policy;
+            splitter->scheduling = agent->split_scheduling;
+            splitter->key_prefix = agent->split_key_prefix;
+            splitter->work_timeout = agent->split_work_timeout;
+            splitter->max_retries = agent->split_max_retries;
+        } else
+            splitter->max_retries = IGS_DEFAULT_SPLIT_MAX_RETRIES;
+        s_split_queue_resize (splitter, s_split_queue_capacity_for_agent (context, agent_uuid));
+        HASH_ADD_KEYPTR (hh, context->splitters, splitter->key, strlen (splitter->key), splitter);
     }
-    if(!splitter_found && new_worker){
-        igs_splitter_t *new_splitter = (igs_splitter_t *)zmalloc(sizeof(igs_splitter_t));
-        new_splitter->agent_uuid = s_strndup(agent_uuid, strlen(agent_uuid));
-        new_splitter->output_name = s_strndup(output->name, strlen(output->name));
-        LL_APPEND(context->splitters, new_splitter);
-        igs_worker_t *new_w = (igs_worker_t *)zmalloc(sizeof(igs_worker_t));
+    char *worker_key = s_split_make_key (worker_uuid, input_name);
+    igs_worker_t *worker = NULL;
+    HASH_FIND_STR (splitter->workers, worker_key, worker);
+    if (worker){
+        worker->credit += credit;
+        if (new_worker)
+            worker->batch_size = batch_size;
+        else
+            s_split_acknowledge_works (worker, (size_t) credit);
+        s_split_heap_update (splitter, worker);
+        free (worker_key);
+    } else if (new_worker){
+        // new workers start with the max number of uses of the workers
+        // of this splitter so that they do not get all the work
+        igs_worker_t *new_w = (igs_worker_t *) zmalloc (sizeof(igs_worker_t));
+        new_w->key = worker_key;
         new_w->agent_uuid = s_strndup(worker_uuid, strlen(worker_uuid));
         new_w->input_name = s_strndup(input_name, strlen(input_name));
         new_w->credit = credit;
-        LL_APPEND(new_splitter->workers_list, new_w);
-    }
+        new_w->uses = splitter->workers_max_uses;
+        new_w->batch_size = batch_size;
+        new_w->splitter = splitter;
+        igsagent_t *local_worker = NULL;
+        HASH_FIND_STR (context->agents, worker_uuid, local_worker);
+        new_w->is_local = (local_worker != NULL);
+        HASH_ADD_KEYPTR (hh, splitter->workers, new_w->key, strlen (new_w->key), new_w);
+        s_split_index_worker (context, new_w);
+        s_split_heap_insert (splitter, new_w);
+        splitter->ring_is_dirty = true;
+    } else
+        free (worker_key);
     s_split_trigger_send_message_to_worker(context, agent_uuid, output);
 }
 
+void s_split_add_credit_for_output (igs_core_context_t *context, const char *agent_uuid, const char *output_name,
+                                    char *worker_uuid, char *input_name, int credit, bool new_worker,
+                                    size_t batch_size)
+{
+    assert(context);
+    assert(agent_uuid);
+    assert(output_name);
+    igsagent_t *agent = NULL;
+    HASH_FIND_STR (context->agents, agent_uuid, agent);
+    if (!agent || !agent->definition)
+        return;
+    igs_iop_t *iop = NULL;
+    HASH_FIND_STR (agent->definition->outputs_table, output_name, iop);
+    if (iop)
+        s_split_add_credit_to_worker (context, agent->uuid, iop, worker_uuid, input_name, credit, new_worker, batch_size);
+}
+
 int split_message_from_worker (char *command, zmsg_t *msg, igs_core_context_t *context)
 {
     assert(command);
@@ -314,67 +876,65 @@ int split_message_from_worker (char *command, zmsg_t *msg, igs_core_context_t *c
         free(outputName);
         return 1;
     }
-    
+
+    // splitters are also accessed by threads writing our outputs
+    model_read_write_lock (__FUNCTION__, __LINE__);
     if(streq(command, WORKER_HELLO_MSG)){
         char *creditStr = zmsg_popstr(msg);
-        int credit = atoi(creditStr);
+        int credit = (creditStr) ? atoi(creditStr) : 0;
         char *agent_uuid = zmsg_popstr(msg);
+        // optional batch size, after the splitter uuid
+        size_t batch_size = 1;
+        if (zmsg_size (msg) > 1){
+            char *batchStr = zmsg_popstr(msg);
+            if (batchStr && atoi(batchStr) > 1)
+                batch_size = (size_t) atoi(batchStr);
+            free(batchStr);
+        }
         if(!agent_uuid){
             igs_error ("no valid splitter uuid in message %s from worker %s : rejecting", command, worker_uuid);
+            model_read_write_unlock (__FUNCTION__, __LINE__);
+            free(creditStr);
             free(worker_uuid);
             free(inputName);
             free(outputName);
             return 1;
         }
-        igsagent_t *agent, *tmpAgent;
-        HASH_ITER(hh, context->agents, agent, tmpAgent){
-            if(streq(agent_uuid, agent->uuid)){
-                igs_iop_t *iop, *tmpIop;
-                HASH_ITER(hh, agent->definition->outputs_table, iop, tmpIop){
-                    if(!iop || !iop->name)
-                        continue;
-                    if (streq(outputName, iop->name)){
-                        s_split_add_credit_to_worker(context, agent->uuid, iop, worker_uuid, inputName, credit, true);
-                        break;
-                    }
-                }
-            }
-        }
+        s_split_add_credit_for_output (context, agent_uuid, outputName, worker_uuid, inputName, credit, true, batch_size);
         free(creditStr);
         free(agent_uuid);
     }else if(streq(command, WORKER_READY_MSG)){
+        // optional number of acknowledged works, before the splitter uuid
+        int credit = 1;
+        if (zmsg_size (msg) > 1){
+            char *countStr = zmsg_popstr(msg);
+            if (countStr && atoi(countStr) > 1)
+                credit = atoi(countStr);
+            free(countStr);
+        }
         char * agent_uuid = zmsg_popstr(msg);
         if(agent_uuid == NULL){
             igs_error ("no valid splitter uuid in message %s from worker %s : rejecting", command, worker_uuid);
+            model_read_write_unlock (__FUNCTION__, __LINE__);
             free(worker_uuid);
             free(inputName);
             free(outputName);
             return 1;
         }
-        igsagent_t *agent, *tmpAgent;
-        HASH_ITER(hh, context->agents, agent, tmpAgent){
-            if(streq(agent_uuid, agent->uuid)){
-                igs_iop_t *iop, *tmpIop;
-                HASH_ITER(hh, agent->definition->outputs_table, iop, tmpIop){
-                    if(!iop || !iop->name)
-                        continue;
-                    if (streq(outputName, iop->name)){
-                        s_split_add_credit_to_worker (context, agent->uuid, iop, worker_uuid, inputName, 1, false);
-                        break;
-                    }
-                }
-            }
-        }
+        s_split_add_credit_for_output (context, agent_uuid, outputName, worker_uuid, inputName, credit, false, 0);
         free(agent_uuid);
     }else if(streq(command, WORKER_GOODBYE_MSG))
         split_remove_worker(context, worker_uuid, inputName);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
     free(worker_uuid);
     free(inputName);
     free(outputName);
     return 0;
 }
 
-int split_message_from_splitter (zmsg_t *msg, igs_core_context_t *context)
+// works received from a splitter through the network or, for local
+// workers, from our split threads which acknowledge them directly
+int s_split_handle_works (zmsg_t *msg, igs_core_context_t *context, bool is_batch, bool is_local)
 {
     assert(msg);
     assert(context);
@@ -416,64 +976,54 @@ int split_message_from_splitter (zmsg_t *msg, igs_core_context_t *context)
         return 1;
     }
 
-    zframe_t *frame = NULL;
-    void *data = NULL;
-    size_t size = 0;
-    char * value = NULL;
-    if (valueType == IGS_STRING_T){
-        value = zmsg_popstr(msg);
-        if (value == NULL){
-            igs_error("value is NULL in received publication : rejecting");
-            free(agent_uuid);
-            free(inputName);
-            free(outputName);
-            return 1;
-        }
-    }else{
-        frame = zmsg_pop(msg);
-        if (!frame){
-            igs_error("value is NULL in received publication : rejecting");
-            free(agent_uuid);
-            free(inputName);
-            free(outputName);
-            return 1;
-        }
-        data = zframe_data(frame);
-        size = zframe_size(frame);
+    size_t worksNb = 1;
+    if (is_batch){
+        char *countStr = zmsg_popstr(msg);
+        worksNb = (countStr && atoi(countStr) > 0) ? (size_t) atoi(countStr) : 0;
+        free(countStr);
     }
-    
-    char * worker_uuid = zmsg_popstr(msg);
-    if(!worker_uuid){
-        igs_error ("no valid worker uuid in work message from splitter %s : rejecting", agent_uuid);
+    // values are followed by our uuid, added by the splitter
+    if (worksNb == 0 || zmsg_size(msg) != worksNb + 1){
+        igs_error("invalid number of values in work message from splitter %s : rejecting", agent_uuid);
         free(agent_uuid);
         free(inputName);
         free(outputName);
-        if (data != NULL)
-            free(data);
-        if (value != NULL)
-            free(value);
         return 1;
     }
-    
-    igsagent_t *tmp, *elt;
-    HASH_ITER(hh, core_context->agents, elt, tmp){
-        if (streq(elt->uuid, worker_uuid)){
-            if (valueType == IGS_STRING_T)
-                model_write_iop(elt, inputName, IGS_INPUT_T, valueType, value, strlen(value)+1);
-            else
-                model_write_iop(elt, inputName, IGS_INPUT_T, valueType, data, size);
-            break;
+    char * worker_uuid = zframe_strdup(zmsg_last(msg));
+    igsagent_t *worker = NULL;
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    HASH_FIND_STR (context->agents, worker_uuid, worker);
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+
+    for (size_t i = 0; i < worksNb; i++){
+        zframe_t *frame = zmsg_pop(msg);
+        if (worker && worker->uuid){
+            if (valueType == IGS_STRING_T){
+                char *value = zframe_strdup(frame);
+                model_write_iop(worker, inputName, IGS_INPUT_T, valueType, value, strlen(value)+1);
+                free(value);
+            }else
+                model_write_iop(worker, inputName, IGS_INPUT_T, valueType,
+                                zframe_data(frame), zframe_size(frame));
         }
-    }
-    if(frame)
         zframe_destroy(&frame);
-    if(elt && elt->uuid){
+    }
+    if(worker && worker->uuid && is_local){
+        model_read_write_lock (__FUNCTION__, __LINE__);
+        s_split_add_credit_for_output (context, agent_uuid, outputName, worker_uuid, inputName, (int) worksNb, false, 0);
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+    }else if(worker && worker->uuid){
         zmsg_t *readyMessage = zmsg_new();
         zmsg_addstr(readyMessage, WORKER_READY_MSG);
         zmsg_addstr(readyMessage, worker_uuid);
         zmsg_addstr(readyMessage, inputName);
         zmsg_addstr(readyMessage, outputName);
+        if (worksNb > 1)
+            zmsg_addstrf(readyMessage, "%zu", worksNb);
         igs_channel_whisper_zmsg(agent_uuid, &readyMessage);
+        if (readyMessage)
+            zmsg_destroy (&readyMessage);
     }
     free(worker_uuid);
     free(agent_uuid);
@@ -482,6 +1032,379 @@ int split_message_from_splitter (zmsg_t *msg, igs_core_context_t *context)
     return 0;
 }
 
+int split_message_from_splitter (zmsg_t *msg, igs_core_context_t *context, bool is_batch)
+{
+    return s_split_handle_works (msg, context, is_batch, false);
+}
+
+// workers need at least enough credit for a full batch
+int s_split_worker_credit (igsagent_t *agent)
+{
+    assert(agent);
+    int credit = IGS_DEFAULT_WORKER_CREDIT;
+    if (agent->split_batch_size > (size_t) credit)
+        credit = (int) agent->split_batch_size;
+    return credit;
+}
+
+void split_send_worker_hello (igsagent_t *agent, const char *input_name,
+                              const char *output_name, const char *splitter_agent)
+{
+    assert(agent);
+    assert(input_name);
+    assert(output_name);
+    assert(splitter_agent);
+    int credit = s_split_worker_credit (agent);
+    zmsg_t *ready_message = zmsg_new ();
+    zmsg_addstr (ready_message, WORKER_HELLO_MSG);
+    zmsg_addstr (ready_message, agent->uuid);
+    zmsg_addstr (ready_message, input_name);
+    zmsg_addstr (ready_message, output_name);
+    zmsg_addstrf (ready_message, "%i", credit);
+    if (agent->split_batch_size <= 1) {
+        igs_channel_whisper_zmsg (splitter_agent, &ready_message);
+        if (ready_message)
+            zmsg_destroy (&ready_message);
+        return;
+    }
+    // batch size goes after the splitter uuid, where splitters not
+    // supporting batches ignore it : the message is sent to each splitter
+    // agent with its uuid, which is added again at the end by the whisper
+    zlist_t *splitters = network_find_remote_agents (agent->context, splitter_agent);
+    igs_remote_agent_t *splitter = zlist_first (splitters);
+    while (splitter) {
+        zmsg_t *dup = zmsg_dup (ready_message);
+        zmsg_addstr (dup, splitter->uuid);
+        zmsg_addstrf (dup, "%zu", agent->split_batch_size);
+        igs_channel_whisper_zmsg (splitter->uuid, &dup);
+        if (dup)
+            zmsg_destroy (&dup);
+        splitter = zlist_next (splitters);
+    }
+    zlist_destroy (&splitters);
+    zmsg_destroy (&ready_message);
+}
+
+void s_split_local_endpoint (igs_core_context_t *context, char *endpoint, size_t size)
+{
+    snprintf (endpoint, size, "inproc://igs_split_%p", (void *) context);
+}
+
+// thread running the works of local workers
+void s_split_local_thread (zsock_t *pipe, void *args)
+{
+    igs_core_context_t *context = (igs_core_context_t *) args;
+    assert (context);
+    char endpoint[IGS_MAX_PEER_ID_LENGTH] = ">";
+    s_split_local_endpoint (context, endpoint + 1, sizeof (endpoint) - 1);
+    zsock_t *puller = zsock_new_pull (endpoint);
+    assert (puller);
+    zpoller_t *poller = zpoller_new (pipe, puller, NULL);
+    zsock_signal (pipe, 0);
+    while (true) {
+        void *which = zpoller_wait (poller, -1);
+        if (which != puller)
+            break; // $TERM from pipe or interrupted
+        zmsg_t *msg = zmsg_recv (puller);
+        if (!msg)
+            break;
+        char *title = zmsg_popstr (msg);
+        if (title)
+            s_split_handle_works (msg, context, streq (title, SPLITTER_WORKS_MSG), true);
+        free (title);
+        zmsg_destroy (&msg);
+    }
+    zpoller_destroy (&poller);
+    zsock_destroy (&puller);
+}
+
+// Model lock must be held when calling this function.
+void s_split_start_local_threads (igs_core_context_t *context)
+{
+    assert (context);
+    assert (context->split_local_pusher == NULL);
+    char endpoint[IGS_MAX_PEER_ID_LENGTH] = "@";
+    s_split_local_endpoint (context, endpoint + 1, sizeof (endpoint) - 1);
+    context->split_local_pusher = zsock_new_push (endpoint);
+    if (!context->split_local_pusher) {
+        igs_error ("could not create %s for local split workers", endpoint + 1);
+        return;
+    }
+    // never block while holding the model lock
+    zsock_set_sndtimeo (context->split_local_pusher, 0);
+    context->split_local_threads = (zactor_t **) zmalloc (context->split_local_threads_nb * sizeof (zactor_t *));
+    for (size_t i = 0; i < context->split_local_threads_nb; i++)
+        context->split_local_threads[i] = zactor_new (s_split_local_thread, context);
+    context->split_local_threads_started = context->split_local_threads_nb;
+}
+
+// Model lock must NOT be held when calling this function. Local workers
+// are removed with the threads : works pushed to the threads and not
+// acknowledged yet are requeued, and the workers come back with their full
+// credit at the next refresh.
+void split_stop_local_threads (igs_core_context_t *context)
+{
+    assert (context);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    igs_splitter_t *splitter, *tmp;
+    HASH_ITER (hh, context->splitters, splitter, tmp){
+        igs_worker_t *worker, *tmp_worker;
+        HASH_ITER (hh, splitter->workers, worker, tmp_worker){
+            if (worker->is_local)
+                s_split_remove_worker_from_splitter (context, splitter, worker);
+        }
+        if (splitter->workers == NULL && splitter->queue_size == 0) {
+            HASH_DEL (context->splitters, splitter);
+            s_split_free_splitter (&splitter);
+        } else
+            s_split_dispatch_works (context, splitter);
+    }
+    zactor_t **threads = context->split_local_threads;
+    size_t threads_nb = context->split_local_threads_started;
+    zsock_t *pusher = context->split_local_pusher;
+    context->split_local_threads = NULL;
+    context->split_local_threads_started = 0;
+    context->split_local_pusher = NULL;
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    // threads may need the model lock to finish their current works
+    for (size_t i = 0; i < threads_nb; i++)
+        zactor_destroy (&threads[i]);
+    if (threads)
+        free (threads);
+    if (pusher)
+        zsock_destroy (&pusher);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    context->split_local_workers_are_dirty = true;
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+bool s_split_local_worker_has_split (igsagent_t *worker_agent, const char *input_name,
+                                     const char *splitter_name, const char *output_name)
+{
+    assert (worker_agent);
+    if (!worker_agent->mapping)
+        return false;
+    igs_split_t *elt, *tmp;
+    HASH_ITER (hh, worker_agent->mapping->split_elements, elt, tmp){
+        if (streq (elt->from_input, input_name)
+            && streq (elt->to_agent, splitter_name)
+            && streq (elt->to_output, output_name))
+            return true;
+    }
+    return false;
+}
+
+// Agents of our context do not receive our own zyre messages : local
+// workers are registered here, when agents or splits have changed.
+// Model lock must be held when calling this function.
+void s_split_refresh_local_workers (igs_core_context_t *context)
+{
+    assert (context);
+    context->split_local_workers_are_dirty = false;
+    // remove local workers which left or do not split their splitter anymore
+    bool has_local_workers = false;
+    igs_splitter_t *splitter, *tmp;
+    HASH_ITER (hh, context->splitters, splitter, tmp){
+        igsagent_t *splitter_agent = NULL;
+        HASH_FIND_STR (context->agents, splitter->agent_uuid, splitter_agent);
+        igs_worker_t *worker, *tmp_worker;
+        HASH_ITER (hh, splitter->workers, worker, tmp_worker){
+            if (!worker->is_local)
+                continue;
+            igsagent_t *worker_agent = NULL;
+            HASH_FIND_STR (context->agents, worker->agent_uuid, worker_agent);
+            if (splitter_agent && worker_agent
+                && s_split_local_worker_has_split (worker_agent, worker->input_name,
+                                                   splitter_agent->definition->name,
+                                                   splitter->output_name))
+                has_local_workers = true;
+            else
+                s_split_remove_worker_from_splitter (context, splitter, worker);
+        }
+        if (splitter->workers == NULL && splitter->queue_size == 0) {
+            HASH_DEL (context->splitters, splitter);
+            s_split_free_splitter (&splitter);
+        }
+    }
+    // add new local workers
+    igsagent_t *worker_agent, *tmp_worker_agent;
+    HASH_ITER (hh, context->agents, worker_agent, tmp_worker_agent){
+        if (!worker_agent->mapping)
+            continue;
+        igs_split_t *elt, *tmp_elt;
+        HASH_ITER (hh, worker_agent->mapping->split_elements, elt, tmp_elt){
+            igsagent_t *splitter_agent, *tmp_splitter_agent;
+            HASH_ITER (hh, context->agents, splitter_agent, tmp_splitter_agent){
+                if (splitter_agent == worker_agent
+                    || !streq (splitter_agent->definition->name, elt->to_agent))
+                    continue;
+                has_local_workers = true;
+                splitter = s_split_find_splitter (context, splitter_agent->uuid, elt->to_output);
+                if (splitter) {
+                    char *worker_key = s_split_make_key (worker_agent->uuid, elt->from_input);
+                    igs_worker_t *worker = NULL;
+                    HASH_FIND_STR (splitter->workers, worker_key, worker);
+                    free (worker_key);
+                    if (worker)
+                        continue;
+                }
+                s_split_add_credit_for_output (context, splitter_agent->uuid, elt->to_output,
+                                               worker_agent->uuid, elt->from_input,
+                                               s_split_worker_credit (worker_agent), true,
+                                               (worker_agent->split_batch_size > 1) ? worker_agent->split_batch_size : 1);
+            }
+        }
+    }
+    if (has_local_workers && !context->split_local_pusher) {
+        s_split_start_local_threads (context);
+        HASH_ITER (hh, context->splitters, splitter, tmp)
+            s_split_dispatch_works (context, splitter);
+    }
+}
+
+const igs_iop_t *split_add_work_to_queue (igs_core_context_t *context, char* agent_uuid, const igs_iop_t *output)
+{
+    assert(context);
+    assert(agent_uuid);
+    assert(output);
+    assert(output->name);
+
+    if (context->split_local_workers_are_dirty)
+        s_split_refresh_local_workers (context);
+    igs_splitter_t *splitter = s_split_find_splitter (context, agent_uuid, output->name);
+    if(!splitter)
+        return output;
+    if(splitter->workers){
+        if (splitter->queue_size == splitter->queue_capacity){
+            igs_queue_policy_t policy = splitter->queue_policy;
+            if (policy == IGS_QUEUE_BLOCK && network_is_loop_thread (context)){
+                // acknowledgments of our workers are handled by this very
+                // thread : waiting for them would only reach the timeout
+                igs_warn ("split queue for %s is full and cannot block the ingescape thread : dropping new value",
+                          output->name);
+                policy = IGS_QUEUE_DROP_NEWEST;
+            }
+            switch (policy) {
+                case IGS_QUEUE_DROP_NEWEST:
+                    igs_debug ("split queue for %s is full : dropping new value", output->name);
+                    splitter->queue_dropped++;
+                    s_split_trigger_send_message_to_worker (context, agent_uuid, output);
+                    return output;
+                case IGS_QUEUE_BLOCK:{
+                    // wait for workers to acknowledge works, model must be
+                    // unlocked meanwhile for their messages to be handled
+                    char *uuid = strdup (agent_uuid);
+                    char *output_name = strdup (output->name);
+                    int64_t deadline = zclock_mono () + IGS_SPLIT_QUEUE_BLOCK_TIMEOUT;
+                    while (splitter && splitter->queue_size == splitter->queue_capacity
+                           && zclock_mono () < deadline){
+                        model_read_write_unlock (__FUNCTION__, __LINE__);
+                        zclock_sleep (1);
+                        model_read_write_lock (__FUNCTION__, __LINE__);
+                        splitter = s_split_find_splitter (context, uuid, output_name);
+                    }
+                    // agent and output may have been destroyed when we were unlocked
+                    igsagent_t *agent = NULL;
+                    igs_iop_t *found = NULL;
+                    HASH_FIND_STR (context->agents, uuid, agent);
+                    if (agent && agent->uuid && agent->definition)
+                        HASH_FIND_STR (agent->definition->outputs_table, output_name, found);
+                    free (uuid);
+                    free (output_name);
+                    if (!found)
+                        return NULL;
+                    output = found;
+                    agent_uuid = agent->uuid;
+                    if (!splitter || !splitter->workers)
+                        return output;
+                    if (splitter->queue_size == splitter->queue_capacity){
+                        igs_warn ("split queue for %s is still full after %d ms : dropping new value",
+                                  output->name, IGS_SPLIT_QUEUE_BLOCK_TIMEOUT);
+                        splitter->queue_dropped++;
+                        return output;
+                    }
+                    break;
+                }
+                case IGS_QUEUE_COALESCE:
+                    if (s_split_queue_coalesce (splitter, output)){
+                        igs_debug ("split queue for %s is full : coalescing new value", output->name);
+                        splitter->queue_dropped++;
+                        s_split_trigger_send_message_to_worker (context, agent_uuid, output);
+                        return output;
+                    }
+                    // no queued value with the same key : drop the oldest one
+                    // fall through
+                case IGS_QUEUE_DROP_OLDEST:
+                default:
+                    igs_debug ("split queue for %s is full : dropping oldest value", output->name);
+                    s_split_queue_pop (splitter);
+                    splitter->queue_dropped++;
+                    break;
+            }
+        }
+        s_split_queue_push (splitter, output);
+    }
+    s_split_trigger_send_message_to_worker(context, agent_uuid, output);
+    return output;
+}
+
+int split_check_timeouts (zloop_t *loop, int timer_id, void *arg)
+{
+    igs_core_context_t *context = (igs_core_context_t *) arg;
+    assert (context);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // timer is armed again when a work timeout is set
+    bool has_timeouts = false;
+    igsagent_t *agent, *tmp_agent;
+    HASH_ITER (hh, context->agents, agent, tmp_agent){
+        if (agent->split_work_timeout > 0) {
+            has_timeouts = true;
+            break;
+        }
+    }
+    if (!has_timeouts) {
+        zloop_timer_end (loop, timer_id);
+        context->split_timeouts_timer_armed = false;
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return 0;
+    }
+    if (context->split_local_workers_are_dirty)
+        s_split_refresh_local_workers (context);
+    int64_t now = zclock_usecs ();
+    igs_splitter_t *splitter, *tmp;
+    HASH_ITER (hh, context->splitters, splitter, tmp){
+        if (splitter->work_timeout == 0)
+            continue;
+        int64_t limit = now - (int64_t) splitter->work_timeout * 1000;
+        bool has_requeued = false;
+        igs_worker_t *worker, *tmp_worker;
+        HASH_ITER (hh, splitter->workers, worker, tmp_worker){
+            // NB: credit of the timed out works is not restored : it will be
+            // if the worker acknowledges them later. As workers process their
+            // works in order, these late acknowledgments come before the ones
+            // of newer dispatches and are not applied to them.
+            while (worker->dispatches && worker->dispatches->timestamp < limit){
+                igs_split_dispatch_t *dispatch = worker->dispatches;
+                igs_warn ("%zu split works for %s timed out on worker %s : requeuing them",
+                          dispatch->works_nb - dispatch->works_acknowledged,
+                          splitter->output_name, worker->agent_uuid);
+                size_t unacknowledged = dispatch->works_nb - dispatch->works_acknowledged;
+                worker->works_in_flight -= (unacknowledged < worker->works_in_flight) ? unacknowledged : worker->works_in_flight;
+                worker->works_expired += unacknowledged;
+                DL_DELETE (worker->dispatches, dispatch);
+                s_split_requeue_dispatch (splitter, &dispatch);
+                has_requeued = true;
+            }
+            s_split_heap_update (splitter, worker);
+        }
+        if (has_requeued)
+            s_split_dispatch_works (context, splitter);
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return 0;
+}
+
+
 ////////////////////////////////////////////////////////////////////////
 // PUBLIC API
 ////////////////////////////////////////////////////////////////////////
@@ -608,22 +1531,19 @@ uint64_t igsagent_split_add (igsagent_t *agent,
         new->id = hash;
         HASH_ADD (hh, agent->mapping->split_elements, id,
                   sizeof (uint64_t), new);
-        agent->network_need_to_send_mapping_update = true;
+        network_request_mapping_update (agent);
+        core_context->split_local_workers_are_dirty = true;
 
         // If agent is already known send HELLO message immediately
-        igs_remote_agent_t *elt_agent, *tmp_agent;
-        HASH_ITER (hh, core_context->remote_agents, elt_agent, tmp_agent)
-        {
-            if (streq (elt_agent->definition->name, to_agent)) {
-                zmsg_t *ready_message = zmsg_new ();
-                zmsg_addstr (ready_message, WORKER_HELLO_MSG);
-                zmsg_addstr (ready_message, agent->uuid);
-                zmsg_addstr (ready_message, from_our_input);
-                zmsg_addstr (ready_message, with_output);
-                zmsg_addstrf (ready_message, "%i", IGS_DEFAULT_WORKER_CREDIT);
-                igs_channel_whisper_zmsg (elt_agent->uuid, &ready_message);
-            }
+        zlist_t *remote_agents = network_find_remote_agents (core_context, reviewed_to_agent);
+        igs_remote_agent_t *elt_agent = zlist_first (remote_agents);
+        while (elt_agent) {
+            if (streq (elt_agent->definition->name, reviewed_to_agent))
+                split_send_worker_hello (agent, from_our_input, with_output,
+                                         elt_agent->uuid);
+            elt_agent = zlist_next (remote_agents);
         }
+        zlist_destroy (&remote_agents);
     }
     else
         igsagent_warn (agent, "split combination %s->%s.%s already exists : will not "
@@ -669,7 +1589,8 @@ igs_result_t igsagent_split_remove_with_id (igsagent_t *agent,
         zmsg_addstr (goodbye_message, el->to_output);
         igs_channel_whisper_zmsg (el->to_agent, &goodbye_message);
         split_free_split_element(&el);
-        agent->network_need_to_send_mapping_update = true;
+        network_request_mapping_update (agent);
+        core_context->split_local_workers_are_dirty = true;
         model_read_write_unlock (__FUNCTION__, __LINE__);
     }
     return IGS_SUCCESS;
@@ -726,7 +1647,305 @@ igs_result_t igsagent_split_remove_with_name (igsagent_t *agent,
     zmsg_addstr (goodbye_message, tmp->to_output);
     igs_channel_whisper_zmsg (tmp->to_agent, &goodbye_message);
     split_free_split_element (&tmp);
-    agent->network_need_to_send_mapping_update = true;
+    network_request_mapping_update (agent);
+    core_context->split_local_workers_are_dirty = true;
     model_read_write_unlock (__FUNCTION__, __LINE__);
     return IGS_SUCCESS;
 }
+
+void igsagent_split_queue_set (igsagent_t *agent,
+                               size_t capacity,
+                               igs_queue_policy_t policy)
+{
+    assert (agent);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent->uuid) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    agent->split_queue_capacity = capacity;
+    agent->split_queue_policy = policy;
+    if (agent->context) {
+        // apply to our existing splitters
+        igs_splitter_t *splitter, *tmp;
+        HASH_ITER (hh, agent->context->splitters, splitter, tmp){
+            if (streq (splitter->agent_uuid, agent->uuid)) {
+                splitter->queue_policy = policy;
+                s_split_queue_resize (splitter, (capacity > 0) ? capacity : IGS_DEFAULT_SPLIT_QUEUE_CAPACITY);
+            }
+        }
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+size_t igsagent_split_queue_size (igsagent_t *agent, const char *output_name)
+{
+    assert (agent);
+    assert (output_name);
+    size_t res = 0;
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (agent->uuid && agent->context) {
+        igs_splitter_t *splitter = s_split_find_splitter (agent->context, agent->uuid, output_name);
+        if (splitter)
+            res = splitter->queue_size;
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return res;
+}
+
+size_t igsagent_split_queue_dropped (igsagent_t *agent, const char *output_name)
+{
+    assert (agent);
+    assert (output_name);
+    size_t res = 0;
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (agent->uuid && agent->context) {
+        igs_splitter_t *splitter = s_split_find_splitter (agent->context, agent->uuid, output_name);
+        if (splitter)
+            res = splitter->queue_dropped;
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return res;
+}
+
+void igsagent_split_set_batch_size (igsagent_t *agent, size_t batch_size)
+{
+    assert (agent);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent->uuid) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    if (agent->mapping && agent->mapping->split_elements)
+        igsagent_warn (agent, "batch size will only apply to splits added from now on");
+    agent->split_batch_size = batch_size;
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+size_t igsagent_split_batch_size (igsagent_t *agent)
+{
+    assert (agent);
+    return (agent->split_batch_size > 1) ? agent->split_batch_size : 1;
+}
+
+void igsagent_split_set_scheduling (igsagent_t *agent, igs_split_scheduling_t scheduling)
+{
+    assert (agent);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent->uuid) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    agent->split_scheduling = scheduling;
+    if (agent->context) {
+        // apply to our existing splitters
+        igs_splitter_t *splitter, *tmp;
+        HASH_ITER (hh, agent->context->splitters, splitter, tmp){
+            if (streq (splitter->agent_uuid, agent->uuid)) {
+                splitter->scheduling = scheduling;
+                s_split_heap_rebuild (splitter);
+            }
+        }
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+igs_split_scheduling_t igsagent_split_scheduling (igsagent_t *agent)
+{
+    assert (agent);
+    return agent->split_scheduling;
+}
+
+igs_split_worker_stats_t *igsagent_split_workers_stats (igsagent_t *agent,
+                                                        const char *output_name,
+                                                        size_t *workers_nbr)
+{
+    assert (agent);
+    assert (output_name);
+    assert (workers_nbr);
+    *workers_nbr = 0;
+    igs_split_worker_stats_t *stats = NULL;
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent->uuid || !agent->context) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return NULL;
+    }
+    igs_splitter_t *splitter = s_split_find_splitter (agent->context, agent->uuid, output_name);
+    if (splitter && splitter->workers_heap_size > 0) {
+        stats = (igs_split_worker_stats_t *) zmalloc (splitter->workers_heap_size * sizeof (igs_split_worker_stats_t));
+        igs_worker_t *worker, *tmp;
+        HASH_ITER (hh, splitter->workers, worker, tmp){
+            igs_split_worker_stats_t *stat = &stats[(*workers_nbr)++];
+            stat->worker_uuid = strdup (worker->agent_uuid);
+            stat->input_name = strdup (worker->input_name);
+            stat->credit = worker->credit;
+            stat->works_in_flight = worker->works_in_flight;
+            stat->works_done = worker->works_done;
+            stat->service_time = (double) worker->service_time / 1000.0;
+            stat->service_time_max = (double) worker->service_time_max / 1000.0;
+        }
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return stats;
+}
+
+void igs_split_free_workers_stats (igs_split_worker_stats_t *stats, size_t workers_nbr)
+{
+    if (!stats)
+        return;
+    for (size_t i = 0; i < workers_nbr; i++) {
+        if (stats[i].worker_uuid)
+            free (stats[i].worker_uuid);
+        if (stats[i].input_name)
+            free (stats[i].input_name);
+    }
+    free (stats);
+}
+
+void igsagent_split_set_key_prefix (igsagent_t *agent, size_t prefix_length)
+{
+    assert (agent);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent->uuid) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    agent->split_key_prefix = prefix_length;
+    if (agent->context) {
+        // apply to our existing splitters
+        igs_splitter_t *splitter, *tmp;
+        HASH_ITER (hh, agent->context->splitters, splitter, tmp){
+            if (streq (splitter->agent_uuid, agent->uuid))
+                splitter->key_prefix = prefix_length;
+        }
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+size_t igsagent_split_key_prefix (igsagent_t *agent)
+{
+    assert (agent);
+    return agent->split_key_prefix;
+}
+
+void igsagent_split_set_key (igsagent_t *agent, const char *output_name, const char *key)
+{
+    assert (agent);
+    assert (output_name);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent->uuid) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    igs_iop_t *iop = model_find_iop_by_name (agent, output_name, IGS_OUTPUT_T);
+    if (!iop) {
+        igsagent_error (agent, "output %s cannot be found", output_name);
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    if (iop->split_key)
+        free (iop->split_key);
+    iop->split_key = (key) ? strdup (key) : NULL;
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+void igsagent_split_set_work_timeout (igsagent_t *agent, unsigned int timeout_ms)
+{
+    assert (agent);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent->uuid) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    agent->split_work_timeout = timeout_ms;
+    if (agent->context) {
+        // apply to our existing splitters
+        igs_splitter_t *splitter, *tmp;
+        HASH_ITER (hh, agent->context->splitters, splitter, tmp){
+            if (streq (splitter->agent_uuid, agent->uuid))
+                splitter->work_timeout = timeout_ms;
+        }
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    if (timeout_ms > 0 && agent->context)
+        network_request_timers_update (agent->context);
+}
+
+unsigned int igsagent_split_work_timeout (igsagent_t *agent)
+{
+    assert (agent);
+    return agent->split_work_timeout;
+}
+
+void igsagent_split_set_max_retries (igsagent_t *agent, unsigned int max_retries)
+{
+    assert (agent);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (!agent->uuid) {
+        model_read_write_unlock (__FUNCTION__, __LINE__);
+        return;
+    }
+    agent->split_max_retries = max_retries;
+    if (agent->context) {
+        // apply to our existing splitters
+        igs_splitter_t *splitter, *tmp;
+        HASH_ITER (hh, agent->context->splitters, splitter, tmp){
+            if (streq (splitter->agent_uuid, agent->uuid))
+                splitter->max_retries = max_retries;
+        }
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+unsigned int igsagent_split_max_retries (igsagent_t *agent)
+{
+    assert (agent);
+    return agent->split_max_retries;
+}
+
+size_t igsagent_split_requeued (igsagent_t *agent, const char *output_name)
+{
+    assert (agent);
+    assert (output_name);
+    size_t res = 0;
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    // check that this agent has not been destroyed when we were locked
+    if (agent->uuid && agent->context) {
+        igs_splitter_t *splitter = s_split_find_splitter (agent->context, agent->uuid, output_name);
+        if (splitter)
+            res = splitter->works_requeued;
+    }
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+    return res;
+}
+
+void igs_split_set_local_threads (size_t threads_nb)
+{
+    core_init_context ();
+    if (threads_nb == 0) {
+        igs_error ("number of local split threads must be at least one");
+        return;
+    }
+    split_stop_local_threads (core_context);
+    model_read_write_lock (__FUNCTION__, __LINE__);
+    core_context->split_local_threads_nb = threads_nb;
+    // threads are restarted when needed by local workers
+    core_context->split_local_workers_are_dirty = true;
+    model_read_write_unlock (__FUNCTION__, __LINE__);
+}
+
+size_t igs_split_local_threads (void)
+{
+    core_init_context ();
+    return core_context->split_local_threads_nb;
+}
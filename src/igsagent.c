@@ -39,6 +39,7 @@ igsagent_t *igsagent_new (const char *name, bool activate_immediately)
     zuuid_t *uuid = zuuid_new ();
     agent->uuid = strdup (zuuid_str (uuid));
     zuuid_destroy (&uuid);
+    agent->split_max_retries = IGS_DEFAULT_SPLIT_MAX_RETRIES;
     igsagent_clear_definition (
       agent); // set valid but empty definition, preserve name
     igsagent_set_name (agent, name);
@@ -54,11 +55,15 @@ void igsagent_destroy (igsagent_t **agent)
 {
     assert (agent);
     assert (*agent);
+    if (core_context)
+        service_cancel_calls (*agent);
     model_read_write_lock (__FUNCTION__, __LINE__);
     if (igsagent_is_activated (*agent))
         igsagent_deactivate (*agent);
 
     zhash_delete (core_context->created_agents, (*agent)->uuid);
+    if ((*agent)->inbound_queue_capacity > 0)
+        core_context->network_inbound_queues--;
     if ((*agent)->uuid) {
         free ((*agent)->uuid);
         (*agent)->uuid = NULL;
@@ -90,6 +95,31 @@ void igsagent_destroy (igsagent_t **agent)
         DL_DELETE ((*agent)->agent_event_callbacks, event_cb);
         free (event_cb);
     }
+    igs_inputs_batch_wrapper_t *batch_cb, *batchtmp;
+    DL_FOREACH_SAFE ((*agent)->inputs_batch_callbacks, batch_cb, batchtmp)
+    {
+        DL_DELETE ((*agent)->inputs_batch_callbacks, batch_cb);
+        free (batch_cb);
+    }
+    igs_batched_input_t *batched, *batchedtmp;
+    DL_FOREACH_SAFE ((*agent)->batched_inputs, batched, batchedtmp)
+    {
+        DL_DELETE ((*agent)->batched_inputs, batched);
+        free (batched->name);
+        free (batched);
+    }
+    igs_inbound_value_t *queued, *queuedtmp;
+    DL_FOREACH_SAFE ((*agent)->inbound_queue, queued, queuedtmp)
+    {
+        DL_DELETE ((*agent)->inbound_queue, queued);
+        free (queued->input_name);
+        if (queued->value)
+            free (queued->value);
+        free (queued);
+    }
+    service_free_latencies (&(*agent)->service_latencies);
+    network_clear_serialization_cache (*agent);
+    network_clear_delta_state (*agent);
     if ((*agent)->mapping)
         mapping_free_mapping (&(*agent)->mapping);
     if ((*agent)->definition)
@@ -110,10 +140,10 @@ igs_result_t igsagent_activate (igsagent_t *agent)
         return IGS_FAILURE;
     }
     agent->context = core_context;
-    agent->network_need_to_send_definition_update =
-      true; // will also trigger mapping update
     agent->network_activation_during_runtime = true;
     HASH_ADD_STR (core_context->agents, uuid, agent);
+    network_request_definition_update (agent); // will also trigger mapping update
+    core_context->split_local_workers_are_dirty = true;
     igsagent_wrapper_t *agent_wrapper_cb;
     DL_FOREACH (agent->activate_callbacks, agent_wrapper_cb)
         agent_wrapper_cb->callback_ptr (agent, true, agent_wrapper_cb->my_data);
@@ -168,6 +198,7 @@ igs_result_t igsagent_deactivate (igsagent_t *agent)
         return IGS_FAILURE;
     }
     HASH_DEL (core_context->agents, agent);
+    core_context->split_local_workers_are_dirty = true;
     igsagent_wrapper_t *cb;
     DL_FOREACH (agent->activate_callbacks, cb)
         cb->callback_ptr (agent, false, cb->my_data);
@@ -208,6 +208,7 @@ void print_usage(const char *myAgentName) {
     printf("--interactiveloop : enables interactive loop to pass commands in CLI (default: false)\n");
     printf("--auto : enables automatic network tests based on timers and network events\n");
     printf("--static : runs static tests only\n");
+    printf("--benchmark nb_iops : compares tree and streaming loading of a generated definition with nb_iops IOPs (e.g. 10000)\n");
 }
 
 //helper to convert paths starting with ~ to absolute paths
@@ -283,6 +284,25 @@ void servicesCommandSparing(void){
     igs_service_args_add_string(&args, "service string test");
     igs_service_args_add_data(&args, myOtherData, 64);
     igs_service_call("tester", "myService", &args, "token");
+
+    //bulk calls send packed arguments : numeric arguments are converted to
+    //the types defined by the callee and values out of range are rejected
+    const char *targets[] = {"tester"};
+    igs_service_args_add_int(&args, 1);
+    igs_service_args_add_double(&args, 3.0);
+    igs_service_args_add_int(&args, 3);
+    assert(igs_service_call_bulk(targets, 1, "packedService", &args, "token") == IGS_SUCCESS);
+    igs_service_args_add_bool(&args, true);
+    igs_service_args_add_double(&args, 1e12);
+    igs_service_args_add_double(&args, 3.0);
+    igs_service_call_bulk(targets, 1, "packedService", &args, "token");
+
+    //tester runs two calls at a time and queues one more : the fourth
+    //call is rejected and the queued one runs after the running ones
+    for (int i = 0; i < 4; i++){
+        igs_service_arg_t *noArgs = NULL;
+        assert(igs_service_call("tester", "concurrentService", &noArgs, NULL) == IGS_SUCCESS);
+    }
 }
 
 void channelsCommand(void){
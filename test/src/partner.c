@@ -22,6 +22,9 @@ const char *p_networkDevice = "en0";
 bool verbose = false;
 bool autoTests = false;
 
+//agents with identical definitions, for autotests
+igsagent_t *twins[2] = {NULL, NULL};
+
 zsock_t *mainThreadPipe = NULL;
 zsock_t *toMainThreadPipe = NULL;
 
@@ -55,6 +58,8 @@ int runAutoTests(zloop_t *loop, int timer_id, void *arg){
     igs_channel_whisper_str("tester", "starting autotests");
     zclock_sleep(100);
     publishCommandSparing();
+    igsagent_output_set_int(twins[0], "twin_output", 1);
+    igsagent_output_set_int(twins[1], "twin_output", 2);
     zclock_sleep(250);
     servicesCommandSparing();
     zclock_sleep(250);
@@ -62,7 +67,8 @@ int runAutoTests(zloop_t *loop, int timer_id, void *arg){
     zclock_sleep(250);
     igs_channel_whisper_str("tester", "STOP_PEER");
     igs_info("autotests completed");
-    return -1;
+    //tester stops us after its additional pass with lazy and lean definitions
+    return 0;
 }
 
 void agentEvents(igs_agent_event_t event, const char *uuid, const char *name, void *eventData, void *myCbData){
@@ -186,6 +192,15 @@ int main(int argc, const char * argv[]) {
     if (staticTests)
         exit(EXIT_SUCCESS);
 
+    //tester receives the same definition twice and shares it
+    if (autoTests){
+        for (int i = 0; i < 2; i++){
+            twins[i] = igsagent_new("twin", true);
+            igsagent_definition_set_version(twins[i], "1.0");
+            igsagent_output_create(twins[i], "twin_output", IGS_INTEGER_T, NULL, 0);
+        }
+    }
+
     igs_start_with_device(p_networkDevice, port);
     igs_channel_join("TEST_CHANNEL");
 
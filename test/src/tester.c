@@ -43,10 +43,13 @@ bool tester_firstAgentExited = false;
 bool tester_secondAgentEntered = false;
 bool tester_secondAgentKnowsUs = false;
 bool tester_secondAgentExited = false;
+bool tester_partnerDefinitionFetched = false; //checked by the lazy definitions pass of autotests
 void agentEvent(igs_agent_event_t event, const char *uuid, const char *name, void *eventData, void *myCbData){
     IGS_UNUSED(eventData)
     IGS_UNUSED(myCbData)
     printf("agentEvent: in tester - %d - %s - %s\n", event, uuid, name);
+    if (streq(name, "partner") && event == IGS_AGENT_UPDATED_DEFINITION)
+        tester_partnerDefinitionFetched = true;
     if (streq(name, "firstAgent")){
         if (event == IGS_AGENT_ENTERED)
             tester_firstAgentEntered = true;
@@ -118,6 +121,197 @@ void agentEvent2(igsagent_t *agent, igs_agent_event_t event, const char *uuid, c
     }
 }
 
+//callback publishing new values while the inbound queue of secondAgent is drained
+int inboundQueueStep = 0;
+void inboundQueueCallback(igsagent_t *agent, igs_iop_type_t iopType, const char* name,
+                          igs_iop_value_type_t valueType, void* value, size_t valueSize, void* myCbData){
+    IGS_UNUSED(iopType)
+    IGS_UNUSED(name)
+    IGS_UNUSED(valueType)
+    IGS_UNUSED(value)
+    IGS_UNUSED(valueSize)
+    igsagent_t *publisher = (igsagent_t *)myCbData;
+    int step = inboundQueueStep;
+    inboundQueueStep = 0;
+    if (step == 1){
+        igsagent_output_set_int(publisher, "first_int", 11);
+        igsagent_output_set_int(publisher, "first_int", 12);
+        igsagent_output_set_int(publisher, "first_int", 13);
+    }else if (step == 2){
+        igsagent_output_set_int(publisher, "first_int", 21);
+        igsagent_inbound_queue_set(agent, 0, IGS_QUEUE_DROP_OLDEST);
+        igsagent_output_set_int(publisher, "first_int", 22);
+    }else if (step == 3){
+        igsagent_output_set_double(publisher, "first_double", 7.5);
+    }
+}
+
+//callback and variables for inputs batches
+size_t inputsBatchCount = 0;
+size_t inputsBatchSize = 0;
+int inputsBatchInt = 0;
+double inputsBatchDouble = 0;
+void inputsBatchCallback(igsagent_t *agent, const igs_iop_value_t *inputs, size_t inputsNbr, void *myCbData){
+    IGS_UNUSED(agent)
+    IGS_UNUSED(myCbData)
+    inputsBatchCount++;
+    inputsBatchSize = inputsNbr;
+    for (size_t i = 0; i < inputsNbr; i++){
+        if (streq(inputs[i].name, "second_int")){
+            assert(inputs[i].value_type == IGS_INTEGER_T);
+            inputsBatchInt = *(int *)inputs[i].value;
+        }else if (streq(inputs[i].name, "second_double")){
+            assert(inputs[i].value_type == IGS_DOUBLE_T);
+            inputsBatchDouble = *(double *)inputs[i].value;
+        }
+    }
+}
+
+//batch callback writing and removing the input it receives, values
+//in the batch shall remain valid during the whole callback
+bool inputsBatchRewritten = false;
+void inputsBatchRewriteCallback(igsagent_t *agent, const igs_iop_value_t *inputs, size_t inputsNbr, void *myCbData){
+    IGS_UNUSED(myCbData)
+    for (size_t i = 0; i < inputsNbr; i++){
+        if (streq(inputs[i].name, "batch_string") && !inputsBatchRewritten){
+            inputsBatchRewritten = true;
+            assert(streq((char *)inputs[i].value, "first value"));
+            igsagent_input_set_string(agent, "batch_string", "second value, which is longer");
+            igsagent_input_remove(agent, "batch_string");
+            assert(streq(inputs[i].name, "batch_string"));
+            assert(streq((char *)inputs[i].value, "first value"));
+        }
+    }
+}
+
+//callback and helper for split queues, works are held by the worker
+//callback as long as splitQueueHold is true
+volatile bool splitQueueHold = false;
+volatile size_t splitQueueCount = 0;
+volatile int splitQueueSum = 0;
+volatile int splitQueueLast = 0;
+void splitQueueCallback(igsagent_t *agent, igs_iop_type_t iopType, const char* name,
+                        igs_iop_value_type_t valueType, void* value, size_t valueSize, void* myCbData){
+    IGS_UNUSED(agent)
+    IGS_UNUSED(iopType)
+    IGS_UNUSED(name)
+    IGS_UNUSED(valueType)
+    IGS_UNUSED(valueSize)
+    IGS_UNUSED(myCbData)
+    while (splitQueueHold)
+        zclock_sleep(1);
+    splitQueueLast = *(int *)value;
+    splitQueueSum += splitQueueLast;
+    splitQueueCount++;
+}
+void splitSlowCallback(igsagent_t *agent, igs_iop_type_t iopType, const char* name,
+                       igs_iop_value_type_t valueType, void* value, size_t valueSize, void* myCbData){
+    IGS_UNUSED(agent)
+    IGS_UNUSED(iopType)
+    IGS_UNUSED(name)
+    IGS_UNUSED(valueType)
+    IGS_UNUSED(value)
+    IGS_UNUSED(valueSize)
+    IGS_UNUSED(myCbData)
+    zclock_sleep(20);
+}
+size_t splitWorksDone(igsagent_t *agent, const char *output, const char *input, double *serviceTime){
+    size_t workersNbr = 0;
+    size_t done = 0;
+    igs_split_worker_stats_t *stats = igsagent_split_workers_stats(agent, output, &workersNbr);
+    for (size_t i = 0; i < workersNbr; i++){
+        if (streq(stats[i].input_name, input)){
+            done = stats[i].works_done;
+            if (serviceTime)
+                *serviceTime = stats[i].service_time;
+        }
+    }
+    igs_split_free_workers_stats(stats, workersNbr);
+    return done;
+}
+size_t splitWorksInFlight(igsagent_t *agent, const char *output, const char *input){
+    size_t workersNbr = 0;
+    size_t inFlight = 0;
+    igs_split_worker_stats_t *stats = igsagent_split_workers_stats(agent, output, &workersNbr);
+    for (size_t i = 0; i < workersNbr; i++){
+        if (streq(stats[i].input_name, input))
+            inFlight = stats[i].works_in_flight;
+    }
+    igs_split_free_workers_stats(stats, workersNbr);
+    return inFlight;
+}
+bool splitQueueIsIdle(igsagent_t *agent, const char *output){
+    size_t workersNbr = 0;
+    size_t inFlight = 0;
+    igs_split_worker_stats_t *stats = igsagent_split_workers_stats(agent, output, &workersNbr);
+    for (size_t i = 0; i < workersNbr; i++)
+        inFlight += stats[i].works_in_flight;
+    igs_split_free_workers_stats(stats, workersNbr);
+    return (inFlight == 0 && igsagent_split_queue_size(agent, output) == 0);
+}
+void splitQueueWait(igsagent_t *agent, const char *output){
+    int64_t deadline = zclock_mono() + 2000;
+    while (!splitQueueIsIdle(agent, output) && zclock_mono() < deadline)
+        zclock_sleep(1);
+    assert(splitQueueIsIdle(agent, output));
+}
+
+//callback for split key affinity and redelivery : values are keys, and
+//the last letter of the input receiving a key is stored as its owner, with
+//its number of deliveries. The input named by affinityHeldInput holds its
+//works.
+#define AFFINITY_KEYS 64
+volatile char affinityOwner[AFFINITY_KEYS] = {0};
+volatile size_t affinityDeliveries[AFFINITY_KEYS] = {0};
+volatile size_t affinityCount = 0;
+const char * volatile affinityHeldInput = NULL;
+void affinityCallback(igsagent_t *agent, igs_iop_type_t iopType, const char* name,
+                      igs_iop_value_type_t valueType, void* value, size_t valueSize, void* myCbData){
+    IGS_UNUSED(agent)
+    IGS_UNUSED(iopType)
+    IGS_UNUSED(valueType)
+    IGS_UNUSED(valueSize)
+    IGS_UNUSED(myCbData)
+    while (affinityHeldInput && streq(affinityHeldInput, name))
+        zclock_sleep(1);
+    int key = *(int *)value;
+    if (key >= 0 && key < AFFINITY_KEYS){
+        affinityOwner[key] = name[strlen(name) - 1];
+        affinityDeliveries[key]++;
+    }
+    affinityCount++;
+}
+
+//callbacks for asynchronous service calls : the service replies with
+//twice its argument when asyncServiceShallReply is true
+bool asyncServiceShallReply = true;
+void asyncServiceCallback(igsagent_t *agent, const char *senderAgentName, const char *senderAgentUUID,
+                          const char *serviceName, igs_service_arg_t *firstArgument, size_t nbArgs,
+                          const char *token, void* myCbData){
+    IGS_UNUSED(senderAgentName)
+    IGS_UNUSED(serviceName)
+    IGS_UNUSED(myCbData)
+    assert(nbArgs == 1);
+    if (!asyncServiceShallReply)
+        return;
+    igs_service_arg_t *reply = NULL;
+    igs_service_args_add_int(&reply, 2 * firstArgument->i);
+    igsagent_service_reply(agent, senderAgentUUID, token, &reply);
+}
+size_t asyncReplyCount = 0;
+uint64_t asyncReplyId = 0;
+igs_service_call_status_t asyncReplyStatus = IGS_SERVICE_CALL_PENDING;
+int asyncReplyValue = 0;
+void asyncReplyCallback(igsagent_t *agent, uint64_t callId, igs_service_call_status_t status,
+                        igs_service_arg_t *firstArgument, size_t nbArgs, void *myCbData){
+    IGS_UNUSED(agent)
+    IGS_UNUSED(myCbData)
+    asyncReplyCount++;
+    asyncReplyId = callId;
+    asyncReplyStatus = status;
+    asyncReplyValue = (nbArgs == 1) ? firstArgument->i : 0;
+}
+
 //callbacks for services
 void testerServiceCallback(const char *senderAgentName, const char *senderAgentUUID,
                            const char *serviceName, igs_service_arg_t *firstArgument, size_t nbArgs,
@@ -131,7 +325,7 @@ void testerServiceCallback(const char *senderAgentName, const char *senderAgentU
         assert(firstArgument->next->type == IGS_INTEGER_T);
         assert(firstArgument->next->i == 3);
         assert(firstArgument->next->next->type == IGS_DOUBLE_T);
-        assert(firstArgument->next->next->d = 3.3 < 0.0001);
+        assert(firstArgument->next->next->d > 3.2999 && firstArgument->next->next->d < 3.3001);
         assert(firstArgument->next->next->next->type == IGS_STRING_T);
         assert(streq(firstArgument->next->next->next->c,"service string test"));
         assert(firstArgument->next->next->next->next->type == IGS_DATA_T);
@@ -166,6 +360,42 @@ void testerServiceCallback(const char *senderAgentName, const char *senderAgentU
     printf(" )\n");
 }
 
+//partner calls this concurrent service four times in a row : two calls run
+//on workers, one is queued and one is rejected. Running calls then go back
+//to sequential execution, which shall still run the queued call.
+void testerConcurrentServiceCallback(const char *senderAgentName, const char *senderAgentUUID,
+                                     const char *serviceName, igs_service_arg_t *firstArgument, size_t nbArgs,
+                                     const char *token, void* myCbData){
+    IGS_UNUSED(senderAgentName)
+    IGS_UNUSED(senderAgentUUID)
+    IGS_UNUSED(firstArgument)
+    IGS_UNUSED(nbArgs)
+    IGS_UNUSED(token)
+    IGS_UNUSED(myCbData)
+    zclock_sleep(100);
+    assert(igs_service_set_concurrency(serviceName, 0, 1) == IGS_SUCCESS);
+}
+
+//partner calls this service with other numeric types than the defined ones
+//to check conversions of packed arguments, and with an integer out of range
+//which shall be rejected before reaching this callback
+void testerPackedServiceCallback(const char *senderAgentName, const char *senderAgentUUID,
+                                 const char *serviceName, igs_service_arg_t *firstArgument, size_t nbArgs,
+                                 const char *token, void* myCbData){
+    IGS_UNUSED(senderAgentName)
+    IGS_UNUSED(senderAgentUUID)
+    IGS_UNUSED(serviceName)
+    IGS_UNUSED(token)
+    IGS_UNUSED(myCbData)
+    assert(nbArgs == 3);
+    assert(firstArgument->type == IGS_BOOL_T);
+    assert(firstArgument->b);
+    assert(firstArgument->next->type == IGS_INTEGER_T);
+    assert(firstArgument->next->i == 3);
+    assert(firstArgument->next->next->type == IGS_DOUBLE_T);
+    assert(firstArgument->next->next->d > 2.9999 && firstArgument->next->next->d < 3.0001);
+}
+
 //callbacks for channels
 size_t msgCountForAutoTests = 0;
 void testerChannelCallback(const char *event, const char *peerID, const char *name,
@@ -276,6 +506,24 @@ void testerChannelCallback(const char *event, const char *peerID, const char *na
 }
 
 //callbacks for iops
+//partner has two agents named twin, with identical definitions, which
+//publish 1 and 2 on their output during autotests
+int twinOutputsSum = 0;
+void twinInputCallback(igs_iop_type_t iopType, const char* name, igs_iop_value_type_t valueType, void* value, size_t valueSize, void* myCbData){
+    IGS_UNUSED(iopType)
+    IGS_UNUSED(name)
+    IGS_UNUSED(valueSize)
+    IGS_UNUSED(myCbData)
+    assert(valueType == IGS_INTEGER_T);
+    twinOutputsSum += *(int *)value;
+    if (twinOutputsSum == 3){
+        //partner and its twins
+        size_t nbRemoteAgents = 0;
+        assert(igs_net_remote_definitions_footprint(&nbRemoteAgents) > 0);
+        assert(nbRemoteAgents == 3);
+    }
+}
+
 void testerIOPCallback(igs_iop_type_t iopType, const char* name, igs_iop_value_type_t valueType, void* value, size_t valueSize, void* myCbData){
     IGS_UNUSED(myCbData)
     IGS_UNUSED(iopType)
@@ -341,6 +589,233 @@ void testerIOPCallback(igs_iop_type_t iopType, const char* name, igs_iop_value_t
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// DEFINITION LOADING BENCHMARK
+//
+//Definitions used to be loaded from a JSON tree and are now loaded by the
+//streaming parser of igsagent_definition_load_str. The tree loader is kept
+//here to compare both on large generated definitions.
+char *benchmarkGenerateDefinition(size_t nbIops){
+    const char *arrays[] = {"inputs", "outputs", "parameters"};
+    char iopName[64] = "";
+    igs_json_t *json = igs_json_new();
+    igs_json_open_map(json);
+    igs_json_add_string(json, "definition");
+    igs_json_open_map(json);
+    igs_json_add_string(json, "name");
+    igs_json_add_string(json, "benchmark");
+    igs_json_add_string(json, "version");
+    igs_json_add_string(json, "1.0");
+    for (size_t a = 0; a < 3; a++){
+        size_t nb = nbIops / 3 + ((a < nbIops % 3) ? 1 : 0);
+        igs_json_add_string(json, arrays[a]);
+        igs_json_open_array(json);
+        for (size_t i = 0; i < nb; i++){
+            snprintf(iopName, 64, "%s_%zu", arrays[a], i);
+            igs_json_open_map(json);
+            igs_json_add_string(json, "name");
+            igs_json_add_string(json, iopName);
+            igs_json_add_string(json, "type");
+            igs_json_add_string(json, "DOUBLE");
+            igs_json_add_string(json, "description");
+            igs_json_add_string(json, "generated for definition loading benchmark");
+            if (a > 0){
+                igs_json_add_string(json, "value");
+                igs_json_add_double(json, 1.5);
+            }
+            igs_json_close_map(json);
+        }
+        igs_json_close_array(json);
+    }
+    igs_json_add_string(json, "services");
+    igs_json_open_array(json);
+    for (size_t i = 0; i < nbIops / 100; i++){
+        snprintf(iopName, 64, "service_%zu", i);
+        igs_json_open_map(json);
+        igs_json_add_string(json, "name");
+        igs_json_add_string(json, iopName);
+        igs_json_add_string(json, "arguments");
+        igs_json_open_array(json);
+        for (size_t j = 0; j < 2; j++){
+            igs_json_open_map(json);
+            igs_json_add_string(json, "name");
+            igs_json_add_string(json, (j == 0) ? "first" : "second");
+            igs_json_add_string(json, "type");
+            igs_json_add_string(json, "INTEGER");
+            igs_json_close_map(json);
+        }
+        igs_json_close_array(json);
+        igs_json_close_map(json);
+    }
+    igs_json_close_array(json);
+    igs_json_close_map(json);
+    igs_json_close_map(json);
+    char *content = igs_json_dump(json);
+    igs_json_destroy(&json);
+    return content;
+}
+igs_iop_value_type_t benchmarkValueType(igs_json_node_t *type){
+    if (!type || type->type != IGS_JSON_STRING)
+        return IGS_UNKNOWN_T;
+    if (streq(type->u.string, "INTEGER"))
+        return IGS_INTEGER_T;
+    if (streq(type->u.string, "DOUBLE"))
+        return IGS_DOUBLE_T;
+    if (streq(type->u.string, "STRING"))
+        return IGS_STRING_T;
+    if (streq(type->u.string, "BOOL"))
+        return IGS_BOOL_T;
+    if (streq(type->u.string, "IMPULSION"))
+        return IGS_IMPULSION_T;
+    if (streq(type->u.string, "DATA"))
+        return IGS_DATA_T;
+    return IGS_UNKNOWN_T;
+}
+void benchmarkServiceCallback(igsagent_t *agent, const char *senderAgentName, const char *senderAgentUUID,
+                              const char *serviceName, igs_service_arg_t *firstArgument, size_t nbArgs,
+                              const char *token, void* myCbData){
+    IGS_UNUSED(agent)
+    IGS_UNUSED(senderAgentName)
+    IGS_UNUSED(senderAgentUUID)
+    IGS_UNUSED(serviceName)
+    IGS_UNUSED(firstArgument)
+    IGS_UNUSED(nbArgs)
+    IGS_UNUSED(token)
+    IGS_UNUSED(myCbData)
+}
+//loads the name, version, description, IOPs with their type, value and
+//description, and services with their arguments, from a JSON tree
+igsagent_t *benchmarkTreeLoad(const char *content){
+    const char *namePath[] = {"name", NULL};
+    const char *typePath[] = {"type", NULL};
+    const char *valuePath[] = {"value", NULL};
+    const char *descriptionPath[] = {"description", NULL};
+    const char *argumentsPath[] = {"arguments", NULL};
+    const char *agentNamePath[] = {"definition", "name", NULL};
+    const char *versionPath[] = {"definition", "version", NULL};
+    const char *agentDescriptionPath[] = {"definition", "description", NULL};
+    const char *inputsPath[] = {"definition", "inputs", NULL};
+    const char *outputsPath[] = {"definition", "outputs", NULL};
+    const char *parametersPath[] = {"definition", "parameters", NULL};
+    const char *servicesPath[] = {"definition", "services", NULL};
+    igs_json_node_t *root = igs_json_node_parse_from_str(content);
+    if (!root)
+        return NULL;
+    igs_json_node_t *node = igs_json_node_find(root, agentNamePath);
+    if (!node || node->type != IGS_JSON_STRING){
+        igs_json_node_destroy(&root);
+        return NULL;
+    }
+    igsagent_t *agent = igsagent_new(node->u.string, false);
+    node = igs_json_node_find(root, versionPath);
+    if (node && node->type == IGS_JSON_STRING)
+        igsagent_definition_set_version(agent, node->u.string);
+    node = igs_json_node_find(root, agentDescriptionPath);
+    if (node && node->type == IGS_JSON_STRING)
+        igsagent_definition_set_description(agent, node->u.string);
+    const char **iopsPaths[] = {inputsPath, outputsPath, parametersPath};
+    for (size_t a = 0; a < 3; a++){
+        igs_json_node_t *iops = igs_json_node_find(root, iopsPaths[a]);
+        if (!iops || iops->type != IGS_JSON_ARRAY)
+            continue;
+        for (size_t i = 0; i < iops->u.array.len; i++){
+            igs_json_node_t *iopName = igs_json_node_find(iops->u.array.values[i], namePath);
+            if (!iopName || iopName->type != IGS_JSON_STRING)
+                continue;
+            igs_iop_value_type_t valueType = benchmarkValueType(igs_json_node_find(iops->u.array.values[i], typePath));
+            igs_json_node_t *value = igs_json_node_find(iops->u.array.values[i], valuePath);
+            int intValue = 0;
+            double doubleValue = 0;
+            bool boolValue = false;
+            void *valuePtr = NULL;
+            size_t valueSize = 0;
+            if (value && (valueType == IGS_INTEGER_T || valueType == IGS_DOUBLE_T)
+                && value->type == IGS_JSON_NUMBER){
+                intValue = (int)value->u.number.i;
+                doubleValue = igs_json_node_is_double(value) ? value->u.number.d : (double)value->u.number.i;
+                valuePtr = (valueType == IGS_INTEGER_T) ? (void *)&intValue : (void *)&doubleValue;
+                valueSize = (valueType == IGS_INTEGER_T) ? sizeof(int) : sizeof(double);
+            }else if (value && valueType == IGS_BOOL_T){
+                boolValue = (value->type == IGS_JSON_TRUE);
+                valuePtr = &boolValue;
+                valueSize = sizeof(bool);
+            }else if (value && valueType == IGS_STRING_T && value->type == IGS_JSON_STRING){
+                valuePtr = value->u.string;
+                valueSize = strlen(value->u.string) + 1;
+            }
+            igs_json_node_t *description = igs_json_node_find(iops->u.array.values[i], descriptionPath);
+            const char *iopDescription = (description && description->type == IGS_JSON_STRING) ? description->u.string : NULL;
+            if (a == 0){
+                igsagent_input_create(agent, iopName->u.string, valueType, NULL, 0);
+                if (iopDescription)
+                    igsagent_input_set_description(agent, iopName->u.string, iopDescription);
+            }else if (a == 1){
+                igsagent_output_create(agent, iopName->u.string, valueType, valuePtr, valueSize);
+                if (iopDescription)
+                    igsagent_output_set_description(agent, iopName->u.string, iopDescription);
+            }else{
+                igsagent_parameter_create(agent, iopName->u.string, valueType, valuePtr, valueSize);
+                if (iopDescription)
+                    igsagent_parameter_set_description(agent, iopName->u.string, iopDescription);
+            }
+        }
+    }
+    igs_json_node_t *services = igs_json_node_find(root, servicesPath);
+    if (services && services->type == IGS_JSON_ARRAY){
+        for (size_t i = 0; i < services->u.array.len; i++){
+            igs_json_node_t *serviceName = igs_json_node_find(services->u.array.values[i], namePath);
+            if (!serviceName || serviceName->type != IGS_JSON_STRING)
+                continue;
+            igsagent_service_init(agent, serviceName->u.string, benchmarkServiceCallback, NULL);
+            igs_json_node_t *arguments = igs_json_node_find(services->u.array.values[i], argumentsPath);
+            if (!arguments || arguments->type != IGS_JSON_ARRAY)
+                continue;
+            for (size_t j = 0; j < arguments->u.array.len; j++){
+                igs_json_node_t *argName = igs_json_node_find(arguments->u.array.values[j], namePath);
+                if (argName && argName->type == IGS_JSON_STRING)
+                    igsagent_service_arg_add(agent, serviceName->u.string, argName->u.string,
+                                             benchmarkValueType(igs_json_node_find(arguments->u.array.values[j], typePath)));
+            }
+        }
+    }
+    igs_json_node_destroy(&root);
+    return agent;
+}
+size_t benchmarkDefinitionSize(igsagent_t *agent){
+    return igsagent_input_count(agent) + igsagent_output_count(agent)
+           + igsagent_parameter_count(agent) + igsagent_service_count(agent);
+}
+//loads a generated definition with nbIops IOPs nbRuns times through the
+//JSON tree and through the streaming parser, checks that both load the
+//same IOPs and services, and prints timings
+void benchmarkDefinitionLoading(size_t nbIops, size_t nbRuns){
+    char *content = benchmarkGenerateDefinition(nbIops);
+    assert(content);
+    size_t treeSize = 0;
+    size_t streamSize = 0;
+    int64_t start = zclock_usecs();
+    for (size_t r = 0; r < nbRuns; r++){
+        igsagent_t *agent = benchmarkTreeLoad(content);
+        assert(agent);
+        treeSize = benchmarkDefinitionSize(agent);
+        igsagent_destroy(&agent);
+    }
+    int64_t treeTime = zclock_usecs() - start;
+    start = zclock_usecs();
+    for (size_t r = 0; r < nbRuns; r++){
+        igsagent_t *agent = igsagent_new("benchmark", false);
+        assert(igsagent_definition_load_str(agent, content) == IGS_SUCCESS);
+        streamSize = benchmarkDefinitionSize(agent);
+        igsagent_destroy(&agent);
+    }
+    int64_t streamTime = zclock_usecs() - start;
+    free(content);
+    assert(treeSize == nbIops + nbIops / 100);
+    assert(streamSize == treeSize);
+    printf("definition with %zu IOPs loaded %zu times: tree %.2f ms, streaming %.2f ms per load\n",
+           nbIops, nbRuns, (double)treeTime / 1000.0 / (double)nbRuns, (double)streamTime / 1000.0 / (double)nbRuns);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // MAIN & OPTIONS & COMMAND INTERPRETER
 //
@@ -352,6 +827,7 @@ int main(int argc, const char * argv[]) {
     int opt = 0;
     bool interactiveloop = false;
     bool staticTests = false;
+    size_t benchmarkIops = 0;
 
     static struct option long_options[] = {
         {"verbose",     no_argument, 0,  'v' },
@@ -363,6 +839,7 @@ int main(int argc, const char * argv[]) {
         {"name",        required_argument, 0,  'n' },
         {"auto",        no_argument, 0,  'a' },
         {"static",        no_argument, 0,  's' },
+        {"benchmark",   required_argument, 0,  'b' },
         {"help",        no_argument, 0,  'h' },
         {0, 0, 0, 0}
     };
@@ -391,6 +868,9 @@ int main(int argc, const char * argv[]) {
             case 's':
                 staticTests = true;
                 break;
+            case 'b':
+                benchmarkIops = (size_t)atoi(optarg);
+                break;
             case 'h':
                 print_usage(agentName);
                 exit(0);
@@ -399,6 +879,10 @@ int main(int argc, const char * argv[]) {
                 exit(1);
         }
     }
+    if (benchmarkIops > 0){
+        benchmarkDefinitionLoading(benchmarkIops, 10);
+        exit(EXIT_SUCCESS);
+    }
     igs_clear_context();
     igs_log_include_data(true);
     igs_log_include_services(true);
@@ -459,6 +943,16 @@ int main(int argc, const char * argv[]) {
     assert(igs_input_add_constraint("constraint_double", "~ (\\d+)") == IGS_FAILURE);
     assert(igs_input_add_constraint("constraint_bool", "~ (\\d+)") == IGS_FAILURE);
     assert(igs_input_add_constraint("constraint_data", "~ (\\d+)") == IGS_FAILURE);
+    //double constraints are written at full precision, exponents being accepted
+    assert(igs_input_add_constraint("constraint_double", "[1e-9, 2.5E+3]") == IGS_SUCCESS);
+    char *constraintsDefinition = igs_definition_json();
+    assert(strstr(constraintsDefinition, "[1.0000000000000001e-09, 2500]"));
+    free(constraintsDefinition);
+    assert(igs_input_add_constraint("constraint_double", "min 1.0000000000000001e-09") == IGS_SUCCESS);
+    igs_constraints_enforce(true);
+    assert(igs_input_set_double("constraint_double", 5e-10) == IGS_FAILURE);
+    assert(igs_input_set_double("constraint_double", 2e-9) == IGS_SUCCESS);
+    igs_constraints_enforce(false);
     
     igs_input_remove("constraint_impulsion");
     igs_input_remove("constraint_int");
@@ -530,6 +1024,34 @@ int main(int argc, const char * argv[]) {
         igs_info("ip %d - %s", i, devicesList[i]);
     }
     igs_free_net_addresses_list(devicesList, nb_devices);
+    //split and service calls are notified one by one unless aggregated
+    assert(igs_net_telemetry_period() == 0);
+    igs_net_set_telemetry_period(500);
+    assert(igs_net_telemetry_period() == 500);
+    igs_net_set_telemetry_period(0);
+    assert(igs_net_telemetry_period() == 0);
+    assert(!igs_net_lazy_definitions());
+    igs_net_set_lazy_definitions(true);
+    assert(igs_net_lazy_definitions());
+    assert(igs_net_fetch_definition("partner") == IGS_FAILURE); //not started
+    igs_net_set_lazy_definitions(false);
+    assert(!igs_net_lazy_definitions());
+    assert(!igs_net_lean_remote_definitions());
+    igs_net_set_lean_remote_definitions(true);
+    assert(igs_net_lean_remote_definitions());
+    igs_net_set_lean_remote_definitions(false);
+    assert(!igs_net_lean_remote_definitions());
+    size_t nbRemoteAgents = 1;
+    assert(igs_net_remote_definitions_footprint(&nbRemoteAgents) == 0);
+    assert(nbRemoteAgents == 0);
+    assert(igs_net_definitions_cache_path() == NULL);
+    igs_net_set_definitions_cache_path("/tmp/igs_tester_definitions_cache");
+    char *cachePath = igs_net_definitions_cache_path();
+    assert(streq(cachePath, "/tmp/igs_tester_definitions_cache"));
+    assert(zsys_file_exists(cachePath));
+    free(cachePath);
+    igs_net_set_definitions_cache_path(NULL);
+    assert(igs_net_definitions_cache_path() == NULL);
     assert(igs_command_line() == NULL);
     igs_set_command_line("my command line");
     char *commandLine = igs_command_line();
@@ -613,7 +1135,67 @@ int main(int argc, const char * argv[]) {
     assert(igs_definition_version() == NULL);
     igs_definition_set_description("");
     igs_definition_set_version("");
-    //TODO: test loading valid string and file definitions
+    //loading a definition, first IOPs and services being kept on duplicates
+    const char *loadedDefinition = "{\"definition\": {\"name\": \"tester\", \"version\": \"1.0\", "
+    "\"description\": \"loaded definition\", "
+    "\"inputs\": [{\"name\": \"in_string\", \"type\": \"STRING\", \"constraint\": \"~ (\\\\d+)\"}, "
+    "{\"name\": \"in_string\", \"type\": \"INTEGER\"}], "
+    "\"outputs\": [{\"name\": \"out_int\", \"type\": \"INTEGER\", \"value\": 5, \"constraint\": \"[1, 10]\", "
+    "\"description\": \"loaded output\"}, {\"name\": \"out_int\", \"type\": \"DOUBLE\"}], "
+    "\"parameters\": [{\"name\": \"param_data\", \"type\": \"DATA\", \"value\": \"0A0b0C\"}, "
+    "{\"name\": \"param_double\", \"type\": \"DOUBLE\", \"value\": 1.5, \"constraint\": \"max 2\"}], "
+    "\"services\": [{\"name\": \"loaded_service\", \"description\": \"loaded service\", "
+    "\"arguments\": [{\"name\": \"first\", \"type\": \"INTEGER\"}, {\"name\": \"second\", \"type\": \"DATA\"}], "
+    "\"reply\": {\"name\": \"loaded_reply\", \"arguments\": [{\"name\": \"result\", \"type\": \"BOOL\"}]}}, "
+    "{\"name\": \"loaded_service\", \"arguments\": []}]}}";
+    assert(igs_definition_load_str(loadedDefinition) == IGS_SUCCESS);
+    char *loadedDesc = igs_definition_description();
+    assert(streq(loadedDesc, "loaded definition"));
+    free(loadedDesc);
+    assert(igs_input_count() == 1);
+    assert(igs_input_type("in_string") == IGS_STRING_T);
+    assert(igs_output_count() == 1);
+    assert(igs_output_type("out_int") == IGS_INTEGER_T);
+    assert(igs_output_int("out_int") == 5);
+    assert(igs_parameter_count() == 2);
+    assert(igs_parameter_double("param_double") - 1.5 < 0.000001);
+    data = NULL;
+    dataSize = 0;
+    assert(igs_parameter_data("param_data", &data, &dataSize) == IGS_SUCCESS);
+    assert(dataSize == 3 && data);
+    assert(((uint8_t *)data)[0] == 0x0A && ((uint8_t *)data)[1] == 0x0B && ((uint8_t *)data)[2] == 0x0C);
+    free(data);
+    data = NULL;
+    assert(igs_service_count() == 1);
+    assert(igs_service_args_count("loaded_service") == 2);
+    igs_service_arg_t *loadedArgs = igs_service_args_first("loaded_service");
+    assert(loadedArgs && streq(loadedArgs->name, "first") && loadedArgs->type == IGS_INTEGER_T);
+    assert(loadedArgs->next && streq(loadedArgs->next->name, "second") && loadedArgs->next->type == IGS_DATA_T);
+    char *loadedJson = igs_definition_json();
+    assert(strstr(loadedJson, "loaded service"));
+    assert(strstr(loadedJson, "loaded_reply"));
+    assert(strstr(loadedJson, "loaded output"));
+    free(loadedJson);
+    igs_constraints_enforce(true);
+    assert(igs_output_set_int("out_int", 11) == IGS_FAILURE);
+    assert(igs_output_set_int("out_int", 7) == IGS_SUCCESS);
+    assert(igs_input_set_string("in_string", "abc") == IGS_FAILURE);
+    assert(igs_input_set_string("in_string", "123") == IGS_SUCCESS);
+    assert(igs_parameter_set_double("param_double", 2.5) == IGS_FAILURE);
+    igs_constraints_enforce(false);
+    //loading the same definition from a file
+    FILE *loadedFile = fopen("/tmp/tester loaded definition.json", "w");
+    assert(loadedFile);
+    fputs(loadedDefinition, loadedFile);
+    fclose(loadedFile);
+    igs_clear_definition();
+    assert(igs_definition_load_file("/tmp/tester loaded definition.json") == IGS_SUCCESS);
+    assert(igs_input_count() == 1 && igs_output_count() == 1 && igs_parameter_count() == 2);
+    assert(igs_service_args_count("loaded_service") == 2);
+    igs_clear_definition();
+    assert(igs_service_count() == 0);
+    //tree and streaming loading of a large generated definition
+    benchmarkDefinitionLoading(10000, 1);
     igs_definition_set_description("my description");
     char *defDesc = igs_definition_description();
     assert(streq(defDesc, "my description"));
@@ -1078,6 +1660,27 @@ int main(int argc, const char * argv[]) {
     assert(igs_mapping_load_file("/does not exist") == IGS_FAILURE);
     assert(igs_mapping_json()); //intentional memory leak here
     assert(igs_mapping_count() == 0);
+    //loading a mapping with reducers, duplicates being ignored
+    const char *loadedMapping = "{\"mappings\": ["
+    "{\"fromInput\": \"in_a\", \"toAgent\": \"other_agent\", \"toOutput\": \"out\", "
+    "\"reducer\": \"average\", \"windowSamples\": 4, \"windowMs\": 100}, "
+    "{\"fromInput\": \"in_a\", \"toAgent\": \"other_agent\", \"toOutput\": \"out\"}, "
+    "{\"fromInput\": \"in_b\", \"toAgent\": \"other_agent\", \"toOutput\": \"out\", \"reducer\": \"unknown\", \"windowMs\": 100}, "
+    "{\"fromInput\": \"in_c\", \"toAgent\": \"other_agent\", \"toOutput\": \"out\", \"reducer\": \"max\"}], "
+    "\"splits\": [{\"fromInput\": \"in_a\", \"toAgent\": \"other_agent\", \"toOutput\": \"out\"}, "
+    "{\"fromInput\": \"in_a\", \"toAgent\": \"other_agent\", \"toOutput\": \"out\"}]}";
+    assert(igs_mapping_load_str(loadedMapping) == IGS_SUCCESS);
+    assert(igs_mapping_count() == 3);
+    assert(igs_split_count() == 1);
+    char *loadedMappingJson = igs_mapping_json();
+    assert(strstr(loadedMappingJson, "\"average\""));
+    assert(strstr(loadedMappingJson, "\"windowSamples\":4") || strstr(loadedMappingJson, "\"windowSamples\": 4"));
+    assert(!strstr(loadedMappingJson, "unknown"));
+    assert(!strstr(loadedMappingJson, "\"max\"")); //reducer without window
+    free(loadedMappingJson);
+    igs_clear_mappings();
+    assert(igs_mapping_count() == 0);
+    assert(igs_split_count() == 0);
 
     assert(igs_mapping_add("toto", "other_agent", "tata") != 0);
     uint64_t mapId = igs_mapping_add("toto", "other_agent", "tata");
@@ -1128,6 +1731,33 @@ int main(int argc, const char * argv[]) {
     assert(igs_split_remove_with_name("toto", "other_agent", "tata") == IGS_SUCCESS);
     igs_clear_mappings();
 
+    //mapping reducers
+    assert(igs_mapping_add_with_reducer("toto", "other_agent", "tata", IGS_REDUCER_AVERAGE, 0, 0) == 0);
+    mapId = igs_mapping_add_with_reducer("toto", "other_agent", "tata", IGS_REDUCER_AVERAGE, 4, 100);
+    assert(mapId > 0);
+    assert(igs_mapping_add("toto", "other_agent", "tata") == mapId);
+    exportedMapping = igs_mapping_json();
+    assert(strstr(exportedMapping, "\"reducer\":\"average\"") || strstr(exportedMapping, "\"reducer\": \"average\""));
+    assert(strstr(exportedMapping, "windowSamples") && strstr(exportedMapping, "windowMs"));
+    igs_clear_mappings();
+    assert(igs_mapping_load_str(exportedMapping) == IGS_SUCCESS);
+    char *reloadedMapping = igs_mapping_json();
+    assert(streq(exportedMapping, reloadedMapping));
+    free(reloadedMapping);
+    assert(igs_mapping_set_reducer(12345, IGS_REDUCER_LAST, 2, 0) == IGS_FAILURE);
+    assert(igs_mapping_set_reducer(mapId, IGS_REDUCER_LAST, 0, 0) == IGS_FAILURE);
+    assert(igs_mapping_set_reducer(mapId, IGS_REDUCER_MAX, 2, 0) == IGS_SUCCESS);
+    reloadedMapping = igs_mapping_json();
+    assert(!streq(exportedMapping, reloadedMapping));
+    assert(strstr(reloadedMapping, "max") && !strstr(reloadedMapping, "windowMs"));
+    free(reloadedMapping);
+    assert(igs_mapping_set_reducer(mapId, IGS_REDUCER_NONE, 0, 0) == IGS_SUCCESS);
+    reloadedMapping = igs_mapping_json();
+    assert(!strstr(reloadedMapping, "reducer") && !strstr(reloadedMapping, "windowSamples"));
+    free(reloadedMapping);
+    free(exportedMapping);
+    igs_clear_mappings();
+
     //services
     igs_service_arg_t *list = NULL;
     igs_service_args_add_bool(&list, myBool);
@@ -1340,6 +1970,12 @@ int main(int argc, const char * argv[]) {
     igs_service_arg_add("myService", "myDouble", IGS_DOUBLE_T);
     igs_service_arg_add("myService", "myString", IGS_STRING_T);
     igs_service_arg_add("myService", "myData", IGS_DATA_T);
+    igs_service_init("packedService", testerPackedServiceCallback, NULL);
+    igs_service_arg_add("packedService", "myBool", IGS_BOOL_T);
+    igs_service_arg_add("packedService", "myInt", IGS_INTEGER_T);
+    igs_service_arg_add("packedService", "myDouble", IGS_DOUBLE_T);
+    igs_service_init("concurrentService", testerConcurrentServiceCallback, NULL);
+    igs_service_set_concurrency("concurrentService", 2, 1);
 
     igs_observe_input("my_impulsion", testerIOPCallback, NULL);
     igs_observe_input("my_bool", testerIOPCallback, NULL);
@@ -1368,6 +2004,10 @@ int main(int argc, const char * argv[]) {
     igs_split_add("my_string_split", "partner", "sparing_string");
     igs_split_add("my_data_split", "partner", "sparing_data");
 
+    igs_input_create("twin_input", IGS_INTEGER_T, NULL, 0);
+    igs_observe_input("twin_input", twinInputCallback, NULL);
+    igs_mapping_add("twin_input", "twin", "twin_output");
+
     //iop description
     igs_input_set_description("my_impulsion", "my iop description here");
     igs_input_set_description("my_impulsion", "my iop description here");
@@ -1700,6 +2340,342 @@ int main(int argc, const char * argv[]) {
     assert(igsagent_input_data(secondAgent, "second_data", &data, &dataSize) == IGS_SUCCESS);
     assert(streq((char*)data, "my data") && strlen((char*)data) == dataSize - 1);
 
+    //test inbound queue in same process
+    igsagent_inbound_queue_set(secondAgent, 4, IGS_QUEUE_DROP_OLDEST);
+    igsagent_output_set_int(firstAgent, "first_int", 6);
+    assert(igsagent_input_int(secondAgent, "second_int") == 6);
+    assert(igsagent_inbound_queue_size(secondAgent) == 0);
+    assert(igsagent_inbound_queue_dropped(secondAgent) == 0);
+    //values received while draining are limited by the queue capacity
+    igsagent_inbound_queue_set(secondAgent, 1, IGS_QUEUE_DROP_NEWEST);
+    igsagent_observe_input(secondAgent, "second_int", inboundQueueCallback, firstAgent);
+    inboundQueueStep = 1;
+    igsagent_output_set_int(firstAgent, "first_int", 10);
+    assert(igsagent_input_int(secondAgent, "second_int") == 11);
+    assert(igsagent_inbound_queue_size(secondAgent) == 0);
+    assert(igsagent_inbound_queue_dropped(secondAgent) == 2);
+    //disabling the queue while it is drained keeps the order of values
+    igsagent_inbound_queue_set(secondAgent, 4, IGS_QUEUE_DROP_OLDEST);
+    inboundQueueStep = 2;
+    igsagent_output_set_int(firstAgent, "first_int", 20);
+    assert(igsagent_input_int(secondAgent, "second_int") == 22);
+    assert(igsagent_inbound_queue_size(secondAgent) == 0);
+    igsagent_output_set_int(firstAgent, "first_int", 5);
+    assert(igsagent_input_int(secondAgent, "second_int") == 5);
+
+    //test inputs batches in same process
+    igsagent_observe_inputs_batch(secondAgent, inputsBatchCallback, NULL);
+    igsagent_input_set_int(secondAgent, "second_int", 7);
+    assert(inputsBatchCount == 1 && inputsBatchSize == 1 && inputsBatchInt == 7);
+    igsagent_output_set_int(firstAgent, "first_int", 8);
+    assert(inputsBatchCount == 2 && inputsBatchSize == 1 && inputsBatchInt == 8);
+    //values drained together from the inbound queue make a single batch
+    igsagent_inbound_queue_set(secondAgent, 4, IGS_QUEUE_DROP_OLDEST);
+    inboundQueueStep = 3;
+    igsagent_output_set_int(firstAgent, "first_int", 9);
+    assert(inputsBatchCount == 3 && inputsBatchSize == 2);
+    assert(inputsBatchInt == 9 && inputsBatchDouble - 7.5 < 0.000001);
+    igsagent_inbound_queue_set(secondAgent, 0, IGS_QUEUE_DROP_OLDEST);
+    //batch values are copies : the input can be written and removed by the callback
+    igsagent_input_create(secondAgent, "batch_string", IGS_STRING_T, NULL, 0);
+    igsagent_observe_inputs_batch(secondAgent, inputsBatchRewriteCallback, NULL);
+    igsagent_input_set_string(secondAgent, "batch_string", "first value");
+    assert(inputsBatchRewritten);
+    assert(!igsagent_input_exists(secondAgent, "batch_string"));
+
+    //test IOP history
+    const igs_iop_sample_t *firstPart = NULL;
+    const igs_iop_sample_t *secondPart = NULL;
+    size_t firstPartNbr = 0;
+    size_t secondPartNbr = 0;
+    assert(igsagent_input_set_history(secondAgent, "unknown", 3) == IGS_FAILURE);
+    assert(igsagent_input_history(secondAgent, "second_int", 0, 0, &firstPart, &firstPartNbr, &secondPart, &secondPartNbr) == 0);
+    assert(igsagent_input_set_history(secondAgent, "second_int", 3) == IGS_SUCCESS);
+    igsagent_input_set_int(secondAgent, "second_int", 1);
+    igsagent_input_set_int(secondAgent, "second_int", 2);
+    assert(igsagent_input_history(secondAgent, "second_int", 0, 0, &firstPart, &firstPartNbr, &secondPart, &secondPartNbr) == 2);
+    assert(firstPartNbr == 2 && secondPartNbr == 0 && secondPart == NULL);
+    assert(firstPart[0].type == IGS_INTEGER_T && firstPart[0].i == 1 && firstPart[1].i == 2);
+    assert(firstPart[0].timestamp <= firstPart[1].timestamp);
+    igsagent_input_set_int(secondAgent, "second_int", 3);
+    igsagent_input_set_int(secondAgent, "second_int", 4);
+    igsagent_input_set_int(secondAgent, "second_int", 5);
+    //the ring has wrapped : oldest samples are dropped and the window is split
+    assert(igsagent_input_history(secondAgent, "second_int", 0, 0, &firstPart, &firstPartNbr, &secondPart, &secondPartNbr) == 3);
+    assert(firstPartNbr + secondPartNbr == 3);
+    int historyValues[3] = {0};
+    for (size_t i = 0; i < firstPartNbr; i++)
+        historyValues[i] = firstPart[i].i;
+    for (size_t i = 0; i < secondPartNbr; i++)
+        historyValues[firstPartNbr + i] = secondPart[i].i;
+    assert(historyValues[0] == 3 && historyValues[1] == 4 && historyValues[2] == 5);
+    assert(igsagent_input_history(secondAgent, "second_int", 2, 0, &firstPart, &firstPartNbr, &secondPart, &secondPartNbr) == 2);
+    assert(firstPartNbr + secondPartNbr == 2);
+    assert(((secondPartNbr > 0) ? secondPart[secondPartNbr - 1].i : firstPart[firstPartNbr - 1].i) == 5);
+    assert(firstPart[0].i == 4);
+    assert(igsagent_input_history(secondAgent, "second_int", 0, zclock_usecs() + 1000000,
+                                  &firstPart, &firstPartNbr, &secondPart, &secondPartNbr) == 0);
+    assert(firstPart == NULL && firstPartNbr == 0);
+    assert(igsagent_input_set_history(secondAgent, "second_string", 2) == IGS_SUCCESS);
+    igsagent_input_set_string(secondAgent, "second_string", "first sample");
+    igsagent_input_set_string(secondAgent, "second_string", "second sample");
+    igsagent_input_set_string(secondAgent, "second_string", "third sample");
+    assert(igsagent_input_history(secondAgent, "second_string", 1, 0, &firstPart, &firstPartNbr, &secondPart, &secondPartNbr) == 1);
+    assert(firstPart[0].type == IGS_STRING_T && streq(firstPart[0].s, "third sample"));
+    assert(igsagent_input_set_history(secondAgent, "second_string", 0) == IGS_SUCCESS);
+    assert(igsagent_input_set_history(secondAgent, "second_int", 0) == IGS_SUCCESS);
+    assert(igsagent_input_history(secondAgent, "second_int", 0, 0, &firstPart, &firstPartNbr, &secondPart, &secondPartNbr) == 0);
+
+    //test mapping reducers in same process
+    uint64_t reducedId = igsagent_mapping_add_with_reducer(secondAgent, "second_double", "firstAgent", "first_double",
+                                                           IGS_REDUCER_AVERAGE, 3, 0);
+    assert(reducedId > 0);
+    igsagent_output_set_double(firstAgent, "first_double", 1);
+    igsagent_output_set_double(firstAgent, "first_double", 2);
+    assert(igsagent_input_double(secondAgent, "second_double") > 7.5 - 0.000001
+           && igsagent_input_double(secondAgent, "second_double") < 7.5 + 0.000001);
+    igsagent_output_set_double(firstAgent, "first_double", 6);
+    assert(igsagent_input_double(secondAgent, "second_double") > 3 - 0.000001
+           && igsagent_input_double(secondAgent, "second_double") < 3 + 0.000001);
+    assert(igsagent_mapping_set_reducer(secondAgent, reducedId, IGS_REDUCER_NONE, 0, 0) == IGS_SUCCESS);
+    igsagent_output_set_double(firstAgent, "first_double", 4);
+    assert(igsagent_input_double(secondAgent, "second_double") > 4 - 0.000001
+           && igsagent_input_double(secondAgent, "second_double") < 4 + 0.000001);
+    reducedId = igsagent_mapping_add_with_reducer(secondAgent, "second_int", "firstAgent", "first_int",
+                                                  IGS_REDUCER_DECIMATE, 2, 0);
+    igsagent_output_set_int(firstAgent, "first_int", 1);
+    assert(igsagent_input_int(secondAgent, "second_int") == 1);
+    igsagent_output_set_int(firstAgent, "first_int", 2);
+    assert(igsagent_input_int(secondAgent, "second_int") == 1);
+    igsagent_output_set_int(firstAgent, "first_int", 3);
+    assert(igsagent_input_int(secondAgent, "second_int") == 3);
+    //the value received after the end of a time window opens a new window
+    assert(igsagent_mapping_set_reducer(secondAgent, reducedId, IGS_REDUCER_DECIMATE, 0, 50) == IGS_SUCCESS);
+    igsagent_output_set_int(firstAgent, "first_int", 10);
+    igsagent_output_set_int(firstAgent, "first_int", 11);
+    assert(igsagent_input_int(secondAgent, "second_int") == 10);
+    zclock_sleep(60);
+    igsagent_output_set_int(firstAgent, "first_int", 12);
+    assert(igsagent_input_int(secondAgent, "second_int") == 12);
+    //an expired time window is delivered before the value opening the next one
+    assert(igsagent_mapping_set_reducer(secondAgent, reducedId, IGS_REDUCER_LAST, 0, 50) == IGS_SUCCESS);
+    igsagent_output_set_int(firstAgent, "first_int", 20);
+    igsagent_output_set_int(firstAgent, "first_int", 21);
+    assert(igsagent_input_int(secondAgent, "second_int") == 12);
+    zclock_sleep(60);
+    igsagent_output_set_int(firstAgent, "first_int", 22);
+    assert(igsagent_input_int(secondAgent, "second_int") == 21);
+    assert(igsagent_mapping_set_reducer(secondAgent, reducedId, IGS_REDUCER_NONE, 0, 0) == IGS_SUCCESS);
+    igsagent_output_set_int(firstAgent, "first_int", 30);
+    assert(igsagent_input_int(secondAgent, "second_int") == 30);
+
+    //test split queues in same process
+    igsagent_output_create(firstAgent, "first_queue", IGS_INTEGER_T, NULL, 0);
+    igsagent_input_create(secondAgent, "second_queue", IGS_INTEGER_T, NULL, 0);
+    igsagent_observe_input(secondAgent, "second_queue", splitQueueCallback, NULL);
+    igsagent_split_add(secondAgent, "second_queue", "firstAgent", "first_queue");
+    igsagent_split_queue_set(firstAgent, 2, IGS_QUEUE_COALESCE);
+    //worker receives values up to its credit, next ones are queued
+    splitQueueHold = true;
+    for (int i = 1; i <= IGS_DEFAULT_WORKER_CREDIT + 2; i++)
+        igsagent_output_set_int(firstAgent, "first_queue", i);
+    assert(igsagent_split_queue_size(firstAgent, "first_queue") == 2);
+    assert(igsagent_split_queue_dropped(firstAgent, "first_queue") == 0);
+    //without split key, the newest queued value is replaced
+    igsagent_output_set_int(firstAgent, "first_queue", 100);
+    assert(igsagent_split_queue_size(firstAgent, "first_queue") == 2);
+    assert(igsagent_split_queue_dropped(firstAgent, "first_queue") == 1);
+    //with split keys, the queued value with the same key is replaced
+    //and the oldest one is dropped if none matches
+    igsagent_split_queue_set(firstAgent, 3, IGS_QUEUE_COALESCE);
+    igsagent_split_set_key(firstAgent, "first_queue", "a");
+    igsagent_output_set_int(firstAgent, "first_queue", 200);
+    igsagent_split_set_key(firstAgent, "first_queue", "b");
+    igsagent_output_set_int(firstAgent, "first_queue", 300);
+    assert(igsagent_split_queue_dropped(firstAgent, "first_queue") == 2);
+    igsagent_split_set_key(firstAgent, "first_queue", "a");
+    igsagent_output_set_int(firstAgent, "first_queue", 400);
+    assert(igsagent_split_queue_size(firstAgent, "first_queue") == 3);
+    assert(igsagent_split_queue_dropped(firstAgent, "first_queue") == 3);
+    splitQueueHold = false;
+    splitQueueWait(firstAgent, "first_queue");
+    assert(splitQueueCount == IGS_DEFAULT_WORKER_CREDIT + 3);
+    assert(splitQueueSum == IGS_DEFAULT_WORKER_CREDIT * (IGS_DEFAULT_WORKER_CREDIT + 1) / 2 + 100 + 400 + 300);
+    assert(splitQueueLast == 300);
+    //new values are dropped when the queue is full
+    igsagent_split_set_key(firstAgent, "first_queue", NULL);
+    igsagent_split_queue_set(firstAgent, 1, IGS_QUEUE_DROP_NEWEST);
+    splitQueueHold = true;
+    splitQueueCount = 0;
+    splitQueueSum = 0;
+    for (int i = 1; i <= IGS_DEFAULT_WORKER_CREDIT + 2; i++)
+        igsagent_output_set_int(firstAgent, "first_queue", i);
+    assert(igsagent_split_queue_size(firstAgent, "first_queue") == 1);
+    assert(igsagent_split_queue_dropped(firstAgent, "first_queue") == 4);
+    //blocking gives up after its timeout when no work is acknowledged
+    igsagent_split_queue_set(firstAgent, 1, IGS_QUEUE_BLOCK);
+    igsagent_output_set_int(firstAgent, "first_queue", 1000);
+    assert(igsagent_split_queue_size(firstAgent, "first_queue") == 1);
+    assert(igsagent_split_queue_dropped(firstAgent, "first_queue") == 5);
+    splitQueueHold = false;
+    splitQueueWait(firstAgent, "first_queue");
+    assert(splitQueueCount == IGS_DEFAULT_WORKER_CREDIT + 1);
+    assert(splitQueueLast == IGS_DEFAULT_WORKER_CREDIT + 1);
+    igsagent_split_queue_set(firstAgent, 0, IGS_QUEUE_DROP_OLDEST);
+    igsagent_split_remove_with_name(secondAgent, "second_queue", "firstAgent", "first_queue");
+
+    //test split scheduling on service time in same process
+    igsagent_split_set_scheduling(firstAgent, IGS_SPLIT_SCHEDULING_LATENCY);
+    assert(igsagent_split_scheduling(firstAgent) == IGS_SPLIT_SCHEDULING_LATENCY);
+    igsagent_output_create(firstAgent, "first_sched", IGS_INTEGER_T, NULL, 0);
+    igsagent_input_create(secondAgent, "second_fast", IGS_INTEGER_T, NULL, 0);
+    igsagent_input_create(secondAgent, "second_slow", IGS_INTEGER_T, NULL, 0);
+    igsagent_observe_input(secondAgent, "second_fast", splitQueueCallback, NULL);
+    igsagent_observe_input(secondAgent, "second_slow", splitSlowCallback, NULL);
+    igsagent_split_add(secondAgent, "second_fast", "firstAgent", "first_sched");
+    igsagent_split_add(secondAgent, "second_slow", "firstAgent", "first_sched");
+    //workers not measured yet are tried first, then the fastest one is preferred
+    for (int i = 0; i < 6; i++){
+        igsagent_output_set_int(firstAgent, "first_sched", i);
+        splitQueueWait(firstAgent, "first_sched");
+    }
+    double fastTime = 0;
+    double slowTime = 0;
+    assert(splitWorksDone(firstAgent, "first_sched", "second_fast", &fastTime) == 5);
+    assert(splitWorksDone(firstAgent, "first_sched", "second_slow", &slowTime) == 1);
+    assert(fastTime > 0 && slowTime >= 20 && fastTime < slowTime);
+    igsagent_split_set_scheduling(firstAgent, IGS_SPLIT_SCHEDULING_CREDIT);
+    igsagent_split_remove_with_name(secondAgent, "second_fast", "firstAgent", "first_sched");
+    igsagent_split_remove_with_name(secondAgent, "second_slow", "firstAgent", "first_sched");
+
+    //test split key affinity in same process
+    igsagent_split_set_scheduling(firstAgent, IGS_SPLIT_SCHEDULING_KEY_AFFINITY);
+    igsagent_output_create(firstAgent, "first_affinity", IGS_INTEGER_T, NULL, 0);
+    igsagent_input_create(secondAgent, "second_affinity_a", IGS_INTEGER_T, NULL, 0);
+    igsagent_input_create(secondAgent, "second_affinity_b", IGS_INTEGER_T, NULL, 0);
+    igsagent_input_create(secondAgent, "second_affinity_c", IGS_INTEGER_T, NULL, 0);
+    igsagent_observe_input(secondAgent, "second_affinity_a", affinityCallback, NULL);
+    igsagent_observe_input(secondAgent, "second_affinity_b", affinityCallback, NULL);
+    igsagent_observe_input(secondAgent, "second_affinity_c", affinityCallback, NULL);
+    igsagent_split_add(secondAgent, "second_affinity_a", "firstAgent", "first_affinity");
+    igsagent_split_add(secondAgent, "second_affinity_b", "firstAgent", "first_affinity");
+    //values with the same key always reach the same worker
+    char affinityOwners[AFFINITY_KEYS] = {0};
+    for (int round = 0; round < 2; round++){
+        for (int i = 0; i < AFFINITY_KEYS; i++){
+            affinityOwner[i] = 0;
+            igsagent_output_set_int(firstAgent, "first_affinity", i);
+            splitQueueWait(firstAgent, "first_affinity");
+            assert(affinityOwner[i] == 'a' || affinityOwner[i] == 'b');
+            if (round == 0)
+                affinityOwners[i] = affinityOwner[i];
+            else
+                assert(affinityOwner[i] == affinityOwners[i]);
+        }
+    }
+    size_t ownedByA = 0;
+    for (int i = 0; i < AFFINITY_KEYS; i++)
+        ownedByA += (affinityOwners[i] == 'a');
+    assert(ownedByA > 0 && ownedByA < AFFINITY_KEYS);
+    //a joining worker only takes keys, a leaving worker only gives its own
+    igsagent_split_add(secondAgent, "second_affinity_c", "firstAgent", "first_affinity");
+    size_t ownedByC = 0;
+    for (int i = 0; i < AFFINITY_KEYS; i++){
+        affinityOwner[i] = 0;
+        igsagent_output_set_int(firstAgent, "first_affinity", i);
+        splitQueueWait(firstAgent, "first_affinity");
+        if (affinityOwner[i] == 'c')
+            ownedByC++;
+        else
+            assert(affinityOwner[i] == affinityOwners[i]);
+    }
+    assert(ownedByC > 0);
+    igsagent_split_remove_with_name(secondAgent, "second_affinity_c", "firstAgent", "first_affinity");
+    for (int i = 0; i < AFFINITY_KEYS; i++){
+        affinityOwner[i] = 0;
+        igsagent_output_set_int(firstAgent, "first_affinity", i);
+        splitQueueWait(firstAgent, "first_affinity");
+        assert(affinityOwner[i] == affinityOwners[i]);
+    }
+    //a busy owner holds back its keys and the works behind them
+    int keyOfA = -1;
+    int keyOfB = -1;
+    for (int i = 0; i < AFFINITY_KEYS; i++){
+        if (affinityOwners[i] == 'a' && keyOfA < 0)
+            keyOfA = i;
+        if (affinityOwners[i] == 'b' && keyOfB < 0)
+            keyOfB = i;
+    }
+    size_t doneByB = splitWorksDone(firstAgent, "first_affinity", "second_affinity_b", NULL);
+    affinityCount = 0;
+    affinityOwner[keyOfB] = 0;
+    affinityHeldInput = "second_affinity_a";
+    for (int i = 0; i <= IGS_DEFAULT_WORKER_CREDIT; i++)
+        igsagent_output_set_int(firstAgent, "first_affinity", keyOfA);
+    assert(igsagent_split_queue_size(firstAgent, "first_affinity") == 1);
+    igsagent_output_set_int(firstAgent, "first_affinity", keyOfB);
+    assert(igsagent_split_queue_size(firstAgent, "first_affinity") == 2);
+    assert(splitWorksDone(firstAgent, "first_affinity", "second_affinity_b", NULL) == doneByB);
+    assert(affinityOwner[keyOfB] == 0);
+    affinityHeldInput = NULL;
+    splitQueueWait(firstAgent, "first_affinity");
+    assert(affinityCount == IGS_DEFAULT_WORKER_CREDIT + 2);
+    assert(affinityOwner[keyOfA] == 'a');
+    assert(affinityOwner[keyOfB] == 'b');
+    assert(splitWorksDone(firstAgent, "first_affinity", "second_affinity_b", NULL) == doneByB + 1);
+    igsagent_split_set_scheduling(firstAgent, IGS_SPLIT_SCHEDULING_CREDIT);
+    igsagent_split_remove_with_name(secondAgent, "second_affinity_a", "firstAgent", "first_affinity");
+    igsagent_split_remove_with_name(secondAgent, "second_affinity_b", "firstAgent", "first_affinity");
+
+    //test split redelivery in same process : works held by a worker
+    //leaving the split are requeued to the other one
+    igsagent_output_create(firstAgent, "first_redelivery", IGS_INTEGER_T, NULL, 0);
+    igsagent_input_create(secondAgent, "second_redelivery_a", IGS_INTEGER_T, NULL, 0);
+    igsagent_input_create(secondAgent, "second_redelivery_b", IGS_INTEGER_T, NULL, 0);
+    igsagent_observe_input(secondAgent, "second_redelivery_a", affinityCallback, NULL);
+    igsagent_observe_input(secondAgent, "second_redelivery_b", affinityCallback, NULL);
+    igsagent_split_add(secondAgent, "second_redelivery_a", "firstAgent", "first_redelivery");
+    assert(igsagent_split_max_retries(firstAgent) == IGS_DEFAULT_SPLIT_MAX_RETRIES);
+    for (int i = 0; i < AFFINITY_KEYS; i++)
+        affinityDeliveries[i] = 0;
+    affinityCount = 0;
+    affinityHeldInput = "second_redelivery_a";
+    for (int i = 0; i < IGS_DEFAULT_WORKER_CREDIT; i++)
+        igsagent_output_set_int(firstAgent, "first_redelivery", i);
+    assert(splitWorksInFlight(firstAgent, "first_redelivery", "second_redelivery_a") == IGS_DEFAULT_WORKER_CREDIT);
+    assert(igsagent_split_requeued(firstAgent, "first_redelivery") == 0);
+    igsagent_split_add(secondAgent, "second_redelivery_b", "firstAgent", "first_redelivery");
+    igsagent_split_remove_with_name(secondAgent, "second_redelivery_a", "firstAgent", "first_redelivery");
+    igsagent_output_set_int(firstAgent, "first_redelivery", IGS_DEFAULT_WORKER_CREDIT);
+    assert(igsagent_split_requeued(firstAgent, "first_redelivery") == IGS_DEFAULT_WORKER_CREDIT);
+    assert(igsagent_split_queue_size(firstAgent, "first_redelivery") == 1);
+    assert(splitWorksInFlight(firstAgent, "first_redelivery", "second_redelivery_b") == IGS_DEFAULT_WORKER_CREDIT);
+    affinityHeldInput = NULL;
+    splitQueueWait(firstAgent, "first_redelivery");
+    //every value is delivered at least once, held ones also to the leaving worker
+    assert(affinityCount == 2 * IGS_DEFAULT_WORKER_CREDIT + 1);
+    for (int i = 0; i <= IGS_DEFAULT_WORKER_CREDIT; i++)
+        assert(affinityDeliveries[i] == ((i < IGS_DEFAULT_WORKER_CREDIT) ? 2 : 1));
+    assert(splitWorksDone(firstAgent, "first_redelivery", "second_redelivery_b", NULL) == IGS_DEFAULT_WORKER_CREDIT + 1);
+    assert(igsagent_split_queue_dropped(firstAgent, "first_redelivery") == 0);
+    //works reaching their max number of retries are dropped
+    igsagent_split_set_max_retries(firstAgent, 0);
+    assert(igsagent_split_max_retries(firstAgent) == 0);
+    affinityHeldInput = "second_redelivery_b";
+    for (int i = 10; i < 10 + IGS_DEFAULT_WORKER_CREDIT; i++)
+        igsagent_output_set_int(firstAgent, "first_redelivery", i);
+    igsagent_split_add(secondAgent, "second_redelivery_a", "firstAgent", "first_redelivery");
+    igsagent_split_remove_with_name(secondAgent, "second_redelivery_b", "firstAgent", "first_redelivery");
+    igsagent_output_set_int(firstAgent, "first_redelivery", 20);
+    assert(igsagent_split_requeued(firstAgent, "first_redelivery") == IGS_DEFAULT_WORKER_CREDIT);
+    assert(igsagent_split_queue_dropped(firstAgent, "first_redelivery") == IGS_DEFAULT_WORKER_CREDIT);
+    affinityHeldInput = NULL;
+    splitQueueWait(firstAgent, "first_redelivery");
+    assert(affinityOwner[20] == 'a');
+    assert(splitWorksDone(firstAgent, "first_redelivery", "second_redelivery_a", NULL) == 1);
+    igsagent_split_set_max_retries(firstAgent, IGS_DEFAULT_SPLIT_MAX_RETRIES);
+    igsagent_split_remove_with_name(secondAgent, "second_redelivery_a", "firstAgent", "first_redelivery");
+
     //test service in the same process
     list = NULL;
     igs_service_args_add_bool(&list, true);
@@ -1709,6 +2685,62 @@ int main(int argc, const char * argv[]) {
     igs_service_args_add_data(&list, data, dataSize);
     igsagent_service_call(firstAgent, "secondAgent", "secondService", &list, "token");
 
+    //test asynchronous service calls in the same process
+    igsagent_service_init(secondAgent, "asyncService", asyncServiceCallback, NULL);
+    igsagent_service_arg_add(secondAgent, "asyncService", "value", IGS_INTEGER_T);
+    //completion through the reply callback
+    list = NULL;
+    igs_service_args_add_int(&list, 21);
+    uint64_t callId = igsagent_service_call_async(firstAgent, "secondAgent", "asyncService", &list,
+                                                  0, asyncReplyCallback, NULL);
+    assert(callId > 0);
+    assert(asyncReplyCount == 1 && asyncReplyId == callId);
+    assert(asyncReplyStatus == IGS_SERVICE_CALL_REPLIED && asyncReplyValue == 42);
+    //completion collected by waiting
+    list = NULL;
+    igs_service_args_add_int(&list, 5);
+    callId = igsagent_service_call_async(firstAgent, "secondAgent", "asyncService", &list, 0, NULL, NULL);
+    assert(callId > 0);
+    igs_service_arg_t *reply = NULL;
+    assert(igs_service_call_wait(callId, &reply) == IGS_SERVICE_CALL_REPLIED);
+    assert(reply && reply->type == IGS_INTEGER_T && reply->i == 10 && reply->next == NULL);
+    igs_service_args_destroy(&reply);
+    assert(igs_service_call_wait(callId, &reply) == IGS_SERVICE_CALL_FAILED); //already collected
+    size_t histogram[IGS_SERVICE_LATENCY_BUCKETS] = {0};
+    assert(igsagent_service_latencies(firstAgent, "asyncService", histogram, IGS_SERVICE_LATENCY_BUCKETS) == 2);
+    //timeout while waiting
+    asyncServiceShallReply = false;
+    list = NULL;
+    igs_service_args_add_int(&list, 1);
+    callId = igsagent_service_call_async(firstAgent, "secondAgent", "asyncService", &list, 50, NULL, NULL);
+    assert(callId > 0);
+    int64_t waitStart = zclock_mono();
+    assert(igs_service_call_wait(callId, &reply) == IGS_SERVICE_CALL_TIMED_OUT);
+    assert(zclock_mono() - waitStart >= 45 && reply == NULL);
+    //cancel, with and without callback
+    list = NULL;
+    igs_service_args_add_int(&list, 1);
+    callId = igsagent_service_call_async(firstAgent, "secondAgent", "asyncService", &list, 0, NULL, NULL);
+    igs_service_call_cancel(callId);
+    assert(igs_service_call_wait(callId, &reply) == IGS_SERVICE_CALL_CANCELLED);
+    list = NULL;
+    igs_service_args_add_int(&list, 1);
+    callId = igsagent_service_call_async(firstAgent, "secondAgent", "asyncService", &list,
+                                         0, asyncReplyCallback, NULL);
+    assert(asyncReplyCount == 1);
+    igs_service_call_cancel(callId);
+    assert(asyncReplyCount == 2 && asyncReplyId == callId && asyncReplyStatus == IGS_SERVICE_CALL_CANCELLED);
+    igs_service_call_cancel(callId); //completes only once
+    assert(asyncReplyCount == 2);
+    asyncServiceShallReply = true;
+    //calls which cannot be sent return zero and do not call back
+    list = NULL;
+    igs_service_args_add_int(&list, 1);
+    assert(igsagent_service_call_async(firstAgent, "unknownAgent", "asyncService", &list,
+                                       0, asyncReplyCallback, NULL) == 0);
+    assert(asyncReplyCount == 2);
+    igsagent_service_remove(secondAgent, "asyncService");
+
     //test agent events in same process
     igsagent_deactivate(secondAgent);
     igsagent_deactivate(firstAgent);
@@ -1789,6 +2821,35 @@ int main(int argc, const char * argv[]) {
         igs_stop();
         
         igs_start_with_device(networkDevice, port);
+
+        //works not acknowledged within the work timeout are requeued by
+        //the ingescape loop and late acknowledgments are ignored
+        igsagent_split_add(secondAgent, "second_redelivery_a", "firstAgent", "first_redelivery");
+        igsagent_split_set_work_timeout(firstAgent, 50);
+        assert(igsagent_split_work_timeout(firstAgent) == 50);
+        size_t requeuedBefore = igsagent_split_requeued(firstAgent, "first_redelivery");
+        for (int i = 0; i < AFFINITY_KEYS; i++)
+            affinityDeliveries[i] = 0;
+        affinityHeldInput = "second_redelivery_a";
+        for (int i = 30; i < 30 + IGS_DEFAULT_WORKER_CREDIT; i++)
+            igsagent_output_set_int(firstAgent, "first_redelivery", i);
+        assert(splitWorksInFlight(firstAgent, "first_redelivery", "second_redelivery_a") == IGS_DEFAULT_WORKER_CREDIT);
+        igsagent_split_add(secondAgent, "second_redelivery_b", "firstAgent", "first_redelivery");
+        int64_t requeueDeadline = zclock_mono() + 2000;
+        while (igsagent_split_requeued(firstAgent, "first_redelivery") < requeuedBefore + IGS_DEFAULT_WORKER_CREDIT
+               && zclock_mono() < requeueDeadline)
+            zclock_sleep(1);
+        assert(igsagent_split_requeued(firstAgent, "first_redelivery") == requeuedBefore + IGS_DEFAULT_WORKER_CREDIT);
+        assert(splitWorksInFlight(firstAgent, "first_redelivery", "second_redelivery_a") == 0);
+        affinityHeldInput = NULL;
+        splitQueueWait(firstAgent, "first_redelivery");
+        for (int i = 30; i < 30 + IGS_DEFAULT_WORKER_CREDIT; i++)
+            assert(affinityDeliveries[i] >= 1);
+        assert(splitWorksDone(firstAgent, "first_redelivery", "second_redelivery_a", NULL) == 0);
+        assert(splitWorksDone(firstAgent, "first_redelivery", "second_redelivery_b", NULL) == IGS_DEFAULT_WORKER_CREDIT);
+        igsagent_split_set_work_timeout(firstAgent, 0);
+        igsagent_split_remove_with_name(secondAgent, "second_redelivery_a", "firstAgent", "first_redelivery");
+        igsagent_split_remove_with_name(secondAgent, "second_redelivery_b", "firstAgent", "first_redelivery");
         igs_channel_join("TEST_CHANNEL");
         zloop_t *loop = zloop_new();
         zsock_t *pipe = igs_pipe_to_ingescape();
@@ -1796,8 +2857,71 @@ int main(int argc, const char * argv[]) {
         igs_info("ready to start autotests");
         zloop_start(loop);
         zloop_destroy(&loop);
+        size_t executed = 0, rejected = 0;
+        double queueTime = 0, runTime = 0;
+        assert(igs_service_metrics("concurrentService", &executed, &rejected,
+                                   &queueTime, &runTime) == IGS_SUCCESS);
+        assert(executed == 3 && rejected == 1);
+        assert(queueTime > 20 && runTime > 50);
+        assert(twinOutputsSum == 3);
+        igs_stop();
+
+        //additional pass with lazy and lean definitions, partner waiting
+        //for us to stop it
+        //partner definition is fetched because we map and split to it
+        igs_net_set_lazy_definitions(true);
+        //we only use outputs and services of remote agents,
+        //lean definitions of the twins are shared
+        igs_net_set_lean_remote_definitions(true);
+        //fetched definitions are stored in a fresh cache
+        zdir_t *cacheDir = zdir_new("/tmp/igs_tester_definitions_cache", NULL);
+        if (cacheDir){
+            zdir_remove(cacheDir, true);
+            zdir_destroy(&cacheDir);
+        }
+        igs_net_set_definitions_cache_path("/tmp/igs_tester_definitions_cache");
+        tester_partnerDefinitionFetched = false;
+        igs_start_with_device(networkDevice, port);
+        //partner and its twins, the twins sharing their definition
+        size_t nbRemoteAgents = 0;
+        int64_t lazyDeadline = zclock_mono() + 5000;
+        while ((!tester_partnerDefinitionFetched
+                || igs_net_remote_definitions_footprint(&nbRemoteAgents) == 0
+                || nbRemoteAgents != 3)
+               && zclock_mono() < lazyDeadline)
+            zclock_sleep(10);
+        assert(tester_partnerDefinitionFetched);
+        assert(igs_net_remote_definitions_footprint(&nbRemoteAgents) > 0);
+        assert(nbRemoteAgents == 3);
+        assert(igs_net_lean_remote_definitions());
+        igs_channel_whisper_str("partner", "STOP_PEER");
+        zclock_sleep(100);
         igsagent_destroy(&secondAgent);
         igs_stop();
+        //cache files are written when stopping and named by their SHA-1
+        cacheDir = zdir_new("/tmp/igs_tester_definitions_cache", NULL);
+        assert(cacheDir && zdir_count(cacheDir) > 0);
+        zfile_t **cacheFiles = zdir_flatten(cacheDir);
+        for (size_t i = 0; cacheFiles[i]; i++){
+            assert(zfile_input(cacheFiles[i]) == 0);
+            zchunk_t *cacheData = zfile_read(cacheFiles[i], zfile_cursize(cacheFiles[i]), 0);
+            assert(cacheData);
+            char *cacheContent = zchunk_strdup(cacheData);
+            zdigest_t *sha1 = zdigest_new();
+            zdigest_update(sha1, (const byte *)cacheContent, strlen(cacheContent));
+            char expectedName[64] = "";
+            snprintf(expectedName, 64, "%s.json", zdigest_string(sha1));
+            assert(streq(expectedName, zfile_filename(cacheFiles[i], "/tmp/igs_tester_definitions_cache/")));
+            zdigest_destroy(&sha1);
+            free(cacheContent);
+            zchunk_destroy(&cacheData);
+            zfile_close(cacheFiles[i]);
+        }
+        zdir_flatten_free(&cacheFiles);
+        zdir_destroy(&cacheDir);
+        igs_net_set_definitions_cache_path(NULL);
+        igs_net_set_lean_remote_definitions(false);
+        igs_net_set_lazy_definitions(false);
         igsagent_destroy(&firstAgent);
         igs_clear_context();
         exit(EXIT_SUCCESS);